@@ -8,7 +8,11 @@
 #define AVLSET_HPP
 
 #include "Set.hpp"
+#include "SetSnapshot.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 
 
@@ -53,11 +57,36 @@ public:
     virtual bool contains(const T& element) const;
 
 
+    // containsBatch() checks several elements at once by descending the
+    // tree for a window of elements in lockstep, one level per round, and
+    // prefetching the next node of every element before comparing any of
+    // them, so the cache misses of the whole window overlap.  This function
+    // always runs in O(log n) time per element when there are n elements in
+    // the AVL tree.
+    virtual std::vector<bool> containsBatch(const std::vector<T>& elements) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const;
 
 
+    // A snapshot of an AVLSet holds its size, then its nodes in preorder,
+    // each as a byte saying which children it has, its height, and its
+    // key, so that the tree is loaded in exactly the same shape, with no
+    // rotations.  The tree is walked with a stack rather than recursively,
+    // both ways.  A snapshot is refused unless its keys are in order and
+    // every height is right and balanced, so a loaded tree is as shallow
+    // as one built by add().
+    virtual bool saveSnapshot(std::ostream& out) const;
+    virtual bool loadSnapshot(std::istream& in);
+
+
 private:
+    // The bits of the byte in a snapshot that says which children a node
+    // has.
+    static constexpr std::uint8_t SNAPSHOT_LEFT = 1;
+    static constexpr std::uint8_t SNAPSHOT_RIGHT = 2;
+
     struct Node {
         T key;
         Node* left = nullptr;
@@ -69,11 +98,24 @@ private:
     int treeSize;
 
 private:
-    void copyNode(Node& copy, Node& orig);
-    void deleteTree(Node* n);
-    int getHeight(Node* n);
-    void leftRotate(Node* n);
-    void rightRotate(Node* n);
+    // A leaf has a height of zero, so an empty subtree has a height of -1.
+    static int heightOf(const Node* n);
+    static void updateHeight(Node* n);
+
+    // insert() adds the element to the subtree with the given root, if it
+    // isn't already there, and returns the subtree's new root once it's
+    // been rebalanced.  It recurses once per level, which is safe because
+    // the tree is always balanced, even when it's loaded from a snapshot.
+    Node* insert(Node* n, const T& element);
+
+    static Node* rebalance(Node* n);
+    static Node* rotateLeft(Node* n);
+    static Node* rotateRight(Node* n);
+
+    // Copying and deleting trees is done with a stack, the same way that
+    // snapshots are saved and loaded.
+    static Node* copyTree(const Node* root);
+    static void deleteTree(Node* root);
 };
 
 
@@ -94,31 +136,32 @@ AVLSet<T>::~AVLSet()
 
 template <typename T>
 AVLSet<T>::AVLSet(const AVLSet& s)
+    : head{copyTree(s.head)}, treeSize{s.treeSize}
 {
-    copyNode(head, s.head);
-    treeSize = s.treeSize;
 }
 
 
 template <typename T>
 AVLSet<T>::AVLSet(AVLSet&& s)
-    :head{nullptr}
+    : head{nullptr}, treeSize{0}
 {
     std::swap(head, s.head);
-    treeSize = s.treeSize;
+    std::swap(treeSize, s.treeSize);
 }
 
 
 template <typename T>
 AVLSet<T>& AVLSet<T>::operator=(const AVLSet& s)
 {
-    if (this != &s) {
+    if (this != &s)
+    {
+        Node* copy = copyTree(s.head);
         deleteTree(head);
-        head = nullptr;
-        copyNode(head, s.head);
+        head = copy;
         treeSize = s.treeSize;
-    return *this;
     }
+
+    return *this;
 }
 
 
@@ -126,6 +169,7 @@ template <typename T>
 AVLSet<T>& AVLSet<T>::operator=(AVLSet&& s)
 {
     std::swap(head, s.head);
+    std::swap(treeSize, s.treeSize);
     return *this;
 }
 
@@ -141,116 +185,365 @@ bool AVLSet<T>::isImplemented() const
 template <typename T>
 void AVLSet<T>::add(const T& element)
 {
-    if(head == nullptr){
-        head = new Node{element};
-        treeSize++;
+    head = insert(head, element);
+}
+
+
+template <typename T>
+bool AVLSet<T>::contains(const T& element) const
+{
+    Node* curr = head;
+
+    while(curr != nullptr){
+        if(curr->key == element) return true;
+        else if(element < curr->key) curr = curr->left;
+        else curr = curr->right;
     }
-    else{
-        Node* curr = head;
 
-        while(curr != nullptr){
-            if(element == curr->key) return;
-            else if(element < curr->key) curr = curr->left;
-            else if(element > curr->key) curr = curr->right;
+    return false;
+}
+
+
+template <typename T>
+std::vector<bool> AVLSet<T>::containsBatch(const std::vector<T>& elements) const
+{
+    std::vector<bool> results(elements.size(), false);
+    Node* cursors[CONTAINS_BATCH_WINDOW];
+
+    for (size_t first = 0; first < elements.size(); first += CONTAINS_BATCH_WINDOW)
+    {
+        size_t count = std::min<size_t>(CONTAINS_BATCH_WINDOW, elements.size() - first);
+        size_t remaining = count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            cursors[i] = head;
         }
 
-        head = new Node{element};
-        head->height = 1+max(getHeight(head->left),getHeight(head->right));
-        treeSize++;
+        while (remaining > 0)
+        {
+            remaining = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                Node* curr = cursors[i];
+
+                if (curr == nullptr)
+                {
+                    continue;
+                }
+
+                const T& element = elements[first + i];
+
+                if (curr->key == element)
+                {
+                    results[first + i] = true;
+                    cursors[i] = nullptr;
+                    continue;
+                }
+
+                cursors[i] = element < curr->key ? curr->left : curr->right;
+
+                if (cursors[i] != nullptr)
+                {
+                    __builtin_prefetch(cursors[i]);
+                    ++remaining;
+                }
+            }
+        }
     }
 
-    int balance = getHeight(head->left) - getHeight(head->right);
+    return results;
+}
 
-    //left left
-    if(balance>1 && element < head->left->key) rightRotate(head);
 
-    //right right
-    if(balance<-1 && element > head->right->key) leftRotate(head);
+template <typename T>
+unsigned int AVLSet<T>::size() const
+{
+    return treeSize;
+}
+
+template <typename T>
+bool AVLSet<T>::saveSnapshot(std::ostream& out) const
+{
+    writeSnapshotHeader(out, "AVL");
+    writeSnapshotInteger<std::uint32_t>(out, treeSize);
+
+    std::vector<Node*> stack;
 
-    //left right
-    if(balance>1 && element > head->left->key){
-        leftRotate(head->left);
-        rightRotate(head);
+    if (head != nullptr)
+    {
+        stack.push_back(head);
     }
 
-    //right left
-    if(balance<-1 && element < head->right->key){
-        rightRotate(head->right);
-        leftRotate(head->left);
+    while (!stack.empty())
+    {
+        Node* n = stack.back();
+        stack.pop_back();
+
+        std::uint8_t children =
+            (n->left != nullptr ? SNAPSHOT_LEFT : 0) | (n->right != nullptr ? SNAPSHOT_RIGHT : 0);
+
+        writeSnapshotInteger(out, children);
+        writeSnapshotLength(out, static_cast<std::uint32_t>(n->height));
+        writeSnapshotElement(out, n->key);
+
+        if (n->right != nullptr)
+        {
+            stack.push_back(n->right);
+        }
+
+        if (n->left != nullptr)
+        {
+            stack.push_back(n->left);
+        }
     }
+
+    return static_cast<bool>(out.flush());
 }
 
 
 template <typename T>
-bool AVLSet<T>::contains(const T& element) const
+bool AVLSet<T>::loadSnapshot(std::istream& in)
 {
-    Node* curr = head;
+    std::uint32_t newSize;
 
-    while(curr != nullptr){
-        if(curr->key == element) return true;
-        else if(element < curr->key) curr = curr->left;
-        else curr = curr->right;
+    if (!readSnapshotHeader(in, "AVL") || !readSnapshotInteger(in, newSize))
+    {
+        return false;
     }
 
-    return false;
+    // Each entry on the stack is where the next node read belongs.  Every
+    // node is also kept in a list, so that if the snapshot turns out not
+    // to be valid, they can be deleted without walking the tree.
+    Node* root = nullptr;
+    std::vector<Node*> nodes;
+    std::vector<Node**> stack;
+
+    if (newSize > 0)
+    {
+        stack.push_back(&root);
+    }
+
+    while (!stack.empty())
+    {
+        Node** slot = stack.back();
+        stack.pop_back();
+
+        std::uint8_t children;
+        std::uint64_t height;
+        T key;
+
+        if (nodes.size() == newSize || !readSnapshotInteger(in, children)
+            || !readSnapshotLength(in, height) || !readSnapshotElement(in, key))
+        {
+            break;
+        }
+
+        *slot = new Node{key};
+        (*slot)->height = static_cast<std::int32_t>(height);
+        nodes.push_back(*slot);
+
+        if ((children & SNAPSHOT_RIGHT) != 0)
+        {
+            stack.push_back(&(*slot)->right);
+        }
+
+        if ((children & SNAPSHOT_LEFT) != 0)
+        {
+            stack.push_back(&(*slot)->left);
+        }
+    }
+
+    bool valid = stack.empty() && nodes.size() == newSize && snapshotTreeIsOrdered(root);
+
+    // The nodes are in preorder, so going through them backward reaches
+    // every node's children before the node itself, and the heights can
+    // be checked from the bottom up.
+    for (auto n = nodes.rbegin(); valid && n != nodes.rend(); ++n)
+    {
+        int leftHeight = heightOf((*n)->left);
+        int rightHeight = heightOf((*n)->right);
+
+        valid = (*n)->height == 1 + std::max(leftHeight, rightHeight)
+            && leftHeight - rightHeight <= 1 && rightHeight - leftHeight <= 1;
+    }
+
+    if (!valid)
+    {
+        for (Node* n : nodes)
+        {
+            delete n;
+        }
+
+        return false;
+    }
+
+    deleteTree(head);
+    head = root;
+    treeSize = newSize;
+    return true;
 }
 
 
 template <typename T>
-unsigned int AVLSet<T>::size() const
+int AVLSet<T>::heightOf(const Node* n)
 {
-    return treeSize;
+    return n == nullptr ? -1 : n->height;
 }
 
+
 template <typename T>
-void AVLSet<T>::copyNode(Node& copy, Node& orig){
-    if(orig == nullptr) copy = nullptr;
-    else{
-        copy = new Node();
-        copy->key = orig->key;
-        copy->height = orig->height;
-        copy->left = orig->left;
-        copy->right = orig->right;
-
-        if(orig->left != nullptr) copyNode(copy->left, orig->left);
-        if(orig->right != nullptr) copyNode(copy->right, orig->right);
-    }
+void AVLSet<T>::updateHeight(Node* n)
+{
+    n->height = 1 + std::max(heightOf(n->left), heightOf(n->right));
 }
 
+
 template <typename T>
-void AVLSet<T>::deleteTree(Node* n){
-    if(n->left != nullptr) deleteTree(n->left);
-    if(n->right != nullptr) deleteTree(n->right);
-    if(n != nullptr) delete n;
+typename AVLSet<T>::Node* AVLSet<T>::insert(Node* n, const T& element)
+{
+    if (n == nullptr)
+    {
+        ++treeSize;
+        return new Node{element};
+    }
+    else if (n->key == element)
+    {
+        return n;
+    }
+    else if (element < n->key)
+    {
+        n->left = insert(n->left, element);
+    }
+    else
+    {
+        n->right = insert(n->right, element);
+    }
+
+    return rebalance(n);
 }
 
+
 template <typename T>
-int AVLSet<T>::getHeight(Node* n){
-    return n->height;
+typename AVLSet<T>::Node* AVLSet<T>::rebalance(Node* n)
+{
+    updateHeight(n);
+    int balance = heightOf(n->left) - heightOf(n->right);
+
+    if (balance > 1)
+    {
+        if (heightOf(n->left->left) < heightOf(n->left->right))
+        {
+            n->left = rotateLeft(n->left);
+        }
+
+        return rotateRight(n);
+    }
+    else if (balance < -1)
+    {
+        if (heightOf(n->right->right) < heightOf(n->right->left))
+        {
+            n->right = rotateRight(n->right);
+        }
+
+        return rotateLeft(n);
+    }
+
+    return n;
 }
 
+
 template <typename T>
-void AVLSet<T>::leftRotate(Node* n){
+typename AVLSet<T>::Node* AVLSet<T>::rotateLeft(Node* n)
+{
     Node* m = n->right;
-    Node* t2 = m->left;
-
+    n->right = m->left;
     m->left = n;
-    n->right = t2;
 
-    n->height = 1+ max(getHeight(n->left), getHeight(n->right));
-    m->height = 1+ max(getHeight(m->left), getHeight(m->right));
+    updateHeight(n);
+    updateHeight(m);
+    return m;
 }
 
+
 template <typename T>
-void AVLSet<T>::rightRotate(Node* n){
+typename AVLSet<T>::Node* AVLSet<T>::rotateRight(Node* n)
+{
     Node* m = n->left;
-    Node* t2 = m->right;
-
+    n->left = m->right;
     m->right = n;
-    n->left = t2;
 
-    n->height = 1+ max(getHeight(n->left), getHeight(n->right));
-    m->height = 1+ max(getHeight(m->left), getHeight(m->right));
+    updateHeight(n);
+    updateHeight(m);
+    return m;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::copyTree(const Node* root)
+{
+    Node* copy = nullptr;
+    std::vector<std::pair<const Node*, Node**>> stack;
+
+    if (root != nullptr)
+    {
+        stack.emplace_back(root, &copy);
+    }
+
+    while (!stack.empty())
+    {
+        auto [original, slot] = stack.back();
+        stack.pop_back();
+
+        *slot = new Node{original->key};
+        (*slot)->height = original->height;
+
+        if (original->left != nullptr)
+        {
+            stack.emplace_back(original->left, &(*slot)->left);
+        }
+
+        if (original->right != nullptr)
+        {
+            stack.emplace_back(original->right, &(*slot)->right);
+        }
+    }
+
+    return copy;
 }
+
+
+template <typename T>
+void AVLSet<T>::deleteTree(Node* root)
+{
+    std::vector<Node*> stack;
+
+    if (root != nullptr)
+    {
+        stack.push_back(root);
+    }
+
+    while (!stack.empty())
+    {
+        Node* n = stack.back();
+        stack.pop_back();
+
+        if (n->left != nullptr)
+        {
+            stack.push_back(n->left);
+        }
+
+        if (n->right != nullptr)
+        {
+            stack.push_back(n->right);
+        }
+
+        delete n;
+    }
+}
+
+
+
 #endif // AVLSET_HPP
 
@@ -6,7 +6,12 @@
 #ifndef BSTSET_HPP
 #define BSTSET_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
 #include "Set.hpp"
+#include "SetSnapshot.hpp"
 
 
 
@@ -53,11 +58,33 @@ public:
     virtual bool contains(const T& element) const;
 
 
+    // containsBatch() checks several elements at once by descending the
+    // tree for a window of elements in lockstep, one level per round, and
+    // prefetching the next node of every element before comparing any of
+    // them, so the cache misses of the whole window overlap.
+    virtual std::vector<bool> containsBatch(const std::vector<T>& elements) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const;
 
 
+    // A snapshot of a BSTSet holds its size, then its nodes in preorder,
+    // each as a byte saying which children it has followed by its key, so
+    // that the tree is loaded in exactly the same shape, however
+    // unbalanced it is.  The tree is walked with a stack rather than
+    // recursively, both ways, so that a deep tree can't overflow the call
+    // stack.  A snapshot whose keys aren't in order is refused.
+    virtual bool saveSnapshot(std::ostream& out) const;
+    virtual bool loadSnapshot(std::istream& in);
+
+
 private:
+    // The bits of the byte in a snapshot that says which children a node
+    // has.
+    static constexpr std::uint8_t SNAPSHOT_LEFT = 1;
+    static constexpr std::uint8_t SNAPSHOT_RIGHT = 2;
+
     struct Node {
         T key;
         Node* left = nullptr;
@@ -68,8 +95,11 @@ private:
     int treeSize;
 
 private:
-    void copyNode(Node& copy, Node& orig);
-    void deleteTree(Node* n);
+    // Copying and deleting trees is done with a stack rather than
+    // recursively, since a tree built from sorted words is as deep as it
+    // is large.
+    static Node* copyTree(const Node* root);
+    static void deleteTree(Node* root);
 };
 
 
@@ -89,39 +119,40 @@ BSTSet<T>::~BSTSet()
 
 template <typename T>
 BSTSet<T>::BSTSet(const BSTSet& s)
-    :head{nullptr}
+    : head{copyTree(s.head)}, treeSize{s.treeSize}
 {
-    copyNode(head, s.head);
-    treeSize = s.treeSize;
 }
 
 
 template <typename T>
 BSTSet<T>::BSTSet(BSTSet&& s)
-    :head{nullptr}
+    : head{nullptr}, treeSize{0}
 {
     std::swap(head, s.head);
-    treeSize = s.treeSize;
+    std::swap(treeSize, s.treeSize);
 }
 
 
 template <typename T>
 BSTSet<T>& BSTSet<T>::operator=(const BSTSet& s)
 {
-    if (this != &s) {
+    if (this != &s)
+    {
+        Node* copy = copyTree(s.head);
         deleteTree(head);
-        head = nullptr;
-        copyNode(head, s.head);
+        head = copy;
         treeSize = s.treeSize;
-    return *this;
     }
+
+    return *this;
 }
 
 
 template <typename T>
 BSTSet<T>& BSTSet<T>::operator=(BSTSet&& s)
 {
-    std::swap(head, s.head)
+    std::swap(head, s.head);
+    std::swap(treeSize, s.treeSize);
     return *this;
 }
 
@@ -136,21 +167,20 @@ bool BSTSet<T>::isImplemented() const
 template <typename T>
 void BSTSet<T>::add(const T& element)
 {
-    if(head = nullptr){
-        head = new Node{element};
-        treeSize++;
-    }
-    else{
-        Node* curr = head;
+    Node** slot = &head;
 
-        while(curr != nullptr){
-            if(element < curr->key) curr = curr->left;
-            else if(element > curr->key) curr = curr->right;
+    while (*slot != nullptr)
+    {
+        if ((*slot)->key == element)
+        {
+            return;
         }
 
-        head = new Node{element}
-        treeSize++
+        slot = element < (*slot)->key ? &(*slot)->left : &(*slot)->right;
     }
+
+    *slot = new Node{element};
+    ++treeSize;
 }
 
 
@@ -169,6 +199,59 @@ bool BSTSet<T>::contains(const T& element) const
 }
 
 
+template <typename T>
+std::vector<bool> BSTSet<T>::containsBatch(const std::vector<T>& elements) const
+{
+    std::vector<bool> results(elements.size(), false);
+    Node* cursors[CONTAINS_BATCH_WINDOW];
+
+    for (size_t first = 0; first < elements.size(); first += CONTAINS_BATCH_WINDOW)
+    {
+        size_t count = std::min<size_t>(CONTAINS_BATCH_WINDOW, elements.size() - first);
+        size_t remaining = count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            cursors[i] = head;
+        }
+
+        while (remaining > 0)
+        {
+            remaining = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                Node* curr = cursors[i];
+
+                if (curr == nullptr)
+                {
+                    continue;
+                }
+
+                const T& element = elements[first + i];
+
+                if (curr->key == element)
+                {
+                    results[first + i] = true;
+                    cursors[i] = nullptr;
+                    continue;
+                }
+
+                cursors[i] = element < curr->key ? curr->left : curr->right;
+
+                if (cursors[i] != nullptr)
+                {
+                    __builtin_prefetch(cursors[i]);
+                    ++remaining;
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+
 template <typename T>
 unsigned int BSTSet<T>::size() const
 {
@@ -176,24 +259,171 @@ unsigned int BSTSet<T>::size() const
 }
 
 template <typename T>
-void BSTSet<T>::copyNode(Node& copy, Node& orig){
-    if(orig == nullptr) copy = nullptr;
-    else{
-        copy = new Node();
-        copy->key = orig->key;
-        copy->left = orig->left;
-        copy->right = orig->right;
+bool BSTSet<T>::saveSnapshot(std::ostream& out) const
+{
+    writeSnapshotHeader(out, "BST");
+    writeSnapshotInteger<std::uint32_t>(out, treeSize);
+
+    std::vector<Node*> stack;
+
+    if (head != nullptr)
+    {
+        stack.push_back(head);
+    }
+
+    while (!stack.empty())
+    {
+        Node* n = stack.back();
+        stack.pop_back();
+
+        std::uint8_t children =
+            (n->left != nullptr ? SNAPSHOT_LEFT : 0) | (n->right != nullptr ? SNAPSHOT_RIGHT : 0);
+
+        writeSnapshotInteger(out, children);
+        writeSnapshotElement(out, n->key);
+
+        if (n->right != nullptr)
+        {
+            stack.push_back(n->right);
+        }
+
+        if (n->left != nullptr)
+        {
+            stack.push_back(n->left);
+        }
+    }
+
+    return static_cast<bool>(out.flush());
+}
+
+
+template <typename T>
+bool BSTSet<T>::loadSnapshot(std::istream& in)
+{
+    std::uint32_t newSize;
+
+    if (!readSnapshotHeader(in, "BST") || !readSnapshotInteger(in, newSize))
+    {
+        return false;
+    }
+
+    // Each entry on the stack is where the next node read belongs.  Every
+    // node is also kept in a list, so that if the snapshot turns out not
+    // to be valid, they can be deleted without walking the tree.
+    Node* root = nullptr;
+    std::vector<Node*> nodes;
+    std::vector<Node**> stack;
+
+    if (newSize > 0)
+    {
+        stack.push_back(&root);
+    }
+
+    while (!stack.empty())
+    {
+        Node** slot = stack.back();
+        stack.pop_back();
+
+        std::uint8_t children;
+        T key;
+
+        if (nodes.size() == newSize || !readSnapshotInteger(in, children)
+            || !readSnapshotElement(in, key))
+        {
+            break;
+        }
+
+        *slot = new Node{key};
+        nodes.push_back(*slot);
+
+        if ((children & SNAPSHOT_RIGHT) != 0)
+        {
+            stack.push_back(&(*slot)->right);
+        }
+
+        if ((children & SNAPSHOT_LEFT) != 0)
+        {
+            stack.push_back(&(*slot)->left);
+        }
+    }
+
+    if (!stack.empty() || nodes.size() != newSize || !snapshotTreeIsOrdered(root))
+    {
+        for (Node* n : nodes)
+        {
+            delete n;
+        }
+
+        return false;
+    }
+
+    deleteTree(head);
+    head = root;
+    treeSize = newSize;
+    return true;
+}
+
+
+template <typename T>
+typename BSTSet<T>::Node* BSTSet<T>::copyTree(const Node* root)
+{
+    Node* copy = nullptr;
+    std::vector<std::pair<const Node*, Node**>> stack;
+
+    if (root != nullptr)
+    {
+        stack.emplace_back(root, &copy);
+    }
 
-        if(orig->left != nullptr) copyNode(copy->left, orig->left);
-        if(origh->right != nullptr) copyNode(copy->right, orig->right);
+    while (!stack.empty())
+    {
+        auto [original, slot] = stack.back();
+        stack.pop_back();
+
+        *slot = new Node{original->key};
+
+        if (original->left != nullptr)
+        {
+            stack.emplace_back(original->left, &(*slot)->left);
+        }
+
+        if (original->right != nullptr)
+        {
+            stack.emplace_back(original->right, &(*slot)->right);
+        }
     }
+
+    return copy;
 }
 
+
 template <typename T>
-void BSTSet<T>::deleteTree(Node* n){
-    if(n->left != nullptr) deleteTree(n->left);
-    if(n->right != nullptr) deleteTree(n->right);
-    if(n != nullptr) delete n;
+void BSTSet<T>::deleteTree(Node* root)
+{
+    std::vector<Node*> stack;
+
+    if (root != nullptr)
+    {
+        stack.push_back(root);
+    }
+
+    while (!stack.empty())
+    {
+        Node* n = stack.back();
+        stack.pop_back();
+
+        if (n->left != nullptr)
+        {
+            stack.push_back(n->left);
+        }
+
+        if (n->right != nullptr)
+        {
+            stack.push_back(n->right);
+        }
+
+        delete n;
+    }
 }
 
 
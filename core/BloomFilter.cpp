@@ -0,0 +1,176 @@
+// BloomFilter.cpp
+
+#include <algorithm>
+#include <cmath>
+#include "BloomFilter.hpp"
+
+
+
+namespace
+{
+    // The 64-bit FNV-1a hash, followed by a final mixing step so that
+    // both halves of the result are well distributed.
+    std::uint64_t mixedFnv1a(const std::string& element)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+
+        for (char c : element)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+
+    // The step between the bits an element sets within its block.  It is
+    // derived from every bit of the hash, so that elements sharing a block
+    // (and therefore the upper half of their hash) still spread out.
+    std::uint32_t secondHash(std::uint64_t hash)
+    {
+        return static_cast<std::uint32_t>((hash * 0x9e3779b97f4a7c15ull) >> 32) | 1;
+    }
+}
+
+
+
+BloomFilter::BloomFilter(unsigned int expectedElements, unsigned int bitsPerElement)
+    : bitsPerElement{bitsPerElement}, elements{0}, bits{}, blockCount{0},
+      queryCount{0}, rejectionCount{0}
+{
+    reset(expectedElements);
+}
+
+
+BloomFilter::BloomFilter(const BloomFilter& f)
+    : bitsPerElement{f.bitsPerElement}, elements{f.elements}, bits{f.bits},
+      blockCount{f.blockCount}, queryCount{f.queryCount.load()},
+      rejectionCount{f.rejectionCount.load()}
+{
+}
+
+
+BloomFilter& BloomFilter::operator=(const BloomFilter& f)
+{
+    bitsPerElement = f.bitsPerElement;
+    elements = f.elements;
+    bits = f.bits;
+    blockCount = f.blockCount;
+    queryCount = f.queryCount.load();
+    rejectionCount = f.rejectionCount.load();
+    return *this;
+}
+
+
+void BloomFilter::reset(unsigned int expectedElements)
+{
+    std::size_t totalBits = static_cast<std::size_t>(expectedElements) * bitsPerElement;
+
+    blockCount = std::max<std::size_t>(1, (totalBits + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK);
+    bits.assign(blockCount * WORDS_PER_BLOCK, 0);
+    elements = 0;
+    queryCount = 0;
+    rejectionCount = 0;
+}
+
+
+std::uint64_t BloomFilter::hash(const std::string& element)
+{
+    return mixedFnv1a(element);
+}
+
+
+void BloomFilter::add(const std::string& element)
+{
+    addHash(hash(element));
+}
+
+
+void BloomFilter::addHash(std::uint64_t hash)
+{
+    std::uint64_t* block = &bits[blockIndexFor(hash) * WORDS_PER_BLOCK];
+    std::uint32_t h1 = static_cast<std::uint32_t>(hash);
+    std::uint32_t h2 = secondHash(hash);
+
+    for (unsigned int i = 0; i < HASHES_PER_ELEMENT; ++i)
+    {
+        unsigned int bit = (h1 + i * h2) % BITS_PER_BLOCK;
+        block[bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+
+    ++elements;
+}
+
+
+bool BloomFilter::mightContain(const std::string& element) const
+{
+    std::uint64_t hash = this->hash(element);
+    const std::uint64_t* block = &bits[blockIndexFor(hash) * WORDS_PER_BLOCK];
+    std::uint32_t h1 = static_cast<std::uint32_t>(hash);
+    std::uint32_t h2 = secondHash(hash);
+
+    for (unsigned int i = 0; i < HASHES_PER_ELEMENT; ++i)
+    {
+        unsigned int bit = (h1 + i * h2) % BITS_PER_BLOCK;
+
+        if ((block[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void BloomFilter::countLookups(unsigned long queries, unsigned long rejections) const
+{
+    queryCount.fetch_add(queries, std::memory_order_relaxed);
+    rejectionCount.fetch_add(rejections, std::memory_order_relaxed);
+}
+
+
+std::size_t BloomFilter::sizeInBytes() const
+{
+    return bits.size() * sizeof(std::uint64_t);
+}
+
+
+unsigned int BloomFilter::elementCount() const
+{
+    return elements;
+}
+
+
+double BloomFilter::falsePositiveRate() const
+{
+    // The classic estimate (1 - e^(-kn/m))^k.  Blocking makes the real
+    // rate slightly higher, since elements are not spread perfectly evenly
+    // among the blocks.
+    double m = static_cast<double>(blockCount) * BITS_PER_BLOCK;
+    double k = HASHES_PER_ELEMENT;
+    return std::pow(1.0 - std::exp(-k * elements / m), k);
+}
+
+
+unsigned long BloomFilter::queries() const
+{
+    return queryCount.load();
+}
+
+
+unsigned long BloomFilter::rejections() const
+{
+    return rejectionCount.load();
+}
+
+
+std::size_t BloomFilter::blockIndexFor(std::uint64_t hash) const
+{
+    // Maps the hash's upper half onto [0, blockCount) without a division.
+    return static_cast<std::size_t>(((hash >> 32) * blockCount) >> 32);
+}
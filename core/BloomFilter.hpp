@@ -0,0 +1,107 @@
+// BloomFilter.hpp
+//
+// A BloomFilter is a compact, probabilistic summary of a set of strings.
+// It can say for certain that a string is *not* in the set, but can only
+// say that a string *might* be in the set; the rate of such false
+// positives depends on how many bits the filter spends on each string.
+//
+// This is a "blocked" Bloom filter: every string maps to a single 64-byte
+// block (one cache line), and all of its bits are set and tested within
+// that block, so a lookup costs at most one cache miss.
+//
+// Strings can be added after the filter is built, but the filter cannot
+// forget them, and strings added to the summarized set without also being
+// added to the filter will be wrongly rejected.
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+
+class BloomFilter
+{
+public:
+    static constexpr unsigned int DEFAULT_BITS_PER_ELEMENT = 10;
+
+public:
+    // Initializes a filter sized for the given number of elements, using
+    // the given number of bits for each.
+    BloomFilter(
+        unsigned int expectedElements = 0,
+        unsigned int bitsPerElement = DEFAULT_BITS_PER_ELEMENT);
+
+    BloomFilter(const BloomFilter& f);
+    BloomFilter& operator=(const BloomFilter& f);
+
+
+    // reset() empties the filter and resizes it for the given number of
+    // elements.  It also resets the counters.
+    void reset(unsigned int expectedElements);
+
+
+    // hash() returns the 64-bit hash the filter uses for a string.  It is
+    // exposed so that callers can hash strings before the filter is sized.
+    static std::uint64_t hash(const std::string& element);
+
+
+    // add() and addHash() add a string (or its hash) to the filter.
+    void add(const std::string& element);
+    void addHash(std::uint64_t hash);
+
+
+    // mightContain() returns false if the string is definitely not in the
+    // set, true if it might be.  It touches nothing but the filter's bits,
+    // so that threads sharing a filter don't contend over it.
+    bool mightContain(const std::string& element) const;
+
+
+    // countLookups() adds to the counts of strings looked up and rejected,
+    // so the filter's effectiveness can be reported.  Callers count their
+    // own lookups and add them all at once, a batch at a time.
+    void countLookups(unsigned long queries, unsigned long rejections) const;
+
+
+    // sizeInBytes() returns the amount of memory used by the filter's bits.
+    std::size_t sizeInBytes() const;
+
+
+    // elementCount() returns the number of strings added to the filter.
+    unsigned int elementCount() const;
+
+
+    // falsePositiveRate() estimates the probability that a string not in
+    // the set is accepted, given how full the filter is.
+    double falsePositiveRate() const;
+
+
+    // queries() and rejections() return the counts of strings looked up
+    // and rejected, as given to countLookups().
+    unsigned long queries() const;
+    unsigned long rejections() const;
+
+
+private:
+    static constexpr unsigned int BITS_PER_BLOCK = 512;
+    static constexpr unsigned int WORDS_PER_BLOCK = BITS_PER_BLOCK / 64;
+    static constexpr unsigned int HASHES_PER_ELEMENT = 7;
+
+    unsigned int bitsPerElement;
+    unsigned int elements;
+    std::vector<std::uint64_t> bits;
+    std::size_t blockCount;
+
+    mutable std::atomic<unsigned long> queryCount;
+    mutable std::atomic<unsigned long> rejectionCount;
+
+private:
+    std::size_t blockIndexFor(std::uint64_t hash) const;
+};
+
+
+
+#endif // BLOOMFILTER_HPP
@@ -0,0 +1,299 @@
+// BoundedQueue.hpp
+//
+// A BoundedQueue<T> hands items from one thread, the producer, to one
+// other thread, the consumer, in the order they were pushed, holding at
+// most a fixed number of them at a time, so that a producer that gets
+// ahead is made to wait rather than using more and more memory.
+//
+// The items are kept in a ring of slots.  While the queue is neither
+// empty nor full, pushing and popping only read and write the two ends
+// of the ring, which are atomic, so neither thread ever waits for the
+// other.  A thread that finds the queue empty (or full) spins briefly,
+// yielding its CPU, then sleeps until the other thread has popped (or
+// pushed) an item; the other thread only takes the queue's lock when
+// it knows someone is asleep.
+//
+// The producer calls close() once it has pushed its last item, and pop()
+// returns false once every item before that has been popped.  Either
+// thread can call cancel() instead, after which push() and pop() return
+// false straight away, so that a pipeline can be torn down early.
+//
+// Counters of how often each thread had to wait, and of how many items
+// were waiting in the queue, are kept as it's used.
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+template <typename T>
+class BoundedQueue
+{
+public:
+    // The statistics of a queue, which are only safe to read once both
+    // threads have finished with it.
+    struct Statistics
+    {
+        unsigned long long pushes = 0;
+
+        // How many items were waiting, at most and in total, each time an
+        // item was pushed (including that item), so that dividing the
+        // total by the number of pushes gives the average depth.
+        size_t maximumDepth = 0;
+        unsigned long long totalDepth = 0;
+
+        // How many times the producer found the queue full, and the
+        // consumer found it empty, and had to wait.
+        unsigned long long producerWaits = 0;
+        unsigned long long consumerWaits = 0;
+    };
+
+public:
+    // Initializes an empty queue that holds at most the given number of
+    // items, which is rounded up to a power of two.
+    explicit BoundedQueue(size_t capacity);
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+
+    // push() adds an item to the back of the queue, waiting for there to
+    // be room for it, and returns true, unless the queue is cancelled
+    // first.  Only the producer may call it.
+    bool push(T&& item);
+
+    // pop() moves the item at the front of the queue into item, waiting
+    // for there to be one, and returns true.  It returns false if the
+    // queue has been closed and is empty, or has been cancelled.  Only the
+    // consumer may call it.
+    bool pop(T& item);
+
+
+    // close() says that no more items will be pushed.  Only the producer
+    // may call it.
+    void close();
+
+    // cancel() makes every call to push() and pop(), including any that
+    // are waiting, return false.  Either thread may call it.
+    void cancel();
+
+    bool isCancelled() const;
+
+
+    size_t capacity() const;
+
+    const Statistics& statistics() const;
+
+
+private:
+    static constexpr unsigned int SPINS_BEFORE_SLEEPING = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+
+    // The ends of the ring are on cache lines of their own, so that the
+    // producer writing one doesn't slow down the consumer reading the
+    // other.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+
+    alignas(64) std::atomic<bool> closed;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> producerSleeping;
+    std::atomic<bool> consumerSleeping;
+
+    std::mutex mutex;
+    std::condition_variable spaceAvailable;
+    std::condition_variable itemAvailable;
+
+    Statistics stats;
+
+private:
+    template <typename Ready>
+    void waitUntil(
+        Ready ready, std::atomic<bool>& sleeping, std::condition_variable& condition);
+
+    void wake(std::atomic<bool>& sleeping, std::condition_variable& condition);
+};
+
+
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+    : slots{}, mask{0}, head{0}, tail{0}, closed{false}, cancelled{false},
+      producerSleeping{false}, consumerSleeping{false}, stats{}
+{
+    size_t slotCount = 1;
+
+    while (slotCount < capacity)
+    {
+        slotCount *= 2;
+    }
+
+    slots.resize(slotCount);
+    mask = slotCount - 1;
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::push(T&& item)
+{
+    size_t back = tail.load(std::memory_order_relaxed);
+
+    if (back - head.load(std::memory_order_acquire) > mask)
+    {
+        ++stats.producerWaits;
+
+        waitUntil(
+            [&]() { return back - head.load() <= mask; },
+            producerSleeping, spaceAvailable);
+    }
+
+    if (cancelled.load())
+    {
+        return false;
+    }
+
+    slots[back & mask] = std::move(item);
+    tail.store(back + 1);
+
+    size_t depth = back + 1 - head.load(std::memory_order_relaxed);
+    ++stats.pushes;
+    stats.totalDepth += depth;
+
+    if (depth > stats.maximumDepth)
+    {
+        stats.maximumDepth = depth;
+    }
+
+    wake(consumerSleeping, itemAvailable);
+    return true;
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+    size_t front = head.load(std::memory_order_relaxed);
+
+    if (tail.load(std::memory_order_acquire) == front)
+    {
+        if (closed.load() && tail.load() == front)
+        {
+            return false;
+        }
+
+        ++stats.consumerWaits;
+
+        waitUntil(
+            [&]() { return tail.load() != front || closed.load(); },
+            consumerSleeping, itemAvailable);
+
+        if (tail.load() == front)
+        {
+            return false;
+        }
+    }
+
+    if (cancelled.load())
+    {
+        return false;
+    }
+
+    item = std::move(slots[front & mask]);
+    head.store(front + 1);
+
+    wake(producerSleeping, spaceAvailable);
+    return true;
+}
+
+
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    closed.store(true);
+    wake(consumerSleeping, itemAvailable);
+}
+
+
+template <typename T>
+void BoundedQueue<T>::cancel()
+{
+    cancelled.store(true);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    spaceAvailable.notify_all();
+    itemAvailable.notify_all();
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::isCancelled() const
+{
+    return cancelled.load();
+}
+
+
+template <typename T>
+size_t BoundedQueue<T>::capacity() const
+{
+    return slots.size();
+}
+
+
+template <typename T>
+const typename BoundedQueue<T>::Statistics& BoundedQueue<T>::statistics() const
+{
+    return stats;
+}
+
+
+// waitUntil() spins for a while, in case the other thread is about to
+// make the queue ready, then sleeps.  The sleeping flag is set before
+// the last check, and the other thread checks it after making the queue
+// ready (both sequentially consistent), so either this thread sees the
+// queue ready or the other thread sees it sleeping and wakes it; and
+// since the lock is held from before the flag is set until the thread
+// is asleep, the wakeup can't come in between and be missed.
+template <typename T>
+template <typename Ready>
+void BoundedQueue<T>::waitUntil(
+    Ready ready, std::atomic<bool>& sleeping, std::condition_variable& condition)
+{
+    for (unsigned int i = 0; i < SPINS_BEFORE_SLEEPING; ++i)
+    {
+        if (ready() || cancelled.load())
+        {
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock{mutex};
+    sleeping.store(true);
+    condition.wait(lock, [&]() { return ready() || cancelled.load(); });
+    sleeping.store(false);
+}
+
+
+template <typename T>
+void BoundedQueue<T>::wake(std::atomic<bool>& sleeping, std::condition_variable& condition)
+{
+    if (sleeping.load())
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        condition.notify_one();
+    }
+}
+
+
+
+#endif // BOUNDEDQUEUE_HPP
@@ -0,0 +1,104 @@
+// Dictionary.cpp
+
+#include <utility>
+#include "Dictionary.hpp"
+
+
+
+Dictionary::Dictionary(
+    std::unique_ptr<Set<std::string>> words, std::unique_ptr<BloomFilter> filter)
+    : wordSet{std::move(words)}, wordFilter{std::move(filter)}
+{
+}
+
+
+const Set<std::string>& Dictionary::words() const
+{
+    return *wordSet;
+}
+
+
+const BloomFilter* Dictionary::filter() const
+{
+    return wordFilter.get();
+}
+
+
+
+DictionaryHandle::DictionaryHandle(std::shared_ptr<const Dictionary> dictionary)
+    : dictionary{std::move(dictionary)}, replacements{0}, lastReloadSucceeded{true}
+{
+}
+
+
+DictionaryHandle::~DictionaryHandle()
+{
+    waitForReload();
+}
+
+
+std::shared_ptr<const Dictionary> DictionaryHandle::current() const
+{
+    return std::atomic_load(&dictionary);
+}
+
+
+unsigned long DictionaryHandle::version() const
+{
+    return replacements.load();
+}
+
+
+void DictionaryHandle::replace(std::shared_ptr<const Dictionary> dictionary)
+{
+    // The old version is held onto until after the new one is published
+    // and the version number bumped, so that if this is the last reference
+    // to it, it's destroyed without holding anything up.
+    std::shared_ptr<const Dictionary> old = std::atomic_exchange(&this->dictionary, std::move(dictionary));
+    replacements.fetch_add(1);
+}
+
+
+void DictionaryHandle::reloadInBackground(Builder build)
+{
+    std::lock_guard<std::mutex> lock{reloadMutex};
+
+    if (reloader.joinable())
+    {
+        reloader.join();
+    }
+
+    reloader = std::thread{
+        [this, build]()
+        {
+            std::shared_ptr<const Dictionary> built;
+
+            try
+            {
+                built = build();
+            }
+            catch (...)
+            {
+            }
+
+            lastReloadSucceeded = built != nullptr;
+
+            if (built != nullptr)
+            {
+                replace(std::move(built));
+            }
+        }};
+}
+
+
+bool DictionaryHandle::waitForReload()
+{
+    std::lock_guard<std::mutex> lock{reloadMutex};
+
+    if (reloader.joinable())
+    {
+        reloader.join();
+    }
+
+    return lastReloadSucceeded;
+}
@@ -0,0 +1,114 @@
+// Dictionary.hpp
+//
+// A Dictionary is a set of words, along with the BloomFilter summarizing
+// them if there is one, that's never changed once it's been built, so any
+// number of threads can check words against it at once.
+//
+// A DictionaryHandle holds the current version of a Dictionary, which can
+// be replaced at any time by one built in the background, in the style of
+// read-copy-update: a check takes a reference to the current version when
+// it starts (see WordChecker's constructor that takes a Dictionary) and
+// uses that version until it finishes, however many times the handle is
+// updated in the meantime, and each version is destroyed when the last
+// check using it lets go of it.  Taking the current version never waits
+// for a new one to be built, only for the pointer to be copied.
+
+#ifndef DICTIONARY_HPP
+#define DICTIONARY_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "BloomFilter.hpp"
+#include "Set.hpp"
+
+
+
+class Dictionary
+{
+public:
+    // Initializes a Dictionary that owns the given Set and, optionally, a
+    // BloomFilter summarizing the same words.
+    explicit Dictionary(
+        std::unique_ptr<Set<std::string>> words,
+        std::unique_ptr<BloomFilter> filter = nullptr);
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+
+    const Set<std::string>& words() const;
+
+    // filter() returns the BloomFilter, or nullptr if there isn't one.
+    const BloomFilter* filter() const;
+
+
+private:
+    std::unique_ptr<Set<std::string>> wordSet;
+    std::unique_ptr<BloomFilter> wordFilter;
+};
+
+
+
+class DictionaryHandle
+{
+public:
+    // A Builder builds a new version of the dictionary, returning nullptr
+    // if it can't (say, because a word file couldn't be read).
+    typedef std::function<std::shared_ptr<const Dictionary>()> Builder;
+
+public:
+    // Initializes a handle to the given dictionary, which may be nullptr
+    // until one has been built.
+    explicit DictionaryHandle(std::shared_ptr<const Dictionary> dictionary = nullptr);
+
+    // Waits for any reload in progress to finish.
+    ~DictionaryHandle();
+
+    DictionaryHandle(const DictionaryHandle&) = delete;
+    DictionaryHandle& operator=(const DictionaryHandle&) = delete;
+
+
+    // current() returns the current version of the dictionary, which stays
+    // alive for as long as the caller holds on to it.
+    std::shared_ptr<const Dictionary> current() const;
+
+    // version() returns the number of times the dictionary has been
+    // replaced, so callers can tell cheaply whether it has changed.
+    unsigned long version() const;
+
+
+    // replace() makes the given dictionary the current one.  The version
+    // it replaces is destroyed here if nothing else is using it, or else
+    // by whichever check is the last to let go of it.
+    void replace(std::shared_ptr<const Dictionary> dictionary);
+
+
+    // reloadInBackground() calls the given builder on a thread of its own
+    // and, if it builds a new dictionary, replaces the current one with it.
+    // Checks carry on with the current version in the meantime.  If a
+    // reload is already in progress, it waits for that one to finish first.
+    void reloadInBackground(Builder build);
+
+    // waitForReload() waits for the reload in progress, if there is one, to
+    // finish, returning true if the last reload replaced the dictionary,
+    // false if its builder failed (returned nullptr or threw an exception).
+    bool waitForReload();
+
+
+private:
+    std::shared_ptr<const Dictionary> dictionary;
+    std::atomic<unsigned long> replacements;
+
+    // Only one thread at a time starts or waits for a reload.
+    std::mutex reloadMutex;
+    std::thread reloader;
+    bool lastReloadSucceeded;
+};
+
+
+
+#endif // DICTIONARY_HPP
@@ -14,8 +14,11 @@
 #ifndef HASHSET_HPP
 #define HASHSET_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include "Set.hpp"
+#include "SetSnapshot.hpp"
 
 
 
@@ -73,19 +76,55 @@ public:
     virtual bool contains(const T& element) const;
 
 
+    // containsBatch() checks several elements at once.  It hashes a window
+    // of elements and prefetches their buckets, then prefetches the first
+    // node in each of those buckets, and only then walks the chains, so the
+    // cache misses for the whole window overlap instead of being paid one
+    // lookup at a time.
+    virtual std::vector<bool> containsBatch(const std::vector<T>& elements) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const;
 
 
+    // A snapshot of a HashSet holds its capacity and size, then each
+    // bucket's chain: its length, followed by its elements in order.  It
+    // doesn't hold the hash function, so loadSnapshot() checks that the
+    // set's own hash function puts the first element of a sample of the
+    // buckets where the snapshot has them, rather than rehashing them all.
+    virtual bool saveSnapshot(std::ostream& out) const;
+    virtual bool loadSnapshot(std::istream& in);
+
+
 private:
+    // The number of buckets whose placement loadSnapshot() checks.
+    static constexpr unsigned int SNAPSHOT_CHECKS = 16;
+
+    struct Node
+    {
+        T key;
+        Node* next;
+    };
+
     HashFunction hashFunction;
+    Node** buckets;
+    unsigned int capacity;
+    unsigned int sz;
+
+private:
+    unsigned int bucketFor(const T& element) const;
+    void copyAll(const HashSet& s);
+    void destroyAll();
+    void resize(unsigned int newCapacity);
 };
 
 
 
 template <typename T>
 HashSet<T>::HashSet(HashFunction hashFunction)
-    : hashFunction{hashFunction}
+    : hashFunction{hashFunction}, buckets{new Node*[DEFAULT_CAPACITY]()},
+      capacity{DEFAULT_CAPACITY}, sz{0}
 {
 }
 
@@ -93,26 +132,39 @@ HashSet<T>::HashSet(HashFunction hashFunction)
 template <typename T>
 HashSet<T>::~HashSet()
 {
+    destroyAll();
 }
 
 
 template <typename T>
 HashSet<T>::HashSet(const HashSet& s)
-    : hashFunction{nullptr}
+    : hashFunction{s.hashFunction}, buckets{nullptr}, capacity{0}, sz{0}
 {
+    copyAll(s);
 }
 
 
 template <typename T>
 HashSet<T>::HashSet(HashSet&& s)
-    : hashFunction{nullptr}
+    : hashFunction{s.hashFunction}, buckets{new Node*[DEFAULT_CAPACITY]()},
+      capacity{DEFAULT_CAPACITY}, sz{0}
 {
+    std::swap(buckets, s.buckets);
+    std::swap(capacity, s.capacity);
+    std::swap(sz, s.sz);
 }
 
 
 template <typename T>
 HashSet<T>& HashSet<T>::operator=(const HashSet& s)
 {
+    if (this != &s)
+    {
+        destroyAll();
+        hashFunction = s.hashFunction;
+        copyAll(s);
+    }
+
     return *this;
 }
 
@@ -120,6 +172,10 @@ HashSet<T>& HashSet<T>::operator=(const HashSet& s)
 template <typename T>
 HashSet<T>& HashSet<T>::operator=(HashSet&& s)
 {
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(buckets, s.buckets);
+    std::swap(capacity, s.capacity);
+    std::swap(sz, s.sz);
     return *this;
 }
 
@@ -127,27 +183,258 @@ HashSet<T>& HashSet<T>::operator=(HashSet&& s)
 template <typename T>
 bool HashSet<T>::isImplemented() const
 {
-    return false;
+    return true;
 }
 
 
 template <typename T>
 void HashSet<T>::add(const T& element)
 {
+    if (contains(element))
+    {
+        return;
+    }
+
+    if (static_cast<double>(sz + 1) / capacity > 0.8)
+    {
+        resize(capacity * 2);
+    }
+
+    unsigned int index = bucketFor(element);
+    buckets[index] = new Node{element, buckets[index]};
+    ++sz;
 }
 
 
 template <typename T>
 bool HashSet<T>::contains(const T& element) const
 {
+    for (Node* curr = buckets[bucketFor(element)]; curr != nullptr; curr = curr->next)
+    {
+        if (curr->key == element)
+        {
+            return true;
+        }
+    }
+
     return false;
 }
 
 
+template <typename T>
+std::vector<bool> HashSet<T>::containsBatch(const std::vector<T>& elements) const
+{
+    std::vector<bool> results(elements.size(), false);
+    unsigned int indexes[CONTAINS_BATCH_WINDOW];
+
+    for (size_t first = 0; first < elements.size(); first += CONTAINS_BATCH_WINDOW)
+    {
+        size_t count = std::min<size_t>(CONTAINS_BATCH_WINDOW, elements.size() - first);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            indexes[i] = bucketFor(elements[first + i]);
+            __builtin_prefetch(&buckets[indexes[i]]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (buckets[indexes[i]] != nullptr)
+            {
+                __builtin_prefetch(buckets[indexes[i]]);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (Node* curr = buckets[indexes[i]]; curr != nullptr; curr = curr->next)
+            {
+                if (curr->key == elements[first + i])
+                {
+                    results[first + i] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+
 template <typename T>
 unsigned int HashSet<T>::size() const
 {
-    return 0;
+    return sz;
+}
+
+
+template <typename T>
+bool HashSet<T>::saveSnapshot(std::ostream& out) const
+{
+    writeSnapshotHeader(out, "HASH");
+    writeSnapshotInteger<std::uint32_t>(out, capacity);
+    writeSnapshotInteger<std::uint32_t>(out, sz);
+
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        std::uint64_t length = 0;
+
+        for (Node* curr = buckets[i]; curr != nullptr; curr = curr->next)
+        {
+            ++length;
+        }
+
+        writeSnapshotLength(out, length);
+
+        for (Node* curr = buckets[i]; curr != nullptr; curr = curr->next)
+        {
+            writeSnapshotElement(out, curr->key);
+        }
+    }
+
+    return static_cast<bool>(out.flush());
+}
+
+
+template <typename T>
+bool HashSet<T>::loadSnapshot(std::istream& in)
+{
+    std::uint32_t newCapacity;
+    std::uint32_t newSize;
+
+    if (!readSnapshotHeader(in, "HASH")
+        || !readSnapshotInteger(in, newCapacity) || !readSnapshotInteger(in, newSize)
+        || newCapacity == 0 || newSize > newCapacity)
+    {
+        return false;
+    }
+
+    // The snapshot is loaded into a separate table, so that the set is
+    // left as it was if it turns out not to be valid.
+    HashSet loaded{hashFunction};
+    delete[] loaded.buckets;
+    loaded.buckets = new Node*[newCapacity]();
+    loaded.capacity = newCapacity;
+
+    unsigned int nextCheck = 0;
+
+    for (unsigned int i = 0; i < newCapacity; ++i)
+    {
+        std::uint64_t length;
+
+        if (!readSnapshotLength(in, length) || length > newSize - loaded.sz)
+        {
+            return false;
+        }
+
+        Node** last = &loaded.buckets[i];
+
+        for (std::uint64_t j = 0; j < length; ++j)
+        {
+            T element;
+
+            if (!readSnapshotElement(in, element))
+            {
+                return false;
+            }
+
+            *last = new Node{std::move(element), nullptr};
+            last = &(*last)->next;
+            ++loaded.sz;
+        }
+
+        if (length > 0 && i >= nextCheck)
+        {
+            if (loaded.bucketFor(loaded.buckets[i]->key) != i)
+            {
+                return false;
+            }
+
+            nextCheck = i + newCapacity / SNAPSHOT_CHECKS + 1;
+        }
+    }
+
+    if (loaded.sz != newSize)
+    {
+        return false;
+    }
+
+    std::swap(buckets, loaded.buckets);
+    std::swap(capacity, loaded.capacity);
+    std::swap(sz, loaded.sz);
+    return true;
+}
+
+
+template <typename T>
+unsigned int HashSet<T>::bucketFor(const T& element) const
+{
+    return hashFunction(element) % capacity;
+}
+
+
+template <typename T>
+void HashSet<T>::copyAll(const HashSet& s)
+{
+    buckets = new Node*[s.capacity]();
+    capacity = s.capacity;
+    sz = s.sz;
+
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        for (Node* curr = s.buckets[i]; curr != nullptr; curr = curr->next)
+        {
+            buckets[i] = new Node{curr->key, buckets[i]};
+        }
+    }
+}
+
+
+template <typename T>
+void HashSet<T>::destroyAll()
+{
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        Node* curr = buckets[i];
+
+        while (curr != nullptr)
+        {
+            Node* temp = curr;
+            curr = curr->next;
+            delete temp;
+        }
+    }
+
+    delete[] buckets;
+    buckets = nullptr;
+    capacity = 0;
+    sz = 0;
+}
+
+
+template <typename T>
+void HashSet<T>::resize(unsigned int newCapacity)
+{
+    Node** newBuckets = new Node*[newCapacity]();
+
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        Node* curr = buckets[i];
+
+        while (curr != nullptr)
+        {
+            Node* next = curr->next;
+            unsigned int index = hashFunction(curr->key) % newCapacity;
+            curr->next = newBuckets[index];
+            newBuckets[index] = curr;
+            curr = next;
+        }
+    }
+
+    delete[] buckets;
+    buckets = newBuckets;
+    capacity = newCapacity;
 }
 
 
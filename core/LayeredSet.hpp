@@ -0,0 +1,240 @@
+// LayeredSet.hpp
+//
+// A LayeredSet is a Set<T> made of an ordered stack of other sets, which
+// contains an element if any of its layers do.  A large dictionary can be
+// shared as one layer, with small per-team or per-user word lists layered
+// alongside it, so that the small ones can be changed or replaced without
+// copying or rebuilding the large one.
+//
+// Lookups go through the layers in order and stop at the first one that
+// has the element, so the cheapest order puts first the layer that most
+// lookups are answered by.  For spell checking that's usually the base
+// dictionary, even though the overlays are smaller: hashing a word is
+// most of the cost of missing in a small layer, so looking in the
+// overlays first makes every correctly spelled word pay for those misses,
+// while looking in them last only costs extra for the few words the base
+// doesn't have.  containsBatch() asks
+// each layer in turn about only the elements the layers before it didn't
+// have, so each layer still gets whole batches to work on.
+//
+// Elements are added to the layer chosen by setWritableLayer(); until one
+// is chosen, add() has no effect.  size() is the sum of the layers' sizes,
+// counting an element that's in several layers more than once.
+//
+// A LayeredSet doesn't synchronize changes to its stack with lookups, so
+// to swap a layer while checks are in progress, build a new LayeredSet
+// sharing the unchanged layers and swap it in with a DictionaryHandle,
+// which also gives checks against it fresh suggestion caches.
+
+#ifndef LAYEREDSET_HPP
+#define LAYEREDSET_HPP
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Set.hpp"
+
+
+
+template <typename T>
+class LayeredSet : public Set<T>
+{
+public:
+    // Initializes a LayeredSet with no layers.
+    LayeredSet();
+
+    // Initializes a LayeredSet with the given layers, in lookup order.
+    explicit LayeredSet(std::vector<std::shared_ptr<Set<T>>> layers);
+
+
+    // addLayer() adds a layer to be looked in after all of the others,
+    // returning its index.
+    size_t addLayer(std::shared_ptr<Set<T>> layer);
+
+    // replaceLayer() puts the given set in place of the layer at the given
+    // index.
+    void replaceLayer(size_t index, std::shared_ptr<Set<T>> layer);
+
+    size_t layerCount() const;
+    const std::shared_ptr<Set<T>>& layer(size_t index) const;
+
+
+    // setWritableLayer() makes add() add elements to the layer at the given
+    // index.
+    void setWritableLayer(size_t index);
+
+
+    virtual bool isImplemented() const;
+    virtual void add(const T& element);
+    virtual bool contains(const T& element) const;
+    virtual std::vector<bool> containsBatch(const std::vector<T>& elements) const;
+    virtual unsigned int size() const;
+
+
+private:
+    static constexpr size_t NO_WRITABLE_LAYER = static_cast<size_t>(-1);
+
+    std::vector<std::shared_ptr<Set<T>>> layers;
+    size_t writableLayer;
+};
+
+
+
+template <typename T>
+LayeredSet<T>::LayeredSet()
+    : layers{}, writableLayer{NO_WRITABLE_LAYER}
+{
+}
+
+
+template <typename T>
+LayeredSet<T>::LayeredSet(std::vector<std::shared_ptr<Set<T>>> layers)
+    : layers{std::move(layers)}, writableLayer{NO_WRITABLE_LAYER}
+{
+}
+
+
+template <typename T>
+size_t LayeredSet<T>::addLayer(std::shared_ptr<Set<T>> layer)
+{
+    layers.push_back(std::move(layer));
+    return layers.size() - 1;
+}
+
+
+template <typename T>
+void LayeredSet<T>::replaceLayer(size_t index, std::shared_ptr<Set<T>> layer)
+{
+    layers[index] = std::move(layer);
+}
+
+
+template <typename T>
+size_t LayeredSet<T>::layerCount() const
+{
+    return layers.size();
+}
+
+
+template <typename T>
+const std::shared_ptr<Set<T>>& LayeredSet<T>::layer(size_t index) const
+{
+    return layers[index];
+}
+
+
+template <typename T>
+void LayeredSet<T>::setWritableLayer(size_t index)
+{
+    writableLayer = index;
+}
+
+
+template <typename T>
+bool LayeredSet<T>::isImplemented() const
+{
+    return true;
+}
+
+
+template <typename T>
+void LayeredSet<T>::add(const T& element)
+{
+    if (writableLayer < layers.size())
+    {
+        layers[writableLayer]->add(element);
+    }
+}
+
+
+template <typename T>
+bool LayeredSet<T>::contains(const T& element) const
+{
+    for (const std::shared_ptr<Set<T>>& layer : layers)
+    {
+        if (layer->contains(element))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename T>
+std::vector<bool> LayeredSet<T>::containsBatch(const std::vector<T>& elements) const
+{
+    if (layers.size() == 1)
+    {
+        return layers[0]->containsBatch(elements);
+    }
+
+    std::vector<bool> results(elements.size(), false);
+
+    // The elements not yet found, and where each one goes in the results.
+    std::vector<T> remaining;
+    std::vector<size_t> positions;
+    const std::vector<T>* queries = &elements;
+
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        std::vector<bool> found = layers[i]->containsBatch(*queries);
+        std::vector<T> stillRemaining;
+        std::vector<size_t> stillPositions;
+
+        for (size_t j = 0; j < found.size(); ++j)
+        {
+            size_t position = queries == &elements ? j : positions[j];
+
+            if (found[j])
+            {
+                results[position] = true;
+            }
+            else if (i + 1 < layers.size())
+            {
+                // Elements are copied out of the caller's vector only once;
+                // after that, they're moved from one round to the next.
+                if (queries == &elements)
+                {
+                    stillRemaining.push_back(elements[j]);
+                }
+                else
+                {
+                    stillRemaining.push_back(std::move(remaining[j]));
+                }
+
+                stillPositions.push_back(position);
+            }
+        }
+
+        if (stillRemaining.empty())
+        {
+            break;
+        }
+
+        remaining = std::move(stillRemaining);
+        positions = std::move(stillPositions);
+        queries = &remaining;
+    }
+
+    return results;
+}
+
+
+template <typename T>
+unsigned int LayeredSet<T>::size() const
+{
+    unsigned int total = 0;
+
+    for (const std::shared_ptr<Set<T>>& layer : layers)
+    {
+        total += layer->size();
+    }
+
+    return total;
+}
+
+
+
+#endif // LAYEREDSET_HPP
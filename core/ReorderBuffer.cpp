@@ -0,0 +1,45 @@
+// ReorderBuffer.cpp
+
+#include "ReorderBuffer.hpp"
+
+
+
+ReorderBuffer::ReorderBuffer(size_t taskCount, std::function<void(size_t)> deliver)
+    : deliver{deliver}, finished(taskCount, false), nextToDeliver{0}, delivering{false}
+{
+}
+
+
+void ReorderBuffer::taskFinished(size_t index)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        finished[index] = true;
+
+        if (delivering)
+        {
+            return;
+        }
+
+        delivering = true;
+    }
+
+    while (true)
+    {
+        size_t next;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+
+            if (nextToDeliver == finished.size() || !finished[nextToDeliver])
+            {
+                delivering = false;
+                return;
+            }
+
+            next = nextToDeliver++;
+        }
+
+        deliver(next);
+    }
+}
@@ -0,0 +1,46 @@
+// ReorderBuffer.hpp
+//
+// A ReorderBuffer delivers the results of a batch of tasks in order, as
+// the tasks finish in any order.  Whichever thread finishes the next task
+// to be delivered delivers it, along with any tasks after it that have
+// already finished; threads that finish tasks further along leave them
+// for it.  So results are delivered in order and one at a time, without
+// any thread waiting for another.
+
+#ifndef REORDERBUFFER_HPP
+#define REORDERBUFFER_HPP
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+
+class ReorderBuffer
+{
+public:
+    // Initializes a ReorderBuffer for the given number of tasks, which
+    // calls deliver() with the index of each task in turn.
+    ReorderBuffer(size_t taskCount, std::function<void(size_t)> deliver);
+
+    ReorderBuffer(const ReorderBuffer&) = delete;
+    ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+
+    // taskFinished() is called once the task with the given index has
+    // finished, delivering it and any others that are then due.
+    void taskFinished(size_t index);
+
+
+private:
+    std::function<void(size_t)> deliver;
+
+    std::mutex mutex;
+    std::vector<bool> finished;
+    size_t nextToDeliver;
+    bool delivering;
+};
+
+
+
+#endif // REORDERBUFFER_HPP
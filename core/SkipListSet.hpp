@@ -11,8 +11,12 @@
 #ifndef SKIPLISTSET_HPP
 #define SKIPLISTSET_HPP
 
+#include <cstdint>
+#include <random>
+#include <utility>
 #include <vector>
 #include "Set.hpp"
+#include "SetSnapshot.hpp"
 
 
 
@@ -38,6 +42,10 @@ enum class SkipListKind
 // and those comparisons respect the notion of whether each key is normal,
 // -INF, or +INF.
 
+template <typename T>
+class SkipListSet;
+
+
 template <typename T>
 class SkipListKey
 {
@@ -48,6 +56,9 @@ public:
     bool operator<(const SkipListKey& other) const;
 
 private:
+    // A SkipListSet's snapshots hold the keys themselves.
+    friend class SkipListSet<T>;
+
     SkipListKind kind;
     T key;
 };
@@ -135,33 +146,64 @@ public:
     virtual unsigned int size() const;
 
 
+    // A snapshot of a SkipListSet holds the number of levels and the
+    // number of keys, then each key on the bottom level, in order, along
+    // with the number of levels it's on.  That's enough to rebuild every
+    // level, including where each node points down to, in one pass, with
+    // no comparisons or coin flips.  Each level begins with a -INF node
+    // and ends with a +INF node; head and tail are those on the top level.
+    virtual bool saveSnapshot(std::ostream& out) const;
+    virtual bool loadSnapshot(std::istream& in);
+
+
 private:
     struct Node {
-        SkipListKey key;
+        SkipListKey<T> key;
         Node* next;
         Node* down;
     };
 
-    std::vector<int> level;
     Node* head;
     Node* tail;
+    unsigned int levelCount;
+    unsigned int elementCount;
 
     int maxLevel;
 
+    // The coins flipped to decide how many levels each new key is on.
+    std::mt19937 coins;
+
 private:
+    // addLevel() adds an empty level on top, whose -INF and +INF nodes
+    // become head and tail.
+    void addLevel();
+
+    // randomHeight() flips coins to decide how many levels a new key is
+    // on, which is never more than maxLevel.
+    unsigned int randomHeight();
+
+    // levelStarts() returns the -INF node on each level, from the bottom
+    // up, and appendKey() adds a key that's greater than every other on
+    // the given number of levels, just after the last node added to each,
+    // keeping track of those last nodes in ends.
+    std::vector<Node*> levelStarts() const;
+    void appendKey(std::vector<Node*>& ends, const T& key, unsigned int height);
+
+    // forEachKey() calls visit() with each key, in order, and the number
+    // of levels it's on.
+    template <typename Visit>
+    void forEachKey(Visit visit) const;
+
     void copyAll(const SkipListSet& s);
     void destroyAll();
-
+    void swapWith(SkipListSet& s);
 };
 
 //Initialzes an empty SkipListSet
 template <typename T>
 SkipListSet<T>::SkipListSet()
-    : maxLevel(16)
+    : head(nullptr), tail(nullptr), levelCount(0), elementCount(0), maxLevel(16)
 {
-    
-
-
 }
 
 //Cleans up SkipListSet
@@ -174,7 +216,7 @@ SkipListSet<T>::~SkipListSet()
 //Initialize copy of existing SkipListSet
 template <typename T>
 SkipListSet<T>::SkipListSet(const SkipListSet& s)
-    : maxLevel(16)
+    : SkipListSet()
 {
     copyAll(s);
 }
@@ -182,19 +224,19 @@ SkipListSet<T>::SkipListSet(const SkipListSet& s)
 //Move SkipListSet contents to new SkipListSet
 template <typename T>
 SkipListSet<T>::SkipListSet(SkipListSet&& s)
-    : maxLevel(16)
+    : SkipListSet()
 {
-    std::swap(head, s.head);
+    swapWith(s);
 }
 
 //Assigns existing SkipListSet into another
 template <typename T>
 SkipListSet<T>& SkipListSet<T>::operator=(const SkipListSet& s)
 {
-    if(this != &s) {
-        destroyAll();
-        head = nullptr;
-        copyAll(s);
+    if (this != &s)
+    {
+        SkipListSet copy{s};
+        swapWith(copy);
     }
 
     return *this;
@@ -204,7 +246,7 @@ SkipListSet<T>& SkipListSet<T>::operator=(const SkipListSet& s)
 template <typename T>
 SkipListSet<T>& SkipListSet<T>::operator=(SkipListSet&& s)
 {
-    std::swap(head, s.head);
+    swapWith(s);
     return *this;
 }
 
@@ -212,44 +254,71 @@ SkipListSet<T>& SkipListSet<T>::operator=(SkipListSet&& s)
 template <typename T>
 bool SkipListSet<T>::isImplemented() const
 {
-    return false;
+    return true;
 }
 
 //Add element to SkipListSet
 template <typename T>
 void SkipListSet<T>::add(const T& element)
 {
-    Node* curr = head;
+    SkipListKey<T> key{SkipListKind::Normal, element};
 
-    while (curr != nullptr) {
-        if (curr->key == element) {
-            return;
-        }
-        else if (curr->key > element) {
-            ////terminate search if already on bottom level
-            curr = curr->down;
-        }
-        else {
+    // The node after which the key belongs on each level, from the top
+    // down.
+    std::vector<Node*> before;
+
+    for (Node* curr = head; curr != nullptr; curr = curr->down)
+    {
+        while (curr->next->key < key)
+        {
             curr = curr->next;
         }
+
+        if (curr->next->key == key)
+        {
+            return;
+        }
+
+        before.push_back(curr);
+    }
+
+    unsigned int height = randomHeight();
+
+    while (levelCount < height)
+    {
+        addLevel();
+        before.insert(before.begin(), head);
     }
 
-    head = new Node{element, head};
+    Node* below = nullptr;
+
+    for (unsigned int level = 0; level < height; ++level)
+    {
+        Node* previous = before[before.size() - 1 - level];
+        previous->next = new Node{key, previous->next, below};
+        below = previous->next;
+    }
 
+    ++elementCount;
 }
 
 //See if element is in SkipListSet
 template <typename T>
 bool SkipListSet<T>::contains(const T& element) const
 {
-    Node* curr = head;
+    SkipListKey<T> key{SkipListKind::Normal, element};
 
-    while (curr != nullptr) {
-        if (curr->key == element) {
-            return true;
+    for (Node* curr = head; curr != nullptr; curr = curr->down)
+    {
+        while (curr->next->key < key)
+        {
+            curr = curr->next;
         }
 
-        curr = curr->next;
+        if (curr->next->key == key)
+        {
+            return true;
+        }
     }
 
     return false;
@@ -259,38 +328,212 @@ bool SkipListSet<T>::contains(const T& element) const
 template <typename T>
 unsigned int SkipListSet<T>::size() const
 {
-    Node* curr = head;
-    unsigned int count = 0;
+    return elementCount;
+}
+
+template <typename T>
+bool SkipListSet<T>::saveSnapshot(std::ostream& out) const
+{
+    writeSnapshotHeader(out, "SKIPLIST");
+    writeSnapshotInteger<std::uint32_t>(out, levelCount);
+    writeSnapshotInteger<std::uint32_t>(out, elementCount);
+
+    forEachKey(
+        [&](const T& key, unsigned int height)
+        {
+            writeSnapshotInteger<std::uint8_t>(out, height);
+            writeSnapshotElement(out, key);
+        });
+
+    return static_cast<bool>(out.flush());
+}
+
+
+template <typename T>
+bool SkipListSet<T>::loadSnapshot(std::istream& in)
+{
+    std::uint32_t snapshotLevels;
+    std::uint32_t keyCount;
 
-    while (curr != nullptr) {
-        ++count;
-        curr = curr->next;
+    if (!readSnapshotHeader(in, "SKIPLIST")
+        || !readSnapshotInteger(in, snapshotLevels) || !readSnapshotInteger(in, keyCount)
+        || snapshotLevels > UINT8_MAX || (snapshotLevels == 0 && keyCount > 0))
+    {
+        return false;
+    }
+
+    // The set is loaded into a new one, so that this one is left as it
+    // was if the snapshot turns out to be incomplete or corrupt.
+    SkipListSet loaded;
+
+    for (std::uint32_t level = 0; level < snapshotLevels; ++level)
+    {
+        loaded.addLevel();
+    }
+
+    std::vector<Node*> ends = loaded.levelStarts();
+
+    for (std::uint32_t i = 0; i < keyCount; ++i)
+    {
+        std::uint8_t height;
+        T key;
+
+        if (!readSnapshotInteger(in, height) || !readSnapshotElement(in, key)
+            || height < 1 || height > snapshotLevels
+            || !(ends[0]->key < SkipListKey<T>{SkipListKind::Normal, key}))
+        {
+            return false;
+        }
+
+        loaded.appendKey(ends, key, height);
     }
 
-    return count;
+    swapWith(loaded);
+    return true;
 }
 
+
 template <typename T>
-void SkipListSet<T>::copyAll(const SkipListSet& s)
+void SkipListSet<T>::addLevel()
 {
-    Node* curr = s.head;
+    tail = new Node{SkipListKey<T>{SkipListKind::PosInf, T{}}, nullptr, tail};
+    head = new Node{SkipListKey<T>{SkipListKind::NegInf, T{}}, tail, head};
+    ++levelCount;
+}
+
 
-    while (curr != nullptr) {
-        head = new Node{curr->key, head}
-        curr = curr->next;
+template <typename T>
+unsigned int SkipListSet<T>::randomHeight()
+{
+    unsigned int height = 1;
+
+    while (height < static_cast<unsigned int>(maxLevel) && (coins() & 1) != 0)
+    {
+        ++height;
     }
+
+    return height;
 }
 
+
 template <typename T>
-void SkipListSet<T>::destroyAll() 
+std::vector<typename SkipListSet<T>::Node*> SkipListSet<T>::levelStarts() const
 {
+    std::vector<Node*> starts(levelCount);
     Node* curr = head;
 
-    while (curr != nullptr) {
-        Node* temp = curr;
-        curr = curr->next;
-        delete temp;
+    for (unsigned int level = levelCount; level > 0; --level)
+    {
+        starts[level - 1] = curr;
+        curr = curr->down;
+    }
+
+    return starts;
+}
+
+
+template <typename T>
+void SkipListSet<T>::appendKey(std::vector<Node*>& ends, const T& key, unsigned int height)
+{
+    Node* below = nullptr;
+
+    for (unsigned int level = 0; level < height; ++level)
+    {
+        ends[level]->next = new Node{
+            SkipListKey<T>{SkipListKind::Normal, key}, ends[level]->next, below};
+
+        ends[level] = ends[level]->next;
+        below = ends[level];
+    }
+
+    ++elementCount;
+}
+
+
+template <typename T>
+template <typename Visit>
+void SkipListSet<T>::forEachKey(Visit visit) const
+{
+    if (head == nullptr)
+    {
+        return;
+    }
+
+    // Each level has a cursor that moves along it as the matching keys
+    // are found on the bottom level.
+    std::vector<Node*> cursors = levelStarts();
+
+    for (Node*& cursor : cursors)
+    {
+        cursor = cursor->next;
     }
+
+    for (Node* curr = cursors[0]; curr->key.kind == SkipListKind::Normal; curr = curr->next)
+    {
+        unsigned int height = 1;
+
+        while (height < levelCount && cursors[height]->key == curr->key)
+        {
+            cursors[height] = cursors[height]->next;
+            ++height;
+        }
+
+        visit(curr->key.key, height);
+    }
+}
+
+
+template <typename T>
+void SkipListSet<T>::copyAll(const SkipListSet& s)
+{
+    for (unsigned int level = 0; level < s.levelCount; ++level)
+    {
+        addLevel();
+    }
+
+    std::vector<Node*> ends = levelStarts();
+
+    s.forEachKey(
+        [&](const T& key, unsigned int height)
+        {
+            appendKey(ends, key, height);
+        });
+}
+
+template <typename T>
+void SkipListSet<T>::destroyAll()
+{
+    Node* level = head;
+
+    while (level != nullptr)
+    {
+        Node* below = level->down;
+        Node* curr = level;
+
+        while (curr != nullptr)
+        {
+            Node* temp = curr;
+            curr = curr->next;
+            delete temp;
+        }
+
+        level = below;
+    }
+
+    head = nullptr;
+    tail = nullptr;
+    levelCount = 0;
+    elementCount = 0;
+}
+
+
+template <typename T>
+void SkipListSet<T>::swapWith(SkipListSet& s)
+{
+    std::swap(head, s.head);
+    std::swap(tail, s.tail);
+    std::swap(levelCount, s.levelCount);
+    std::swap(elementCount, s.elementCount);
 }
 
 
@@ -0,0 +1,135 @@
+// SuggestionCache.cpp
+
+#include "SuggestionCache.hpp"
+
+
+
+namespace
+{
+    size_t estimateBytes(const std::string& word, const std::vector<std::string>& suggestions)
+    {
+        size_t bytes = sizeof(std::string) + word.capacity();
+
+        for (const std::string& suggestion : suggestions)
+        {
+            bytes += sizeof(std::string) + suggestion.capacity();
+        }
+
+        // The list node, the map node and the key the map holds.
+        return bytes + 4 * sizeof(void*) + sizeof(std::string) + word.capacity();
+    }
+}
+
+
+
+SuggestionCache::SuggestionCache(unsigned int maxEntries, size_t maxBytes)
+    : maxEntries{maxEntries}, maxBytes{maxBytes}, totalBytes{0},
+      generation{0}, hitCount{0}, missCount{0}
+{
+}
+
+
+bool SuggestionCache::find(const std::string& word, std::vector<std::string>& suggestions)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto found = index.find(word);
+
+    if (found == index.end())
+    {
+        ++missCount;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, found->second);
+    suggestions = found->second->suggestions;
+    ++hitCount;
+    return true;
+}
+
+
+void SuggestionCache::store(const std::string& word, const std::vector<std::string>& suggestions)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    size_t bytes = estimateBytes(word, suggestions);
+
+    if (maxEntries == 0 || bytes > maxBytes || index.count(word) != 0)
+    {
+        return;
+    }
+
+    evictUntilWithin(maxEntries - 1, maxBytes - bytes);
+
+    entries.push_front(Entry{word, suggestions, bytes});
+    index[word] = entries.begin();
+    totalBytes += bytes;
+}
+
+
+void SuggestionCache::validate(unsigned long generation)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (generation != this->generation)
+    {
+        evictUntilWithin(0, 0);
+        this->generation = generation;
+    }
+}
+
+
+void SuggestionCache::clear()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    evictUntilWithin(0, 0);
+}
+
+
+void SuggestionCache::setBounds(unsigned int maxEntries, size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    this->maxEntries = maxEntries;
+    this->maxBytes = maxBytes;
+    evictUntilWithin(maxEntries, maxBytes);
+}
+
+
+unsigned long SuggestionCache::hits() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return hitCount;
+}
+
+
+unsigned long SuggestionCache::misses() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return missCount;
+}
+
+
+unsigned int SuggestionCache::size() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return entries.size();
+}
+
+
+size_t SuggestionCache::bytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return totalBytes;
+}
+
+
+void SuggestionCache::evictUntilWithin(unsigned int entryCount, size_t byteCount)
+{
+    while (!entries.empty() && (entries.size() > entryCount || totalBytes > byteCount))
+    {
+        totalBytes -= entries.back().bytes;
+        index.erase(entries.back().word);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,98 @@
+// SuggestionCache.hpp
+//
+// A SuggestionCache remembers the suggestions that were found for recently
+// misspelled words, so that a misspelling that recurs in a document (a
+// name, a piece of jargon, a repeated typo) only has its suggestions
+// generated once.  The cache is bounded both by a number of entries and by
+// an estimate of the memory its entries occupy; when either bound would be
+// exceeded, the least recently used entries are evicted.
+//
+// The cache is safe to use from several threads at once.
+
+#ifndef SUGGESTIONCACHE_HPP
+#define SUGGESTIONCACHE_HPP
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+
+class SuggestionCache
+{
+public:
+    static constexpr unsigned int DEFAULT_MAX_ENTRIES = 4096;
+    static constexpr size_t DEFAULT_MAX_BYTES = 4 * 1024 * 1024;
+
+public:
+    // Initializes an empty cache with the given bounds.  A cache whose
+    // maximum number of entries is zero stores nothing.
+    SuggestionCache(
+        unsigned int maxEntries = DEFAULT_MAX_ENTRIES,
+        size_t maxBytes = DEFAULT_MAX_BYTES);
+
+
+    // find() looks up the given word.  If it is cached, its suggestions are
+    // stored into suggestions, the entry becomes the most recently used one
+    // and true is returned; otherwise, false is returned.  Either way, the
+    // hit or miss is counted.
+    bool find(const std::string& word, std::vector<std::string>& suggestions);
+
+
+    // store() caches the suggestions for the given word, evicting the least
+    // recently used entries as necessary to stay within the bounds.
+    void store(const std::string& word, const std::vector<std::string>& suggestions);
+
+
+    // validate() clears the cache if the given generation differs from the
+    // one the cached entries were computed against, then remembers it.
+    // Callers pass something that changes whenever the dictionary does.
+    void validate(unsigned long generation);
+
+
+    // clear() removes every entry, leaving the counters intact.
+    void clear();
+
+
+    // setBounds() changes the bounds, evicting entries if necessary.
+    void setBounds(unsigned int maxEntries, size_t maxBytes);
+
+
+    unsigned long hits() const;
+    unsigned long misses() const;
+    unsigned int size() const;
+    size_t bytes() const;
+
+
+private:
+    struct Entry
+    {
+        std::string word;
+        std::vector<std::string> suggestions;
+        size_t bytes;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    mutable std::mutex mutex;
+
+    EntryList entries;
+    std::unordered_map<std::string, EntryList::iterator> index;
+
+    unsigned int maxEntries;
+    size_t maxBytes;
+    size_t totalBytes;
+
+    unsigned long generation;
+    unsigned long hitCount;
+    unsigned long missCount;
+
+private:
+    void evictUntilWithin(unsigned int entryCount, size_t byteCount);
+};
+
+
+
+#endif // SUGGESTIONCACHE_HPP
@@ -0,0 +1,238 @@
+// ThreadPool.cpp
+
+#include "ThreadPool.hpp"
+
+
+
+namespace
+{
+    // The pool, if any, whose worker is running on this thread, and the
+    // index of that worker's queue.
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentQueue = 0;
+}
+
+
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : queuedTasks{0}, steals{0}, stopping{false}
+{
+    for (unsigned int i = 0; i <= threadCount; ++i)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back([this, i]() { work(i); });
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+
+    workAvailable.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+
+void ThreadPool::runAll(const std::vector<Task>& tasks)
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(Batch{&tasks, 0, nullptr});
+    size_t home = homeQueue();
+
+    if (workers.empty() || tasks.size() == 1)
+    {
+        for (const Task& task : tasks)
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                if (!batch->error)
+                {
+                    batch->error = std::current_exception();
+                }
+            }
+        }
+
+        if (batch->error)
+        {
+            std::rethrow_exception(batch->error);
+        }
+
+        return;
+    }
+
+    // The tasks are counted before any of them is queued, since a worker
+    // may take one, and count it as taken, as soon as it's there.
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        queuedTasks += tasks.size();
+    }
+
+    // Deal the tasks out starting with this thread's own queue, so it
+    // starts on the first of them.
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        Queue& queue = *queues[(home + i) % queues.size()];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(TaskRef{batch, i});
+    }
+
+    workAvailable.notify_all();
+
+    while (true)
+    {
+        while (runOneTask(home))
+        {
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+
+        batchFinished.wait(
+            lock, [&]() { return batch->finished == tasks.size() || queuedTasks > 0; });
+
+        if (batch->finished == tasks.size())
+        {
+            break;
+        }
+    }
+
+    if (batch->error)
+    {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+
+unsigned int ThreadPool::threadCount() const
+{
+    return workers.size();
+}
+
+
+unsigned long ThreadPool::stealCount() const
+{
+    return steals;
+}
+
+
+void ThreadPool::work(size_t queueIndex)
+{
+    currentPool = this;
+    currentQueue = queueIndex;
+
+    while (true)
+    {
+        if (runOneTask(queueIndex))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        workAvailable.wait(lock, [this]() { return stopping || queuedTasks > 0; });
+
+        if (stopping && queuedTasks == 0)
+        {
+            return;
+        }
+    }
+}
+
+
+size_t ThreadPool::homeQueue() const
+{
+    return currentPool == this ? currentQueue : workers.size();
+}
+
+
+bool ThreadPool::takeTask(size_t home, TaskRef& task)
+{
+    {
+        Queue& queue = *queues[home];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        Queue& queue = *queues[(home + i) % queues.size()];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            ++steals;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool ThreadPool::runOneTask(size_t home)
+{
+    if (queuedTasks == 0)
+    {
+        return false;
+    }
+
+    TaskRef task;
+
+    if (!takeTask(home, task))
+    {
+        return false;
+    }
+
+    --queuedTasks;
+
+    std::exception_ptr error;
+
+    try
+    {
+        (*task.batch->tasks)[task.index]();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (error && !task.batch->error)
+        {
+            task.batch->error = error;
+        }
+
+        ++task.batch->finished;
+    }
+
+    batchFinished.notify_all();
+    return true;
+}
@@ -0,0 +1,104 @@
+// ThreadPool.hpp
+//
+// A ThreadPool owns a fixed number of worker threads that run batches of
+// tasks on behalf of other code.  The thread that submits a batch works
+// on it too, rather than sitting idle until it finishes, so it's safe for
+// a task to submit a batch of its own to the same pool.
+//
+// Each worker has a queue of its own, and a batch's tasks are dealt out
+// across all of the queues.  Workers take tasks from the front of their
+// own queue, so tasks submitted in order tend to run in order, and steal
+// from the back of another queue when their own runs dry, so a worker
+// that draws slow tasks doesn't hold up the rest of the batch.
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+public:
+    // Starts a pool with the given number of worker threads.  A pool with
+    // no workers runs every batch on the thread that submits it.
+    explicit ThreadPool(unsigned int threadCount);
+
+    // Stops the worker threads, waiting for any batches in progress.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+
+    // runAll() runs every one of the given tasks, in no particular order
+    // and possibly simultaneously, and returns once all have finished.  If
+    // any task throws an exception, the first one is rethrown afterward.
+    void runAll(const std::vector<Task>& tasks);
+
+
+    // threadCount() returns the number of worker threads.
+    unsigned int threadCount() const;
+
+
+    // stealCount() returns the number of tasks that have been run by a
+    // thread other than the one whose queue they were dealt to.
+    unsigned long stealCount() const;
+
+
+private:
+    struct Batch
+    {
+        const std::vector<Task>* tasks;
+        size_t finished;
+        std::exception_ptr error;
+    };
+
+    struct TaskRef
+    {
+        std::shared_ptr<Batch> batch;
+        size_t index;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<TaskRef> tasks;
+    };
+
+    std::vector<std::thread> workers;
+
+    // One queue per worker, followed by one shared by every thread that
+    // isn't a worker.
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::atomic<size_t> queuedTasks;
+    std::atomic<unsigned long> steals;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable batchFinished;
+    bool stopping;
+
+private:
+    void work(size_t queueIndex);
+    size_t homeQueue() const;
+    bool takeTask(size_t home, TaskRef& task);
+    bool runOneTask(size_t home);
+};
+
+
+
+#endif // THREADPOOL_HPP
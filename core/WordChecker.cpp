@@ -1,68 +1,687 @@
 // WordChecker.cpp
 
 #include "WordChecker.hpp"
-#include <iostream>
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <utility>
+
+
+
+namespace
+{
+    const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+
+    // The kinds of edit that turn a misspelled word into candidate
+    // suggestions, in the order in which their suggestions are reported.
+    enum class EditKind
+    {
+        Swap,
+        Insert,
+        Delete,
+        Replace,
+        Split
+    };
+
+    const EditKind editKinds[] =
+    {
+        EditKind::Swap, EditKind::Insert, EditKind::Delete,
+        EditKind::Replace, EditKind::Split
+    };
+
+    constexpr size_t editKindCount = sizeof(editKinds) / sizeof(editKinds[0]);
+
+
+    // In ranking mode, the budgeted findSuggestions() still finds every
+    // suggestion, unranked, so its results are cached apart from the ranked
+    // ones, under keys no word can have, and neither is served in place of
+    // the other.
+    const char unrankedKeyPrefix = '\n';
+
+
+    // In ranking mode, a suggestion's score is the weight of the kind of
+    // edit that produced it times one more than its frequency.  The weights
+    // reflect how likely a typist is to make each kind of mistake.
+    double weightOf(EditKind kind)
+    {
+        switch (kind)
+        {
+        case EditKind::Swap:
+            return 1.0;
+
+        case EditKind::Replace:
+            return 0.8;
+
+        case EditKind::Insert:
+        case EditKind::Delete:
+            return 0.6;
+
+        default: // EditKind::Split
+            return 0.3;
+        }
+    }
+
+
+    // The number of positions in the given word at which one kind of edit
+    // can be made.  Each position produces one candidate, except that
+    // insertions and replacements produce one per letter.
+    size_t positionCount(EditKind kind, const std::string& word)
+    {
+        switch (kind)
+        {
+        case EditKind::Insert:
+            return word.size() + 1;
+
+        case EditKind::Delete:
+        case EditKind::Replace:
+            return word.size();
+
+        default: // EditKind::Swap, EditKind::Split
+            return word.empty() ? 0 : word.size() - 1;
+        }
+    }
+
+
+    // Generates the candidates for one kind of edit of the given word, at
+    // the positions [first, last).  A split is only a suggestion when both
+    // halves are words, so each split adds two candidates: its left half,
+    // then its right half.
+    void generateCandidates(
+        EditKind kind, const std::string& word, size_t first, size_t last,
+        std::vector<std::string>& candidates)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            switch (kind)
+            {
+            case EditKind::Swap:
+            {
+                std::string candidate = word;
+                std::swap(candidate[i], candidate[i + 1]);
+                candidates.push_back(candidate);
+                break;
+            }
+
+            case EditKind::Insert:
+                for (char letter : alphabet)
+                {
+                    std::string candidate = word;
+                    candidate.insert(i, 1, letter);
+                    candidates.push_back(candidate);
+                }
+                break;
+
+            case EditKind::Delete:
+            {
+                std::string candidate = word;
+                candidate.erase(i, 1);
+                candidates.push_back(candidate);
+                break;
+            }
+
+            case EditKind::Replace:
+                for (char letter : alphabet)
+                {
+                    if (letter != word[i])
+                    {
+                        std::string candidate = word;
+                        candidate[i] = letter;
+                        candidates.push_back(candidate);
+                    }
+                }
+                break;
+
+            case EditKind::Split:
+                candidates.push_back(word.substr(0, i + 1));
+                candidates.push_back(word.substr(i + 1));
+                break;
+            }
+        }
+    }
+
+
+    // Calls found() with each suggestion among the candidates of one kind
+    // of edit, given which of the candidates are words.
+    template <typename FoundFunction>
+    void forEachSuggestion(
+        EditKind kind, const std::vector<std::string>& candidates,
+        const std::vector<bool>& exists, FoundFunction found)
+    {
+        if (kind == EditKind::Split)
+        {
+            for (size_t i = 0; i + 1 < candidates.size(); i += 2)
+            {
+                if (exists[i] && exists[i + 1])
+                {
+                    found(candidates[i] + " " + candidates[i + 1]);
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                if (exists[i])
+                {
+                    found(candidates[i]);
+                }
+            }
+        }
+    }
+
+
+    // A piece of the work of finding suggestions: one kind of edit at a
+    // range of positions, along with the suggestions it found.
+    struct SuggestionPiece
+    {
+        size_t kindIndex;
+        size_t first;
+        size_t last;
+        std::vector<std::string> suggestions;
+    };
+
+
+    // The highest score any suggestion produced by one kind of edit of
+    // the given word could have in ranking mode.
+    double scoreBound(EditKind kind, const std::string& word, const WordFrequencies& frequencies)
+    {
+        unsigned long maxFrequency = 0;
+
+        switch (kind)
+        {
+        case EditKind::Swap:
+        case EditKind::Replace:
+            maxFrequency = frequencies.maxFrequencyOfLength(word.size());
+            break;
+
+        case EditKind::Insert:
+            maxFrequency = frequencies.maxFrequencyOfLength(word.size() + 1);
+            break;
+
+        case EditKind::Delete:
+            maxFrequency = word.empty() ? 0 : frequencies.maxFrequencyOfLength(word.size() - 1);
+            break;
+
+        case EditKind::Split:
+            for (size_t length = 1; length < word.size(); ++length)
+            {
+                maxFrequency = std::max(maxFrequency, frequencies.maxFrequencyOfLength(length));
+            }
+            break;
+        }
+
+        return weightOf(kind) * (1.0 + maxFrequency);
+    }
+
+
+    struct RankedSuggestion
+    {
+        std::string text;
+        double score;
+        size_t kindIndex;
+        size_t position;
+
+        bool operator<(const RankedSuggestion& other) const
+        {
+            if (score != other.score)
+            {
+                return score > other.score;
+            }
+            else if (kindIndex != other.kindIndex)
+            {
+                return kindIndex < other.kindIndex;
+            }
+            else
+            {
+                return position < other.position;
+            }
+        }
+    };
+}
+
+
 
 WordChecker::WordChecker(const Set<std::string>& words)
-    : words{words}
+    : words{words}, filter{nullptr}, cache{},
+      frequencies{nullptr}, maxSuggestions{0},
+      pool{nullptr}, minimumParallelWordLength{DEFAULT_MINIMUM_PARALLEL_WORD_LENGTH}
+{
+}
+
+
+WordChecker::WordChecker(const Set<std::string>& words, const BloomFilter& filter)
+    : words{words}, filter{&filter}, cache{},
+      frequencies{nullptr}, maxSuggestions{0},
+      pool{nullptr}, minimumParallelWordLength{DEFAULT_MINIMUM_PARALLEL_WORD_LENGTH}
+{
+}
+
+
+WordChecker::WordChecker(std::shared_ptr<const Dictionary> dictionary)
+    : dictionary{std::move(dictionary)},
+      words{this->dictionary->words()}, filter{this->dictionary->filter()}, cache{},
+      frequencies{nullptr}, maxSuggestions{0},
+      pool{nullptr}, minimumParallelWordLength{DEFAULT_MINIMUM_PARALLEL_WORD_LENGTH}
 {
 }
 
 
 bool WordChecker::wordExists(const std::string& word) const
 {
-    return this->words.contains(word);
+    if (filter == nullptr)
+    {
+        return words.contains(word);
+    }
+
+    bool mightExist = filter->mightContain(word);
+    filter->countLookups(1, mightExist ? 0 : 1);
+
+    return mightExist && words.contains(word);
+}
+
+
+std::vector<bool> WordChecker::wordsExist(const std::vector<std::string>& words) const
+{
+    if (filter == nullptr)
+    {
+        return this->words.containsBatch(words);
+    }
+
+    // Only the words that get past the filter are looked up in the Set.
+    std::vector<bool> exists(words.size(), false);
+    std::vector<std::string> candidates;
+    std::vector<size_t> positions;
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        if (filter->mightContain(words[i]))
+        {
+            candidates.push_back(words[i]);
+            positions.push_back(i);
+        }
+    }
+
+    filter->countLookups(words.size(), words.size() - candidates.size());
+
+    std::vector<bool> found = this->words.containsBatch(candidates);
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        exists[positions[i]] = found[i];
+    }
+
+    return exists;
 }
 
 
 std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
 {
-    std::string alphabet = "QWERTYUIOPASDFGHJKLZXCVBNM";
-    
-    std::vector<std::string> suggest;
+    std::vector<std::string> suggestions;
+    cache.validate(words.size());
+
+    if (!cache.find(word, suggestions))
+    {
+        suggestions = generateSuggestions(word);
+        cache.store(word, suggestions);
+    }
+
+    return suggestions;
+}
+
+
+std::vector<std::string> WordChecker::findSuggestions(
+    const std::string& word, const SuggestionBudget& budget, bool& complete) const
+{
+    std::vector<std::string> suggestions;
+    cache.validate(words.size());
+
+    std::string key = frequencies == nullptr ? word : unrankedKeyPrefix + word;
+
+    if (cache.find(key, suggestions))
+    {
+        complete = true;
+        return suggestions;
+    }
 
-    for(int i = 0; i<word.size()-1; i++){
+    SuggestionGenerator generator = findSuggestionsIncrementally(word, budget);
+    std::string suggestion;
 
-    //swap adjacent pair of characters
-        std::string temp0 = word;
-        std::swap(temp0[i],temp0[i+1]);
-        if(wordExists(temp0) && (std::find(suggest.begin(), suggest.end(), temp0) == suggest.end()))
-            suggest.push_back(temp0);
+    while (generator.next(suggestion))
+    {
+        suggestions.push_back(suggestion);
+    }
 
-    //insert space between pair of characters
-        std::string temp1 = word;
-        temp.insert(i," ");
-        if(wordExists(temp1) && (std::find(suggest.begin(), suggest.end(, temp1) == suggest.end()))
-            suggest.push_back(temp1);
+    complete = generator.complete();
 
+    if (complete)
+    {
+        cache.store(key, suggestions);
     }
 
-    for(int j = 0; j<word.size(); j++){    
-        for(int k = 0; k<alphabet.size(); k++){
+    return suggestions;
+}
+
+
+WordChecker::SuggestionGenerator WordChecker::findSuggestionsIncrementally(
+    const std::string& word, const SuggestionBudget& budget) const
+{
+    return SuggestionGenerator{*this, word, budget};
+}
+
+
+void WordChecker::setSuggestionCacheBounds(unsigned int maxEntries, size_t maxBytes)
+{
+    cache.setBounds(maxEntries, maxBytes);
+}
+
+
+void WordChecker::clearSuggestionCache()
+{
+    cache.clear();
+}
+
+
+const SuggestionCache& WordChecker::suggestionCache() const
+{
+    return cache;
+}
+
 
-        //insert alphabet between pairs of characters
-            std::string temp2 = word;
-            temp2.insert(j,1,alphabet[k]);
-            if(wordExists(temp2) && (std::find(suggest.begin(), suggest.end(), temp2) == suggest.end()))
-                suggest.push_back(temp2);
-        
-        //replace characters with alphabet
-            std::string temp3 = word
-            temp3.replace(j,1,alphabet[k]);
-            if(wordExists(temp3) && (std::fint(suggest.begin(), suggest.end(), temp3) == suggest.end()))
-                suggest.push_back(temp3)
+void WordChecker::setRanking(const WordFrequencies& frequencies, unsigned int maxSuggestions)
+{
+    this->frequencies = &frequencies;
+    this->maxSuggestions = maxSuggestions;
+    cache.clear();
+}
+
+
+void WordChecker::clearRanking()
+{
+    frequencies = nullptr;
+    maxSuggestions = 0;
+    cache.clear();
+}
+
+
+std::vector<std::string> WordChecker::generateSuggestions(const std::string& word) const
+{
+    if (frequencies != nullptr)
+    {
+        return generateRankedSuggestions(word);
+    }
+
+    std::vector<size_t> kinds;
+
+    for (size_t k = 0; k < editKindCount; ++k)
+    {
+        kinds.push_back(k);
+    }
+
+    std::vector<std::vector<std::string>> found = findSuggestionsOfKinds(kinds, word);
+    std::vector<std::string> suggestions;
+
+    for (const std::vector<std::string>& kindSuggestions : found)
+    {
+        for (const std::string& suggestion : kindSuggestions)
+        {
+            if (std::find(suggestions.begin(), suggestions.end(), suggestion) == suggestions.end())
+            {
+                suggestions.push_back(suggestion);
+            }
+        }
+    }
+
+    return suggestions;
+}
+
+
+std::vector<std::string> WordChecker::generateRankedSuggestions(const std::string& word) const
+{
+    // The kinds of edit are tried in decreasing order of the best score
+    // they could produce, so that as soon as the k-th best suggestion so
+    // far scores at least that well, no remaining kind can displace it and
+    // generation stops.
+    size_t order[editKindCount];
+    double bounds[editKindCount];
+
+    for (size_t k = 0; k < editKindCount; ++k)
+    {
+        order[k] = k;
+        bounds[k] = scoreBound(editKinds[k], word, *frequencies);
+    }
+
+    std::stable_sort(
+        order, order + editKindCount,
+        [&](size_t a, size_t b) { return bounds[a] > bounds[b]; });
+
+    std::vector<RankedSuggestion> ranked;
+
+    for (size_t k : order)
+    {
+        if (maxSuggestions == 0
+            || (ranked.size() >= maxSuggestions
+                && ranked[maxSuggestions - 1].score >= bounds[k]))
+        {
+            break;
         }
 
-    //delete each character
-        std::string temp4 = word;
-        temp4.erase(j,1);
-        if(wordExists(temp4) && (std::find(suggest.begin(), suggest.end(), temp4) === suggest.end()))
-            suggest.push_back(temp4);
+        std::vector<std::string> found = findSuggestionsOfKinds({k}, word)[0];
 
+        for (size_t position = 0; position < found.size(); ++position)
+        {
+            const std::string& suggestion = found[position];
+
+            RankedSuggestion candidate{
+                suggestion,
+                weightOf(editKinds[k]) * (1.0 + frequencies->frequencyOf(suggestion)),
+                k, position};
+
+            auto existing = std::find_if(
+                ranked.begin(), ranked.end(),
+                [&](const RankedSuggestion& r) { return r.text == suggestion; });
+
+            if (existing == ranked.end())
+            {
+                ranked.push_back(candidate);
+            }
+            else if (candidate < *existing)
+            {
+                *existing = candidate;
+            }
+        }
+
+        std::sort(ranked.begin(), ranked.end());
+    }
+
+    std::vector<std::string> suggestions;
+
+    for (size_t i = 0; i < ranked.size() && i < maxSuggestions; ++i)
+    {
+        suggestions.push_back(ranked[i].text);
     }
 
-    return suggest;
+    return suggestions;
 }
 
+
+std::vector<std::vector<std::string>> WordChecker::findSuggestionsOfKinds(
+    const std::vector<size_t>& kinds, const std::string& word) const
+{
+    bool parallel = pool != nullptr && word.size() >= minimumParallelWordLength;
+
+    // In parallel, each kind of edit is split into about two pieces per
+    // thread, so that threads that finish early can pick up the slack.
+    size_t piecesPerKind = parallel ? 2 * (pool->threadCount() + 1) : 1;
+
+    std::vector<SuggestionPiece> pieces;
+
+    for (size_t k : kinds)
+    {
+        size_t count = positionCount(editKinds[k], word);
+        size_t step = std::max<size_t>(1, (count + piecesPerKind - 1) / piecesPerKind);
+
+        for (size_t first = 0; first < count; first += step)
+        {
+            pieces.push_back(SuggestionPiece{k, first, std::min(count, first + step), {}});
+        }
+    }
+
+    auto findPiece =
+        [&](SuggestionPiece& piece)
+        {
+            EditKind kind = editKinds[piece.kindIndex];
+
+            std::vector<std::string> candidates;
+            generateCandidates(kind, word, piece.first, piece.last, candidates);
+
+            forEachSuggestion(
+                kind, candidates, wordsExist(candidates),
+                [&](const std::string& suggestion)
+                {
+                    piece.suggestions.push_back(suggestion);
+                });
+        };
+
+    if (parallel)
+    {
+        std::vector<ThreadPool::Task> tasks;
+
+        for (SuggestionPiece& piece : pieces)
+        {
+            tasks.push_back([&]() { findPiece(piece); });
+        }
+
+        pool->runAll(tasks);
+    }
+    else
+    {
+        for (SuggestionPiece& piece : pieces)
+        {
+            findPiece(piece);
+        }
+    }
+
+    // The pieces are in order, so concatenating each kind's pieces gives
+    // the same order a serial search would have.
+    std::vector<std::vector<std::string>> found(kinds.size());
+
+    for (size_t i = 0, p = 0; i < kinds.size(); ++i)
+    {
+        for (; p < pieces.size() && pieces[p].kindIndex == kinds[i]; ++p)
+        {
+            found[i].insert(
+                found[i].end(), pieces[p].suggestions.begin(), pieces[p].suggestions.end());
+        }
+    }
+
+    return found;
+}
+
+
+void WordChecker::setThreadPool(ThreadPool& pool, size_t minimumWordLength)
+{
+    this->pool = &pool;
+    minimumParallelWordLength = minimumWordLength;
+}
+
+
+void WordChecker::clearThreadPool()
+{
+    pool = nullptr;
+}
+
+
+
+WordChecker::SuggestionGenerator::SuggestionGenerator(
+    const WordChecker& checker, const std::string& word,
+    const SuggestionBudget& budget)
+    : checker{checker}, word{word}, budget{budget},
+      startTime{std::chrono::steady_clock::now()},
+      kindIndex{0}, position{0}, probeCount{0}, exhausted{false}
+{
+}
+
+
+bool WordChecker::SuggestionGenerator::next(std::string& suggestion)
+{
+    while (pending.empty())
+    {
+        if (kindIndex == editKindCount || exhausted)
+        {
+            return false;
+        }
+        else if (!withinBudget())
+        {
+            exhausted = true;
+            return false;
+        }
+
+        advance();
+    }
+
+    suggestion = pending.front();
+    pending.pop_front();
+    return true;
+}
+
+
+bool WordChecker::SuggestionGenerator::complete() const
+{
+    return kindIndex == editKindCount && pending.empty();
+}
+
+
+bool WordChecker::SuggestionGenerator::budgetExhausted() const
+{
+    return exhausted;
+}
+
+
+unsigned long WordChecker::SuggestionGenerator::probes() const
+{
+    return probeCount;
+}
+
+
+bool WordChecker::SuggestionGenerator::withinBudget() const
+{
+    return (budget.probes == 0 || probeCount < budget.probes)
+        && (budget.time.count() == 0
+            || std::chrono::steady_clock::now() - startTime < budget.time);
+}
+
+
+void WordChecker::SuggestionGenerator::advance()
+{
+    // Each step tries one kind of edit at one position in the word, so a
+    // budget is overshot by at most one position's candidates (one per
+    // letter of the alphabet).
+    EditKind kind = editKinds[kindIndex];
+
+    if (position < positionCount(kind, word))
+    {
+        std::vector<std::string> candidates;
+        generateCandidates(kind, word, position, position + 1, candidates);
+        probeCount += candidates.size();
+
+        forEachSuggestion(
+            kind, candidates, checker.wordsExist(candidates),
+            [&](const std::string& suggestion)
+            {
+                if (std::find(found.begin(), found.end(), suggestion) == found.end())
+                {
+                    found.push_back(suggestion);
+                    pending.push_back(suggestion);
+                }
+            });
+
+        ++position;
+    }
+
+    if (position >= positionCount(kind, word))
+    {
+        ++kindIndex;
+        position = 0;
+    }
+}
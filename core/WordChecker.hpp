@@ -7,14 +7,46 @@
 #ifndef WORDCHECKER_HPP
 #define WORDCHECKER_HPP
 
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
+#include "BloomFilter.hpp"
+#include "Dictionary.hpp"
 #include "Set.hpp"
+#include "SuggestionCache.hpp"
+#include "ThreadPool.hpp"
+#include "WordFrequencies.hpp"
+
+
+
+// A SuggestionBudget limits how much work is done finding suggestions for
+// one word: how long it may take, how many candidate words may be looked
+// up, or both.  A limit of zero means there is no such limit.
+struct SuggestionBudget
+{
+    std::chrono::microseconds time{0};
+    unsigned long probes = 0;
+
+    bool isLimited() const
+    {
+        return time.count() > 0 || probes > 0;
+    }
+};
 
 
 
 class WordChecker
 {
+public:
+    class SuggestionGenerator;
+
+public:
+    // Words shorter than this have too few candidate suggestions for
+    // splitting the work among threads to pay off.
+    static constexpr size_t DEFAULT_MINIMUM_PARALLEL_WORD_LENGTH = 10;
+
 public:
     // The constructor requires a Set of words to be passed into it.  The
     // WordChecker will store a reference to a const Set, which it will use
@@ -22,19 +54,165 @@ public:
     WordChecker(const Set<std::string>& words);
 
 
+    // This constructor additionally takes a BloomFilter summarizing the
+    // same words (see WordSetLoader).  Words the filter rejects are known
+    // to be misspelled without searching the Set at all.  The WordChecker
+    // stores a reference to the filter, too, and counts its lookups in the
+    // filter once per call rather than once per word.
+    WordChecker(const Set<std::string>& words, const BloomFilter& filter);
+
+
+    // This constructor checks words against the given version of a
+    // Dictionary, using its BloomFilter if it has one, and keeps that
+    // version alive for as long as the WordChecker lives, even if its
+    // DictionaryHandle moves on to a newer one in the meantime.
+    explicit WordChecker(std::shared_ptr<const Dictionary> dictionary);
+
+
     // wordExists() returns true if the given word is spelled correctly,
     // false otherwise.
     bool wordExists(const std::string& word) const;
 
 
+    // wordsExist() returns, for each of the given words in order, whether
+    // it is spelled correctly.  Checking many words at once lets the
+    // underlying Set overlap the memory accesses of the lookups.
+    std::vector<bool> wordsExist(const std::vector<std::string>& words) const;
+
+
     // findSuggestions() returns a vector containing suggested alternative
     // spellings for the given word, using the five algorithms described in
-    // the project write-up.
+    // the project write-up.  Suggestions are remembered in a bounded LRU
+    // cache, so a misspelling that recurs is only worked out once; the
+    // cache is discarded whenever the size of the Set changes, i.e.,
+    // whenever words have been added to the dictionary.
     std::vector<std::string> findSuggestions(const std::string& word) const;
 
 
+    // This overload of findSuggestions() stops looking for suggestions
+    // once the given budget is exhausted, returning the ones it found so
+    // far in the order it found them, and sets complete to indicate whether
+    // the search finished.  Incomplete results are not cached, and neither
+    // ranking nor the thread pool is used; in ranking mode, the complete
+    // results are cached apart from the ranked ones.
+    std::vector<std::string> findSuggestions(
+        const std::string& word, const SuggestionBudget& budget, bool& complete) const;
+
+
+    // findSuggestionsIncrementally() returns a generator that yields the
+    // same suggestions as findSuggestions(), in the same order, one at a
+    // time, doing only as much work as it needs to find each one, and
+    // stopping if the given budget is exhausted.
+    SuggestionGenerator findSuggestionsIncrementally(
+        const std::string& word, const SuggestionBudget& budget = SuggestionBudget{}) const;
+
+
+    // setSuggestionCacheBounds() limits how many misspellings, and roughly
+    // how many bytes of them, the suggestion cache holds.  A maximum of
+    // zero entries turns the cache off.
+    void setSuggestionCacheBounds(unsigned int maxEntries, size_t maxBytes);
+
+
+    // clearSuggestionCache() discards every cached suggestion.
+    void clearSuggestionCache();
+
+
+    // suggestionCache() gives access to the cache, mainly so that its hit
+    // and miss counters can be reported.
+    const SuggestionCache& suggestionCache() const;
+
+
+    // setRanking() switches findSuggestions() into ranking mode, in which
+    // it returns only the best maxSuggestions suggestions, best first.
+    // Suggestions are scored by the kind of edit that produced them and by
+    // their frequency in the given table, and generation stops early once
+    // no remaining kind of edit could produce a better suggestion.  The
+    // WordChecker stores a reference to the table.  clearRanking() goes
+    // back to returning every suggestion in the order it was found.
+    void setRanking(const WordFrequencies& frequencies, unsigned int maxSuggestions);
+    void clearRanking();
+
+
+    // setThreadPool() makes findSuggestions() split the generation and
+    // lookup of candidates for words of at least the given length among
+    // the threads of the given pool, by kind of edit and range of positions
+    // in the word.  The suggestions are found in the same order either way.
+    // The WordChecker stores a reference to the pool.  clearThreadPool()
+    // goes back to finding suggestions on the calling thread.
+    void setThreadPool(
+        ThreadPool& pool,
+        size_t minimumWordLength = DEFAULT_MINIMUM_PARALLEL_WORD_LENGTH);
+    void clearThreadPool();
+
+
+public:
+    class SuggestionGenerator
+    {
+    public:
+        // next() finds the next suggestion and stores it into suggestion,
+        // returning true, or returns false when there are no more or the
+        // budget has been exhausted.
+        bool next(std::string& suggestion);
+
+        // complete() returns true once every suggestion has been found,
+        // false if there may be more (including when the search stopped
+        // because the budget was exhausted).
+        bool complete() const;
+
+        // budgetExhausted() returns true if the search stopped early.
+        bool budgetExhausted() const;
+
+        // probes() returns the number of candidate words looked up so far.
+        unsigned long probes() const;
+
+    private:
+        friend class WordChecker;
+
+        SuggestionGenerator(
+            const WordChecker& checker, const std::string& word,
+            const SuggestionBudget& budget);
+
+        bool withinBudget() const;
+        void advance();
+
+        const WordChecker& checker;
+        std::string word;
+        SuggestionBudget budget;
+        std::chrono::steady_clock::time_point startTime;
+
+        size_t kindIndex;
+        size_t position;
+        unsigned long probeCount;
+        bool exhausted;
+
+        std::deque<std::string> pending;
+        std::vector<std::string> found;
+    };
+
+
 private:
+    // Only set by the constructor that takes a Dictionary; declared first
+    // so that it's initialized before the references into it.
+    std::shared_ptr<const Dictionary> dictionary;
+
     const Set<std::string>& words;
+    const BloomFilter* filter;
+    mutable SuggestionCache cache;
+
+    const WordFrequencies* frequencies;
+    unsigned int maxSuggestions;
+
+    ThreadPool* pool;
+    size_t minimumParallelWordLength;
+
+private:
+    std::vector<std::string> generateSuggestions(const std::string& word) const;
+    std::vector<std::string> generateRankedSuggestions(const std::string& word) const;
+
+    // Finds the suggestions produced by each of the given kinds of edit
+    // (numbered in the order their suggestions are reported), in order.
+    std::vector<std::vector<std::string>> findSuggestionsOfKinds(
+        const std::vector<size_t>& kinds, const std::string& word) const;
 };
 
 
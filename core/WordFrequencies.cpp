@@ -0,0 +1,52 @@
+// WordFrequencies.cpp
+
+#include <algorithm>
+#include "WordFrequencies.hpp"
+
+
+
+WordFrequencies::WordFrequencies()
+    : frequencies{}, maxFrequencies{}
+{
+}
+
+
+void WordFrequencies::set(const std::string& word, unsigned long frequency)
+{
+    frequencies[word] = frequency;
+
+    if (maxFrequencies.size() <= word.size())
+    {
+        maxFrequencies.resize(word.size() + 1, 0);
+    }
+
+    maxFrequencies[word.size()] = std::max(maxFrequencies[word.size()], frequency);
+}
+
+
+unsigned long WordFrequencies::frequencyOf(const std::string& word) const
+{
+    size_t space = word.find(' ');
+
+    if (space != std::string::npos)
+    {
+        return std::min(
+            frequencyOf(word.substr(0, space)),
+            frequencyOf(word.substr(space + 1)));
+    }
+
+    auto found = frequencies.find(word);
+    return found != frequencies.end() ? found->second : 0;
+}
+
+
+unsigned long WordFrequencies::maxFrequencyOfLength(size_t length) const
+{
+    return length < maxFrequencies.size() ? maxFrequencies[length] : 0;
+}
+
+
+unsigned int WordFrequencies::size() const
+{
+    return frequencies.size();
+}
@@ -0,0 +1,50 @@
+// WordFrequencies.hpp
+//
+// WordFrequencies is a table of how often each word occurs in some large
+// body of text.  It is used to rank suggestions, so that common words are
+// suggested ahead of rare ones.  Words that aren't in the table have a
+// frequency of zero.
+
+#ifndef WORDFREQUENCIES_HPP
+#define WORDFREQUENCIES_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+
+class WordFrequencies
+{
+public:
+    WordFrequencies();
+
+
+    // set() records the frequency of the given word.
+    void set(const std::string& word, unsigned long frequency);
+
+
+    // frequencyOf() returns the frequency of the given word.  The frequency
+    // of several words separated by spaces is the frequency of the least
+    // frequent of them.
+    unsigned long frequencyOf(const std::string& word) const;
+
+
+    // maxFrequencyOfLength() returns the highest frequency of any word
+    // with the given length, which bounds the frequency of any suggestion
+    // of that length.
+    unsigned long maxFrequencyOfLength(size_t length) const;
+
+
+    // size() returns the number of words in the table.
+    unsigned int size() const;
+
+
+private:
+    std::unordered_map<std::string, unsigned long> frequencies;
+    std::vector<unsigned long> maxFrequencies;
+};
+
+
+
+#endif // WORDFREQUENCIES_HPP
@@ -0,0 +1,163 @@
+// Benchmarks.hpp
+//
+// The benchmarks that can be run by the experiment driver in main.cpp.
+// Each one reads its parameters, one per line, from the given input
+// stream (see readParameter()) and prints a table of its results to the
+// given output stream.
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <iostream>
+#include <string>
+
+
+
+// readParameter() reads one line of input, returning the given default if
+// the line is empty or there is no more input.
+std::string readParameter(std::istream& in, const std::string& defaultValue);
+
+
+// Times findSuggestions() on random words of increasing length, using
+// increasing numbers of threads, checking that every thread count finds
+// the same suggestions in the same order.
+//
+// Parameters: word set path
+void runSuggestionBenchmark(std::istream& in, std::ostream& out);
+
+
+// Checks a large synthetic text file, and copies of it compressed with
+// gzip and (if supported) zstd, each evicted from the page cache first,
+// reporting how long just reading (and decompressing) each one takes and
+// how long checking it end to end takes.
+//
+// Parameters: word set path, size of the text file in MB, text file path
+void runCompressedInputBenchmark(std::istream& in, std::ostream& out);
+
+
+// Measures how long starting up with a dictionary takes, loading its word
+// file into a HashSet, loading a snapshot of that HashSet (see
+// Set<T>::saveSnapshot()), and opening it compiled (see CompiledWordSet),
+// with and without verifying its checksum, for the given word set and a
+// much larger synthetic one.  Each startup ends with a batch of lookups,
+// so that pages of a compiled dictionary aren't left untouched.
+//
+// Parameters: word set path, number of synthetic words, synthetic word
+// file path
+void runDictionaryStartupBenchmark(std::istream& in, std::ostream& out);
+
+
+// Times looking words up, one at a time and in batches, in a LayeredSet of
+// a base dictionary and two small overlays, with the overlays looked in
+// first and then last, alongside the base dictionary alone and a single
+// set with all three merged into it.
+//
+// Parameters: word set path, number of words in each overlay, number of
+// times to look up every query
+void runLayeredLookupBenchmark(std::istream& in, std::ostream& out);
+
+
+// Times loading a large synthetic word set on one thread and then using
+// increasing numbers of threads, into an EmptySet (so only reading and
+// normalizing the words is timed), a HashSet, and a HashSet with a
+// BloomFilter in front of it.
+//
+// Parameters: word file path, number of words
+void runLoaderBenchmark(std::istream& in, std::ostream& out);
+
+
+// Tells listeners about every word of a synthetic text file as though it
+// were misspelled, first one misspelling at a time and then in batches of
+// the sizes spell checkers use (see SpellCheckerListener), with one and
+// several listeners that just count them and with an
+// OutputSpellCheckerListener writing to nowhere.
+//
+// Parameters: word set path, size of the text file in MB, text file path
+void runNotifyBenchmark(std::istream& in, std::ostream& out);
+
+
+// Measures how many events per second can be notified to 1, 4 and 16
+// observers that just count them, by Observable as it used to be, by
+// Observable locking each observer for each event, and by Observable while
+// a Hold keeps them locked.
+//
+// Parameters: number of events
+void runObserverBenchmark(std::istream& in, std::ostream& out);
+
+
+// Times SpellChecker::run() and then SpellChecker::runParallel() with
+// increasing numbers of threads, on many copies of a text file, checking
+// that every run reports the same misspellings in the same order.
+//
+// Parameters: word set path, text file path, number of copies, chunk size
+void runParallelCheckBenchmark(std::istream& in, std::ostream& out);
+
+
+// Times SpellChecker::run() and SpellChecker::runPipelined() on a large
+// synthetic text file, read both mapped into memory and as a stream,
+// checking that they find the same number of misspellings, and reports
+// how busy each stage of the pipeline was and how full its queue got.
+//
+// Parameters: word set path, size of the text file in MB, text file path
+void runPipelineBenchmark(std::istream& in, std::ostream& out);
+
+
+// Checks a large synthetic text file, evicted from the page cache before
+// each run, using a StreamTextReader that reads directly and then ones
+// that read ahead in blocks of increasing size, alongside how long just
+// reading the file and just checking it take.  With reading ahead, the
+// total should approach the larger of the two rather than their sum.
+//
+// Parameters: word set path, size of the text file in MB, text file path
+void runReadAheadBenchmark(std::istream& in, std::ostream& out);
+
+
+// Measures how many words per second can be checked, in batches that each
+// take the current version of a dictionary from a DictionaryHandle, first
+// with the dictionary left alone and then while new versions of it are
+// built from a synthetic word file and swapped in, one after another.
+//
+// Parameters: word file path, number of words, number of checking
+// threads, seconds to check for in each case
+void runReloadBenchmark(std::istream& in, std::ostream& out);
+
+
+// Measures how many words per second TextFileReader, MappedTextFileReader
+// and WindowedTextReader can read from a large synthetic text file, along
+// with each word's context.
+//
+// Parameters: word set path, size of the text file in MB, text file path
+void runReaderBenchmark(std::istream& in, std::ostream& out);
+
+
+// Runs a SpellCheckServer and has increasing numbers of clients make
+// requests of it at once, first to check small documents cut from a text
+// file and then to check a few words at a time, reporting how many
+// requests are served per second, the median and 99th percentile time
+// they take, and how many the server serves in each batch.
+//
+// Parameters: word set path, text file path, size of each document in
+// bytes, number of requests each client makes
+void runServerBenchmark(std::istream& in, std::ostream& out);
+
+
+// Forks a number of worker processes, each of which makes a dictionary
+// ready and looks up every word in it, and measures the total memory they
+// use when each has no dictionary, when each loads its own copy into a
+// HashSet, and when all of them open one copy published in shared memory
+// (see CompiledWordSet::writeShared()).
+//
+// Parameters: word file path, number of synthetic words, number of workers
+void runSharedDictionaryBenchmark(std::istream& in, std::ostream& out);
+
+
+// Measures how fast each WordTokenizer supported by this CPU can find and
+// uppercase the words in a synthetic text held in memory, treating it both
+// as ASCII and as UTF-8, and checking that they all find the same words.
+//
+// Parameters: word set path, size of the text in MB, text file path
+void runTokenizerBenchmark(std::istream& in, std::ostream& out);
+
+
+
+#endif // BENCHMARKS_HPP
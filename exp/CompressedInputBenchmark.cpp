@@ -0,0 +1,189 @@
+// CompressedInputBenchmark.cpp
+
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+#include "Benchmarks.hpp"
+#include "Decompressor.hpp"
+#include "HashSet.hpp"
+#include "ReadAheadFile.hpp"
+#include "SpellChecker.hpp"
+#include "Stopwatch.hpp"
+#include "StreamTextReader.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+
+namespace
+{
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+
+    void writeFile(const std::string& path, const std::string& contents)
+    {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+    }
+
+
+    std::string gzip(const std::string& text)
+    {
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+
+        std::string compressed(deflateBound(&stream, text.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = text.size();
+        stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+        stream.avail_out = compressed.size();
+
+        deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        return compressed;
+    }
+
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+    std::string zstd(const std::string& text)
+    {
+        std::string compressed(ZSTD_compressBound(text.size()), '\0');
+        compressed.resize(ZSTD_compress(compressed.data(), compressed.size(), text.data(), text.size(), 3));
+        return compressed;
+    }
+#endif
+
+
+    // Asks the kernel to drop the file's pages from the page cache, so
+    // that the next read of it has to go to the disk.
+    void evictFromPageCache(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd >= 0)
+        {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+
+
+    double readOnly(const std::string& path)
+    {
+        ReadAheadFile file{path};
+        std::string chunk(ReadAheadFile::DEFAULT_BLOCK_SIZE, '\0');
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        while (file.read(chunk.data(), chunk.size()) > 0)
+        {
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    double check(const WordChecker& wordChecker, const std::string& path)
+    {
+        SpellChecker spellChecker;
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        StreamTextReader reader{path};
+        spellChecker.run(wordChecker, reader);
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    // Reports a time in microseconds, along with the rate at which the
+    // uncompressed text was got through.
+    void report(std::ostream& out, double usec, unsigned long long textBytes)
+    {
+        out << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << usec << " usec"
+            << std::setprecision(1)
+            << std::setw(9) << (textBytes / (usec / 1000000.0) / (1024.0 * 1024.0)) << " MB/s";
+    }
+}
+
+
+
+void runCompressedInputBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "32"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-compressed.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    // The compressed files are made from the whole text file, which may
+    // have been made larger by an earlier run.
+    std::string text = readFile(textFilePath);
+    std::vector<std::pair<std::string, std::string>> files{{"uncompressed", textFilePath}};
+
+    out << "Compressing it ..." << std::endl;
+
+    writeFile(textFilePath + ".gz", gzip(text));
+    files.emplace_back("gzip", textFilePath + ".gz");
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+    writeFile(textFilePath + ".zst", zstd(text));
+    files.emplace_back("zstd", textFilePath + ".zst");
+#endif
+
+    HashSet<std::string> wordSet{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, wordSet);
+    WordChecker wordChecker{wordSet};
+
+    // Check once first, so that every timed run finds the same
+    // suggestions already cached.
+    check(wordChecker, textFilePath);
+
+    out << std::endl
+        << std::left << std::setw(16) << "input" << std::right << std::setw(10) << "size"
+        << std::setw(31) << "read (cold)" << std::setw(31) << "check (cold)" << std::endl;
+
+    for (const auto& [name, path] : files)
+    {
+        unsigned long long size = readFile(path).size();
+
+        evictFromPageCache(path);
+        double readDuration = readOnly(path);
+
+        evictFromPageCache(path);
+        double checkDuration = check(wordChecker, path);
+
+        out << std::left << std::setw(16) << name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8) << (size / (1024.0 * 1024.0)) << "MB";
+
+        report(out, readDuration, text.size());
+        report(out, checkDuration, text.size());
+        out << std::endl;
+    }
+
+    out << std::endl << "(rates are of uncompressed text)" << std::endl;
+}
@@ -0,0 +1,153 @@
+// DictionaryStartupBenchmark.cpp
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "CompiledWordSet.hpp"
+#include "HashSet.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    unsigned long long fileSize(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        return file ? static_cast<unsigned long long>(file.tellg()) : 0;
+    }
+
+
+    // Queries some words that are there and some that aren't, so that a
+    // set that's been mapped in place pays for the pages it touches.
+    unsigned long long query(const Set<std::string>& wordSet, const std::vector<std::string>& queries)
+    {
+        std::vector<bool> found = wordSet.containsBatch(queries);
+        return std::count(found.begin(), found.end(), true);
+    }
+
+
+    std::vector<std::string> queriesFor(const std::string& wordFilePath)
+    {
+        std::ifstream wordFile{wordFilePath};
+        std::vector<std::string> queries;
+        std::string word;
+
+        while (queries.size() < 10000 && std::getline(wordFile, word))
+        {
+            std::string uppercase;
+
+            for (char c : word)
+            {
+                uppercase += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+
+            queries.push_back(uppercase);
+            queries.push_back(uppercase + "Q");
+        }
+
+        return queries;
+    }
+
+
+    void report(std::ostream& out, const std::string& name, double usec, unsigned long long found)
+    {
+        out << "  " << std::left << std::setw(36) << name
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << usec << " usec"
+            << std::setw(10) << found << " found" << std::endl;
+    }
+
+
+    void measure(
+        std::ostream& out, const std::string& wordFilePath, const std::string& compiledFilePath,
+        const std::string& snapshotFilePath)
+    {
+        std::vector<std::string> queries = queriesFor(wordFilePath);
+        Stopwatch stopwatch;
+
+        out << std::endl << wordFilePath << " (" << fileSize(wordFilePath) << " bytes)" << std::endl;
+
+        {
+            stopwatch.start();
+            HashSet<std::string> wordSet{hashStringAsProduct};
+            WordSetLoader{}.load(wordFilePath, wordSet);
+            unsigned long long found = query(wordSet, queries);
+            stopwatch.stop();
+
+            report(out, "load text into HASH PRODUCT", stopwatch.lastDuration(), found);
+
+            stopwatch.start();
+            std::ofstream snapshot{snapshotFilePath, std::ios::binary | std::ios::trunc};
+            wordSet.saveSnapshot(snapshot);
+            snapshot.close();
+            stopwatch.stop();
+
+            report(out, "save HASH PRODUCT snapshot", stopwatch.lastDuration(), 0);
+        }
+
+        {
+            stopwatch.start();
+            HashSet<std::string> wordSet{hashStringAsProduct};
+            std::ifstream snapshot{snapshotFilePath, std::ios::binary};
+            wordSet.loadSnapshot(snapshot);
+            unsigned long long found = query(wordSet, queries);
+            stopwatch.stop();
+
+            report(out, "load HASH PRODUCT snapshot", stopwatch.lastDuration(), found);
+        }
+
+        {
+            stopwatch.start();
+            WordSetLoader{}.compile(wordFilePath, compiledFilePath);
+            stopwatch.stop();
+
+            report(out, "compile", stopwatch.lastDuration(), 0);
+        }
+
+        for (bool verifyChecksum : {true, false})
+        {
+            stopwatch.start();
+            CompiledWordSet wordSet{compiledFilePath, verifyChecksum};
+            unsigned long long found = query(wordSet, queries);
+            stopwatch.stop();
+
+            report(
+                out, verifyChecksum ? "open compiled, verifying checksum" : "open compiled",
+                stopwatch.lastDuration(), found);
+        }
+
+        out << "  (" << fileSize(compiledFilePath) << " bytes compiled, "
+            << fileSize(snapshotFilePath) << " bytes as a snapshot)" << std::endl;
+    }
+}
+
+
+
+void runDictionaryStartupBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long syntheticWords = std::stoull(readParameter(in, "5000000"));
+    std::string syntheticWordFilePath = readParameter(in, "/tmp/spellcheck-words.txt");
+
+    out << "Preparing " << syntheticWords << " synthetic words in "
+        << syntheticWordFilePath << " ..." << std::endl;
+
+    ensureSyntheticWordSet(syntheticWordFilePath, syntheticWords);
+
+    out << std::endl
+        << "Each startup loads or opens the dictionary, then looks up "
+        << queriesFor(wordFilePath).size() << " words" << std::endl;
+
+    measure(out, wordFilePath, "/tmp/spellcheck-wordset.dict", "/tmp/spellcheck-wordset.snapshot");
+    measure(
+        out, syntheticWordFilePath, syntheticWordFilePath + ".dict",
+        syntheticWordFilePath + ".snapshot");
+}
@@ -0,0 +1,187 @@
+// LayeredLookupBenchmark.cpp
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+#include "LayeredSet.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const size_t batchSize = 1000;
+
+
+    std::vector<std::string> uppercaseWordsIn(const std::string& wordFilePath)
+    {
+        std::ifstream wordFile{wordFilePath};
+        std::vector<std::string> words;
+        std::string word;
+
+        while (std::getline(wordFile, word))
+        {
+            for (char& c : word)
+            {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+
+            words.push_back(word);
+        }
+
+        return words;
+    }
+
+
+    std::shared_ptr<Set<std::string>> overlayOf(const std::vector<std::string>& words)
+    {
+        std::shared_ptr<Set<std::string>> overlay =
+            std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+
+        for (const std::string& word : words)
+        {
+            overlay->add(word);
+        }
+
+        return overlay;
+    }
+
+
+    // Looks every query up one at a time, then in batches, the given number
+    // of times, reporting the nanoseconds per lookup each way.
+    void measure(
+        std::ostream& out, const std::string& name, const Set<std::string>& words,
+        const std::vector<std::string>& queries, unsigned int repetitions)
+    {
+        Stopwatch stopwatch;
+        unsigned long long found = 0;
+
+        stopwatch.start();
+
+        for (unsigned int r = 0; r < repetitions; ++r)
+        {
+            for (const std::string& query : queries)
+            {
+                found += words.contains(query);
+            }
+        }
+
+        stopwatch.stop();
+        double single = stopwatch.lastDuration();
+
+        std::vector<std::vector<std::string>> batches;
+
+        for (size_t start = 0; start < queries.size(); start += batchSize)
+        {
+            size_t end = std::min(start + batchSize, queries.size());
+            batches.emplace_back(queries.begin() + start, queries.begin() + end);
+        }
+
+        unsigned long long foundInBatches = 0;
+        stopwatch.start();
+
+        for (unsigned int r = 0; r < repetitions; ++r)
+        {
+            for (const std::vector<std::string>& batch : batches)
+            {
+                std::vector<bool> results = words.containsBatch(batch);
+                foundInBatches += std::count(results.begin(), results.end(), true);
+            }
+        }
+
+        stopwatch.stop();
+        double batched = stopwatch.lastDuration();
+
+        double lookups = static_cast<double>(queries.size()) * repetitions;
+
+        out << "  " << std::left << std::setw(28) << name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << single * 1000.0 / lookups << " ns"
+            << std::setw(10) << batched * 1000.0 / lookups << " ns"
+            << std::setw(10) << found / repetitions
+            << (found == foundInBatches ? "" : "  (batches found a different number!)")
+            << std::endl;
+    }
+}
+
+
+
+void runLayeredLookupBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned int overlaySize = std::stoul(readParameter(in, "200"));
+    unsigned int repetitions = std::stoul(readParameter(in, "20"));
+
+    std::vector<std::string> words = uppercaseWordsIn(wordFilePath);
+
+    std::shared_ptr<Set<std::string>> base =
+        std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+    WordSetLoader{}.load(wordFilePath, *base);
+
+    // The overlays hold made-up words, the way team and user word lists
+    // hold names and jargon the base dictionary doesn't.
+    std::vector<std::string> teamWords;
+    std::vector<std::string> userWords;
+
+    for (unsigned int i = 0; i < overlaySize; ++i)
+    {
+        teamWords.push_back(words[i * 7919 % words.size()] + "TEAM");
+        userWords.push_back(words[i * 104729 % words.size()] + "USER");
+    }
+
+    std::shared_ptr<Set<std::string>> team = overlayOf(teamWords);
+    std::shared_ptr<Set<std::string>> user = overlayOf(userWords);
+
+    HashSet<std::string> merged{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, merged);
+
+    for (const std::string& word : teamWords)
+    {
+        merged.add(word);
+    }
+
+    for (const std::string& word : userWords)
+    {
+        merged.add(word);
+    }
+
+    // Mostly words from the base dictionary, as in most text, with some
+    // from each overlay and some misspellings.
+    std::vector<std::string> queries;
+
+    for (size_t i = 0; i < words.size(); i += 2)
+    {
+        queries.push_back(words[i]);
+
+        if (i % 20 == 0)
+        {
+            queries.push_back(words[i] + "Q");
+        }
+
+        if (i % 40 == 0)
+        {
+            queries.push_back(teamWords[i / 40 % teamWords.size()]);
+            queries.push_back(userWords[i / 40 % userWords.size()]);
+        }
+    }
+
+    out << queries.size() << " queries against " << base->size() << " base words and two "
+        << "overlays of " << overlaySize << " words, " << repetitions << " times" << std::endl
+        << std::endl
+        << "  " << std::left << std::setw(28) << "" << std::right
+        << std::setw(13) << "contains()" << std::setw(13) << "batched"
+        << std::setw(10) << "found" << std::endl;
+
+    measure(out, "one merged set", merged, queries, repetitions);
+    measure(out, "base alone", *base, queries, repetitions);
+    measure(out, "layers: user, team, base", LayeredSet<std::string>{{user, team, base}}, queries, repetitions);
+    measure(out, "layers: base, team, user", LayeredSet<std::string>{{base, team, user}}, queries, repetitions);
+}
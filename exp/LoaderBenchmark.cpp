@@ -0,0 +1,121 @@
+// LoaderBenchmark.cpp
+
+#include <iomanip>
+#include <memory>
+#include <string>
+#include "Benchmarks.hpp"
+#include "BloomFilter.hpp"
+#include "EmptySet.hpp"
+#include "HashSet.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "ThreadPool.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+
+
+    // Loads the word set into the given set, on one thread or using a pool
+    // with the given number of threads, and returns how long it took.
+    double load(
+        const std::string& wordFilePath, Set<std::string>& wordSet, BloomFilter* filter,
+        unsigned int threads)
+    {
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        if (threads == 1)
+        {
+            if (filter != nullptr)
+            {
+                WordSetLoader{}.load(wordFilePath, wordSet, *filter);
+            }
+            else
+            {
+                WordSetLoader{}.load(wordFilePath, wordSet);
+            }
+        }
+        else
+        {
+            ThreadPool pool{threads - 1};
+
+            if (filter != nullptr)
+            {
+                WordSetLoader{}.load(wordFilePath, wordSet, *filter, pool);
+            }
+            else
+            {
+                WordSetLoader{}.load(wordFilePath, wordSet, pool);
+            }
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    void report(std::ostream& out, double usec, double baseline)
+    {
+        out << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << usec << " usec"
+            << std::setprecision(2) << std::setw(7) << (baseline / usec) << "x";
+    }
+}
+
+
+
+void runLoaderBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "/tmp/spellcheck-words.txt");
+    unsigned long long words = std::stoull(readParameter(in, "5000000"));
+
+    out << "Preparing " << words << " synthetic words in " << wordFilePath << " ..." << std::endl;
+
+    ensureSyntheticWordSet(wordFilePath, words);
+
+    out << std::endl
+        << std::left << std::setw(10) << "threads"
+        << std::right << std::setw(23) << "EMPTY" << std::setw(23) << "HASH PRODUCT"
+        << std::setw(23) << "HASH PRODUCT BLOOM" << std::endl;
+
+    double baselines[3] = { 0.0, 0.0, 0.0 };
+    unsigned int expectedSize = 0;
+
+    for (unsigned int threads : threadCounts)
+    {
+        EmptySet<std::string> emptySet;
+        double emptyDuration = load(wordFilePath, emptySet, nullptr, threads);
+
+        HashSet<std::string> hashSet{hashStringAsProduct};
+        double hashDuration = load(wordFilePath, hashSet, nullptr, threads);
+
+        HashSet<std::string> filteredSet{hashStringAsProduct};
+        BloomFilter filter;
+        double filteredDuration = load(wordFilePath, filteredSet, &filter, threads);
+
+        if (threads == 1)
+        {
+            baselines[0] = emptyDuration;
+            baselines[1] = hashDuration;
+            baselines[2] = filteredDuration;
+            expectedSize = hashSet.size();
+        }
+
+        out << std::left << std::setw(10) << threads;
+        report(out, emptyDuration, baselines[0]);
+        report(out, hashDuration, baselines[1]);
+        report(out, filteredDuration, baselines[2]);
+        out << std::endl;
+
+        if (hashSet.size() != expectedSize || filteredSet.size() != expectedSize)
+        {
+            out << "ERROR: loaded " << hashSet.size() << " and " << filteredSet.size()
+                << " words, rather than " << expectedSize << std::endl;
+        }
+    }
+}
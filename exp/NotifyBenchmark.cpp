@@ -0,0 +1,221 @@
+// NotifyBenchmark.cpp
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ics46/observable/Observable.hpp>
+#include "Benchmarks.hpp"
+#include "MappedTextFileReader.hpp"
+#include "MisspellingRecord.hpp"
+#include "OutputSpellCheckerListener.hpp"
+#include "SpellChecker.hpp"
+#include "SpellCheckerListener.hpp"
+#include "Stopwatch.hpp"
+#include "SyntheticText.hpp"
+
+
+
+namespace
+{
+    const unsigned int countingListenerCounts[] = { 1, 4 };
+
+    const size_t batchSizes[] = { SpellChecker::BATCH_SIZE, SpellChecker::PIPELINE_BATCH_SIZE };
+
+
+    // A listener that does as little as it can with each misspelling, so
+    // that the cost of telling it about them is what's measured.
+    class CountingListener : public SpellCheckerListener
+    {
+    public:
+        virtual void misspellingFound(
+            const std::string& word, const std::string& line,
+            const std::vector<std::string>& suggestions)
+        {
+            misspellingFoundInContext(WordContext{word, line}, suggestions);
+        }
+
+        virtual void misspellingFoundInContext(
+            const WordContext& context, const std::vector<std::string>& suggestions)
+        {
+            ++count;
+            checksum += context.word.size() + suggestions.size();
+        }
+
+        unsigned long long count = 0;
+        unsigned long long checksum = 0;
+    };
+
+
+    typedef ics46::observable::Observable<SpellCheckerListener> Notifier;
+
+
+    // Treats every word the reader reads as misspelled, as they'd be in a
+    // very dirty input.
+    std::vector<MisspellingRecord> misspellingsIn(WordReader& reader)
+    {
+        std::vector<MisspellingRecord> misspellings;
+
+        while (!reader.noMoreWords())
+        {
+            misspellings.push_back(MisspellingRecord{
+                std::string{reader.currentWordView()}, reader.currentWordContext(), {}, true});
+
+            reader.advanceToNextWord();
+        }
+
+        for (MisspellingRecord& misspelling : misspellings)
+        {
+            misspelling.context.word = misspelling.word;
+        }
+
+        return misspellings;
+    }
+
+
+    std::vector<std::vector<MisspellingRecord>> inBatches(
+        const std::vector<MisspellingRecord>& misspellings, size_t batchSize)
+    {
+        std::vector<std::vector<MisspellingRecord>> batches;
+
+        for (size_t first = 0; first < misspellings.size(); first += batchSize)
+        {
+            size_t last = std::min(first + batchSize, misspellings.size());
+            batches.emplace_back(misspellings.begin() + first, misspellings.begin() + last);
+
+            for (MisspellingRecord& misspelling : batches.back())
+            {
+                misspelling.context.word = misspelling.word;
+            }
+        }
+
+        return batches;
+    }
+
+
+    // Tells the notifier's observers about every misspelling one at a
+    // time, the way spell checkers used to, and returns the time taken.
+    double notifyOneAtATime(Notifier& notifier, const std::vector<MisspellingRecord>& misspellings)
+    {
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        for (const MisspellingRecord& misspelling : misspellings)
+        {
+            notifier.notifyEachObserver(
+                [&](auto listener)
+                {
+                    listener->misspellingFoundInContext(
+                        misspelling.context, misspelling.suggestions);
+                });
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    double notifyInBatches(
+        Notifier& notifier, const std::vector<std::vector<MisspellingRecord>>& batches)
+    {
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        for (const std::vector<MisspellingRecord>& batch : batches)
+        {
+            notifier.notifyEachObserver(
+                [&](auto listener)
+                {
+                    listener->misspellingsFound(batch);
+                });
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    void report(
+        std::ostream& out, const std::string& listeners, const std::string& how,
+        double usec, double oneAtATimeUsec, unsigned long long misspellings)
+    {
+        out << std::left << std::setw(16) << listeners << std::setw(20) << how
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(14) << usec
+            << std::setw(16) << misspellings / (usec / 1000000.0)
+            << std::setprecision(2) << std::setw(9) << oneAtATimeUsec / usec << "x"
+            << std::endl;
+    }
+
+
+    // Notifies the given listeners one misspelling at a time and then in
+    // batches of each size, reporting how long each takes.
+    void measure(
+        std::ostream& out, const std::string& listenerName,
+        const std::vector<std::shared_ptr<SpellCheckerListener>>& listeners,
+        const std::vector<MisspellingRecord>& misspellings)
+    {
+        Notifier notifier;
+
+        for (const std::shared_ptr<SpellCheckerListener>& listener : listeners)
+        {
+            notifier.addObserver(listener);
+        }
+
+        double oneAtATime = notifyOneAtATime(notifier, misspellings);
+        report(out, listenerName, "one at a time", oneAtATime, oneAtATime, misspellings.size());
+
+        for (size_t batchSize : batchSizes)
+        {
+            std::vector<std::vector<MisspellingRecord>> batches = inBatches(misspellings, batchSize);
+
+            double batched = notifyInBatches(notifier, batches);
+            report(
+                out, listenerName, "batches of " + std::to_string(batchSize),
+                batched, oneAtATime, misspellings.size());
+        }
+    }
+}
+
+
+
+void runNotifyBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "8"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-notify.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    // The reader is kept around, since the misspellings' contexts are
+    // views of its lines.
+    MappedTextFileReader reader{textFilePath};
+    std::vector<MisspellingRecord> misspellings = misspellingsIn(reader);
+
+    out << "Notifying listeners of " << misspellings.size()
+        << " misspellings, every word of the text" << std::endl << std::endl
+        << std::left << std::setw(16) << "listeners" << std::setw(20) << "how"
+        << std::right << std::setw(14) << "usec" << std::setw(16) << "misspellings/s"
+        << std::setw(10) << "speedup" << std::endl;
+
+    for (unsigned int listenerCount : countingListenerCounts)
+    {
+        std::vector<std::shared_ptr<SpellCheckerListener>> listeners;
+
+        for (unsigned int i = 0; i < listenerCount; ++i)
+        {
+            listeners.push_back(std::make_shared<CountingListener>());
+        }
+
+        measure(out, std::to_string(listenerCount) + " counting", listeners, misspellings);
+    }
+
+    std::ofstream nowhere{"/dev/null"};
+
+    measure(out, "1 output", {std::make_shared<OutputSpellCheckerListener>(nowhere)}, misspellings);
+}
@@ -0,0 +1,204 @@
+// ObserverBenchmark.cpp
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ics46/observable/Observable.hpp>
+#include "Benchmarks.hpp"
+#include "Stopwatch.hpp"
+
+
+
+namespace
+{
+    const unsigned int observerCounts[] = { 1, 4, 16 };
+
+
+    class CountingObserver
+    {
+    public:
+        virtual ~CountingObserver() = default;
+
+        virtual void eventHappened(unsigned long long event)
+        {
+            total += event;
+        }
+
+        unsigned long long total = 0;
+    };
+
+
+    // The way Observable used to notify its observers, for comparison:
+    // tidying up the whole list, then copying and locking each observer's
+    // weak pointer, on every event.
+    class OriginalObservable
+    {
+    public:
+        typedef std::function<void(std::shared_ptr<CountingObserver>)> NotifyFunction;
+
+        void addObserver(std::weak_ptr<CountingObserver> observerToAdd)
+        {
+            observers.push_back(observerToAdd);
+        }
+
+        void notifyObservers(NotifyFunction notifyFunction)
+        {
+            observers.erase(
+                std::remove_if(
+                    observers.begin(), observers.end(),
+                    [=](std::weak_ptr<CountingObserver> observer)
+                    {
+                        return observer.expired();
+                    }),
+                observers.end());
+
+            std::for_each(
+                observers.begin(), observers.end(),
+                [=](std::weak_ptr<CountingObserver> observer)
+                {
+                    if (!observer.expired())
+                    {
+                        notifyFunction(observer.lock());
+                    }
+                });
+        }
+
+    private:
+        std::vector<std::weak_ptr<CountingObserver>> observers;
+    };
+
+
+    typedef ics46::observable::Observable<CountingObserver> Subject;
+
+
+    // Calls notify() with each of the given number of events, and returns
+    // the time taken.
+    template <typename Notify>
+    double notifyEvents(unsigned long long events, Notify notify)
+    {
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        for (unsigned long long event = 0; event < events; ++event)
+        {
+            notify(event);
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    void report(
+        std::ostream& out, unsigned int observerCount, const std::string& how,
+        unsigned long long events, double usec, double originalUsec,
+        const std::vector<std::shared_ptr<CountingObserver>>& observers,
+        unsigned long long expectedTotal)
+    {
+        out << std::right << std::setw(10) << observerCount
+            << std::left << "  " << std::setw(28) << how
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(14) << usec
+            << std::setw(16) << events / (usec / 1000000.0)
+            << std::setprecision(2) << std::setw(9) << originalUsec / usec << "x";
+
+        for (const std::shared_ptr<CountingObserver>& observer : observers)
+        {
+            if (observer->total != expectedTotal)
+            {
+                out << "  ERROR: an observer missed events";
+                break;
+            }
+        }
+
+        out << std::endl;
+    }
+}
+
+
+
+void runObserverBenchmark(std::istream& in, std::ostream& out)
+{
+    unsigned long long events = std::stoull(readParameter(in, "10000000"));
+    unsigned long long expectedTotal = events * (events - 1) / 2;
+
+    out << "Notifying observers of " << events << " events" << std::endl << std::endl
+        << std::right << std::setw(10) << "observers"
+        << std::left << "  " << std::setw(28) << "how"
+        << std::right << std::setw(14) << "usec" << std::setw(16) << "events/s"
+        << std::setw(10) << "speedup" << std::endl;
+
+    for (unsigned int observerCount : observerCounts)
+    {
+        std::vector<std::shared_ptr<CountingObserver>> observers;
+
+        for (unsigned int i = 0; i < observerCount; ++i)
+        {
+            observers.push_back(std::make_shared<CountingObserver>());
+        }
+
+        auto resetTotals =
+            [&]()
+            {
+                for (const std::shared_ptr<CountingObserver>& observer : observers)
+                {
+                    observer->total = 0;
+                }
+            };
+
+        OriginalObservable original;
+        Subject subject;
+
+        for (const std::shared_ptr<CountingObserver>& observer : observers)
+        {
+            original.addObserver(observer);
+            subject.addObserver(observer);
+        }
+
+        auto notifyOriginal =
+            [&](unsigned long long event)
+            {
+                original.notifyObservers(
+                    [event](std::shared_ptr<CountingObserver> observer)
+                    {
+                        observer->eventHappened(event);
+                    });
+            };
+
+        auto notifySubject =
+            [&](unsigned long long event)
+            {
+                subject.notifyEachObserver(
+                    [event](CountingObserver* observer)
+                    {
+                        observer->eventHappened(event);
+                    });
+            };
+
+        double originalUsec = notifyEvents(events, notifyOriginal);
+        report(
+            out, observerCount, "original", events, originalUsec, originalUsec,
+            observers, expectedTotal);
+
+        resetTotals();
+        double lockingUsec = notifyEvents(events, notifySubject);
+        report(
+            out, observerCount, "locking each event", events, lockingUsec, originalUsec,
+            observers, expectedTotal);
+
+        resetTotals();
+        double heldUsec = 0.0;
+
+        {
+            Subject::Hold hold{subject};
+            heldUsec = notifyEvents(events, notifySubject);
+        }
+
+        report(
+            out, observerCount, "held (Observable::Hold)", events, heldUsec, originalUsec,
+            observers, expectedTotal);
+    }
+}
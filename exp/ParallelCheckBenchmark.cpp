@@ -0,0 +1,168 @@
+// ParallelCheckBenchmark.cpp
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+#include "MappedTextFileReader.hpp"
+#include "SpellChecker.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "ThreadPool.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+
+
+    // Folds every misspelling it's told about into a hash that depends on
+    // their order, so runs can be checked against one another cheaply.
+    class HashingListener : public SpellCheckerListener
+    {
+    public:
+        void misspellingFound(
+            const std::string& word, const std::string& line,
+            const std::vector<std::string>& suggestions) override
+        {
+            misspellingFoundInLine(word, line, suggestions);
+        }
+
+
+        void misspellingFoundInLine(
+            std::string_view word, std::string_view line,
+            const std::vector<std::string>& suggestions) override
+        {
+            add(word);
+            add(line);
+
+            for (const std::string& suggestion : suggestions)
+            {
+                add(suggestion);
+            }
+        }
+
+
+        unsigned long long hash = 14695981039346656037ull;
+
+
+    private:
+        void add(std::string_view s)
+        {
+            for (char c : s)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+
+            hash = (hash ^ 0xFF) * 1099511628211ull;
+        }
+    };
+
+
+    struct CheckResult
+    {
+        double duration;
+        unsigned long misspellings;
+        unsigned long long hash;
+    };
+
+
+    // Checks the text with a fresh WordChecker each time, so that no run
+    // benefits from suggestions cached by an earlier one.
+    CheckResult check(
+        const Set<std::string>& wordSet, const std::string& text,
+        ThreadPool* pool, size_t chunkSize)
+    {
+        SpellChecker spellChecker;
+        std::shared_ptr<HashingListener> listener = std::make_shared<HashingListener>();
+        spellChecker.addObserver(listener);
+
+        WordChecker wordChecker{wordSet};
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        if (pool != nullptr)
+        {
+            spellChecker.runParallel(wordChecker, text, *pool, chunkSize);
+        }
+        else
+        {
+            MappedTextFileReader reader{text.data(), text.data() + text.size()};
+            spellChecker.run(wordChecker, reader);
+        }
+
+        stopwatch.stop();
+
+        return CheckResult{stopwatch.lastDuration(), spellChecker.misspellingCount(), listener->hash};
+    }
+}
+
+
+
+void runParallelCheckBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    std::string textFilePath = readParameter(in, "biginput.txt");
+    unsigned int copies = std::stoul(readParameter(in, "1000"));
+    size_t chunkSize = std::stoul(
+        readParameter(in, std::to_string(SpellChecker::DEFAULT_CHUNK_SIZE)));
+
+    HashSet<std::string> wordSet{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, wordSet);
+
+    std::string text;
+
+    {
+        std::ifstream file{textFilePath, std::ios::binary};
+        std::ostringstream contents;
+        contents << file.rdbuf();
+
+        for (unsigned int i = 0; i < copies; ++i)
+        {
+            text += contents.str();
+        }
+    }
+
+    out << "Checking " << copies << " copies of " << textFilePath
+        << " (" << std::fixed << std::setprecision(1) << (text.size() / (1024.0 * 1024.0))
+        << "MB) in chunks of " << chunkSize << " bytes" << std::endl;
+    out << std::endl;
+
+    CheckResult serial = check(wordSet, text, nullptr, chunkSize);
+
+    out << std::left << std::setw(12) << "run()"
+        << std::right << std::fixed << std::setprecision(0)
+        << std::setw(14) << serial.duration << " usec"
+        << std::setw(12) << serial.misspellings << " misspellings" << std::endl;
+
+    double oneThreadDuration = 0.0;
+
+    for (unsigned int threads : threadCounts)
+    {
+        ThreadPool pool{threads - 1};
+        CheckResult parallel = check(wordSet, text, &pool, chunkSize);
+
+        if (threads == 1)
+        {
+            oneThreadDuration = parallel.duration;
+        }
+
+        out << std::left << std::setw(12) << (std::to_string(threads) + " thr")
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(14) << parallel.duration << " usec"
+            << std::setprecision(2)
+            << std::setw(12) << (oneThreadDuration / parallel.duration) << "x speedup"
+            << std::endl;
+
+        if (parallel.misspellings != serial.misspellings || parallel.hash != serial.hash)
+        {
+            out << "ERROR: " << threads << " threads reported different misspellings" << std::endl;
+        }
+    }
+}
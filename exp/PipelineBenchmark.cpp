@@ -0,0 +1,173 @@
+// PipelineBenchmark.cpp
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+#include "MappedTextFileReader.hpp"
+#include "OutputSpellCheckerListener.hpp"
+#include "SpellChecker.hpp"
+#include "Stopwatch.hpp"
+#include "StreamTextReader.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const unsigned int suggestingThreadCounts[] = { 1, 2, 4 };
+
+
+    // Checks the file with a new reader of the given kind, either with
+    // run() or, if given a number of suggesting threads, runPipelined(),
+    // writing the misspellings out the way the shell does, though to
+    // nowhere.  Returns the time taken, and stores the number of
+    // misspellings and the pipeline's statistics.
+    double check(
+        const WordChecker& wordChecker, const std::string& path, bool stream,
+        unsigned int suggestingThreads, unsigned long& misspellings,
+        std::vector<SpellChecker::PipelineStageStatistics>& stages)
+    {
+        std::ofstream nowhere{"/dev/null"};
+        SpellChecker spellChecker;
+        spellChecker.addObserver(std::make_shared<OutputSpellCheckerListener>(nowhere));
+
+        std::unique_ptr<WordReader> reader;
+
+        if (stream)
+        {
+            reader = std::make_unique<StreamTextReader>(path);
+        }
+        else
+        {
+            reader = std::make_unique<MappedTextFileReader>(path);
+        }
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        if (suggestingThreads > 0)
+        {
+            spellChecker.runPipelined(wordChecker, *reader, suggestingThreads);
+        }
+        else
+        {
+            spellChecker.run(wordChecker, *reader);
+        }
+
+        stopwatch.stop();
+
+        misspellings = spellChecker.misspellingCount();
+        stages = spellChecker.pipelineStatistics();
+        return stopwatch.lastDuration();
+    }
+
+
+    void report(
+        std::ostream& out, bool stream, const std::string& how, double usec, double sequentialUsec,
+        unsigned long misspellings, unsigned long expectedMisspellings)
+    {
+        out << std::left << std::setw(10) << (stream ? "stream" : "mapped")
+            << std::setw(24) << how
+            << std::right << std::fixed << std::setprecision(0) << std::setw(14) << usec
+            << std::setprecision(2) << std::setw(9) << sequentialUsec / usec << "x"
+            << std::setw(14) << misspellings;
+
+        if (misspellings != expectedMisspellings)
+        {
+            out << "  ERROR: expected " << expectedMisspellings;
+        }
+
+        out << std::endl;
+    }
+
+
+    void reportStages(
+        std::ostream& out, const std::vector<SpellChecker::PipelineStageStatistics>& stages)
+    {
+        out << std::right << std::setw(12) << "stage" << std::setw(9) << "threads"
+            << std::setw(12) << "batches" << std::setw(12) << "words" << std::setw(12) << "busy usec"
+            << std::setw(12) << "words/s" << std::setw(14) << "queue max/avg"
+            << std::setw(10) << "starved" << std::setw(10) << "blocked" << std::endl;
+
+        for (const SpellChecker::PipelineStageStatistics& stage : stages)
+        {
+            out << std::setw(12) << stage.name << std::setw(9) << stage.threads
+                << std::setw(12) << stage.batches
+                << std::setw(12) << stage.words
+                << std::fixed << std::setprecision(0) << std::setw(12) << stage.busyMicroseconds
+                << std::setw(12)
+                << (stage.busyMicroseconds > 0 ? stage.words / (stage.busyMicroseconds / 1000000.0) : 0.0)
+                << std::setw(8) << stage.maximumQueueDepth << "/"
+                << std::left << std::setprecision(1) << std::setw(5) << stage.averageQueueDepth
+                << std::right << std::setw(10) << stage.starved
+                << std::setw(10) << stage.blocked << std::endl;
+        }
+    }
+}
+
+
+
+void runPipelineBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "32"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-pipeline.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    HashSet<std::string> wordSet{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, wordSet);
+    WordChecker wordChecker{wordSet};
+
+    // Check once first, so that every timed run finds the same
+    // suggestions already cached and the file in the page cache.
+    unsigned long expectedMisspellings = 0;
+    std::vector<SpellChecker::PipelineStageStatistics> stages;
+    check(wordChecker, textFilePath, false, 0, expectedMisspellings, stages);
+
+    out << "Checking on " << std::thread::hardware_concurrency() << " hardware thread(s)"
+        << std::endl << std::endl
+        << std::left << std::setw(10) << "reader" << std::setw(24) << "how"
+        << std::right << std::setw(14) << "usec" << std::setw(10) << "speedup"
+        << std::setw(14) << "misspellings" << std::endl;
+
+    std::vector<SpellChecker::PipelineStageStatistics> singleSuggesterStages;
+
+    for (bool stream : {false, true})
+    {
+        unsigned long misspellings = 0;
+        double sequential = check(wordChecker, textFilePath, stream, 0, misspellings, stages);
+
+        report(out, stream, "run()", sequential, sequential, misspellings, expectedMisspellings);
+
+        for (unsigned int suggestingThreads : suggestingThreadCounts)
+        {
+            double duration = check(
+                wordChecker, textFilePath, stream, suggestingThreads, misspellings, stages);
+
+            if (!stream && suggestingThreads == 1)
+            {
+                singleSuggesterStages = stages;
+            }
+
+            report(
+                out, stream, "pipelined, " + std::to_string(suggestingThreads) + " suggesting",
+                duration, sequential, misspellings, expectedMisspellings);
+        }
+    }
+
+    out << std::endl << "Stages of the pipelined check of the mapped file, with one "
+        << "suggesting thread:" << std::endl;
+    reportStages(out, singleSuggesterStages);
+}
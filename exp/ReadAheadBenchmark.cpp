@@ -0,0 +1,141 @@
+// ReadAheadBenchmark.cpp
+
+#include <fcntl.h>
+#include <iomanip>
+#include <string>
+#include <unistd.h>
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+#include "ReadAheadFile.hpp"
+#include "SpellChecker.hpp"
+#include "Stopwatch.hpp"
+#include "StreamTextReader.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const size_t blockSizes[] = { 0, 64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024 };
+
+
+    // Asks the kernel to drop the file's pages from the page cache, so
+    // that the next read of it has to go to the disk.  This has no effect
+    // on file systems kept in memory, such as tmpfs.
+    bool evictFromPageCache(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        bool evicted = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        ::close(fd);
+        return evicted;
+    }
+
+
+    double readOnly(const std::string& path)
+    {
+        ReadAheadFile file{path, ReadAheadFile::DEFAULT_BLOCK_SIZE};
+        std::string chunk(ReadAheadFile::DEFAULT_BLOCK_SIZE, '\0');
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        while (file.read(chunk.data(), chunk.size()) > 0)
+        {
+        }
+
+        stopwatch.stop();
+        return stopwatch.lastDuration();
+    }
+
+
+    // Checks the file, returning the time taken and storing the time spent
+    // waiting for blocks read ahead in waiting.
+    double check(
+        const WordChecker& wordChecker, const std::string& path, size_t blockSize,
+        double& waiting)
+    {
+        SpellChecker spellChecker;
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        StreamTextReader reader{path, StreamTextReader::DEFAULT_BUFFER_SIZE, blockSize};
+        spellChecker.run(wordChecker, reader);
+
+        stopwatch.stop();
+        waiting = reader.readAheadWaitTime().count() / 1000.0;
+        return stopwatch.lastDuration();
+    }
+
+
+    void report(std::ostream& out, const std::string& name, double usec, double waiting)
+    {
+        out << std::left << std::setw(24) << name
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(14) << usec << " usec";
+
+        if (waiting >= 0.0)
+        {
+            out << std::setw(14) << waiting << " usec waiting";
+        }
+
+        out << std::endl;
+    }
+}
+
+
+
+void runReadAheadBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "32"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-readahead.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    HashSet<std::string> wordSet{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, wordSet);
+    WordChecker wordChecker{wordSet};
+
+    // Check once with a warm cache first, so that every timed run finds
+    // the same suggestions already cached, and so that there's a figure
+    // for how long checking takes when there's nothing to wait for.
+    double waiting = 0.0;
+    check(wordChecker, textFilePath, 0, waiting);
+    double computeOnly = check(wordChecker, textFilePath, 0, waiting);
+
+    if (!evictFromPageCache(textFilePath))
+    {
+        out << "WARNING: could not evict " << textFilePath << " from the page cache" << std::endl;
+    }
+
+    double ioOnly = readOnly(textFilePath);
+
+    out << std::endl;
+    report(out, "read only (cold)", ioOnly, -1.0);
+    report(out, "check only (warm)", computeOnly, -1.0);
+    out << std::endl;
+
+    for (size_t blockSize : blockSizes)
+    {
+        evictFromPageCache(textFilePath);
+        double duration = check(wordChecker, textFilePath, blockSize, waiting);
+
+        std::string name = blockSize == 0
+            ? "direct reads (cold)"
+            : "read ahead " + std::to_string(blockSize / 1024) + "KB (cold)";
+
+        report(out, name, duration, blockSize == 0 ? -1.0 : waiting);
+    }
+}
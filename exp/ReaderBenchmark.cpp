@@ -0,0 +1,105 @@
+// ReaderBenchmark.cpp
+
+#include <iomanip>
+#include <string>
+#include "Benchmarks.hpp"
+#include "MappedTextFileReader.hpp"
+#include "Stopwatch.hpp"
+#include "SyntheticText.hpp"
+#include "TextFileReader.hpp"
+#include "WindowedTextReader.hpp"
+#include "WordReader.hpp"
+
+
+
+namespace
+{
+    // Reads every word, touching each one so the work can't be skipped,
+    // and returns the number of words read.
+    unsigned long long readAllWords(WordReader& reader, unsigned long long& checksum)
+    {
+        unsigned long long count = 0;
+
+        while (!reader.noMoreWords())
+        {
+            std::string_view word = reader.currentWordView();
+            checksum += word.size() + static_cast<unsigned char>(word[0]);
+            checksum += reader.currentLineView().size();
+            checksum += reader.currentWordContext().offset;
+            ++count;
+            reader.advanceToNextWord();
+        }
+
+        return count;
+    }
+
+
+    void report(
+        std::ostream& out, const std::string& name, unsigned long long words,
+        unsigned long long bytes, double usec)
+    {
+        double seconds = usec / 1000000.0;
+
+        out << std::left << std::setw(24) << name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << (words / seconds / 1000000.0) << " Mwords/s"
+            << std::setw(12) << (bytes / seconds / (1024.0 * 1024.0)) << " MB/s"
+            << std::endl;
+    }
+}
+
+
+
+void runReaderBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "2048"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-synthetic.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    unsigned long long bytes =
+        ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    Stopwatch stopwatch;
+    unsigned long long checksum = 0;
+    unsigned long long words = 0;
+
+    {
+        stopwatch.start();
+        TextFileReader reader{textFilePath};
+        words = readAllWords(reader, checksum);
+        stopwatch.stop();
+    }
+
+    report(out, "TextFileReader", words, bytes, stopwatch.lastDuration());
+
+    unsigned long long mappedWords = 0;
+
+    {
+        stopwatch.start();
+        MappedTextFileReader reader{textFilePath};
+        mappedWords = readAllWords(reader, checksum);
+        stopwatch.stop();
+    }
+
+    report(out, "MappedTextFileReader", mappedWords, bytes, stopwatch.lastDuration());
+
+    unsigned long long windowedWords = 0;
+
+    {
+        stopwatch.start();
+        WindowedTextReader reader{textFilePath};
+        windowedWords = readAllWords(reader, checksum);
+        stopwatch.stop();
+    }
+
+    report(out, "WindowedTextReader", windowedWords, bytes, stopwatch.lastDuration());
+
+    if (words != mappedWords || words != windowedWords)
+    {
+        out << "ERROR: readers disagree on the number of words ("
+            << words << " vs. " << mappedWords << " vs. " << windowedWords << ")" << std::endl;
+    }
+}
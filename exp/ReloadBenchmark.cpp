@@ -0,0 +1,203 @@
+// ReloadBenchmark.cpp
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "Dictionary.hpp"
+#include "HashSet.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const size_t batchSize = 1000;
+
+
+    std::shared_ptr<const Dictionary> build(const std::string& wordFilePath)
+    {
+        std::unique_ptr<Set<std::string>> words =
+            std::make_unique<HashSet<std::string>>(hashStringAsProduct);
+        WordSetLoader{}.load(wordFilePath, *words);
+
+        return std::make_shared<Dictionary>(std::move(words));
+    }
+
+
+    // Some words that are in the dictionary and some that aren't.
+    std::vector<std::string> queriesFor(const std::string& wordFilePath)
+    {
+        std::ifstream wordFile{wordFilePath};
+        std::vector<std::string> queries;
+        std::string word;
+
+        while (queries.size() < 100 * batchSize && std::getline(wordFile, word))
+        {
+            std::string uppercase;
+
+            for (char c : word)
+            {
+                uppercase += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+
+            queries.push_back(uppercase);
+            queries.push_back(uppercase + "Q");
+        }
+
+        return queries;
+    }
+
+
+    struct CheckResult
+    {
+        unsigned long long words = 0;
+        double slowestBatch = 0.0;
+    };
+
+
+    // Checks batches of the queries on each of the given number of threads
+    // until told to stop, each batch with a WordChecker holding whichever
+    // version of the dictionary was current when the batch started, the
+    // way a long-running checker would handle each request.
+    std::vector<CheckResult> checkUntil(
+        const DictionaryHandle& handle, const std::vector<std::string>& queries,
+        unsigned int threads, const std::atomic<bool>& stop)
+    {
+        std::vector<CheckResult> results(threads);
+        std::vector<std::thread> checkers;
+
+        for (unsigned int t = 0; t < threads; ++t)
+        {
+            checkers.emplace_back(
+                [&, t]()
+                {
+                    CheckResult& result = results[t];
+                    size_t start = t * batchSize % queries.size();
+
+                    while (!stop)
+                    {
+                        Stopwatch stopwatch;
+                        stopwatch.start();
+
+                        WordChecker checker{handle.current()};
+                        size_t end = std::min(start + batchSize, queries.size());
+                        std::vector<std::string> batch{queries.begin() + start, queries.begin() + end};
+                        checker.wordsExist(batch);
+
+                        stopwatch.stop();
+
+                        result.words += batch.size();
+                        result.slowestBatch = std::max(result.slowestBatch, stopwatch.lastDuration());
+                        start = end < queries.size() ? end : 0;
+                    }
+                });
+        }
+
+        for (std::thread& checker : checkers)
+        {
+            checker.join();
+        }
+
+        return results;
+    }
+
+
+    void report(
+        std::ostream& out, const std::string& name, double usec,
+        const std::vector<CheckResult>& results, unsigned int reloads)
+    {
+        unsigned long long words = 0;
+        double slowestBatch = 0.0;
+
+        for (const CheckResult& result : results)
+        {
+            words += result.words;
+            slowestBatch = std::max(slowestBatch, result.slowestBatch);
+        }
+
+        out << "  " << std::left << std::setw(24) << name
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << words / (usec / 1000000.0) << " words/sec"
+            << std::setw(10) << slowestBatch << " usec slowest batch"
+            << std::setw(6) << reloads << " reloads" << std::endl;
+    }
+}
+
+
+
+void runReloadBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "/tmp/spellcheck-reload-words.txt");
+    unsigned long long syntheticWords = std::stoull(readParameter(in, "1000000"));
+    unsigned int threads = std::stoul(readParameter(in, "1"));
+    double seconds = std::stod(readParameter(in, "5"));
+
+    out << "Preparing " << syntheticWords << " synthetic words in "
+        << wordFilePath << " ..." << std::endl;
+
+    ensureSyntheticWordSet(wordFilePath, syntheticWords);
+
+    std::vector<std::string> queries = queriesFor(wordFilePath);
+    Stopwatch stopwatch;
+
+    stopwatch.start();
+    DictionaryHandle handle{build(wordFilePath)};
+    stopwatch.stop();
+
+    out << std::endl
+        << "Building the dictionary takes " << std::fixed << std::setprecision(0)
+        << stopwatch.lastDuration() << " usec; checking batches of " << batchSize
+        << " words on " << threads << " thread(s) for " << seconds << " sec, with "
+        << std::thread::hardware_concurrency() << " hardware thread(s)" << std::endl;
+
+    for (bool reloading : {false, true})
+    {
+        std::atomic<bool> stop{false};
+        unsigned long versionBefore = handle.version();
+
+        // While reloading, a new version of the dictionary is built as soon
+        // as the last one has been swapped in.
+        std::thread timer{
+            [&]()
+            {
+                auto deadline = std::chrono::steady_clock::now()
+                    + std::chrono::microseconds{static_cast<long long>(seconds * 1000000.0)};
+
+                while (std::chrono::steady_clock::now() < deadline)
+                {
+                    if (reloading)
+                    {
+                        handle.reloadInBackground([&]() { return build(wordFilePath); });
+                        handle.waitForReload();
+                    }
+                    else
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+                    }
+                }
+
+                stop = true;
+            }};
+
+        stopwatch.start();
+        std::vector<CheckResult> results = checkUntil(handle, queries, threads, stop);
+        stopwatch.stop();
+        timer.join();
+
+        report(
+            out, reloading ? "during reloads" : "steady", stopwatch.lastDuration(), results,
+            handle.version() - versionBefore);
+    }
+}
@@ -0,0 +1,229 @@
+// ServerBenchmark.cpp
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "Dictionary.hpp"
+#include "HashSet.hpp"
+#include "MappedFile.hpp"
+#include "SpellCheckClient.hpp"
+#include "SpellCheckServer.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const unsigned int concurrencies[] = { 1, 2, 4, 8, 16 };
+
+    const std::string socketPath = "/tmp/spellcheck-server-benchmark.sock";
+
+    const size_t wordsPerRequest = 20;
+
+
+    // Splits the text into documents of about the given size, each ending
+    // at the end of a line.
+    std::vector<std::string_view> documentsIn(std::string_view text, size_t documentSize)
+    {
+        std::vector<std::string_view> documents;
+        size_t start = 0;
+
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', std::min(start + documentSize, text.size()));
+            end = end == std::string_view::npos ? text.size() : end + 1;
+
+            documents.push_back(text.substr(start, end - start));
+            start = end;
+        }
+
+        return documents;
+    }
+
+
+    // Requests to check words are made of the words of a document, some of
+    // which are misspelled.
+    std::vector<std::string> wordsIn(std::string_view document)
+    {
+        std::vector<std::string> words;
+        std::string word;
+
+        for (char c : document)
+        {
+            if (std::isalpha(static_cast<unsigned char>(c)))
+            {
+                word += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            else if (!word.empty())
+            {
+                words.push_back(word);
+                word.clear();
+
+                if (words.size() == wordsPerRequest)
+                {
+                    break;
+                }
+            }
+        }
+
+        return words;
+    }
+
+
+    double percentile(std::vector<double>& latencies, double fraction)
+    {
+        size_t index = std::min(
+            latencies.size() - 1, static_cast<size_t>(fraction * latencies.size()));
+
+        std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+        return latencies[index];
+    }
+
+
+    // Has each of the given number of clients, on threads of their own, make
+    // the given number of requests one after another, then reports how many
+    // requests were served per second, the median and 99th percentile time
+    // a request took, and how many requests the server served per batch.
+    void measure(
+        std::ostream& out, const std::string& kind, SpellCheckServer& server,
+        const std::vector<std::string_view>& documents, unsigned int clientCount,
+        unsigned int requestsPerClient)
+    {
+        std::vector<std::vector<double>> latencies(clientCount);
+        std::vector<std::thread> clients;
+
+        unsigned long requestsBefore = server.requestCount();
+        unsigned long batchesBefore = server.batchCount();
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        for (unsigned int c = 0; c < clientCount; ++c)
+        {
+            clients.emplace_back(
+                [&, c]()
+                {
+                    SpellCheckClient client{socketPath};
+                    std::string misspellings;
+                    std::vector<bool> exists;
+
+                    for (unsigned int i = 0; i < requestsPerClient; ++i)
+                    {
+                        std::string_view document = documents[(c * 7919 + i) % documents.size()];
+                        std::vector<std::string> words;
+
+                        if (kind == "words")
+                        {
+                            words = wordsIn(document);
+                        }
+
+                        auto start = std::chrono::steady_clock::now();
+
+                        if (kind == "words")
+                        {
+                            client.checkWords(words, exists);
+                        }
+                        else
+                        {
+                            client.checkText(document, misspellings);
+                        }
+
+                        auto finish = std::chrono::steady_clock::now();
+
+                        latencies[c].push_back(
+                            std::chrono::duration<double, std::micro>(finish - start).count());
+                    }
+                });
+        }
+
+        for (std::thread& client : clients)
+        {
+            client.join();
+        }
+
+        stopwatch.stop();
+
+        std::vector<double> all;
+
+        for (const std::vector<double>& clientLatencies : latencies)
+        {
+            all.insert(all.end(), clientLatencies.begin(), clientLatencies.end());
+        }
+
+        unsigned long requests = server.requestCount() - requestsBefore;
+        unsigned long batches = server.batchCount() - batchesBefore;
+
+        out << std::right << std::setw(8) << clientCount
+            << std::setw(8) << kind
+            << std::fixed << std::setprecision(0)
+            << std::setw(12) << all.size() / (stopwatch.lastDuration() / 1000000.0)
+            << std::setw(12) << percentile(all, 0.5)
+            << std::setw(12) << percentile(all, 0.99)
+            << std::setprecision(2)
+            << std::setw(12) << (batches > 0 ? static_cast<double>(requests) / batches : 0.0)
+            << std::endl;
+    }
+}
+
+
+
+void runServerBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    std::string textFilePath = readParameter(in, "biginput.txt");
+    size_t documentSize = std::stoul(readParameter(in, "2000"));
+    unsigned int requestsPerClient = std::stoul(readParameter(in, "500"));
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    std::unique_ptr<Set<std::string>> wordSet =
+        std::make_unique<HashSet<std::string>>(hashStringAsProduct);
+    WordSetLoader{}.load(wordFilePath, *wordSet);
+    DictionaryHandle dictionary{std::make_shared<Dictionary>(std::move(wordSet))};
+
+    stopwatch.stop();
+
+    MappedFile text{textFilePath};
+    std::vector<std::string_view> documents = documentsIn(text.text(), documentSize);
+
+    out << "Loading the dictionary, as every run of the shell does, takes "
+        << std::fixed << std::setprecision(0) << stopwatch.lastDuration() << " usec" << std::endl
+        << "Each client makes " << requestsPerClient << " requests, each either a document of "
+        << "about " << documentSize << " bytes or " << wordsPerRequest << " words, on "
+        << std::thread::hardware_concurrency() << " hardware thread(s)" << std::endl
+        << std::endl
+        << std::right << std::setw(8) << "clients" << std::setw(8) << "kind"
+        << std::setw(12) << "requests/s" << std::setw(12) << "p50 usec"
+        << std::setw(12) << "p99 usec" << std::setw(12) << "per batch" << std::endl;
+
+    SpellCheckServer server{dictionary, socketPath};
+
+    if (!server.isListening())
+    {
+        out << "ERROR: Cannot listen on socket: " << socketPath << std::endl;
+        return;
+    }
+
+    std::thread serverThread{[&]() { server.run(); }};
+
+    for (const std::string kind : {"text", "words"})
+    {
+        for (unsigned int clientCount : concurrencies)
+        {
+            measure(out, kind, server, documents, clientCount, requestsPerClient);
+        }
+    }
+
+    server.stop();
+    serverThread.join();
+}
@@ -0,0 +1,262 @@
+// SharedDictionaryBenchmark.cpp
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Benchmarks.hpp"
+#include "CompiledWordSet.hpp"
+#include "EmptySet.hpp"
+#include "HashSet.hpp"
+#include "StringHashing.hpp"
+#include "SyntheticText.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const std::string sharedMemoryName = "/spellcheck-shared-benchmark";
+
+
+    // A worker's report, sent to the benchmark once it's ready: how many of
+    // the words it found, and how long it took to get its dictionary ready
+    // and look all of them up.
+    struct WorkerReport
+    {
+        unsigned long long found;
+        double usec;
+    };
+
+
+    // Looks up every word in the word file, one line at a time, so that
+    // every page of the dictionary is touched, without the lookups holding
+    // more than a line of the file in memory.
+    unsigned long long lookUpEveryWord(const Set<std::string>& wordSet, const std::string& wordFilePath)
+    {
+        std::ifstream wordFile{wordFilePath};
+        std::string word;
+        unsigned long long found = 0;
+
+        while (std::getline(wordFile, word))
+        {
+            for (char& c : word)
+            {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+
+            found += wordSet.contains(word) ? 1 : 0;
+        }
+
+        return found;
+    }
+
+
+    // Reads a field, in kB, from one of a process's files in /proc, such
+    // as VmRSS from status or Pss from smaps_rollup.
+    unsigned long long procField(pid_t pid, const std::string& file, const std::string& field)
+    {
+        std::ifstream in{"/proc/" + std::to_string(pid) + "/" + file};
+        std::string line;
+
+        while (std::getline(in, line))
+        {
+            if (line.compare(0, field.size() + 1, field + ":") == 0)
+            {
+                std::istringstream value{line.substr(field.size() + 1)};
+                unsigned long long kilobytes = 0;
+                value >> kilobytes;
+                return kilobytes;
+            }
+        }
+
+        return 0;
+    }
+
+
+    // Runs the given function in a child process, waiting for it to
+    // finish, so that whatever it allocates is gone afterward rather than
+    // inherited by workers forked later.
+    bool runInChild(const std::function<bool()>& f)
+    {
+        pid_t child = fork();
+
+        if (child == 0)
+        {
+            _exit(f() ? 0 : 1);
+        }
+
+        int status;
+        return child > 0 && waitpid(child, &status, 0) == child
+            && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+
+    // Forks the given number of workers, each of which makes a set with the
+    // given function and looks up every word in it, then waits until it's
+    // told to finish.  Once all of them are ready, reports the total of
+    // their resident set sizes, which counts pages they share once in each
+    // of them, and of their proportional set sizes, which divides each
+    // shared page among the processes sharing it.
+    void measure(
+        std::ostream& out, const std::string& name, unsigned int workerCount,
+        const std::string& wordFilePath,
+        const std::function<std::unique_ptr<Set<std::string>>()>& makeSet)
+    {
+        int ready[2];
+        int finish[2];
+
+        if (pipe(ready) != 0 || pipe(finish) != 0)
+        {
+            out << "ERROR: Cannot create pipes" << std::endl;
+            return;
+        }
+
+        std::vector<pid_t> workers;
+        out.flush();
+
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            pid_t worker = fork();
+
+            if (worker == 0)
+            {
+                close(ready[0]);
+                close(finish[1]);
+
+                auto start = std::chrono::steady_clock::now();
+                std::unique_ptr<Set<std::string>> wordSet = makeSet();
+                unsigned long long found = lookUpEveryWord(*wordSet, wordFilePath);
+                auto end = std::chrono::steady_clock::now();
+
+                WorkerReport report{
+                    found, std::chrono::duration<double, std::micro>(end - start).count()};
+                [[maybe_unused]] ssize_t written = write(ready[1], &report, sizeof(report));
+
+                // The benchmark closes its end of the pipe when it's done
+                // measuring, which ends this read.
+                char c;
+                [[maybe_unused]] ssize_t received = read(finish[0], &c, 1);
+                _exit(0);
+            }
+            else if (worker > 0)
+            {
+                workers.push_back(worker);
+            }
+        }
+
+        close(ready[1]);
+        close(finish[0]);
+
+        unsigned long long found = 0;
+        double slowest = 0.0;
+        WorkerReport report;
+
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            if (read(ready[0], &report, sizeof(report)) == sizeof(report))
+            {
+                found += report.found;
+                slowest = std::max(slowest, report.usec);
+            }
+        }
+
+        unsigned long long rss = 0;
+        unsigned long long pss = 0;
+
+        for (pid_t worker : workers)
+        {
+            rss += procField(worker, "status", "VmRSS");
+            pss += procField(worker, "smaps_rollup", "Pss");
+        }
+
+        close(finish[1]);
+        close(ready[0]);
+
+        for (pid_t worker : workers)
+        {
+            waitpid(worker, nullptr, 0);
+        }
+
+        out << "  " << std::left << std::setw(32) << name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << rss / 1024.0
+            << std::setw(12) << pss / 1024.0
+            << std::setprecision(0)
+            << std::setw(14) << slowest
+            << std::setw(12) << (workers.empty() ? 0 : found / workers.size())
+            << std::endl;
+    }
+}
+
+
+
+void runSharedDictionaryBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "/tmp/spellcheck-shared-words.txt");
+    unsigned long long words = std::stoull(readParameter(in, "1000000"));
+    unsigned int workerCount = std::stoul(readParameter(in, "16"));
+
+    out << "Preparing " << words << " synthetic words in " << wordFilePath << " ..." << std::endl;
+    ensureSyntheticWordSet(wordFilePath, words);
+
+    // The dictionary is published by a process of its own, which finishes
+    // before any workers start, the way it would be in production.
+    out.flush();
+
+    if (!runInChild([&]() { return WordSetLoader{}.compileShared(wordFilePath, sharedMemoryName); }))
+    {
+        out << "ERROR: Cannot publish " << wordFilePath << " as " << sharedMemoryName << std::endl;
+        return;
+    }
+
+    unsigned long long sharedSize = 0;
+
+    {
+        std::ifstream segment{"/dev/shm" + sharedMemoryName, std::ios::binary | std::ios::ate};
+        sharedSize = segment ? static_cast<unsigned long long>(segment.tellg()) : 0;
+    }
+
+    out << "Published as " << sharedMemoryName << " (" << sharedSize << " bytes, held once "
+        << "however many workers open it)" << std::endl
+        << std::endl
+        << "Each of " << workerCount << " workers makes its dictionary ready and looks up "
+        << "every word, then the total memory of all of them is measured" << std::endl
+        << std::endl
+        << "  " << std::left << std::setw(32) << "dictionary"
+        << std::right << std::setw(12) << "RSS MB" << std::setw(12) << "PSS MB"
+        << std::setw(14) << "slowest usec" << std::setw(12) << "found" << std::endl;
+
+    measure(
+        out, "EMPTY (no dictionary)", workerCount, wordFilePath,
+        []() { return std::make_unique<EmptySet<std::string>>(); });
+
+    measure(
+        out, "HASH PRODUCT (a copy each)", workerCount, wordFilePath,
+        [&]()
+        {
+            std::unique_ptr<Set<std::string>> wordSet =
+                std::make_unique<HashSet<std::string>>(hashStringAsProduct);
+            WordSetLoader{}.load(wordFilePath, *wordSet);
+            return wordSet;
+        });
+
+    measure(
+        out, "SHARED (one copy for all)", workerCount, wordFilePath,
+        []()
+        {
+            std::unique_ptr<CompiledWordSet> wordSet = std::make_unique<CompiledWordSet>();
+            wordSet->openShared(sharedMemoryName);
+            return std::unique_ptr<Set<std::string>>{std::move(wordSet)};
+        });
+
+    CompiledWordSet::removeShared(sharedMemoryName);
+}
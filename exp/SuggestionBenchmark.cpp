@@ -0,0 +1,123 @@
+// SuggestionBenchmark.cpp
+
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "HashSet.hpp"
+#include "Stopwatch.hpp"
+#include "StringHashing.hpp"
+#include "ThreadPool.hpp"
+#include "WordChecker.hpp"
+#include "WordSetLoader.hpp"
+
+
+
+namespace
+{
+    const unsigned int wordsPerLength = 200;
+    const size_t wordLengths[] = { 4, 8, 12, 16, 24, 32, 48 };
+    const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+
+
+    std::vector<std::string> makeRandomWords(size_t length, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> letter{'A', 'Z'};
+        std::vector<std::string> words;
+
+        for (unsigned int i = 0; i < wordsPerLength; ++i)
+        {
+            std::string word;
+
+            for (size_t j = 0; j < length; ++j)
+            {
+                word.push_back(static_cast<char>(letter(random)));
+            }
+
+            words.push_back(word);
+        }
+
+        return words;
+    }
+}
+
+
+
+void runSuggestionBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+
+    HashSet<std::string> wordSet{hashStringAsProduct};
+    WordSetLoader{}.load(wordFilePath, wordSet);
+
+    std::mt19937 random{46};
+    Stopwatch stopwatch;
+
+    out << "Finding suggestions for " << wordsPerLength
+        << " random words of each length (usec per word)" << std::endl;
+    out << std::endl;
+    out << std::left << std::setw(8) << "Length";
+
+    for (unsigned int threads : threadCounts)
+    {
+        out << std::right << std::setw(12) << (std::to_string(threads) + " thr");
+    }
+
+    out << std::right << std::setw(12) << "Speedup" << std::endl;
+
+    for (size_t length : wordLengths)
+    {
+        std::vector<std::string> words = makeRandomWords(length, random);
+        std::vector<std::vector<std::string>> serialSuggestions;
+        double serialDuration = 0.0;
+        double bestDuration = 0.0;
+
+        out << std::left << std::setw(8) << length;
+
+        for (unsigned int threads : threadCounts)
+        {
+            ThreadPool pool{threads - 1};
+            WordChecker wordChecker{wordSet};
+            wordChecker.setSuggestionCacheBounds(0, 0);
+
+            if (threads > 1)
+            {
+                wordChecker.setThreadPool(pool, 0);
+            }
+
+            std::vector<std::vector<std::string>> suggestions;
+
+            stopwatch.start();
+
+            for (const std::string& word : words)
+            {
+                suggestions.push_back(wordChecker.findSuggestions(word));
+            }
+
+            stopwatch.stop();
+
+            double duration = stopwatch.lastDuration() / words.size();
+
+            if (threads == 1)
+            {
+                serialSuggestions = suggestions;
+                serialDuration = duration;
+                bestDuration = duration;
+            }
+            else if (suggestions != serialSuggestions)
+            {
+                out << std::endl << "ERROR: suggestions differ with " << threads
+                    << " threads" << std::endl;
+                return;
+            }
+
+            bestDuration = std::min(bestDuration, duration);
+
+            out << std::right << std::fixed << std::setprecision(1) << std::setw(12) << duration;
+        }
+
+        out << std::right << std::fixed << std::setprecision(2) << std::setw(11)
+            << (bestDuration > 0.0 ? serialDuration / bestDuration : 0.0) << "x" << std::endl;
+    }
+}
@@ -0,0 +1,139 @@
+// SyntheticText.cpp
+
+#include <fstream>
+#include <random>
+#include <vector>
+#include "SyntheticText.hpp"
+
+
+
+namespace
+{
+    std::vector<std::string> readWords(const std::string& wordFilePath)
+    {
+        std::ifstream wordFile{wordFilePath};
+        std::vector<std::string> words;
+        std::string word;
+
+        while (std::getline(wordFile, word))
+        {
+            if (!word.empty() && word.back() == '\r')
+            {
+                word.pop_back();
+            }
+
+            if (!word.empty())
+            {
+                words.push_back(word);
+            }
+        }
+
+        if (words.empty())
+        {
+            words.push_back("lorem");
+        }
+
+        return words;
+    }
+
+
+    unsigned long long fileSize(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        return file ? static_cast<unsigned long long>(file.tellg()) : 0;
+    }
+}
+
+
+
+unsigned long long ensureSyntheticText(
+    const std::string& wordFilePath, const std::string& textFilePath,
+    unsigned long long bytes)
+{
+    unsigned long long existing = fileSize(textFilePath);
+
+    if (existing >= bytes)
+    {
+        return existing;
+    }
+
+    std::vector<std::string> words = readWords(wordFilePath);
+    std::mt19937 random{46};
+    std::uniform_int_distribution<size_t> pickWord{0, words.size() - 1};
+    std::uniform_int_distribution<int> percent{0, 99};
+    std::uniform_int_distribution<int> letter{'a', 'z'};
+    const char punctuation[] = ",.;:!?\"()";
+
+    std::ofstream textFile{textFilePath, std::ios::binary | std::ios::trunc};
+    std::string line;
+    unsigned long long written = 0;
+
+    while (written < bytes)
+    {
+        std::string word = words[pickWord(random)];
+
+        // About one word in twenty is misspelled.
+        if (percent(random) < 5)
+        {
+            word[word.size() / 2] = static_cast<char>(letter(random));
+        }
+
+        if (!line.empty())
+        {
+            line.push_back(' ');
+        }
+
+        line += word;
+
+        if (percent(random) < 10)
+        {
+            line.push_back(punctuation[percent(random) % (sizeof(punctuation) - 1)]);
+        }
+
+        if (line.size() >= 72)
+        {
+            line.push_back('\n');
+            textFile << line;
+            written += line.size();
+            line.clear();
+        }
+    }
+
+    return written;
+}
+
+
+void ensureSyntheticWordSet(const std::string& wordFilePath, unsigned long long words)
+{
+    std::ifstream existing{wordFilePath};
+    unsigned long long lines = 0;
+    std::string line;
+
+    while (lines < words && std::getline(existing, line))
+    {
+        ++lines;
+    }
+
+    if (lines >= words)
+    {
+        return;
+    }
+
+    std::mt19937 random{46};
+    std::uniform_int_distribution<int> length{3, 12};
+    std::uniform_int_distribution<int> letter{'a', 'z'};
+    std::ofstream wordFile{wordFilePath, std::ios::trunc};
+
+    for (unsigned long long i = 0; i < words; ++i)
+    {
+        // A numbered suffix keeps every word distinct.
+        std::string word;
+
+        for (int j = length(random); j > 0; --j)
+        {
+            word += static_cast<char>(letter(random));
+        }
+
+        wordFile << word << i << '\n';
+    }
+}
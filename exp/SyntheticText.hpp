@@ -0,0 +1,30 @@
+// SyntheticText.hpp
+//
+// Generates large text files for benchmarks to read.  The text is made of
+// words from a word set, some of them misspelled, separated by spaces and
+// punctuation and broken into lines of typical length.  Large word sets
+// can be generated, too.
+
+#ifndef SYNTHETICTEXT_HPP
+#define SYNTHETICTEXT_HPP
+
+#include <string>
+
+
+
+// ensureSyntheticText() writes a synthetic text file of (about) the given
+// size to the given path, unless a file at least that large is already
+// there, and returns the size of the file.
+unsigned long long ensureSyntheticText(
+    const std::string& wordFilePath, const std::string& textFilePath,
+    unsigned long long bytes);
+
+
+// ensureSyntheticWordSet() writes a word file of the given number of
+// distinct made-up words to the given path, unless one with at least that
+// many lines is already there.
+void ensureSyntheticWordSet(const std::string& wordFilePath, unsigned long long words);
+
+
+
+#endif // SYNTHETICTEXT_HPP
@@ -0,0 +1,146 @@
+// TokenizerBenchmark.cpp
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include "Benchmarks.hpp"
+#include "Stopwatch.hpp"
+#include "SyntheticText.hpp"
+#include "WordTokenizer.hpp"
+
+
+
+namespace
+{
+    struct TokenizerResult
+    {
+        unsigned long long words;
+        unsigned long long checksum;
+    };
+
+
+    // Finds and uppercases every word in the text, the way
+    // MappedTextFileReader does, but without splitting it into lines
+    // (newlines aren't word characters, so the words are the same).
+    TokenizerResult tokenizeAll(const WordTokenizer& tokenizer, const std::string& text)
+    {
+        TokenizerResult result{0, 0};
+        std::string word;
+        size_t index = 0;
+
+        while (tokenizer.nextWord(text.data(), index, text.size(), word))
+        {
+            result.checksum = result.checksum * 31 + word.size() + static_cast<unsigned char>(word.back());
+            ++result.words;
+        }
+
+        return result;
+    }
+
+
+    std::string nameOf(TokenizerKind kind)
+    {
+        switch (kind)
+        {
+        case TokenizerKind::Sse2:
+            return "SSE2";
+
+        case TokenizerKind::Avx2:
+            return "AVX2";
+
+        default:
+            return "scalar";
+        }
+    }
+}
+
+
+
+void runTokenizerBenchmark(std::istream& in, std::ostream& out)
+{
+    std::string wordFilePath = readParameter(in, "wordset.txt");
+    unsigned long long megabytes = std::stoull(readParameter(in, "256"));
+    std::string textFilePath = readParameter(in, "/tmp/spellcheck-synthetic.txt");
+
+    out << "Preparing " << megabytes << "MB of synthetic text in "
+        << textFilePath << " ..." << std::endl;
+
+    ensureSyntheticText(wordFilePath, textFilePath, megabytes * 1024 * 1024);
+
+    // Only the first megabytes of the file are tokenized, since it may have
+    // been made larger by an earlier benchmark.
+    std::string text(megabytes * 1024 * 1024, '\0');
+
+    {
+        std::ifstream file{textFilePath, std::ios::binary};
+        file.read(text.data(), text.size());
+        text.resize(file.gcount());
+    }
+
+    // The synthetic text is all ASCII, so the UTF-8 tokenizers find the
+    // same words as the ASCII ones; the difference in their throughput is
+    // the cost of looking out for non-ASCII bytes.
+    Stopwatch stopwatch;
+    bool first = true;
+    TokenizerResult expected{0, 0};
+
+    for (TokenizerKind kind : { TokenizerKind::Scalar, TokenizerKind::Sse2, TokenizerKind::Avx2 })
+    {
+        if (!tokenizerKindSupported(kind))
+        {
+            out << std::left << std::setw(16) << nameOf(kind) << "not supported" << std::endl;
+            continue;
+        }
+
+        double asciiSeconds = 0.0;
+
+        for (TextEncoding encoding : { TextEncoding::Ascii, TextEncoding::Utf8 })
+        {
+            WordTokenizer tokenizer{kind, encoding};
+            std::string name = nameOf(kind) + (encoding == TextEncoding::Ascii ? " ASCII" : " UTF-8");
+
+            // The fastest of a few runs is reported, since the differences
+            // being measured are small enough to be lost in the noise.
+            TokenizerResult result{0, 0};
+            double seconds = 0.0;
+
+            for (int run = 0; run < 3; ++run)
+            {
+                stopwatch.start();
+                result = tokenizeAll(tokenizer, text);
+                stopwatch.stop();
+
+                double runSeconds = stopwatch.lastDuration() / 1000000.0;
+                seconds = run == 0 ? runSeconds : std::min(seconds, runSeconds);
+            }
+
+            out << std::left << std::setw(16) << name
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(14) << (result.words / seconds / 1000000.0) << " Mwords/s"
+                << std::setw(12) << (text.size() / seconds / (1024.0 * 1024.0)) << " MB/s";
+
+            if (encoding == TextEncoding::Ascii)
+            {
+                asciiSeconds = seconds;
+            }
+            else
+            {
+                out << std::setw(10) << std::showpos
+                    << ((seconds / asciiSeconds - 1.0) * 100.0) << "%" << std::noshowpos;
+            }
+
+            out << std::endl;
+
+            if (first)
+            {
+                expected = result;
+                first = false;
+            }
+            else if (result.words != expected.words || result.checksum != expected.checksum)
+            {
+                out << "ERROR: " << name << " found different words than scalar ASCII" << std::endl;
+            }
+        }
+    }
+}
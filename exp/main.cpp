@@ -0,0 +1,72 @@
+// main.cpp
+//
+// Runs one of the benchmarks declared in Benchmarks.hpp.  The name of the
+// benchmark is read from the standard input, followed by its parameters.
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include "Benchmarks.hpp"
+
+
+namespace
+{
+    const std::map<std::string, std::function<void(std::istream&, std::ostream&)>> benchmarks =
+    {
+        { "CHECK", runParallelCheckBenchmark },
+        { "COMPRESSED", runCompressedInputBenchmark },
+        { "DICTIONARY", runDictionaryStartupBenchmark },
+        { "LAYERS", runLayeredLookupBenchmark },
+        { "LOAD", runLoaderBenchmark },
+        { "NOTIFY", runNotifyBenchmark },
+        { "OBSERVE", runObserverBenchmark },
+        { "PIPELINE", runPipelineBenchmark },
+        { "READ", runReaderBenchmark },
+        { "READAHEAD", runReadAheadBenchmark },
+        { "RELOAD", runReloadBenchmark },
+        { "SERVER", runServerBenchmark },
+        { "SHARED", runSharedDictionaryBenchmark },
+        { "SUGGEST", runSuggestionBenchmark },
+        { "TOKENIZE", runTokenizerBenchmark }
+    };
+}
+
+
+std::string readParameter(std::istream& in, const std::string& defaultValue)
+{
+    std::string line;
+
+    if (std::getline(in, line) && !line.empty())
+    {
+        return line;
+    }
+    else
+    {
+        return defaultValue;
+    }
+}
+
+
+int main()
+{
+    std::string name = readParameter(std::cin, "");
+    auto benchmark = benchmarks.find(name);
+
+    if (benchmark == benchmarks.end())
+    {
+        std::cout << "ERROR: Unknown benchmark: " << name << std::endl;
+        std::cout << "Benchmarks are:";
+
+        for (const auto& b : benchmarks)
+        {
+            std::cout << " " << b.first;
+        }
+
+        std::cout << std::endl;
+        return 0;
+    }
+
+    benchmark->second(std::cin, std::cout);
+    return 0;
+}
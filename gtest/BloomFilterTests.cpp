@@ -0,0 +1,78 @@
+// BloomFilterTests.cpp
+//
+// Unit tests for BloomFilter, and for WordChecker's use of one.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "BloomFilter.hpp"
+#include "ListSet.hpp"
+#include "WordChecker.hpp"
+
+
+TEST(BloomFilterTests, neverRejectsAddedElements)
+{
+    BloomFilter filter{1000};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        filter.add("WORD" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(filter.mightContain("WORD" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(1000u, filter.elementCount());
+}
+
+
+TEST(BloomFilterTests, rejectsMostOtherElements)
+{
+    BloomFilter filter{1000};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        filter.add("WORD" + std::to_string(i));
+    }
+
+    unsigned int rejections = 0;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        if (!filter.mightContain("OTHER" + std::to_string(i)))
+        {
+            ++rejections;
+        }
+    }
+
+    EXPECT_GT(rejections, 9500u);
+    EXPECT_LT(filter.falsePositiveRate(), 0.05);
+}
+
+
+TEST(BloomFilterTests, wordCheckerConsultsFilterFirst)
+{
+    ListSet<std::string> words;
+    words.add("BOO");
+    words.add("BOOT");
+
+    BloomFilter filter{2};
+    filter.add("BOO");
+
+    WordChecker checker{words, filter};
+
+    EXPECT_TRUE(checker.wordExists("BOO"));
+    EXPECT_FALSE(checker.wordExists("IS"));
+    EXPECT_EQ(
+        (std::vector<bool>{true, false}),
+        checker.wordsExist({"BOO", "HAPPY"}));
+
+    // The filter doesn't count its own lookups; the checker counts them.
+    EXPECT_EQ(4u, filter.queries());
+    EXPECT_EQ(2u, filter.rejections());
+
+    filter.mightContain("BOOT");
+    EXPECT_EQ(4u, filter.queries());
+}
@@ -0,0 +1,84 @@
+// BoundedQueueTests.cpp
+//
+// Unit tests for BoundedQueue.
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "BoundedQueue.hpp"
+
+
+TEST(BoundedQueueTests, handsItemsOverInOrder)
+{
+    BoundedQueue<std::string> queue{3};
+    EXPECT_EQ(4u, queue.capacity());
+
+    EXPECT_TRUE(queue.push("BOO"));
+    EXPECT_TRUE(queue.push("IS"));
+    queue.close();
+
+    std::string item;
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ("BOO", item);
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ("IS", item);
+    EXPECT_FALSE(queue.pop(item));
+
+    EXPECT_EQ(2u, queue.statistics().pushes);
+    EXPECT_EQ(2u, queue.statistics().maximumDepth);
+    EXPECT_EQ(3u, queue.statistics().totalDepth);
+}
+
+
+TEST(BoundedQueueTests, producerWaitsForRoomWhileConsumerKeepsUp)
+{
+    BoundedQueue<std::vector<int>> queue{2};
+    std::vector<int> popped;
+
+    std::thread consumer{
+        [&]()
+        {
+            std::vector<int> item;
+
+            while (queue.pop(item))
+            {
+                popped.push_back(item.at(0));
+            }
+        }};
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_TRUE(queue.push(std::vector<int>{i}));
+    }
+
+    queue.close();
+    consumer.join();
+
+    ASSERT_EQ(100000u, popped.size());
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_EQ(i, popped[i]);
+    }
+
+    EXPECT_LE(queue.statistics().maximumDepth, queue.capacity());
+}
+
+
+TEST(BoundedQueueTests, cancellingWakesWaitingThreads)
+{
+    BoundedQueue<int> full{1};
+    ASSERT_TRUE(full.push(1));
+
+    std::thread producer{[&]() { EXPECT_FALSE(full.push(2)); }};
+    full.cancel();
+    producer.join();
+
+    BoundedQueue<int> empty{1};
+    std::thread consumer{[&]() { int item; EXPECT_FALSE(empty.pop(item)); }};
+    empty.cancel();
+    consumer.join();
+
+    EXPECT_TRUE(empty.isCancelled());
+}
@@ -0,0 +1,226 @@
+// CompiledWordSetTests.cpp
+//
+// Unit tests checking that a compiled dictionary holds the same words as
+// the word file it was compiled from, and that files that aren't valid
+// compiled dictionaries are refused rather than trusted, and that one
+// published in shared memory can be opened by other processes.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "CompiledWordSet.hpp"
+#include "HashSet.hpp"
+#include "StringHashing.hpp"
+#include "WordSetLoader.hpp"
+
+
+namespace
+{
+    std::string writeTempFile(const std::string& name, const std::string& contents)
+    {
+        std::string path = testing::TempDir() + name;
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+
+    std::vector<std::string> manyWords()
+    {
+        std::vector<std::string> words;
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            words.push_back("WORD" + std::to_string(i * 7919 % 100003));
+        }
+
+        return words;
+    }
+
+
+    std::string compile(const std::vector<std::string>& words)
+    {
+        std::string path = testing::TempDir() + "CompiledWordSetTests.dict";
+        EXPECT_TRUE(CompiledWordSet::write(words, path));
+        return path;
+    }
+}
+
+
+TEST(CompiledWordSetTests, containsExactlyTheCompiledWords)
+{
+    std::vector<std::string> words = manyWords();
+    std::string path = compile(words);
+
+    CompiledWordSet compiled{path};
+    ASSERT_TRUE(compiled.isOpen());
+    EXPECT_EQ(words.size(), compiled.size());
+
+    for (const std::string& word : words)
+    {
+        EXPECT_TRUE(compiled.contains(word)) << word;
+        EXPECT_FALSE(compiled.contains(word + "X")) << word;
+    }
+
+    EXPECT_FALSE(compiled.contains(""));
+
+    std::vector<std::string> queries = words;
+    queries.insert(queries.end(), {"", "WORD", "NOT A WORD"});
+
+    std::vector<bool> expected;
+
+    for (const std::string& query : queries)
+    {
+        expected.push_back(compiled.contains(query));
+    }
+
+    EXPECT_EQ(expected, compiled.containsBatch(queries));
+
+    std::remove(path.c_str());
+}
+
+
+TEST(CompiledWordSetTests, leavesOutDuplicates)
+{
+    std::string path = compile({"BOO", "IS", "BOO", "HAPPY", "IS"});
+
+    CompiledWordSet compiled{path};
+    EXPECT_EQ(3u, compiled.size());
+
+    std::vector<std::string> found;
+    compiled.forEachWord([&](std::string_view word) { found.emplace_back(word); });
+    std::sort(found.begin(), found.end());
+
+    EXPECT_EQ((std::vector<std::string>{"BOO", "HAPPY", "IS"}), found);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(CompiledWordSetTests, compilesWordFilesTheWayTheyAreLoaded)
+{
+    std::string wordPath = writeTempFile(
+        "CompiledWordSetTests-words.txt", "apple\r\nBanana\ncaf\xC3\xA9\n\ncherry");
+    std::string compiledPath = testing::TempDir() + "CompiledWordSetTests-words.dict";
+
+    ASSERT_TRUE(WordSetLoader{}.compile(wordPath, compiledPath));
+    EXPECT_TRUE(CompiledWordSet::isCompiledWordSet(compiledPath));
+    EXPECT_FALSE(CompiledWordSet::isCompiledWordSet(wordPath));
+
+    HashSet<std::string> loaded{hashStringAsProduct};
+    WordSetLoader{}.load(wordPath, loaded);
+
+    CompiledWordSet compiled{compiledPath};
+    EXPECT_EQ(loaded.size(), compiled.size());
+
+    for (const std::string& word :
+        std::vector<std::string>{"APPLE", "BANANA", "CAF\xC3\x89", "", "CHERRY"})
+    {
+        EXPECT_TRUE(loaded.contains(word)) << word;
+        EXPECT_TRUE(compiled.contains(word)) << word;
+    }
+
+    // A compiled dictionary can be loaded into any other Set.
+    HashSet<std::string> reloaded{hashStringAsProduct};
+    WordSetLoader{}.load(compiledPath, reloaded);
+    EXPECT_EQ(loaded.size(), reloaded.size());
+    EXPECT_TRUE(reloaded.contains("CAF\xC3\x89"));
+
+    std::remove(wordPath.c_str());
+    std::remove(compiledPath.c_str());
+}
+
+
+TEST(CompiledWordSetTests, refusesFilesThatAreNotValidCompiledDictionaries)
+{
+    std::string path = compile(manyWords());
+    std::string contents = readFile(path);
+
+    EXPECT_FALSE(CompiledWordSet{testing::TempDir() + "no-such-file"}.isOpen());
+    EXPECT_FALSE(CompiledWordSet{writeTempFile("CompiledWordSetTests.txt", "BOO\nIS\n")}.isOpen());
+
+    std::string truncated = contents.substr(0, contents.size() - 1);
+    EXPECT_FALSE(CompiledWordSet{writeTempFile("CompiledWordSetTests.dict", truncated)}.isOpen());
+
+    std::string otherVersion = contents;
+    otherVersion[8] ^= 0x7F;
+    EXPECT_FALSE(CompiledWordSet{writeTempFile("CompiledWordSetTests.dict", otherVersion)}.isOpen());
+
+    // A corrupt word is caught by the checksum, unless it isn't verified,
+    // in which case the set can still be queried safely.
+    std::string corrupt = contents;
+    corrupt[corrupt.size() - 3] ^= 0x01;
+    writeTempFile("CompiledWordSetTests.dict", corrupt);
+
+    CompiledWordSet verified{path};
+    EXPECT_FALSE(verified.isOpen());
+    EXPECT_EQ(0u, verified.size());
+    EXPECT_FALSE(verified.contains("WORD0"));
+
+    CompiledWordSet unverified{path, false};
+    EXPECT_TRUE(unverified.isOpen());
+    EXPECT_TRUE(unverified.contains("WORD0"));
+
+    std::remove(path.c_str());
+    std::remove((testing::TempDir() + "CompiledWordSetTests.txt").c_str());
+}
+
+
+TEST(CompiledWordSetTests, publishesDictionariesInSharedMemory)
+{
+    std::string name = "/CompiledWordSetTests-" + std::to_string(getpid());
+    std::vector<std::string> words = manyWords();
+
+    ASSERT_TRUE(CompiledWordSet::writeShared(words, name));
+
+    CompiledWordSet shared;
+    ASSERT_TRUE(shared.openShared(name));
+    EXPECT_EQ(words.size(), shared.size());
+    EXPECT_TRUE(shared.contains(words.front()));
+    EXPECT_FALSE(shared.contains("NOT A WORD"));
+
+    // Another process opens the same dictionary, rather than compiling
+    // one of its own.
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+
+    if (child == 0)
+    {
+        CompiledWordSet attached;
+        bool found = attached.openShared(name) && attached.size() == words.size()
+            && attached.contains(words.back()) && !attached.contains("NOT A WORD");
+        _exit(found ? 0 : 1);
+    }
+
+    int status;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Publishing again replaces the dictionary for sets opened from then
+    // on, while sets that already have it open keep the one they opened.
+    ASSERT_TRUE(CompiledWordSet::writeShared({"BOO", "IS", "HAPPY"}, name));
+
+    CompiledWordSet replacement;
+    ASSERT_TRUE(replacement.openShared(name));
+    EXPECT_EQ(3u, replacement.size());
+    EXPECT_TRUE(replacement.contains("HAPPY"));
+    EXPECT_EQ(words.size(), shared.size());
+    EXPECT_TRUE(shared.contains(words.back()));
+
+    EXPECT_TRUE(CompiledWordSet::removeShared(name));
+    EXPECT_FALSE(CompiledWordSet::removeShared(name));
+    EXPECT_FALSE(CompiledWordSet{}.openShared(name));
+    EXPECT_TRUE(replacement.contains("HAPPY"));
+}
@@ -0,0 +1,233 @@
+// DecompressorTests.cpp
+//
+// Unit tests checking that gzip- (and, when supported, zstd-) compressed
+// files are recognized and read the same way as the uncompressed text,
+// whichever reader or loader is reading them.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <gtest/gtest.h>
+#include "Decompressor.hpp"
+#include "HashSet.hpp"
+#include "ReadAheadFile.hpp"
+#include "StreamTextReader.hpp"
+#include "StringHashing.hpp"
+#include "TextFileReader.hpp"
+#include "WordSetLoader.hpp"
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+namespace
+{
+    std::string sampleText()
+    {
+        std::string text;
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            text += "word" + std::to_string(i % 977) + (i % 12 == 11 ? ".\n" : " ");
+        }
+
+        return text;
+    }
+
+
+    // gzip() compresses the text as a single gzip member.
+    std::string gzip(const std::string& text)
+    {
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+
+        std::string compressed(deflateBound(&stream, text.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = text.size();
+        stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+        stream.avail_out = compressed.size();
+
+        deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        return compressed;
+    }
+
+
+    std::string writeTempFile(const std::string& name, const std::string& contents)
+    {
+        std::string path = testing::TempDir() + name;
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+
+
+    std::vector<std::string> readWords(WordReader& reader)
+    {
+        std::vector<std::string> words;
+
+        while (!reader.noMoreWords())
+        {
+            words.push_back(std::string{reader.currentWordView()}
+                + "@" + std::to_string(reader.currentLineNumber()));
+
+            reader.advanceToNextWord();
+        }
+
+        return words;
+    }
+
+
+    std::string readAll(ReadAheadFile& file)
+    {
+        std::string contents;
+        std::string chunk(4096, '\0');
+        size_t count;
+
+        while ((count = file.read(chunk.data(), chunk.size())) > 0)
+        {
+            contents.append(chunk, 0, count);
+        }
+
+        return contents;
+    }
+
+
+    // Checks that every way of reading the compressed file finds what's
+    // in the uncompressed one.
+    void expectSameAsUncompressed(const std::string& path, const std::string& text)
+    {
+        std::string plainPath = writeTempFile("DecompressorTests.txt", text);
+        TextFileReader plainReader{plainPath};
+        std::vector<std::string> expected = readWords(plainReader);
+
+        for (size_t blockSize : {0, 1000, 1 << 20})
+        {
+            ReadAheadFile file{path, std::max<size_t>(blockSize, 4096)};
+            EXPECT_TRUE(file.isOpen());
+            EXPECT_EQ(text, readAll(file));
+
+            StreamTextReader streamReader{path, StreamTextReader::DEFAULT_BUFFER_SIZE, blockSize};
+            EXPECT_TRUE(streamReader.isOpen());
+            EXPECT_EQ(expected, readWords(streamReader)) << "blocks of " << blockSize;
+        }
+
+        TextFileReader textFileReader{path};
+        EXPECT_EQ(expected, readWords(textFileReader));
+
+        std::remove(plainPath.c_str());
+    }
+}
+
+
+TEST(DecompressorTests, recognizesCompressionByContents)
+{
+    std::string text = sampleText();
+    std::string plainPath = writeTempFile("DecompressorTests-plain.gz", text);
+    std::string gzipPath = writeTempFile("DecompressorTests-gzip.txt", gzip(text));
+    std::string zstdPath = writeTempFile("DecompressorTests-zstd.txt", "\x28\xb5\x2f\xfd");
+
+    EXPECT_EQ(Compression::None, detectCompression(plainPath));
+    EXPECT_EQ(Compression::Gzip, detectCompression(gzipPath));
+    EXPECT_EQ(Compression::Zstd, detectCompression(zstdPath));
+    EXPECT_EQ(Compression::None, detectCompression(testing::TempDir() + "no-such-file"));
+
+    EXPECT_TRUE(compressionSupported(Compression::Gzip));
+
+    std::remove(plainPath.c_str());
+    std::remove(gzipPath.c_str());
+    std::remove(zstdPath.c_str());
+}
+
+
+TEST(DecompressorTests, readsGzipFilesLikeUncompressedOnes)
+{
+    std::string text = sampleText();
+    std::string path = writeTempFile("DecompressorTests.txt.gz", gzip(text));
+
+    expectSameAsUncompressed(path, text);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(DecompressorTests, readsConcatenatedGzipMembers)
+{
+    std::string text = sampleText();
+    std::string first = text.substr(0, 12345);
+    std::string second = text.substr(12345);
+
+    std::string path = writeTempFile("DecompressorTests.txt.gz", gzip(first) + gzip(second));
+
+    expectSameAsUncompressed(path, text);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(DecompressorTests, truncatedFilesEndEarlyRatherThanHanging)
+{
+    std::string text = sampleText();
+    std::string compressed = gzip(text);
+    std::string path = writeTempFile(
+        "DecompressorTests.txt.gz", compressed.substr(0, compressed.size() / 2));
+
+    ReadAheadFile file{path};
+    std::string contents = readAll(file);
+
+    EXPECT_LT(contents.size(), text.size());
+    EXPECT_EQ(text.substr(0, contents.size()), contents);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(DecompressorTests, loaderReadsCompressedWordSets)
+{
+    std::string path = writeTempFile("DecompressorTests-words.txt.gz", gzip("apple\nbanana\ncherry\n"));
+
+    HashSet<std::string> words{hashStringAsProduct};
+    WordSetLoader{}.load(path, words);
+
+    EXPECT_EQ(3u, words.size());
+    EXPECT_TRUE(words.contains("BANANA"));
+
+    std::remove(path.c_str());
+}
+
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+
+TEST(DecompressorTests, readsZstdFilesLikeUncompressedOnes)
+{
+    std::string text = sampleText();
+    std::string compressed(ZSTD_compressBound(text.size()), '\0');
+    compressed.resize(ZSTD_compress(compressed.data(), compressed.size(), text.data(), text.size(), 3));
+
+    std::string path = writeTempFile("DecompressorTests.txt.zst", compressed);
+
+    expectSameAsUncompressed(path, text);
+
+    std::remove(path.c_str());
+}
+
+#else
+
+TEST(DecompressorTests, unsupportedZstdFilesCannotBeOpened)
+{
+    std::string path = writeTempFile("DecompressorTests.txt.zst", "\x28\xb5\x2f\xfd");
+
+    EXPECT_FALSE(compressionSupported(Compression::Zstd));
+    EXPECT_FALSE(ReadAheadFile{path}.isOpen());
+    EXPECT_FALSE((StreamTextReader{path, StreamTextReader::DEFAULT_BUFFER_SIZE, 0}.isOpen()));
+
+    std::remove(path.c_str());
+}
+
+#endif
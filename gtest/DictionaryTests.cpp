@@ -0,0 +1,172 @@
+// DictionaryTests.cpp
+//
+// Unit tests checking that a DictionaryHandle can be switched to a new
+// Dictionary while checks are in progress, that those checks keep using
+// the version they started with, and that old versions are destroyed once
+// nothing is using them any longer.
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Dictionary.hpp"
+#include "HashSet.hpp"
+#include "StringHashing.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // Version n of the dictionary holds the words V<n>-0 through V<n>-99,
+    // so a check can tell which version it's looking at, and whether it's
+    // seeing all of it.
+    std::shared_ptr<const Dictionary> makeVersion(unsigned int n, bool withFilter = false)
+    {
+        std::unique_ptr<Set<std::string>> words =
+            std::make_unique<HashSet<std::string>>(hashStringAsProduct);
+        std::unique_ptr<BloomFilter> filter =
+            withFilter ? std::make_unique<BloomFilter>(100) : nullptr;
+
+        for (unsigned int i = 0; i < 100; ++i)
+        {
+            std::string word = "V" + std::to_string(n) + "-" + std::to_string(i);
+            words->add(word);
+
+            if (filter != nullptr)
+            {
+                filter->add(word);
+            }
+        }
+
+        return std::make_shared<Dictionary>(std::move(words), std::move(filter));
+    }
+}
+
+
+TEST(DictionaryTests, checksKeepTheVersionTheyStartedWith)
+{
+    DictionaryHandle handle{makeVersion(1)};
+    std::weak_ptr<const Dictionary> first = handle.current();
+
+    {
+        WordChecker checker{handle.current()};
+        handle.replace(makeVersion(2));
+
+        EXPECT_EQ(1u, handle.version());
+        EXPECT_FALSE(first.expired());
+        EXPECT_TRUE(checker.wordExists("V1-0"));
+        EXPECT_FALSE(checker.wordExists("V2-0"));
+
+        WordChecker newChecker{handle.current()};
+        EXPECT_FALSE(newChecker.wordExists("V1-0"));
+        EXPECT_TRUE(newChecker.wordExists("V2-0"));
+    }
+
+    // Once the last check using the first version is done, it's gone.
+    EXPECT_TRUE(first.expired());
+}
+
+
+TEST(DictionaryTests, checkersUseTheDictionarysFilter)
+{
+    std::shared_ptr<const Dictionary> dictionary = makeVersion(3, true);
+    ASSERT_NE(nullptr, dictionary->filter());
+
+    WordChecker checker{dictionary};
+    EXPECT_TRUE(checker.wordExists("V3-42"));
+    EXPECT_FALSE(checker.wordExists("V3-100"));
+
+    EXPECT_EQ(
+        (std::vector<bool>{true, false, true}),
+        checker.wordsExist({"V3-0", "V4-0", "V3-99"}));
+}
+
+
+TEST(DictionaryTests, reloadsInTheBackground)
+{
+    DictionaryHandle handle{makeVersion(1)};
+
+    handle.reloadInBackground([]() { return makeVersion(2); });
+    EXPECT_TRUE(handle.waitForReload());
+    EXPECT_TRUE(WordChecker{handle.current()}.wordExists("V2-0"));
+    EXPECT_EQ(1u, handle.version());
+
+    // A builder that fails leaves the current version in place.
+    handle.reloadInBackground([]() { return nullptr; });
+    EXPECT_FALSE(handle.waitForReload());
+
+    handle.reloadInBackground(
+        []() -> std::shared_ptr<const Dictionary> { throw std::runtime_error{"no words"}; });
+    EXPECT_FALSE(handle.waitForReload());
+
+    EXPECT_TRUE(WordChecker{handle.current()}.wordExists("V2-0"));
+    EXPECT_EQ(1u, handle.version());
+}
+
+
+TEST(DictionaryTests, checksSeeWholeVersionsWhileReloading)
+{
+    DictionaryHandle handle{makeVersion(0)};
+    std::atomic<bool> done{false};
+    std::atomic<unsigned int> inconsistent{0};
+    std::vector<std::thread> checkers;
+
+    for (unsigned int t = 0; t < 3; ++t)
+    {
+        checkers.emplace_back(
+            [&]()
+            {
+                while (!done)
+                {
+                    WordChecker checker{handle.current()};
+
+                    // Work out which version this is, then make sure every
+                    // word of that version, and none of any other, is there.
+                    unsigned int n = 0;
+
+                    while (n < 50 && !checker.wordExists("V" + std::to_string(n) + "-0"))
+                    {
+                        ++n;
+                    }
+
+                    std::vector<std::string> words;
+
+                    for (unsigned int i = 0; i < 100; ++i)
+                    {
+                        words.push_back("V" + std::to_string(n) + "-" + std::to_string(i));
+                        words.push_back("V" + std::to_string(n + 1) + "-" + std::to_string(i));
+                    }
+
+                    std::vector<bool> exists = checker.wordsExist(words);
+
+                    for (size_t i = 0; i < exists.size(); ++i)
+                    {
+                        if (exists[i] != (i % 2 == 0))
+                        {
+                            ++inconsistent;
+                        }
+                    }
+                }
+            });
+    }
+
+    for (unsigned int n = 1; n <= 50; ++n)
+    {
+        handle.reloadInBackground([n]() { return makeVersion(n); });
+    }
+
+    EXPECT_TRUE(handle.waitForReload());
+    done = true;
+
+    for (std::thread& checker : checkers)
+    {
+        checker.join();
+    }
+
+    EXPECT_EQ(0u, inconsistent.load());
+    EXPECT_EQ(50u, handle.version());
+    EXPECT_TRUE(WordChecker{handle.current()}.wordExists("V50-0"));
+}
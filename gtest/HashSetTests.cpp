@@ -0,0 +1,65 @@
+// HashSetTests.cpp
+//
+// Unit tests checking that containsBatch() on a HashSet agrees with
+// contains(), whether its chains are short or every element shares one.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+}
+
+
+TEST(HashSetTests, containsBatchAgreesWithContains)
+{
+    for (HashSet<int>::HashFunction hash : {zeroHash<int>, identityHash})
+    {
+        HashSet<int> s{hash};
+
+        for (int i = 0; i < 1000; i += 2)
+        {
+            s.add(i);
+        }
+
+        // More queries than fit in one window, some there and some not.
+        std::vector<int> queries;
+
+        for (int i = -3; i < 1003; i += 3)
+        {
+            queries.push_back(i);
+        }
+
+        std::vector<bool> found = s.containsBatch(queries);
+        ASSERT_EQ(queries.size(), found.size());
+
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            EXPECT_EQ(s.contains(queries[i]), found[i]) << queries[i];
+        }
+    }
+}
+
+
+TEST(HashSetTests, containsBatchOfStrings)
+{
+    HashSet<std::string> s{zeroHash<std::string>};
+    s.add("Boo");
+
+    EXPECT_EQ((std::vector<bool>{false, true}), s.containsBatch({"is", "Boo"}));
+    EXPECT_EQ(std::vector<bool>{}, s.containsBatch({}));
+}
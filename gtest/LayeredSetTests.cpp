@@ -0,0 +1,143 @@
+// LayeredSetTests.cpp
+//
+// Unit tests checking that a LayeredSet contains exactly the elements of
+// its layers, looking in them in order and no further than it needs to,
+// and that its layers can be added to and replaced.
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+#include "LayeredSet.hpp"
+#include "ListSet.hpp"
+#include "StringHashing.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // A ListSet that counts how many elements it has been asked about.
+    class CountingSet : public ListSet<std::string>
+    {
+    public:
+        CountingSet(std::initializer_list<std::string> words)
+        {
+            for (const std::string& word : words)
+            {
+                add(word);
+            }
+        }
+
+
+        bool contains(const std::string& element) const override
+        {
+            ++lookups;
+            return ListSet<std::string>::contains(element);
+        }
+
+        mutable unsigned int lookups = 0;
+    };
+}
+
+
+TEST(LayeredSetTests, containsTheElementsOfEveryLayer)
+{
+    auto base = std::make_shared<CountingSet>(std::initializer_list<std::string>{"BOO", "IS", "HAPPY"});
+    auto team = std::make_shared<CountingSet>(std::initializer_list<std::string>{"ZOTBOT"});
+    auto user = std::make_shared<CountingSet>(std::initializer_list<std::string>{"ANTEATER", "BOO"});
+
+    LayeredSet<std::string> words{{user, team, base}};
+    EXPECT_TRUE(words.isImplemented());
+    EXPECT_EQ(3u, words.layerCount());
+    EXPECT_EQ(6u, words.size());
+
+    EXPECT_TRUE(words.contains("ANTEATER"));
+    EXPECT_TRUE(words.contains("ZOTBOT"));
+    EXPECT_TRUE(words.contains("HAPPY"));
+    EXPECT_FALSE(words.contains("SAD"));
+
+    // Lookups stop at the first layer that has the element.
+    user->lookups = team->lookups = base->lookups = 0;
+    EXPECT_TRUE(words.contains("BOO"));
+    EXPECT_EQ(1u, user->lookups);
+    EXPECT_EQ(0u, team->lookups);
+    EXPECT_EQ(0u, base->lookups);
+}
+
+
+TEST(LayeredSetTests, batchesAskEachLayerOnlyAboutWhatIsLeft)
+{
+    auto base = std::make_shared<CountingSet>(std::initializer_list<std::string>{"BOO", "IS", "HAPPY"});
+    auto team = std::make_shared<CountingSet>(std::initializer_list<std::string>{"ZOTBOT"});
+    auto user = std::make_shared<CountingSet>(std::initializer_list<std::string>{"ANTEATER"});
+
+    LayeredSet<std::string> words{{base, team, user}};
+
+    EXPECT_EQ(
+        (std::vector<bool>{true, false, true, true, false, true}),
+        words.containsBatch({"BOO", "SAD", "ZOTBOT", "ANTEATER", "", "HAPPY"}));
+
+    EXPECT_EQ(6u, base->lookups);
+    EXPECT_EQ(4u, team->lookups);
+    EXPECT_EQ(3u, user->lookups);
+
+    EXPECT_EQ(std::vector<bool>{}, words.containsBatch({}));
+    EXPECT_EQ(std::vector<bool>{false}, LayeredSet<std::string>{}.containsBatch({"BOO"}));
+}
+
+
+TEST(LayeredSetTests, layersCanBeAddedToAndReplaced)
+{
+    auto base = std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+    base->add("BOO");
+
+    auto user = std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+
+    LayeredSet<std::string> words;
+    words.addLayer(base);
+    size_t userLayer = words.addLayer(user);
+
+    // Until a writable layer is chosen, nothing can be added.
+    words.add("ANTEATER");
+    EXPECT_FALSE(words.contains("ANTEATER"));
+
+    words.setWritableLayer(userLayer);
+    words.add("ANTEATER");
+    EXPECT_TRUE(words.contains("ANTEATER"));
+    EXPECT_TRUE(user->contains("ANTEATER"));
+    EXPECT_FALSE(base->contains("ANTEATER"));
+
+    auto otherUser = std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+    otherUser->add("ZOTBOT");
+    words.replaceLayer(userLayer, otherUser);
+
+    EXPECT_FALSE(words.contains("ANTEATER"));
+    EXPECT_TRUE(words.contains("ZOTBOT"));
+    EXPECT_TRUE(words.contains("BOO"));
+    EXPECT_EQ(base, words.layer(0));
+}
+
+
+TEST(LayeredSetTests, wordCheckersCheckAgainstEveryLayer)
+{
+    auto base = std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+    base->add("BOO");
+    base->add("BOOT");
+
+    auto user = std::make_shared<HashSet<std::string>>(hashStringAsProduct);
+    user->add("BOOM");
+
+    LayeredSet<std::string> words{{user, base}};
+    WordChecker checker{words};
+
+    EXPECT_TRUE(checker.wordExists("BOOM"));
+    EXPECT_TRUE(checker.wordExists("BOOT"));
+    EXPECT_FALSE(checker.wordExists("BOOX"));
+
+    std::vector<std::string> suggestions = checker.findSuggestions("BOOX");
+    EXPECT_NE(suggestions.end(), std::find(suggestions.begin(), suggestions.end(), "BOOM"));
+    EXPECT_NE(suggestions.end(), std::find(suggestions.begin(), suggestions.end(), "BOOT"));
+}
@@ -0,0 +1,93 @@
+// MappedTextFileReaderTests.cpp
+//
+// Unit tests checking that MappedTextFileReader reads the same words, on
+// the same lines, as TextFileReader.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MappedTextFileReader.hpp"
+#include "TextFileReader.hpp"
+
+
+namespace
+{
+    struct WordOnLine
+    {
+        std::string word;
+        std::string line;
+        int lineNumber;
+
+        bool operator==(const WordOnLine& other) const
+        {
+            return word == other.word && line == other.line && lineNumber == other.lineNumber;
+        }
+    };
+
+
+    std::vector<WordOnLine> readAll(WordReader& reader)
+    {
+        std::vector<WordOnLine> words;
+
+        while (!reader.noMoreWords())
+        {
+            words.push_back(WordOnLine{
+                std::string{reader.currentWordView()},
+                std::string{reader.currentLineView()},
+                reader.currentLineNumber()});
+
+            reader.advanceToNextWord();
+        }
+
+        return words;
+    }
+
+
+    std::vector<WordOnLine> readWithTextFileReader(const std::string& path)
+    {
+        TextFileReader reader{path};
+        return readAll(reader);
+    }
+
+
+    std::vector<WordOnLine> readWithMappedTextFileReader(const std::string& path)
+    {
+        MappedTextFileReader reader{path};
+        return readAll(reader);
+    }
+
+
+    std::string writeTempFile(const std::string& contents)
+    {
+        std::string path = testing::TempDir() + "MappedTextFileReaderTests.txt";
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+}
+
+
+TEST(MappedTextFileReaderTests, readsSameWordsAsTextFileReader)
+{
+    std::string path = writeTempFile(
+        "Boo is happy today!\n"
+        "\n"
+        "  don't-stop re-entry ''quoted'' trailing- 'lead\r\n"
+        "x--y a' b- 42nd -- ' 9\n"
+        "last line without newline");
+
+    EXPECT_EQ(readWithTextFileReader(path), readWithMappedTextFileReader(path));
+    std::remove(path.c_str());
+}
+
+
+TEST(MappedTextFileReaderTests, emptyAndMissingFilesHaveNoWords)
+{
+    std::string path = writeTempFile("");
+    EXPECT_TRUE(MappedTextFileReader{path}.noMoreWords());
+    std::remove(path.c_str());
+
+    EXPECT_TRUE(MappedTextFileReader{path}.noMoreWords());
+}
@@ -0,0 +1,215 @@
+// ObservableTests.cpp
+//
+// Unit tests for Observable, including observers that expire, or are added
+// or removed while observers are being notified, with and without a Hold,
+// and notifying them through shared pointers, as callers always have.
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ics46/observable/Observable.hpp>
+
+
+namespace
+{
+    class Observer;
+
+    typedef ics46::observable::Observable<Observer> Subject;
+
+
+    // Records, in a log shared by every observer, that it was notified,
+    // then does whatever it's been told to.
+    class Observer
+    {
+    public:
+        Observer(const std::string& name, std::vector<std::string>& log)
+            : name{name}, log{log}
+        {
+        }
+
+        void notified()
+        {
+            log.push_back(name);
+
+            if (then)
+            {
+                then();
+            }
+        }
+
+        std::string name;
+        std::vector<std::string>& log;
+        std::function<void()> then;
+    };
+
+
+    void notify(Subject& subject)
+    {
+        subject.notifyEachObserver([](Observer* observer) { observer->notified(); });
+    }
+}
+
+
+TEST(ObservableTests, notifiesEachObserverOnceInTheOrderTheyWereAdded)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+    std::shared_ptr<Observer> b = std::make_shared<Observer>("B", log);
+
+    Subject subject;
+    subject.addObserver(a);
+    subject.addObserver(b);
+    subject.addObserver(a);
+    notify(subject);
+
+    subject.removeObserver(a);
+    notify(subject);
+
+    EXPECT_EQ((std::vector<std::string>{"A", "B", "B"}), log);
+}
+
+
+TEST(ObservableTests, notifyObserversPassesSharedPointersAsItAlwaysHas)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+
+    Subject subject;
+    subject.addObserver(a);
+
+    subject.notifyObservers([](std::shared_ptr<Observer> observer) { observer->notified(); });
+    subject.notifyObservers([](auto observer) { observer->notified(); });
+
+    std::weak_ptr<Observer> passed;
+    subject.notifyObservers([&](std::shared_ptr<Observer> observer) { passed = observer; });
+
+    EXPECT_EQ(a, passed.lock());
+    EXPECT_EQ((std::vector<std::string>{"A", "A"}), log);
+}
+
+
+TEST(ObservableTests, skipsObserversThatHaveExpired)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+    std::shared_ptr<Observer> b = std::make_shared<Observer>("B", log);
+
+    Subject subject;
+    subject.addObserver(a);
+    subject.addObserver(b);
+
+    a.reset();
+    notify(subject);
+
+    // A new observer may end up where the expired one was.
+    a = std::make_shared<Observer>("C", log);
+    subject.addObserver(a);
+    notify(subject);
+
+    EXPECT_EQ((std::vector<std::string>{"B", "B", "C"}), log);
+}
+
+
+TEST(ObservableTests, observersCanBeAddedAndRemovedWhileBeingNotified)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+    std::shared_ptr<Observer> b = std::make_shared<Observer>("B", log);
+    std::shared_ptr<Observer> c = std::make_shared<Observer>("C", log);
+    std::vector<std::shared_ptr<Observer>> added;
+
+    Subject subject;
+    subject.addObserver(a);
+    subject.addObserver(b);
+    subject.addObserver(c);
+
+    // A removes itself and B, and adds enough new observers that the list
+    // has to grow, the first time it's notified.
+    a->then =
+        [&]()
+        {
+            if (!added.empty())
+            {
+                return;
+            }
+
+            subject.removeObserver(a);
+            subject.removeObserver(b);
+
+            for (unsigned int i = 0; i < 100; ++i)
+            {
+                added.push_back(std::make_shared<Observer>("D", log));
+                subject.addObserver(added.back());
+            }
+        };
+
+    notify(subject);
+    EXPECT_EQ((std::vector<std::string>{"A", "C"}), log);
+
+    log.clear();
+    notify(subject);
+    ASSERT_EQ(101u, log.size());
+    EXPECT_EQ("C", log[0]);
+    EXPECT_EQ("D", log[100]);
+}
+
+
+TEST(ObservableTests, holdKeepsObserversAliveUntilItsDestroyed)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+    std::shared_ptr<Observer> b = std::make_shared<Observer>("B", log);
+    std::weak_ptr<Observer> weakA = a;
+
+    Subject subject;
+    subject.addObserver(a);
+
+    {
+        Subject::Hold hold{subject};
+        subject.addObserver(b);
+
+        a.reset();
+        EXPECT_FALSE(weakA.expired());
+
+        notify(subject);
+
+        {
+            Subject::Hold nested{subject};
+            notify(subject);
+        }
+
+        EXPECT_FALSE(weakA.expired());
+    }
+
+    EXPECT_TRUE(weakA.expired());
+
+    notify(subject);
+    EXPECT_EQ((std::vector<std::string>{"A", "B", "A", "B", "B"}), log);
+}
+
+
+TEST(ObservableTests, anObserverThatThrowsLeavesTheOthersRegistered)
+{
+    std::vector<std::string> log;
+    std::shared_ptr<Observer> a = std::make_shared<Observer>("A", log);
+    std::shared_ptr<Observer> b = std::make_shared<Observer>("B", log);
+
+    Subject subject;
+    subject.addObserver(a);
+    subject.addObserver(b);
+
+    a->then =
+        [&]()
+        {
+            subject.removeObserver(a);
+            throw std::runtime_error{"observer failed"};
+        };
+
+    EXPECT_THROW(notify(subject), std::runtime_error);
+
+    notify(subject);
+    EXPECT_EQ((std::vector<std::string>{"A", "B"}), log);
+}
@@ -0,0 +1,96 @@
+// ReadAheadFileTests.cpp
+//
+// Unit tests for ReadAheadFile.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "ReadAheadFile.hpp"
+
+
+namespace
+{
+    std::string writeTempFile(const std::string& contents)
+    {
+        std::string path = testing::TempDir() + "ReadAheadFileTests.txt";
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+
+
+    std::string readAll(ReadAheadFile& file, size_t chunkSize)
+    {
+        std::string contents;
+        std::string chunk(chunkSize, '\0');
+        size_t count;
+
+        while ((count = file.read(chunk.data(), chunk.size())) > 0)
+        {
+            contents.append(chunk, 0, count);
+        }
+
+        return contents;
+    }
+}
+
+
+TEST(ReadAheadFileTests, readsWholeFileWhateverTheBlockSize)
+{
+    std::string expected;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        expected += std::to_string(i) + (i % 10 == 9 ? "\n" : " ");
+    }
+
+    std::string path = writeTempFile(expected);
+
+    for (size_t blockSize : {1, 7, 4096, 1 << 20})
+    {
+        for (size_t chunkSize : {1, 100, 65536})
+        {
+            ReadAheadFile file{path, blockSize};
+            ASSERT_TRUE(file.isOpen());
+            EXPECT_EQ(expected, readAll(file, chunkSize))
+                << "blocks of " << blockSize << ", chunks of " << chunkSize;
+
+            EXPECT_EQ(0u, file.read(&expected[0], 1));
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(ReadAheadFileTests, handsOutPartialBlocksFromPipes)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    ASSERT_EQ(4, ::write(fds[1], "boo\n", 4));
+
+    {
+        ReadAheadFile file{"/dev/fd/" + std::to_string(fds[0]), 1 << 20};
+        char buffer[16];
+
+        ASSERT_EQ(4u, file.read(buffer, sizeof(buffer)));
+        EXPECT_EQ("boo\n", std::string(buffer, 4));
+
+        // Destroying the file while its writer is still open mustn't hang.
+    }
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+
+TEST(ReadAheadFileTests, fileThatCannotBeOpenedIsEmpty)
+{
+    ReadAheadFile file{testing::TempDir() + "ReadAheadFileTests-missing.txt"};
+    char c;
+
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_EQ(0u, file.read(&c, 1));
+}
@@ -0,0 +1,50 @@
+// ReorderBufferTests.cpp
+//
+// Unit tests for ReorderBuffer.
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "ReorderBuffer.hpp"
+#include "ThreadPool.hpp"
+
+
+TEST(ReorderBufferTests, deliversInOrderWhateverOrderTasksFinishIn)
+{
+    std::vector<size_t> delivered;
+    ReorderBuffer reorderBuffer{5, [&](size_t index) { delivered.push_back(index); }};
+
+    reorderBuffer.taskFinished(2);
+    reorderBuffer.taskFinished(1);
+    EXPECT_TRUE(delivered.empty());
+
+    reorderBuffer.taskFinished(0);
+    EXPECT_EQ((std::vector<size_t>{0, 1, 2}), delivered);
+
+    reorderBuffer.taskFinished(4);
+    reorderBuffer.taskFinished(3);
+    EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 4}), delivered);
+}
+
+
+TEST(ReorderBufferTests, deliversOneAtATimeFromManyThreads)
+{
+    ThreadPool pool{3};
+    std::vector<size_t> delivered;
+    ReorderBuffer reorderBuffer{1000, [&](size_t index) { delivered.push_back(index); }};
+
+    std::vector<ThreadPool::Task> tasks;
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        tasks.push_back([&, i]() { reorderBuffer.taskFinished(i); });
+    }
+
+    pool.runAll(tasks);
+
+    ASSERT_EQ(1000u, delivered.size());
+
+    for (size_t i = 0; i < delivered.size(); ++i)
+    {
+        EXPECT_EQ(i, delivered[i]);
+    }
+}
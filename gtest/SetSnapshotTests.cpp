@@ -0,0 +1,306 @@
+// SetSnapshotTests.cpp
+//
+// Unit tests checking that a HashSet loaded from a snapshot has the same
+// elements, laid out in the same buckets in the same order, as the one
+// the snapshot was saved from, that AVL trees, binary search trees and
+// skip lists are loaded in the same shape they were saved in, and that
+// snapshots that don't fit the set they're loaded into are refused,
+// leaving the set as it was.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "BSTSet.hpp"
+#include "EmptySet.hpp"
+#include "HashSet.hpp"
+#include "SetSnapshot.hpp"
+#include "SkipListSet.hpp"
+#include "StringHashing.hpp"
+
+
+namespace
+{
+    HashSet<std::string> manyWords()
+    {
+        HashSet<std::string> words{hashStringAsProduct};
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            words.add("WORD" + std::to_string(i * 7919 % 100003));
+        }
+
+        return words;
+    }
+
+
+    std::string snapshotOf(const Set<std::string>& words)
+    {
+        std::ostringstream out;
+        EXPECT_TRUE(words.saveSnapshot(out));
+        return out.str();
+    }
+
+
+    // Checks that a set of the given type, loaded from a snapshot, has the
+    // same elements as the one it was saved from, and is the same shape,
+    // since saving it again gives the same snapshot; and that a snapshot
+    // that's cut short, or is of another kind of set, is refused.
+    template <typename OrderedSet>
+    void expectLoadedInSameShape(const std::string& otherKindOfSnapshot)
+    {
+        OrderedSet saved;
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            saved.add("WORD" + std::to_string(i * 7919 % 100003));
+        }
+
+        std::string snapshot = snapshotOf(saved);
+
+        OrderedSet loaded;
+        loaded.add("NOT IN THE SNAPSHOT");
+
+        std::istringstream in{snapshot};
+        ASSERT_TRUE(loaded.loadSnapshot(in));
+
+        EXPECT_EQ(saved.size(), loaded.size());
+        EXPECT_FALSE(loaded.contains("NOT IN THE SNAPSHOT"));
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            std::string word = "WORD" + std::to_string(i * 7919 % 100003);
+            EXPECT_TRUE(loaded.contains(word)) << word;
+        }
+
+        EXPECT_EQ(snapshot, snapshotOf(loaded));
+
+        loaded.add("WORD");
+        EXPECT_TRUE(loaded.contains("WORD"));
+        EXPECT_EQ(saved.size() + 1, loaded.size());
+
+        for (const std::string& refused :
+            {snapshot.substr(0, snapshot.size() - 1), otherKindOfSnapshot})
+        {
+            std::istringstream refusedIn{refused};
+            EXPECT_FALSE(loaded.loadSnapshot(refusedIn));
+            EXPECT_EQ(saved.size() + 1, loaded.size());
+        }
+
+        // An empty set has a snapshot, too.
+        OrderedSet empty;
+        std::istringstream emptyIn{snapshotOf(OrderedSet{})};
+        ASSERT_TRUE(empty.loadSnapshot(emptyIn));
+        EXPECT_EQ(0u, empty.size());
+        EXPECT_FALSE(empty.contains("WORD"));
+    }
+}
+
+
+TEST(SetSnapshotTests, hashSetIsLoadedWithSameLayout)
+{
+    HashSet<std::string> saved = manyWords();
+    std::string snapshot = snapshotOf(saved);
+
+    HashSet<std::string> loaded{hashStringAsProduct};
+    loaded.add("NOT IN THE SNAPSHOT");
+
+    std::istringstream in{snapshot};
+    ASSERT_TRUE(loaded.loadSnapshot(in));
+
+    EXPECT_EQ(saved.size(), loaded.size());
+    EXPECT_FALSE(loaded.contains("NOT IN THE SNAPSHOT"));
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string word = "WORD" + std::to_string(i * 7919 % 100003);
+        EXPECT_TRUE(loaded.contains(word)) << word;
+    }
+
+    // Saving the loaded set again gives exactly the same snapshot, so the
+    // buckets and the order of their chains are the same.
+    EXPECT_EQ(snapshot, snapshotOf(loaded));
+
+    // A set loaded from a snapshot can be added to like any other.
+    loaded.add("WORD");
+    EXPECT_TRUE(loaded.contains("WORD"));
+    EXPECT_EQ(saved.size() + 1, loaded.size());
+}
+
+
+TEST(SetSnapshotTests, hashSetOfTriviallyCopyableElements)
+{
+    HashSet<int> saved{[](const int& i) { return static_cast<unsigned int>(i) * 2654435761u; }};
+
+    for (int i = -500; i < 500; i += 3)
+    {
+        saved.add(i);
+    }
+
+    std::stringstream snapshot;
+    ASSERT_TRUE(saved.saveSnapshot(snapshot));
+
+    HashSet<int> loaded{[](const int& i) { return static_cast<unsigned int>(i) * 2654435761u; }};
+    ASSERT_TRUE(loaded.loadSnapshot(snapshot));
+
+    EXPECT_EQ(saved.size(), loaded.size());
+    EXPECT_TRUE(loaded.contains(-500));
+    EXPECT_TRUE(loaded.contains(499));
+    EXPECT_FALSE(loaded.contains(0));
+}
+
+
+TEST(SetSnapshotTests, avlSetIsLoadedInSameShape)
+{
+    expectLoadedInSameShape<AVLSet<std::string>>(snapshotOf(manyWords()));
+}
+
+
+TEST(SetSnapshotTests, bstSetIsLoadedInSameShape)
+{
+    expectLoadedInSameShape<BSTSet<std::string>>(snapshotOf(AVLSet<std::string>{}));
+}
+
+
+TEST(SetSnapshotTests, skipListSetIsLoadedInSameShape)
+{
+    expectLoadedInSameShape<SkipListSet<std::string>>(snapshotOf(BSTSet<std::string>{}));
+}
+
+
+TEST(SetSnapshotTests, refusesSnapshotsThatDoNotFit)
+{
+    std::string snapshot = snapshotOf(manyWords());
+
+    HashSet<std::string> loaded{hashStringAsProduct};
+    loaded.add("BOO");
+
+    auto expectRefused =
+        [&](const std::string& contents)
+        {
+            std::istringstream in{contents};
+            EXPECT_FALSE(loaded.loadSnapshot(in));
+            EXPECT_EQ(1u, loaded.size());
+            EXPECT_TRUE(loaded.contains("BOO"));
+        };
+
+    expectRefused("");
+    expectRefused("BOO\nIS\nHAPPY\n");
+    expectRefused(snapshot.substr(0, snapshot.size() - 1));
+    expectRefused(snapshot.substr(0, snapshot.size() / 2));
+
+    std::string otherKind = snapshot;
+    otherKind.replace(8, 4, std::string{"AVL\0", 4});
+    expectRefused(otherKind);
+
+    std::string otherVersion = snapshot;
+    otherVersion[16] ^= 0x7F;
+    expectRefused(otherVersion);
+
+    // A set with another hash function would look for the elements in
+    // the wrong buckets.
+    HashSet<std::string> otherHash{hashStringAsSum};
+    std::istringstream in{snapshot};
+    EXPECT_FALSE(otherHash.loadSnapshot(in));
+    EXPECT_EQ(0u, otherHash.size());
+}
+
+
+TEST(SetSnapshotTests, refusesTreesThatAreOutOfOrderOrUnbalanced)
+{
+    // Writes a snapshot of a tree of the given kind whose nodes, in
+    // preorder, say which children they have (1 for a left child, 2 for
+    // a right one), their height, which only AVL trees store, and their
+    // key.
+    auto treeSnapshot =
+        [](const char* kind, const std::vector<std::tuple<std::uint8_t, int, int>>& nodes)
+        {
+            std::ostringstream out;
+            writeSnapshotHeader(out, kind);
+            writeSnapshotInteger<std::uint32_t>(out, nodes.size());
+
+            for (const auto& [children, height, key] : nodes)
+            {
+                writeSnapshotInteger(out, children);
+
+                if (std::string{kind} == "AVL")
+                {
+                    writeSnapshotLength(out, height);
+                }
+
+                writeSnapshotElement(out, key);
+            }
+
+            return out.str();
+        };
+
+    auto loads =
+        [](Set<int>& loaded, const std::string& snapshot)
+        {
+            std::istringstream in{snapshot};
+            bool result = loaded.loadSnapshot(in);
+            EXPECT_EQ(result ? 3u : 1u, loaded.size());
+            return result;
+        };
+
+    {
+        AVLSet<int> loaded;
+        loaded.add(42);
+        EXPECT_FALSE(loads(loaded, treeSnapshot("AVL", {{3, 1, 2}, {0, 0, 3}, {0, 0, 1}})));
+        EXPECT_FALSE(loads(loaded, treeSnapshot("AVL", {{3, 2, 2}, {0, 0, 1}, {0, 0, 3}})));
+        EXPECT_FALSE(loads(loaded, treeSnapshot("AVL", {{2, 2, 1}, {2, 1, 2}, {0, 0, 3}})));
+        EXPECT_TRUE(loaded.contains(42));
+
+        EXPECT_TRUE(loads(loaded, treeSnapshot("AVL", {{3, 1, 2}, {0, 0, 1}, {0, 0, 3}})));
+        EXPECT_TRUE(loaded.contains(1) && loaded.contains(2) && loaded.contains(3));
+    }
+
+    {
+        // A binary search tree doesn't have to be balanced, only in order.
+        BSTSet<int> loaded;
+        loaded.add(42);
+        EXPECT_FALSE(loads(loaded, treeSnapshot("BST", {{2, 0, 1}, {2, 0, 3}, {0, 0, 2}})));
+        EXPECT_TRUE(loaded.contains(42));
+
+        EXPECT_TRUE(loads(loaded, treeSnapshot("BST", {{2, 0, 1}, {2, 0, 2}, {0, 0, 3}})));
+        EXPECT_TRUE(loaded.contains(1) && loaded.contains(2) && loaded.contains(3));
+    }
+}
+
+
+TEST(SetSnapshotTests, setsWithoutSnapshotsSaySo)
+{
+    EmptySet<std::string> empty;
+    std::ostringstream out;
+    EXPECT_FALSE(empty.saveSnapshot(out));
+
+    std::istringstream in{snapshotOf(manyWords())};
+    EXPECT_FALSE(empty.loadSnapshot(in));
+}
+
+
+TEST(SetSnapshotTests, snapshotFilesAreRecognized)
+{
+    std::string path = testing::TempDir() + "SetSnapshotTests.snapshot";
+
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        EXPECT_TRUE(manyWords().saveSnapshot(out));
+    }
+
+    EXPECT_TRUE(isSetSnapshot(path));
+    EXPECT_FALSE(isSetSnapshot("wordset.txt"));
+    EXPECT_FALSE(isSetSnapshot(testing::TempDir() + "no-such-file"));
+
+    std::ifstream in{path, std::ios::binary};
+    HashSet<std::string> loaded{hashStringAsProduct};
+    EXPECT_TRUE(loaded.loadSnapshot(in));
+    EXPECT_EQ(manyWords().size(), loaded.size());
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,220 @@
+// SpellCheckServerTests.cpp
+//
+// Unit tests checking that a SpellCheckServer answers its clients' requests
+// the same way a WordChecker and SpellChecker would have, whether they come
+// one at a time or from many clients at once, that it picks up a reloaded
+// dictionary, and that clients that break the protocol are disconnected
+// without disturbing the others.
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "Dictionary.hpp"
+#include "HashSet.hpp"
+#include "MappedTextFileReader.hpp"
+#include "OutputSpellCheckerListener.hpp"
+#include "SpellChecker.hpp"
+#include "SpellCheckClient.hpp"
+#include "SpellCheckProtocol.hpp"
+#include "SpellCheckServer.hpp"
+#include "StringHashing.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    std::shared_ptr<const Dictionary> dictionaryOf(const std::vector<std::string>& words)
+    {
+        std::unique_ptr<Set<std::string>> wordSet =
+            std::make_unique<HashSet<std::string>>(hashStringAsProduct);
+
+        for (const std::string& word : words)
+        {
+            wordSet->add(word);
+        }
+
+        return std::make_shared<Dictionary>(std::move(wordSet));
+    }
+
+
+    // Runs a server on a thread of its own for as long as it exists.
+    class RunningServer
+    {
+    public:
+        explicit RunningServer(DictionaryHandle& dictionary)
+            : socketPath{testing::TempDir() + "SpellCheckServerTests.sock"},
+              server{dictionary, socketPath},
+              thread{[this]() { server.run(); }}
+        {
+        }
+
+
+        ~RunningServer()
+        {
+            server.stop();
+            thread.join();
+        }
+
+
+        std::string socketPath;
+        SpellCheckServer server;
+        std::thread thread;
+    };
+
+
+    const std::vector<std::string> words = {"BOO", "BOOT", "IS", "HAPPY", "TODAY"};
+}
+
+
+TEST(SpellCheckServerTests, answersRequestsLikeAWordChecker)
+{
+    DictionaryHandle dictionary{dictionaryOf(words)};
+    RunningServer running{dictionary};
+    ASSERT_TRUE(running.server.isListening());
+
+    SpellCheckClient client{running.socketPath};
+    ASSERT_TRUE(client.isConnected());
+
+    std::vector<bool> exists;
+    ASSERT_TRUE(client.checkWords({"BOO", "BOX", "HAPPY", ""}, exists));
+    EXPECT_EQ((std::vector<bool>{true, false, true, false}), exists);
+
+    ASSERT_TRUE(client.checkWords({}, exists));
+    EXPECT_TRUE(exists.empty());
+
+    WordChecker local{dictionary.current()};
+    std::vector<std::vector<std::string>> suggestions;
+    ASSERT_TRUE(client.findSuggestions({"BOX", "HAPY", "QQQQQQ"}, suggestions));
+    ASSERT_EQ(3u, suggestions.size());
+    EXPECT_EQ(local.findSuggestions("BOX"), suggestions[0]);
+    EXPECT_EQ(local.findSuggestions("HAPY"), suggestions[1]);
+    EXPECT_TRUE(suggestions[2].empty());
+
+    std::string text = "Boo is hapy\ntoday, boot or no bot.\n";
+    std::ostringstream expected;
+    SpellChecker spellChecker;
+    std::shared_ptr<OutputSpellCheckerListener> output =
+        std::make_shared<OutputSpellCheckerListener>(expected);
+    spellChecker.addObserver(output);
+    MappedTextFileReader reader{text.data(), text.data() + text.size()};
+    spellChecker.run(local, reader);
+
+    std::string misspellings;
+    ASSERT_TRUE(client.checkText(text, misspellings));
+    EXPECT_EQ(expected.str(), misspellings);
+    EXPECT_NE(std::string::npos, misspellings.find("HAPY"));
+
+    EXPECT_EQ(4u, running.server.requestCount());
+}
+
+
+TEST(SpellCheckServerTests, servesManyClientsAtOnce)
+{
+    DictionaryHandle dictionary{dictionaryOf(words)};
+    RunningServer running{dictionary};
+
+    std::vector<std::thread> clients;
+    std::vector<unsigned int> wrong(8, 0);
+
+    for (unsigned int c = 0; c < 8; ++c)
+    {
+        clients.emplace_back(
+            [&, c]()
+            {
+                SpellCheckClient client{running.socketPath};
+
+                for (unsigned int i = 0; i < 100; ++i)
+                {
+                    std::vector<bool> exists;
+
+                    if (!client.checkWords({words[(c + i) % words.size()], "NOPE"}, exists)
+                        || exists != std::vector<bool>{true, false})
+                    {
+                        ++wrong[c];
+                    }
+                }
+            });
+    }
+
+    for (std::thread& client : clients)
+    {
+        client.join();
+    }
+
+    EXPECT_EQ(std::vector<unsigned int>(8, 0), wrong);
+    EXPECT_EQ(800u, running.server.requestCount());
+    EXPECT_LE(running.server.batchCount(), running.server.requestCount());
+}
+
+
+TEST(SpellCheckServerTests, picksUpReloadedDictionaries)
+{
+    DictionaryHandle dictionary{dictionaryOf(words)};
+    RunningServer running{dictionary};
+    SpellCheckClient client{running.socketPath};
+
+    std::vector<bool> exists;
+    ASSERT_TRUE(client.checkWords({"BOO", "ZOTBOT"}, exists));
+    EXPECT_EQ((std::vector<bool>{true, false}), exists);
+
+    dictionary.reloadInBackground([]() { return dictionaryOf({"ZOTBOT"}); });
+    ASSERT_TRUE(dictionary.waitForReload());
+
+    ASSERT_TRUE(client.checkWords({"BOO", "ZOTBOT"}, exists));
+    EXPECT_EQ((std::vector<bool>{false, true}), exists);
+}
+
+
+TEST(SpellCheckServerTests, disconnectsClientsThatBreakTheProtocol)
+{
+    DictionaryHandle dictionary{dictionaryOf(words)};
+    RunningServer running{dictionary};
+
+    SpellCheckClient wellBehaved{running.socketPath};
+
+    // An unknown kind of request, sent ahead of a valid one, gets the
+    // connection closed without either being answered.
+    int badSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(badSocket, 0);
+
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        running.socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+        ASSERT_EQ(0, connect(badSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+    }
+
+    std::string frames;
+    appendFrame(frames, "XBOO");
+    appendFrame(frames, "WBOO");
+    ASSERT_EQ(static_cast<ssize_t>(frames.size()), send(badSocket, frames.data(), frames.size(), 0));
+
+    std::string response;
+    EXPECT_FALSE(receiveFrame(badSocket, response));
+    close(badSocket);
+
+    std::vector<bool> exists;
+    ASSERT_TRUE(wellBehaved.checkWords({"BOO"}, exists));
+    EXPECT_EQ(std::vector<bool>{true}, exists);
+}
+
+
+TEST(SpellCheckServerTests, shutsDownWhenAsked)
+{
+    DictionaryHandle dictionary{dictionaryOf(words)};
+    std::string socketPath = testing::TempDir() + "SpellCheckServerTests.sock";
+    SpellCheckServer server{dictionary, socketPath};
+    std::thread thread{[&]() { server.run(); }};
+
+    SpellCheckClient client{socketPath};
+    EXPECT_TRUE(client.shutdownServer());
+    thread.join();
+
+    EXPECT_FALSE(SpellCheckClient{testing::TempDir() + "no-such-socket"}.isConnected());
+}
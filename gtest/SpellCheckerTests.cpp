@@ -0,0 +1,333 @@
+// SpellCheckerTests.cpp
+//
+// Unit tests checking that SpellChecker::runParallel() reports the same
+// misspellings, in the same order, as SpellChecker::run(), no matter how
+// the text is split into chunks or how many threads check them, and that
+// SpellChecker::runPipelined() does too, whatever it reads from.  Each of
+// them reports its misspellings in batches, which listeners that only
+// care about one misspelling at a time see one at a time.
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+#include "MappedTextFileReader.hpp"
+#include "SpellChecker.hpp"
+#include "StreamTextReader.hpp"
+#include "StringHashing.hpp"
+#include "ThreadPool.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    class RecordingListener : public SpellCheckerListener
+    {
+    public:
+        void misspellingFound(
+            const std::string& word, const std::string& line,
+            const std::vector<std::string>& suggestions) override
+        {
+            std::string record = word + "|" + line + "|";
+
+            for (const std::string& suggestion : suggestions)
+            {
+                record += suggestion + ",";
+            }
+
+            records.push_back(record);
+        }
+
+
+        void misspellingFoundInContext(
+            const WordContext& context, const std::vector<std::string>& suggestions) override
+        {
+            misspellingFound(std::string{context.word}, std::string{context.text}, suggestions);
+
+            records.back() += "@" + std::to_string(context.offset)
+                + " " + std::to_string(context.lineNumber) + ":" + std::to_string(context.column);
+        }
+
+        std::vector<std::string> records;
+    };
+
+
+    class BatchRecordingListener : public RecordingListener
+    {
+    public:
+        void misspellingsFound(const std::vector<MisspellingRecord>& misspellings) override
+        {
+            batchSizes.push_back(misspellings.size());
+
+            for (const MisspellingRecord& misspelling : misspellings)
+            {
+                EXPECT_EQ(misspelling.word.data(), misspelling.context.word.data());
+                misspellingFoundInContext(misspelling.context, misspelling.suggestions);
+            }
+        }
+
+        std::vector<size_t> batchSizes;
+    };
+
+
+    const std::vector<std::string> dictionary =
+    {
+        "THE", "BOO", "IS", "HAPPY", "TODAY", "AND", "SO", "ARE", "WE", "BOOT", "BOOK"
+    };
+
+    const std::vector<std::string> misspelled =
+    {
+        "TEH", "BOOO", "HAPY", "TODYA", "ADN", "BOKO", "WEE", "AR"
+    };
+
+
+    std::string randomText(std::mt19937& engine, unsigned int lines)
+    {
+        std::string text;
+
+        for (unsigned int i = 0; i < lines; ++i)
+        {
+            unsigned int words = engine() % 8;
+
+            for (unsigned int j = 0; j < words; ++j)
+            {
+                const std::vector<std::string>& source =
+                    engine() % 4 == 0 ? misspelled : dictionary;
+
+                text += source[engine() % source.size()];
+                text += j + 1 < words ? " " : ".";
+            }
+
+            text += "\n";
+        }
+
+        return text;
+    }
+
+
+    std::vector<std::string> check(
+        const WordChecker& wordChecker, const std::string& text,
+        ThreadPool* pool, size_t chunkSize)
+    {
+        SpellChecker spellChecker;
+        std::shared_ptr<RecordingListener> listener = std::make_shared<RecordingListener>();
+        spellChecker.addObserver(listener);
+
+        if (pool != nullptr)
+        {
+            spellChecker.runParallel(wordChecker, text, *pool, chunkSize);
+        }
+        else
+        {
+            MappedTextFileReader reader{text.data(), text.data() + text.size()};
+            spellChecker.run(wordChecker, reader);
+        }
+
+        EXPECT_EQ(listener->records.size(), spellChecker.misspellingCount());
+        return listener->records;
+    }
+}
+
+
+TEST(SpellCheckerTests, parallelRunReportsMisspellingsInDocumentOrder)
+{
+    HashSet<std::string> words{hashStringAsProduct};
+
+    for (const std::string& word : dictionary)
+    {
+        words.add(word);
+    }
+
+    WordChecker wordChecker{words};
+    std::mt19937 engine{34};
+
+    std::string text = randomText(engine, 500);
+    std::vector<std::string> expected = check(wordChecker, text, nullptr, 0);
+    ASSERT_FALSE(expected.empty());
+
+    for (unsigned int threads : {0, 1, 3})
+    {
+        ThreadPool pool{threads};
+
+        for (size_t chunkSize : {1, 7, 100, 4096, 1 << 20})
+        {
+            EXPECT_EQ(expected, check(wordChecker, text, &pool, chunkSize))
+                << threads << " threads, chunks of " << chunkSize;
+        }
+    }
+}
+
+
+TEST(SpellCheckerTests, lastLineNeedNotEndWithNewline)
+{
+    HashSet<std::string> words{hashStringAsProduct};
+    words.add("BOO");
+
+    WordChecker wordChecker{words};
+    ThreadPool pool{2};
+    std::string text = "boo\nbooo boo\nboo teh";
+
+    EXPECT_EQ(check(wordChecker, text, nullptr, 0), check(wordChecker, text, &pool, 2));
+}
+
+
+
+TEST(SpellCheckerTests, reportsWhereMisspellingsWereFound)
+{
+    HashSet<std::string> words{hashStringAsProduct};
+    words.add("BOO");
+
+    WordChecker wordChecker{words};
+    ThreadPool pool{2};
+    std::string text = "boo\nbooo boo\nboo teh";
+
+    std::vector<std::string> expected = {"BOOO|booo boo|BOO,@4 2:1", "TEH|boo teh|@17 3:5"};
+
+    EXPECT_EQ(expected, check(wordChecker, text, nullptr, 0));
+    EXPECT_EQ(expected, check(wordChecker, text, &pool, 2));
+}
+
+
+TEST(SpellCheckerTests, pipelinedRunReportsTheSameMisspellingsAsRun)
+{
+    HashSet<std::string> words{hashStringAsProduct};
+
+    for (const std::string& word : dictionary)
+    {
+        words.add(word);
+    }
+
+    WordChecker wordChecker{words};
+    std::mt19937 engine{48};
+
+    std::string text = randomText(engine, 5000);
+    std::vector<std::string> expected = check(wordChecker, text, nullptr, 0);
+    ASSERT_FALSE(expected.empty());
+
+    for (unsigned int suggestingThreads : {1, 3})
+    {
+        SpellChecker spellChecker;
+        std::shared_ptr<RecordingListener> listener = std::make_shared<RecordingListener>();
+        spellChecker.addObserver(listener);
+
+        MappedTextFileReader reader{text.data(), text.data() + text.size()};
+        spellChecker.runPipelined(wordChecker, reader, suggestingThreads);
+
+        EXPECT_EQ(expected, listener->records) << suggestingThreads << " suggesting threads";
+        EXPECT_EQ(expected.size(), spellChecker.misspellingCount());
+
+        const std::vector<SpellChecker::PipelineStageStatistics>& stages =
+            spellChecker.pipelineStatistics();
+
+        ASSERT_EQ(4u, stages.size());
+        EXPECT_EQ("read", stages[0].name);
+        EXPECT_EQ(stages[0].words, stages[1].words);
+        EXPECT_EQ(expected.size(), stages[2].words);
+        EXPECT_EQ(suggestingThreads, stages[2].threads);
+        EXPECT_EQ(expected.size(), stages[3].words);
+        EXPECT_LE(stages[1].maximumQueueDepth, stages[1].queueCapacity);
+    }
+
+    // A stream's lines don't stay valid, so their text has to be copied
+    // to go from one stage to the next.
+    std::string path = testing::TempDir() + "SpellCheckerTests.txt";
+    std::ofstream{path, std::ios::binary | std::ios::trunc} << text;
+
+    SpellChecker streamChecker;
+    std::shared_ptr<RecordingListener> streamListener = std::make_shared<RecordingListener>();
+    streamChecker.addObserver(streamListener);
+
+    StreamTextReader streamReader{path, 256};
+    streamChecker.runPipelined(wordChecker, streamReader, 2);
+
+    EXPECT_EQ(expected, streamListener->records);
+    std::remove(path.c_str());
+}
+
+
+TEST(SpellCheckerTests, pipelinedRunStopsWhenAnObserverThrows)
+{
+    class ThrowingListener : public SpellCheckerListener
+    {
+    public:
+        void misspellingFound(
+            const std::string&, const std::string&,
+            const std::vector<std::string>&) override
+        {
+            throw std::runtime_error{"observer failed"};
+        }
+    };
+
+    HashSet<std::string> words{hashStringAsProduct};
+    words.add("BOO");
+
+    WordChecker wordChecker{words};
+    std::mt19937 engine{49};
+    std::string text = randomText(engine, 5000);
+
+    SpellChecker spellChecker;
+    std::shared_ptr<ThrowingListener> listener = std::make_shared<ThrowingListener>();
+    spellChecker.addObserver(listener);
+
+    MappedTextFileReader reader{text.data(), text.data() + text.size()};
+    EXPECT_THROW(spellChecker.runPipelined(wordChecker, reader), std::runtime_error);
+
+    // Only the first batch was reported before the observer threw.
+    ASSERT_EQ(4u, spellChecker.pipelineStatistics().size());
+    EXPECT_EQ(1u, spellChecker.pipelineStatistics()[3].batches);
+    EXPECT_EQ(spellChecker.pipelineStatistics()[3].words, spellChecker.misspellingCount());
+}
+
+
+TEST(SpellCheckerTests, reportsMisspellingsInBatches)
+{
+    HashSet<std::string> words{hashStringAsProduct};
+
+    for (const std::string& word : dictionary)
+    {
+        words.add(word);
+    }
+
+    WordChecker wordChecker{words};
+    std::mt19937 engine{49};
+
+    std::string text = randomText(engine, 2000);
+    std::vector<std::string> expected = check(wordChecker, text, nullptr, 0);
+    ASSERT_FALSE(expected.empty());
+
+    ThreadPool pool{2};
+
+    for (const std::string how : {"run", "runParallel", "runPipelined"})
+    {
+        SpellChecker spellChecker;
+        std::shared_ptr<BatchRecordingListener> listener = std::make_shared<BatchRecordingListener>();
+        spellChecker.addObserver(listener);
+
+        MappedTextFileReader reader{text.data(), text.data() + text.size()};
+
+        if (how == "run")
+        {
+            spellChecker.run(wordChecker, reader);
+        }
+        else if (how == "runParallel")
+        {
+            spellChecker.runParallel(wordChecker, text, pool, 4096);
+        }
+        else
+        {
+            spellChecker.runPipelined(wordChecker, reader, 2);
+        }
+
+        EXPECT_EQ(expected, listener->records) << how;
+        EXPECT_LT(listener->batchSizes.size(), expected.size()) << how;
+
+        for (size_t batchSize : listener->batchSizes)
+        {
+            EXPECT_GT(batchSize, 0u) << how;
+        }
+    }
+}
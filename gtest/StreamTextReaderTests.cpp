@@ -0,0 +1,197 @@
+// StreamTextReaderTests.cpp
+//
+// Unit tests checking that StreamTextReader reads the same words as
+// TextFileReader, whatever the size of its buffer and wherever it breaks
+// a long line of UTF-8 text, and that it knows when reading from a pipe
+// may have to wait.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "StreamTextReader.hpp"
+#include "TextFileReader.hpp"
+
+
+namespace
+{
+    const std::string tricky =
+        "Boo is happy today!\n"
+        "\n"
+        "  don't-stop re-entry ''quoted'' trailing- 'lead\r\n"
+        "x--y a' b- 42nd -- ' 9\n"
+        "a rather longer line, so that small buffers have to break it into pieces\n"
+        "last line without newline";
+
+
+    const std::string multibyte =
+        "Été à la façade naïve, Ωμέγα και Привет мир 日本語 Ærøskøbing "
+        "crème-brûlée and über straße, l'été São Paulo ĳssel ﬁne Ｆｕｌｌ\n";
+
+
+    std::string writeTempFile(const std::string& contents)
+    {
+        std::string path = testing::TempDir() + "StreamTextReaderTests.txt";
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+
+
+    std::vector<std::string> readWords(WordReader& reader)
+    {
+        std::vector<std::string> words;
+
+        while (!reader.noMoreWords())
+        {
+            words.emplace_back(reader.currentWordView());
+            reader.advanceToNextWord();
+        }
+
+        return words;
+    }
+
+
+    std::vector<std::string> readLines(WordReader& reader)
+    {
+        std::vector<std::string> lines;
+
+        while (!reader.noMoreWords())
+        {
+            lines.push_back(
+                std::to_string(reader.currentLineNumber()) + ":"
+                + std::string{reader.currentLineView()});
+
+            reader.advanceToNextWord();
+        }
+
+        return lines;
+    }
+}
+
+
+TEST(StreamTextReaderTests, readsSameWordsAndLinesAsTextFileReader)
+{
+    std::string path = writeTempFile(tricky);
+
+    TextFileReader expectedReader{path};
+    std::vector<std::string> expected = readLines(expectedReader);
+
+    StreamTextReader pathReader{path};
+    EXPECT_EQ(expected, readLines(pathReader));
+
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    ASSERT_NE(nullptr, file);
+    StreamTextReader fileReader{file};
+    EXPECT_EQ(expected, readLines(fileReader));
+    std::fclose(file);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(StreamTextReaderTests, smallBuffersBreakLongLinesBetweenWords)
+{
+    std::string path = writeTempFile(tricky);
+
+    TextFileReader expectedReader{path};
+    std::vector<std::string> expected = readWords(expectedReader);
+
+    for (size_t bufferSize : {12, 13, 16, 31, 64})
+    {
+        StreamTextReader reader{path, bufferSize};
+        EXPECT_EQ(expected, readWords(reader)) << "buffer of " << bufferSize;
+
+        StreamTextReader smallBlockReader{path, bufferSize, 5};
+        EXPECT_EQ(expected, readWords(smallBlockReader)) << "buffer of " << bufferSize;
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        StreamTextReader fdReader{fd, bufferSize};
+        EXPECT_EQ(expected, readWords(fdReader)) << "buffer of " << bufferSize;
+        ::close(fd);
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(StreamTextReaderTests, longUtf8LinesAreBrokenBetweenWords)
+{
+    std::string path = writeTempFile(multibyte);
+
+    TextFileReader expectedReader{path};
+    std::vector<std::string> expected = readWords(expectedReader);
+
+    // Every buffer size in this range puts the end of the buffer inside
+    // a multibyte character, or just after one, somewhere in the line.
+    for (size_t bufferSize = 20; bufferSize <= 48; ++bufferSize)
+    {
+        StreamTextReader reader{path, bufferSize};
+        EXPECT_EQ(expected, readWords(reader)) << "buffer of " << bufferSize;
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(StreamTextReaderTests, wordsLongerThanTheBufferAreNotBrokenInsideACharacter)
+{
+    std::string path = writeTempFile("ééééééééééééééé Привееееееет\n");
+
+    for (size_t bufferSize : {7, 8, 9, 10, 11})
+    {
+        StreamTextReader reader{path, bufferSize};
+        std::string words;
+
+        for (const std::string& word : readWords(reader))
+        {
+            words += word;
+        }
+
+        EXPECT_EQ("ÉÉÉÉÉÉÉÉÉÉÉÉÉÉÉПРИВЕЕЕЕЕЕЕТ", words) << "buffer of " << bufferSize;
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(StreamTextReaderTests, knowsWhenAPipeMayMakeItWait)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    ASSERT_EQ(13, ::write(fds[1], "hello wrold\nm", 13));
+
+    StreamTextReader reader{fds[0]};
+    ASSERT_EQ("HELLO", reader.currentWordView());
+    EXPECT_FALSE(reader.mayWaitForInput());
+
+    reader.advanceToNextWord();
+    ASSERT_EQ("WROLD", reader.currentWordView());
+    EXPECT_TRUE(reader.mayWaitForInput());
+
+    ASSERT_EQ(4, ::write(fds[1], "ore\n", 4));
+    ::close(fds[1]);
+
+    reader.advanceToNextWord();
+    EXPECT_EQ("MORE", reader.currentWordView());
+    EXPECT_EQ(2, reader.currentLineNumber());
+    EXPECT_FALSE(reader.mayWaitForInput());
+
+    reader.advanceToNextWord();
+    EXPECT_TRUE(reader.noMoreWords());
+
+    ::close(fds[0]);
+}
+
+
+TEST(StreamTextReaderTests, fileThatCannotBeOpenedHasNoWords)
+{
+    StreamTextReader reader{testing::TempDir() + "StreamTextReaderTests-missing.txt"};
+
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_TRUE(reader.noMoreWords());
+}
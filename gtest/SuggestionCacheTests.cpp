@@ -0,0 +1,86 @@
+// SuggestionCacheTests.cpp
+//
+// Unit tests for the bounded LRU SuggestionCache, and for the way
+// WordChecker uses it.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ListSet.hpp"
+#include "SuggestionCache.hpp"
+#include "WordChecker.hpp"
+
+
+TEST(SuggestionCacheTests, findsWhatWasStored)
+{
+    SuggestionCache cache;
+    cache.store("BOO", {"BOOT", "BOOK"});
+
+    std::vector<std::string> suggestions;
+    EXPECT_TRUE(cache.find("BOO", suggestions));
+    EXPECT_EQ((std::vector<std::string>{"BOOT", "BOOK"}), suggestions);
+    EXPECT_FALSE(cache.find("IS", suggestions));
+
+    EXPECT_EQ(1u, cache.hits());
+    EXPECT_EQ(1u, cache.misses());
+}
+
+
+TEST(SuggestionCacheTests, evictsLeastRecentlyUsedEntry)
+{
+    SuggestionCache cache{2};
+    std::vector<std::string> suggestions;
+
+    cache.store("A", {});
+    cache.store("B", {});
+    EXPECT_TRUE(cache.find("A", suggestions));
+    cache.store("C", {});
+
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_TRUE(cache.find("A", suggestions));
+    EXPECT_FALSE(cache.find("B", suggestions));
+    EXPECT_TRUE(cache.find("C", suggestions));
+}
+
+
+TEST(SuggestionCacheTests, staysWithinByteBound)
+{
+    SuggestionCache cache{100, 1024};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        cache.store(std::to_string(i), {"SOME SUGGESTION THAT IS FAIRLY LONG"});
+    }
+
+    EXPECT_LE(cache.bytes(), 1024u);
+    EXPECT_GT(cache.size(), 0u);
+}
+
+
+TEST(SuggestionCacheTests, validateClearsOnNewGeneration)
+{
+    SuggestionCache cache;
+    std::vector<std::string> suggestions;
+
+    cache.validate(1);
+    cache.store("BOO", {"BOOT"});
+    cache.validate(1);
+    EXPECT_TRUE(cache.find("BOO", suggestions));
+    cache.validate(2);
+    EXPECT_FALSE(cache.find("BOO", suggestions));
+}
+
+
+TEST(SuggestionCacheTests, wordCheckerInvalidatesWhenWordsAreAdded)
+{
+    ListSet<std::string> words;
+    words.add("BOOT");
+    WordChecker checker{words};
+
+    EXPECT_EQ((std::vector<std::string>{"BOOT"}), checker.findSuggestions("BOO"));
+    EXPECT_EQ((std::vector<std::string>{"BOOT"}), checker.findSuggestions("BOO"));
+    EXPECT_EQ(1u, checker.suggestionCache().hits());
+
+    words.add("BOOK");
+    EXPECT_EQ((std::vector<std::string>{"BOOK", "BOOT"}), checker.findSuggestions("BOO"));
+}
@@ -0,0 +1,102 @@
+// ThreadPoolTests.cpp
+//
+// Unit tests for ThreadPool.
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ThreadPool.hpp"
+
+
+TEST(ThreadPoolTests, runsEveryTask)
+{
+    ThreadPool pool{3};
+    std::vector<int> results(100, 0);
+    std::vector<ThreadPool::Task> tasks;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        tasks.push_back([&results, i]() { results[i] = i * i; });
+    }
+
+    pool.runAll(tasks);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i * i, results[i]);
+    }
+}
+
+
+TEST(ThreadPoolTests, tasksCanRunBatchesOfTheirOwn)
+{
+    ThreadPool pool{2};
+    std::atomic<int> count{0};
+    std::vector<ThreadPool::Task> outer;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        outer.push_back(
+            [&]()
+            {
+                std::vector<ThreadPool::Task> inner(8, [&]() { ++count; });
+                pool.runAll(inner);
+            });
+    }
+
+    pool.runAll(outer);
+    EXPECT_EQ(64, count.load());
+}
+
+
+TEST(ThreadPoolTests, tasksBehindABlockedTaskAreStolen)
+{
+    // Whichever thread runs the first task is stuck until every other task
+    // has run, including the ones dealt to its own queue.
+    ThreadPool pool{2};
+    std::atomic<int> count{0};
+    std::vector<ThreadPool::Task> tasks;
+
+    tasks.push_back(
+        [&]()
+        {
+            auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+
+            while (count < 8 && std::chrono::steady_clock::now() < giveUp)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+    for (int i = 0; i < 8; ++i)
+    {
+        tasks.push_back([&]() { ++count; });
+    }
+
+    pool.runAll(tasks);
+    EXPECT_EQ(8, count.load());
+    EXPECT_GT(pool.stealCount(), 0ul);
+}
+
+
+TEST(ThreadPoolTests, rethrowsExceptionsFromTasks)
+{
+    ThreadPool pool{2};
+    std::vector<ThreadPool::Task> tasks(4, []() { throw std::runtime_error{"boo"}; });
+
+    EXPECT_THROW(pool.runAll(tasks), std::runtime_error);
+}
+
+
+TEST(ThreadPoolTests, poolWithoutWorkersRunsOnCallingThread)
+{
+    ThreadPool pool{0};
+    int count = 0;
+    std::vector<ThreadPool::Task> tasks(5, [&]() { ++count; });
+
+    pool.runAll(tasks);
+    EXPECT_EQ(5, count);
+}
@@ -0,0 +1,178 @@
+// TreeSetTests.cpp
+//
+// Unit tests checking that an AVLSet and a BSTSet each contain exactly what
+// was added to them, in whatever order it was added (even when a BSTSet
+// degenerates into a list), that they copy and move correctly, and that
+// containsBatch() agrees with contains().
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "BSTSet.hpp"
+
+
+namespace
+{
+    // Every even number below 2 * count, in ascending order if sorted is
+    // true, or shuffled otherwise.
+    std::vector<int> evens(int count, bool sorted)
+    {
+        std::vector<int> numbers;
+
+        for (int i = 0; i < count; ++i)
+        {
+            numbers.push_back(2 * i);
+        }
+
+        if (!sorted)
+        {
+            std::shuffle(numbers.begin(), numbers.end(), std::mt19937{46});
+        }
+
+        return numbers;
+    }
+
+
+    template <typename TreeSet>
+    TreeSet setOf(const std::vector<int>& numbers)
+    {
+        TreeSet s;
+
+        for (int number : numbers)
+        {
+            s.add(number);
+        }
+
+        return s;
+    }
+
+
+    // Expects the set to contain the even numbers below 2 * count and
+    // none of the odd ones.
+    void expectEvens(const Set<int>& s, int count)
+    {
+        EXPECT_EQ(static_cast<unsigned int>(count), s.size());
+
+        for (int i = -1; i <= 2 * count; ++i)
+        {
+            EXPECT_EQ(i >= 0 && i < 2 * count && i % 2 == 0, s.contains(i)) << i;
+        }
+    }
+
+
+    // The same kind of tree as TreeSet, holding strings instead.
+    template <typename TreeSet>
+    struct StringsIn;
+
+    template <>
+    struct StringsIn<AVLSet<int>>
+    {
+        using type = AVLSet<std::string>;
+    };
+
+    template <>
+    struct StringsIn<BSTSet<int>>
+    {
+        using type = BSTSet<std::string>;
+    };
+}
+
+
+template <typename TreeSet>
+class TreeSetTests : public ::testing::Test
+{
+};
+
+using TreeSetTypes = ::testing::Types<AVLSet<int>, BSTSet<int>>;
+TYPED_TEST_SUITE(TreeSetTests, TreeSetTypes);
+
+
+TYPED_TEST(TreeSetTests, containsWhatWasAddedInAnyOrder)
+{
+    expectEvens(setOf<TypeParam>(evens(1000, false)), 1000);
+    expectEvens(setOf<TypeParam>(evens(1000, true)), 1000);
+}
+
+
+TYPED_TEST(TreeSetTests, addingAnElementAgainHasNoEffect)
+{
+    std::vector<int> numbers = evens(100, false);
+    TypeParam s = setOf<TypeParam>(numbers);
+
+    for (int number : numbers)
+    {
+        s.add(number);
+    }
+
+    expectEvens(s, 100);
+}
+
+
+TYPED_TEST(TreeSetTests, copiesAreIndependent)
+{
+    TypeParam original = setOf<TypeParam>(evens(100, false));
+    TypeParam copy{original};
+    copy.add(1);
+
+    TypeParam assigned;
+    assigned.add(3);
+    assigned = original;
+    assigned.add(5);
+
+    expectEvens(original, 100);
+    EXPECT_TRUE(copy.contains(1));
+    EXPECT_FALSE(copy.contains(5));
+    EXPECT_EQ(101u, copy.size());
+    EXPECT_FALSE(assigned.contains(3));
+    EXPECT_TRUE(assigned.contains(5));
+    EXPECT_EQ(101u, assigned.size());
+}
+
+
+TYPED_TEST(TreeSetTests, movingTakesTheElements)
+{
+    TypeParam original = setOf<TypeParam>(evens(100, false));
+    TypeParam moved{std::move(original)};
+    expectEvens(moved, 100);
+
+    TypeParam assigned;
+    assigned = std::move(moved);
+    expectEvens(assigned, 100);
+}
+
+
+TYPED_TEST(TreeSetTests, containsBatchAgreesWithContains)
+{
+    for (bool sorted : {false, true})
+    {
+        TypeParam s = setOf<TypeParam>(evens(1000, sorted));
+        std::vector<int> queries;
+
+        // More queries than fit in one window, some there and some not,
+        // so that lookups finish at different depths.
+        for (int i = -3; i < 2003; i += 3)
+        {
+            queries.push_back(i);
+        }
+
+        std::vector<bool> found = s.containsBatch(queries);
+        ASSERT_EQ(queries.size(), found.size());
+
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            EXPECT_EQ(s.contains(queries[i]), found[i]) << queries[i];
+        }
+    }
+
+    using Words = typename StringsIn<TypeParam>::type;
+
+    Words words;
+    words.add("Boo");
+    words.add("is");
+    EXPECT_EQ((std::vector<bool>{true, false, true}), words.containsBatch({"is", "happy", "Boo"}));
+    EXPECT_EQ(std::vector<bool>{false}, Words{}.containsBatch({"Boo"}));
+}
@@ -0,0 +1,108 @@
+// Utf8Tests.cpp
+//
+// Unit tests for UTF-8 decoding, encoding and case conversion, and for
+// WordSetLoader's use of it when loading word sets and frequencies.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+#include "StringHashing.hpp"
+#include "Utf8.hpp"
+#include "WordFrequencies.hpp"
+#include "WordSetLoader.hpp"
+
+
+TEST(Utf8Tests, decodesAndEncodesEveryLength)
+{
+    for (char32_t codePoint : { U'A', U'é', U'€', U'\U0001F600', U'\U0010FFFF' })
+    {
+        std::string text;
+        appendUtf8(codePoint, text);
+
+        size_t index = 0;
+        char32_t decoded = 0;
+        ASSERT_TRUE(decodeUtf8(text.data(), index, text.size(), decoded));
+        EXPECT_EQ(codePoint, decoded);
+        EXPECT_EQ(text.size(), index);
+    }
+}
+
+
+TEST(Utf8Tests, rejectsInvalidSequencesOneByteAtATime)
+{
+    for (const std::string& text : {
+            std::string{"\x80"}, std::string{"\xc0\xaf"}, std::string{"\xe0\x80\xaf"},
+            std::string{"\xed\xa0\x80"}, std::string{"\xf4\x90\x80\x80"},
+            std::string{"\xe2\x82"}, std::string{"\xff"}})
+    {
+        size_t index = 0;
+        char32_t codePoint;
+        EXPECT_FALSE(decodeUtf8(text.data(), index, text.size(), codePoint));
+        EXPECT_EQ(1u, index);
+    }
+}
+
+
+TEST(Utf8Tests, classifiesLettersMarksAndPunctuation)
+{
+    EXPECT_TRUE(isLetterOrDigit(U'7'));
+    EXPECT_TRUE(isLetterOrDigit(U'é'));
+    EXPECT_TRUE(isLetterOrDigit(U'Ω'));
+    EXPECT_TRUE(isLetterOrDigit(U'中'));
+
+    EXPECT_FALSE(isLetterOrDigit(U'́'));
+    EXPECT_TRUE(isWordCharacter(U'́'));
+    EXPECT_TRUE(isWordCharacter(U'\''));
+
+    for (char32_t codePoint : { U' ', U' ', U'¿', U'’', U'“', U'。' })
+    {
+        EXPECT_FALSE(isWordCharacter(codePoint));
+    }
+}
+
+
+TEST(Utf8Tests, uppercasesAsciiAndNonAsciiText)
+{
+    std::string uppercase;
+
+    uppercaseUtf8("hello, world-wide web's", uppercase);
+    EXPECT_EQ("HELLO, WORLD-WIDE WEB'S", uppercase);
+
+    uppercaseUtf8("straße été ωμέγα жёлтый \xff!", uppercase);
+    EXPECT_EQ("STRAßE ÉTÉ ΩΜΈΓΑ ЖЁЛТЫЙ \xff!", uppercase);
+}
+
+
+TEST(Utf8Tests, loaderUppercasesUtf8Words)
+{
+    std::string wordPath = testing::TempDir() + "Utf8Tests-words.txt";
+    std::string frequencyPath = testing::TempDir() + "Utf8Tests-frequencies.txt";
+
+    {
+        std::ofstream wordFile{wordPath, std::ios::binary | std::ios::trunc};
+        wordFile << "café\r\nnaïve\nplain\n";
+
+        std::ofstream frequencyFile{frequencyPath, std::ios::binary | std::ios::trunc};
+        frequencyFile << "café 12\nplain 3\n";
+    }
+
+    HashSet<std::string> words{hashStringAsProduct};
+    WordFrequencies frequencies;
+    WordSetLoader loader;
+
+    loader.load(wordPath, words);
+    loader.loadFrequencies(frequencyPath, frequencies);
+
+    EXPECT_TRUE(words.contains("CAFÉ"));
+    EXPECT_TRUE(words.contains("NAÏVE"));
+    EXPECT_TRUE(words.contains("PLAIN"));
+    EXPECT_FALSE(words.contains("CAFé"));
+
+    EXPECT_EQ(12u, frequencies.frequencyOf("CAFÉ"));
+    EXPECT_EQ(3u, frequencies.frequencyOf("PLAIN"));
+
+    std::remove(wordPath.c_str());
+    std::remove(frequencyPath.c_str());
+}
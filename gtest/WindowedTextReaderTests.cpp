@@ -0,0 +1,264 @@
+// WindowedTextReaderTests.cpp
+//
+// Unit tests checking that WindowedTextReader reads the same words as
+// TextFileReader, at the same offsets, lines and columns, whatever the
+// size of its window, and that the context it gives each word is the
+// same bounded piece of its line that wordContextInLine() would give,
+// however long the line is.
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <gtest/gtest.h>
+#include "TextFileReader.hpp"
+#include "WindowedTextReader.hpp"
+
+
+namespace
+{
+    const std::vector<std::string> samples =
+    {
+        "boo", "is", "happy", "today", "don't-stop", "re-entry", "''quoted''",
+        "trailing-", "x--y", "42nd", "caf\xC3\xA9", "na\xC3\xAFve", "--", "!"
+    };
+
+
+    // randomText() makes text with lines of very different lengths,
+    // including some far longer than the windows being tested.
+    std::string randomText(std::mt19937& engine, unsigned int words)
+    {
+        std::string text;
+
+        for (unsigned int i = 0; i < words; ++i)
+        {
+            text += samples[engine() % samples.size()];
+
+            unsigned int separator = engine() % 1000;
+            text += separator < 20 ? "\n" : separator < 22 ? "\n\n" : separator < 100 ? ", " : " ";
+        }
+
+        return text;
+    }
+
+
+    std::string writeTempFile(const std::string& name, const std::string& contents)
+    {
+        std::string path = testing::TempDir() + name;
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+
+
+    std::string gzip(const std::string& text)
+    {
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+
+        std::string compressed(deflateBound(&stream, text.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = text.size();
+        stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+        stream.avail_out = compressed.size();
+
+        deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        return compressed;
+    }
+
+
+    std::vector<std::string> splitLines(const std::string& text)
+    {
+        std::vector<std::string> lines;
+        size_t start = 0;
+
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', start);
+            end = end == std::string::npos ? text.size() : end;
+
+            lines.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+
+        return lines;
+    }
+
+
+    std::string describe(const WordContext& context)
+    {
+        return std::string{context.word}
+            + "@" + std::to_string(context.offset)
+            + " " + std::to_string(context.lineNumber) + ":" + std::to_string(context.column)
+            + " " + (context.lineContinuesBefore ? "..." : "")
+            + "[" + std::string{context.text.substr(0, context.wordStart)}
+            + "|" + std::string{context.text.substr(context.wordStart, context.wordEnd - context.wordStart)}
+            + "|" + std::string{context.text.substr(context.wordEnd)} + "]"
+            + (context.lineContinuesAfter ? "..." : "");
+    }
+
+
+    // expectedContexts() reads the words in the text with a TextFileReader,
+    // which holds whole lines, and finds each one's context in its whole
+    // line.
+    std::vector<std::string> expectedContexts(
+        const std::string& path, const std::string& text, size_t contextSize)
+    {
+        std::vector<std::string> lines = splitLines(text);
+        std::vector<std::string> contexts;
+
+        for (TextFileReader reader{path}; !reader.noMoreWords(); reader.advanceToNextWord())
+        {
+            WordContext context = reader.currentWordContext();
+            size_t wordStart = context.column - 1;
+
+            contexts.push_back(describe(wordContextInLine(
+                context.word, lines[context.lineNumber - 1],
+                wordStart, wordStart + context.wordEnd - context.wordStart,
+                context.offset - wordStart, context.lineNumber, contextSize)));
+        }
+
+        return contexts;
+    }
+
+
+    std::vector<std::string> readContexts(WordReader& reader)
+    {
+        std::vector<std::string> contexts;
+
+        while (!reader.noMoreWords())
+        {
+            contexts.push_back(describe(reader.currentWordContext()));
+            reader.advanceToNextWord();
+        }
+
+        return contexts;
+    }
+}
+
+
+TEST(WindowedTextReaderTests, readsSameWordsAndContextsAsWholeLines)
+{
+    std::mt19937 engine{46};
+    std::string text = randomText(engine, 20000);
+    std::string path = writeTempFile("WindowedTextReaderTests.txt", text);
+
+    for (size_t contextSize : {4, 16, 80})
+    {
+        std::vector<std::string> expected = expectedContexts(path, text, contextSize);
+
+        for (size_t windowSize : {0, 1000, 1 << 16})
+        {
+            for (size_t blockSize : {7, 4096})
+            {
+                WindowedTextReader reader{path, contextSize, windowSize, blockSize};
+                EXPECT_TRUE(reader.isOpen());
+                EXPECT_EQ(expected, readContexts(reader))
+                    << "context " << contextSize << ", window " << windowSize
+                    << ", blocks of " << blockSize;
+            }
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(WindowedTextReaderTests, giganticLinesHaveBoundedContexts)
+{
+    // A single line of several megabytes, with no newline at all.
+    std::string text;
+
+    while (text.size() < (4 << 20))
+    {
+        text += "spam eggs ";
+    }
+
+    std::string path = writeTempFile("WindowedTextReaderTests.txt", text);
+    WindowedTextReader reader{path, 20, 4096};
+
+    unsigned long long words = 0;
+    std::string lastWord;
+    WordContext last;
+
+    for (; !reader.noMoreWords(); reader.advanceToNextWord())
+    {
+        last = reader.currentWordContext();
+        lastWord = last.word;
+
+        ASSERT_LE(last.text.size(), 2 * 20 + 4u);
+        ASSERT_EQ(1u, last.lineNumber);
+        ASSERT_EQ(last.offset + 1, last.column);
+        ++words;
+    }
+
+    EXPECT_EQ(text.size() / 5, words);
+    EXPECT_EQ("EGGS", lastWord);
+    EXPECT_EQ(text.size() - 4, last.column);
+    EXPECT_TRUE(last.lineContinuesBefore);
+    EXPECT_FALSE(last.lineContinuesAfter);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(WindowedTextReaderTests, breaksWordsLongerThanTheWindow)
+{
+    std::string text = "short " + std::string(5000, 'x') + " end\n";
+    std::string path = writeTempFile("WindowedTextReaderTests.txt", text);
+
+    WindowedTextReader reader{path, 4, 0};
+    std::string longWord;
+    std::vector<std::string> others;
+
+    for (; !reader.noMoreWords(); reader.advanceToNextWord())
+    {
+        std::string word{reader.currentWordView()};
+
+        if (word[0] == 'X')
+        {
+            EXPECT_EQ(6 + longWord.size() + 1, reader.currentWordContext().column);
+            longWord += word;
+        }
+        else
+        {
+            others.push_back(word);
+        }
+    }
+
+    EXPECT_EQ(std::string(5000, 'X'), longWord);
+    EXPECT_EQ((std::vector<std::string>{"SHORT", "END"}), others);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(WindowedTextReaderTests, readsCompressedFiles)
+{
+    std::mt19937 engine{46};
+    std::string text = randomText(engine, 5000);
+    std::string plainPath = writeTempFile("WindowedTextReaderTests.txt", text);
+    std::string gzipPath = writeTempFile("WindowedTextReaderTests.txt.gz", gzip(text));
+
+    WindowedTextReader plainReader{plainPath, 16, 1000};
+    WindowedTextReader gzipReader{gzipPath, 16, 1000};
+
+    EXPECT_EQ(readContexts(plainReader), readContexts(gzipReader));
+
+    std::remove(plainPath.c_str());
+    std::remove(gzipPath.c_str());
+}
+
+
+TEST(WindowedTextReaderTests, filesThatCannotBeOpenedHaveNoWords)
+{
+    WindowedTextReader reader{testing::TempDir() + "no-such-file"};
+
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_TRUE(reader.noMoreWords());
+}
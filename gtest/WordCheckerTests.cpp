@@ -0,0 +1,183 @@
+// WordCheckerTests.cpp
+//
+// Unit tests for the behavior of WordChecker beyond the basic suggestion
+// algorithms: ranking, and the ways in which suggestions are generated.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+#include "ListSet.hpp"
+#include "ThreadPool.hpp"
+#include "WordChecker.hpp"
+#include "WordFrequencies.hpp"
+
+
+namespace
+{
+    // A ListSet that counts how many lookups it has been asked to do.
+    class CountingSet : public ListSet<std::string>
+    {
+    public:
+        bool contains(const std::string& element) const override
+        {
+            ++lookups;
+            return ListSet<std::string>::contains(element);
+        }
+
+        mutable unsigned int lookups = 0;
+    };
+}
+
+
+TEST(WordCheckerTests, suggestionsAreFoundInEditOrder)
+{
+    ListSet<std::string> words;
+    words.add("OBO");
+    words.add("BOOT");
+    words.add("BO");
+    words.add("BOA");
+    words.add("B");
+    words.add("OO");
+
+    WordChecker checker{words};
+
+    EXPECT_EQ(
+        (std::vector<std::string>{"OBO", "BOOT", "OO", "BO", "BOA", "B OO"}),
+        checker.findSuggestions("BOO"));
+}
+
+
+TEST(WordCheckerTests, rankingReturnsMostFrequentFirst)
+{
+    ListSet<std::string> words;
+    words.add("BOOT");
+    words.add("BOOK");
+    words.add("BOA");
+
+    WordFrequencies frequencies;
+    frequencies.set("BOOT", 10);
+    frequencies.set("BOOK", 500);
+    frequencies.set("BOA", 20);
+
+    WordChecker checker{words};
+    checker.setRanking(frequencies, 2);
+
+    EXPECT_EQ((std::vector<std::string>{"BOOK", "BOA"}), checker.findSuggestions("BOO"));
+
+    checker.clearRanking();
+    EXPECT_EQ((std::vector<std::string>{"BOOK", "BOOT", "BOA"}), checker.findSuggestions("BOO"));
+}
+
+
+TEST(WordCheckerTests, budgetedAndRankedSuggestionsAreCachedApart)
+{
+    ListSet<std::string> words;
+    words.add("BOOT");
+    words.add("BOOK");
+    words.add("BOOM");
+
+    WordFrequencies frequencies;
+    frequencies.set("BOOK", 500);
+
+    WordChecker checker{words};
+    checker.setRanking(frequencies, 1);
+
+    SuggestionBudget budget;
+    budget.probes = 1000000;
+    bool complete = false;
+
+    std::vector<std::string> unranked = checker.findSuggestions("BOO", budget, complete);
+    EXPECT_TRUE(complete);
+    EXPECT_EQ(3u, unranked.size());
+
+    EXPECT_EQ((std::vector<std::string>{"BOOK"}), checker.findSuggestions("BOO"));
+    EXPECT_EQ(unranked, checker.findSuggestions("BOO", budget, complete));
+    EXPECT_EQ((std::vector<std::string>{"BOOK"}), checker.findSuggestions("BOO"));
+}
+
+
+TEST(WordCheckerTests, rankingStopsOnceNoBetterSuggestionIsPossible)
+{
+    CountingSet words;
+    words.add("FORM");
+    words.add("FROM");
+
+    WordFrequencies frequencies;
+    frequencies.set("FROM", 1000);
+    frequencies.set("FORM", 10);
+
+    WordChecker checker{words};
+    checker.setRanking(frequencies, 1);
+
+    EXPECT_EQ((std::vector<std::string>{"FROM"}), checker.findSuggestions("FORM"));
+
+    // Swapping adjacent characters is the only kind of edit that was tried.
+    EXPECT_EQ(3u, words.lookups);
+}
+
+
+TEST(WordCheckerTests, parallelSuggestionsMatchSerialOrder)
+{
+    HashSet<std::string> words{[](const std::string& s) { return std::hash<std::string>{}(s); }};
+
+    for (const char* word : {"INTERNATIONAL", "INTERNATIONALS", "INTER", "NATIONAL",
+                             "INTERNATIONALLY", "INTERNATIONAL NATIONAL", "NATIONALS"})
+    {
+        words.add(word);
+    }
+
+    WordChecker serial{words};
+    std::vector<std::string> expected = serial.findSuggestions("INTERNATIONAL");
+
+    ThreadPool pool{3};
+    WordChecker parallel{words};
+    parallel.setThreadPool(pool, 0);
+
+    EXPECT_EQ(expected, parallel.findSuggestions("INTERNATIONAL"));
+    EXPECT_EQ(serial.findSuggestions("INTERNATINOAL"), parallel.findSuggestions("INTERNATINOAL"));
+}
+
+
+TEST(WordCheckerTests, incrementalSuggestionsMatchFindSuggestions)
+{
+    ListSet<std::string> words;
+    words.add("OBO");
+    words.add("BOOT");
+    words.add("BO");
+
+    WordChecker checker{words};
+    WordChecker::SuggestionGenerator generator = checker.findSuggestionsIncrementally("BOO");
+
+    std::vector<std::string> suggestions;
+    std::string suggestion;
+
+    while (generator.next(suggestion))
+    {
+        suggestions.push_back(suggestion);
+    }
+
+    EXPECT_TRUE(generator.complete());
+    EXPECT_FALSE(generator.budgetExhausted());
+    EXPECT_EQ(checker.findSuggestions("BOO"), suggestions);
+}
+
+
+TEST(WordCheckerTests, probeBudgetStopsSearchEarly)
+{
+    CountingSet words;
+    words.add("OBO");
+    words.add("BOOT");
+
+    WordChecker checker{words};
+
+    SuggestionBudget budget;
+    budget.probes = 2;
+
+    bool complete = true;
+    std::vector<std::string> suggestions = checker.findSuggestions("BOO", budget, complete);
+
+    EXPECT_FALSE(complete);
+    EXPECT_EQ((std::vector<std::string>{"OBO"}), suggestions);
+    EXPECT_EQ(2u, words.lookups);
+}
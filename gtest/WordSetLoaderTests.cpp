@@ -0,0 +1,223 @@
+// WordSetLoaderTests.cpp
+//
+// Unit tests checking that loading a word set normalizes each line the
+// same way, whether it's done in bulk, a whole file at a time, or using a
+// ThreadPool, and that the words are added in the same order, including
+// from a pipe, which can only be read once.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "BloomFilter.hpp"
+#include "Set.hpp"
+#include "ThreadPool.hpp"
+#include "Utf8.hpp"
+#include "WordSetLoader.hpp"
+
+
+namespace
+{
+    // A RecordingSet remembers every word added to it, in order.
+    class RecordingSet : public Set<std::string>
+    {
+    public:
+        bool isImplemented() const override
+        {
+            return true;
+        }
+
+        void add(const std::string& element) override
+        {
+            added.push_back(element);
+        }
+
+        bool contains(const std::string&) const override
+        {
+            return false;
+        }
+
+        unsigned int size() const override
+        {
+            return added.size();
+        }
+
+        std::vector<std::string> added;
+    };
+
+
+    // wordFile() makes a word file large enough to be split into several
+    // chunks, with a mixture of line endings, empty lines and non-ASCII
+    // words, and no newline at the end.
+    std::string wordFile()
+    {
+        const std::vector<std::string> samples =
+        {
+            "apple", "Banana", "caf\xC3\xA9", "na\xC3\xAFve", "don't", "x", "", "WORD"
+        };
+
+        std::mt19937 engine{41};
+        std::string contents;
+
+        for (int i = 0; i < 100000; ++i)
+        {
+            contents += samples[engine() % samples.size()] + std::to_string(i % 1000);
+            contents += engine() % 5 == 0 ? "\r\n" : "\n";
+        }
+
+        return contents + "last";
+    }
+
+
+    // normalizeLines() normalizes each line of a word file one at a time,
+    // the way the loader once did, to check the bulk normalization against.
+    std::vector<std::string> normalizeLines(const std::string& contents)
+    {
+        std::istringstream in{contents};
+        std::vector<std::string> words;
+        std::string line;
+
+        while (std::getline(in, line))
+        {
+            line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+
+            std::string word;
+            uppercaseUtf8(line, word);
+            words.push_back(word);
+        }
+
+        return words;
+    }
+
+
+    std::string writeTempFile(const std::string& contents)
+    {
+        std::string path = testing::TempDir() + "WordSetLoaderTests.txt";
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+        return path;
+    }
+}
+
+
+TEST(WordSetLoaderTests, normalizesEachLineLikeGetline)
+{
+    const std::vector<std::string> contents =
+    {
+        "",
+        "\n",
+        "\n\n\r\n",
+        "boo",
+        "boo\n",
+        "boo\r\nis\r\nhappy\r\n",
+        "a\rb\r\r\n\r",
+        "caf\xC3\xA9\nna\xC3\xAFve",
+        "an-ascii-line-longer-than-thirty-two-bytes-abcdefghijklmnopqrstuvwxyz\n"
+            "then-one-that-ends-with-caf\xC3\xA9-after-many-more-bytes-of-ascii\r\n"
+            "and an \xFF invalid byte, then 0123456789 {|}~ `@[\\]^_\n",
+        wordFile()
+    };
+
+    for (const std::string& content : contents)
+    {
+        std::string path = writeTempFile(content);
+
+        RecordingSet loaded;
+        WordSetLoader{}.load(path, loaded);
+
+        EXPECT_EQ(normalizeLines(content), loaded.added) << content.substr(0, 200);
+
+        std::remove(path.c_str());
+    }
+}
+
+
+TEST(WordSetLoaderTests, parallelLoadAddsSameWordsInSameOrder)
+{
+    std::string path = writeTempFile(wordFile());
+
+    RecordingSet expected;
+    WordSetLoader{}.load(path, expected);
+    ASSERT_EQ(100001u, expected.size());
+
+    for (unsigned int threads : {0, 1, 3})
+    {
+        ThreadPool pool{threads};
+        RecordingSet loaded;
+        WordSetLoader{}.load(path, loaded, pool);
+
+        EXPECT_EQ(expected.added, loaded.added) << threads << " threads";
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(WordSetLoaderTests, parallelLoadFillsSameBloomFilter)
+{
+    std::string path = writeTempFile(wordFile());
+
+    RecordingSet expectedSet;
+    BloomFilter expected;
+    WordSetLoader{}.load(path, expectedSet, expected);
+
+    ThreadPool pool{3};
+    RecordingSet loadedSet;
+    BloomFilter loaded;
+    WordSetLoader{}.load(path, loadedSet, loaded, pool);
+
+    EXPECT_EQ(expectedSet.added, loadedSet.added);
+    EXPECT_EQ(expected.sizeInBytes(), loaded.sizeInBytes());
+
+    for (const std::string& word : expectedSet.added)
+    {
+        EXPECT_TRUE(loaded.mightContain(word)) << word;
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(WordSetLoaderTests, loadsFromAPipe)
+{
+    for (bool parallel : {false, true})
+    {
+        int fds[2];
+        ASSERT_EQ(0, ::pipe(fds));
+        ASSERT_EQ(13, ::write(fds[1], "apple\nbanana\n", 13));
+        ::close(fds[1]);
+
+        // Opening /dev/fd/N opens the same pipe again, the way a shell's
+        // /dev/stdin does, so the words can only be read once.
+        ThreadPool pool{2};
+        RecordingSet loaded;
+        std::string path = "/dev/fd/" + std::to_string(fds[0]);
+
+        if (parallel)
+        {
+            WordSetLoader{}.load(path, loaded, pool);
+        }
+        else
+        {
+            WordSetLoader{}.load(path, loaded);
+        }
+
+        EXPECT_EQ((std::vector<std::string>{"APPLE", "BANANA"}), loaded.added);
+        ::close(fds[0]);
+    }
+}
+
+
+TEST(WordSetLoaderTests, parallelLoadOfMissingFileAddsNothing)
+{
+    ThreadPool pool{2};
+    RecordingSet loaded;
+    WordSetLoader{}.load(testing::TempDir() + "no-such-file", loaded, pool);
+
+    EXPECT_EQ(0u, loaded.size());
+}
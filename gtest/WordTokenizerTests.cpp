@@ -0,0 +1,234 @@
+// WordTokenizerTests.cpp
+//
+// Unit tests checking that every kind of WordTokenizer supported by this
+// CPU finds the same words as TextFileReader, including in text with
+// hyphens, apostrophes and non-ASCII bytes around the edges of the
+// 16- and 32-byte blocks the vectorized tokenizers scan, and that UTF-8
+// words are found and uppercased as a whole.
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MappedTextFileReader.hpp"
+#include "TextFileReader.hpp"
+#include "WordTokenizer.hpp"
+
+
+namespace
+{
+    const std::vector<TokenizerKind> allKinds =
+    {
+        TokenizerKind::Scalar, TokenizerKind::Sse2, TokenizerKind::Avx2
+    };
+
+
+    // Random text drawn mostly from word characters, so that words are
+    // often longer than a block, with some of every other kind of byte.
+    std::string randomText(std::mt19937& engine, size_t length)
+    {
+        static const std::string alphabet =
+            "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+            "abcdefghijklmnopqrstuvwxyz--''";
+
+        static const std::string others = " \t\r\n.,;!?\"@[`{/:\x7f\x80\xc3\xa9\xff";
+
+        std::uniform_int_distribution<int> percent{0, 99};
+        std::string text;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (percent(engine) < 85)
+            {
+                text += alphabet[engine() % alphabet.size()];
+            }
+            else
+            {
+                text += others[engine() % others.size()];
+            }
+        }
+
+        return text;
+    }
+
+
+    // Every word the tokenizer finds in the text, each followed by the
+    // index just past it.
+    std::vector<std::string> allWords(const WordTokenizer& tokenizer, const std::string& text)
+    {
+        std::vector<std::string> words;
+        std::string word;
+        size_t index = 0;
+
+        while (tokenizer.nextWord(text.data(), index, text.size(), word))
+        {
+            words.push_back(word + "@" + std::to_string(index));
+        }
+
+        return words;
+    }
+
+
+    std::vector<std::string> readWords(WordReader& reader)
+    {
+        std::vector<std::string> words;
+
+        while (!reader.noMoreWords())
+        {
+            words.push_back(std::string{reader.currentWordView()}
+                + "@" + std::to_string(reader.currentLineNumber()));
+
+            reader.advanceToNextWord();
+        }
+
+        return words;
+    }
+}
+
+
+TEST(WordTokenizerTests, unsupportedKindsFallBackToScalar)
+{
+    for (TokenizerKind kind : allKinds)
+    {
+        WordTokenizer tokenizer{kind};
+
+        if (tokenizerKindSupported(kind))
+        {
+            EXPECT_EQ(kind, tokenizer.kind());
+        }
+        else
+        {
+            EXPECT_EQ(TokenizerKind::Scalar, tokenizer.kind());
+        }
+    }
+}
+
+
+TEST(WordTokenizerTests, classifiesEveryByteLikeScalar)
+{
+    std::string all;
+
+    for (int c = 0; c < 256; ++c)
+    {
+        all += static_cast<char>(c);
+    }
+
+    for (TextEncoding encoding : { TextEncoding::Ascii, TextEncoding::Utf8 })
+    {
+        WordTokenizer scalar{TokenizerKind::Scalar, encoding};
+
+        for (TokenizerKind kind : allKinds)
+        {
+            WordTokenizer tokenizer{kind, encoding};
+
+            for (size_t i = 0; i < all.size(); ++i)
+            {
+                // Put the byte at every position within a block of 32, both
+                // where a word might start and where one might end.
+                for (const std::string& text : {
+                        std::string(64, '.') + all[i] + std::string(40, 'a') + ".",
+                        std::string(64, 'x') + all[i] + std::string(40, '.') + "y"})
+                {
+                    for (size_t start = 0; start < 64; ++start)
+                    {
+                        ASSERT_EQ(
+                            allWords(scalar, text.substr(start)),
+                            allWords(tokenizer, text.substr(start)));
+                    }
+                }
+            }
+
+            std::string expected(all.size(), '\0');
+            std::string actual(all.size(), '\0');
+            scalar.copyUppercase(all.data(), all.size(), expected.data());
+            tokenizer.copyUppercase(all.data(), all.size(), actual.data());
+            EXPECT_EQ(expected, actual);
+        }
+    }
+}
+
+
+TEST(WordTokenizerTests, asciiWordsAreTheSameInEitherEncoding)
+{
+    std::mt19937 engine{37};
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        std::string text = randomText(engine, 2000);
+
+        // Non-ASCII bytes are where the encodings legitimately differ.
+        for (char& c : text)
+        {
+            if (static_cast<unsigned char>(c) >= 0x80)
+            {
+                c = ' ';
+            }
+        }
+
+        for (TokenizerKind kind : allKinds)
+        {
+            ASSERT_EQ(
+                allWords(WordTokenizer{kind, TextEncoding::Ascii}, text),
+                allWords(WordTokenizer{kind, TextEncoding::Utf8}, text));
+        }
+    }
+}
+
+
+TEST(WordTokenizerTests, findsAndUppercasesUtf8Words)
+{
+    std::string text =
+        "Caf\u00e9 na\u00efve-- \u00e9t\u00e9 \u03b1\u03b2\u03b3 \u043f\u0440\u0438\u0432\u0435\u0442, "
+        "don\u2019t x\xff\xfey e\u0301 \u0301a \u00bfqu\u00e9?";
+
+    std::vector<std::string> expected =
+    {
+        "CAF\u00c9@5", "NA\u00cfVE-@14", "\u00c9T\u00c9@20", "\u0391\u0392\u0393@27",
+        "\u041f\u0420\u0418\u0412\u0415\u0422@40", "DON@45", "T@49", "X@51", "Y@54",
+        "E\u0301@58", "A@62", "QU\u00c9@69"
+    };
+
+    for (TokenizerKind kind : allKinds)
+    {
+        EXPECT_EQ(expected, allWords(WordTokenizer{kind, TextEncoding::Utf8}, text));
+    }
+
+    std::vector<std::string> expectedAscii =
+    {
+        "CAF@3", "NA@8", "VE-@14", "T@18", "DON@45", "T@49", "X@51", "Y@54", "E@56",
+        "A@62", "QU@67"
+    };
+
+    for (TokenizerKind kind : allKinds)
+    {
+        EXPECT_EQ(expectedAscii, allWords(WordTokenizer{kind, TextEncoding::Ascii}, text));
+    }
+}
+
+
+TEST(WordTokenizerTests, readsSameWordsAsTextFileReader)
+{
+    std::mt19937 engine{46};
+    std::string path = testing::TempDir() + "WordTokenizerTests.txt";
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            file << randomText(engine, 2000);
+        }
+
+        TextFileReader textFileReader{path};
+        std::vector<std::string> expected = readWords(textFileReader);
+
+        for (TokenizerKind kind : allKinds)
+        {
+            MappedTextFileReader mappedReader{path, kind};
+            ASSERT_EQ(expected, readWords(mappedReader));
+        }
+    }
+
+    std::remove(path.c_str());
+}
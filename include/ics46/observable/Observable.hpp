@@ -4,11 +4,30 @@
 // that provides the ability for an object to have a list of "observer"
 // objects associated with it, which can be "notified" when an interesting
 // event occurs.
+//
+// Observers are held by weak pointers, so an observable never keeps one
+// alive by itself.  The list of observers is kept compact, each alongside
+// its address, and is only tidied up when an observer is found to have
+// expired (or been removed), rather than on every notification.
+//
+// Notifying an observer normally means locking its weak pointer for the
+// duration of the call.  An object that's about to notify its observers
+// many times in a row can create a Hold first, which locks each of them
+// once and keeps them alive until the Hold is destroyed, so that each
+// notification in between calls them without touching their reference
+// counts at all.
+//
+// Observers may be added or removed while they're being notified (by the
+// observers themselves, for example).  An observer added during a
+// notification isn't told about that event, but is told about later
+// ones; an observer removed during a notification isn't told about it if
+// it hasn't been already.
 
 #ifndef OBSERVABLE_HPP
 #define OBSERVABLE_HPP
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -23,81 +42,306 @@ namespace ics46 { namespace observable
     public:
         typedef std::function<void(std::shared_ptr<ObserverType>)> NotifyFunction;
 
+        // While a Hold exists, the observable's observers are kept alive and
+        // are notified without their reference counts being touched.  Holds
+        // may be nested.
+        class Hold
+        {
+        public:
+            explicit Hold(Observable& observable);
+            ~Hold();
+
+            Hold(const Hold&) = delete;
+            Hold& operator=(const Hold&) = delete;
+
+        private:
+            Observable& observable;
+        };
+
     public:
+        Observable();
+
         void addObserver(std::weak_ptr<ObserverType> observerToAdd);
         void removeObserver(std::weak_ptr<ObserverType> observerToRemove);
+
+        // notifyObservers() passes each observer to the given function as a
+        // shared pointer.
         void notifyObservers(NotifyFunction notifyFunction);
 
+        // notifyEachObserver() passes each observer to the given function,
+        // which can be anything callable, such as a lambda, as a plain
+        // pointer, so that neither the function nor the observer needs to
+        // be copied.
+        template <typename Notify>
+        void notifyEachObserver(Notify notify);
+
+    private:
+        // Each observer is kept with its address, which is null once it's
+        // known to have expired or been removed, and, while there's a Hold,
+        // a shared pointer that keeps it alive.
+        struct Observer
+        {
+            std::weak_ptr<ObserverType> weak;
+            std::shared_ptr<ObserverType> held;
+            ObserverType* address;
+        };
+
+        // Every notification, even one that ends with an exception, is
+        // followed by tidying up the list if it's the outermost one.
+        class Notifying
+        {
+        public:
+            explicit Notifying(Observable& observable);
+            ~Notifying();
+
+        private:
+            Observable& observable;
+        };
+
+        std::vector<Observer> observers;
+        unsigned int holds;
+        unsigned int notifications;
+        bool compactionNeeded;
+
     private:
-        std::vector<std::weak_ptr<ObserverType>> observers;
+        template <typename Call>
+        void dispatch(Call call);
+
+        Observer* find(ObserverType* address);
+        void forget(Observer& observer);
+        void compact();
     };
 
 
 
     template <typename ObserverType>
-    void Observable<ObserverType>::addObserver(std::weak_ptr<ObserverType> observerToAdd)
+    Observable<ObserverType>::Hold::Hold(Observable& observable)
+        : observable{observable}
     {
-        if (observerToAdd.expired())
+        if (observable.holds++ > 0)
         {
             return;
         }
 
-        if (!std::any_of(
-                observers.begin(), observers.end(),
-                [=](std::weak_ptr<ObserverType> observer)
+        for (Observer& observer : observable.observers)
+        {
+            if (observer.address != nullptr)
+            {
+                observer.held = observer.weak.lock();
+
+                if (observer.held == nullptr)
                 {
-                    return observer.lock() == observerToAdd.lock();
-                }))
+                    observable.forget(observer);
+                }
+            }
+        }
+
+        if (observable.notifications == 0)
         {
-            observers.push_back(observerToAdd);
+            observable.compact();
         }
     }
 
 
+    template <typename ObserverType>
+    Observable<ObserverType>::Hold::~Hold()
+    {
+        if (--observable.holds > 0)
+        {
+            return;
+        }
+
+        // The observers are only let go of once the list is consistent,
+        // since one of them being destroyed might remove another.
+        std::vector<std::shared_ptr<ObserverType>> released;
+        released.reserve(observable.observers.size());
+
+        for (Observer& observer : observable.observers)
+        {
+            released.push_back(std::move(observer.held));
+        }
+    }
+
+
+    template <typename ObserverType>
+    Observable<ObserverType>::Notifying::Notifying(Observable& observable)
+        : observable{observable}
+    {
+        ++observable.notifications;
+    }
+
+
+    template <typename ObserverType>
+    Observable<ObserverType>::Notifying::~Notifying()
+    {
+        if (--observable.notifications == 0 && observable.compactionNeeded)
+        {
+            observable.compact();
+        }
+    }
+
+
+    template <typename ObserverType>
+    Observable<ObserverType>::Observable()
+        : observers{}, holds{0}, notifications{0}, compactionNeeded{false}
+    {
+    }
+
+
+    template <typename ObserverType>
+    void Observable<ObserverType>::addObserver(std::weak_ptr<ObserverType> observerToAdd)
+    {
+        std::shared_ptr<ObserverType> observer = observerToAdd.lock();
+
+        if (observer == nullptr || find(observer.get()) != nullptr)
+        {
+            return;
+        }
+
+        observers.push_back(Observer{
+            observerToAdd, holds > 0 ? observer : nullptr, observer.get()});
+    }
+
+
     template <typename ObserverType>
     void Observable<ObserverType>::removeObserver(std::weak_ptr<ObserverType> observerToRemove)
     {
-        if (observerToRemove.expired())
+        std::shared_ptr<ObserverType> observer = observerToRemove.lock();
+
+        if (observer == nullptr)
         {
             return;
         }
 
-        observers.erase(
-            std::remove_if(
-                observers.begin(), observers.end(),
-                [=](std::weak_ptr<ObserverType> observer)
-                {
-                    return observer.lock() == observerToRemove.lock();
-                }),
-            observers.end());
+        Observer* found = find(observer.get());
+
+        if (found != nullptr)
+        {
+            forget(*found);
+
+            if (notifications == 0)
+            {
+                compact();
+            }
+        }
     }
 
 
     template <typename ObserverType>
     void Observable<ObserverType>::notifyObservers(NotifyFunction notifyFunction)
     {
+        dispatch(
+            [&](const std::shared_ptr<ObserverType>& observer)
+            {
+                notifyFunction(observer);
+            });
+    }
+
+
+    template <typename ObserverType>
+    template <typename Notify>
+    void Observable<ObserverType>::notifyEachObserver(Notify notify)
+    {
+        dispatch(
+            [&](const std::shared_ptr<ObserverType>& observer)
+            {
+                notify(observer.get());
+            });
+    }
+
+
+    // dispatch() calls the given function with each observer that was
+    // there when it started, skipping any that have been removed since.
+    // The list may grow while an observer is being notified, so it's
+    // indexed afresh each time; the shared pointer the function is given
+    // must only be used before the observer is notified.
+    template <typename ObserverType>
+    template <typename Call>
+    void Observable<ObserverType>::dispatch(Call call)
+    {
+        Notifying notifying{*this};
+
+        for (size_t i = 0, count = observers.size(); i < count; ++i)
+        {
+            Observer& observer = observers[i];
+
+            if (observer.address == nullptr)
+            {
+                continue;
+            }
+            else if (observer.held != nullptr)
+            {
+                call(observer.held);
+            }
+            else if (std::shared_ptr<ObserverType> locked = observer.weak.lock())
+            {
+                call(locked);
+            }
+            else
+            {
+                forget(observer);
+            }
+        }
+    }
+
+
+    // find() returns the live observer at the given address, if any.  An
+    // expired observer may share its address with a new object, so it
+    // doesn't count.
+    template <typename ObserverType>
+    typename Observable<ObserverType>::Observer* Observable<ObserverType>::find(
+        ObserverType* address)
+    {
+        for (Observer& observer : observers)
+        {
+            if (observer.address == address && !observer.weak.expired())
+            {
+                return &observer;
+            }
+        }
+
+        return nullptr;
+    }
+
+
+    // forget() marks an observer to be left out of notifications from now
+    // on and removed from the list once it's safe to.
+    template <typename ObserverType>
+    void Observable<ObserverType>::forget(Observer& observer)
+    {
+        observer.address = nullptr;
+        compactionNeeded = true;
+    }
+
+
+    // compact() removes the observers that have been forgotten, and is only
+    // called when no notification is going on.
+    template <typename ObserverType>
+    void Observable<ObserverType>::compact()
+    {
+        std::vector<std::shared_ptr<ObserverType>> released;
+
+        for (Observer& observer : observers)
+        {
+            if (observer.address == nullptr && observer.held != nullptr)
+            {
+                released.push_back(std::move(observer.held));
+            }
+        }
+
         observers.erase(
             std::remove_if(
                 observers.begin(), observers.end(),
-                [=](std::weak_ptr<ObserverType> observer)
+                [](const Observer& observer)
                 {
-                    return observer.expired();
+                    return observer.address == nullptr;
                 }),
             observers.end());
 
-        std::for_each(
-            observers.begin(), observers.end(),
-            [=](std::weak_ptr<ObserverType> observer)
-            {
-                if (!observer.expired())
-                {
-                    notifyFunction(observer.lock());
-                }
-            });
+        compactionNeeded = false;
     }
 } }
 
 
 
 #endif // OBSERVABLE_HPP
-
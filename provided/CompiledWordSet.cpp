@@ -0,0 +1,482 @@
+// CompiledWordSet.cpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CompiledWordSet.hpp"
+
+
+
+namespace
+{
+    const char magic[8] = { 'S', 'P', 'E', 'L', 'L', 'D', 'I', 'C' };
+
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t wordCount;
+        std::uint64_t slotCount;
+        std::uint64_t blobSize;
+        std::uint64_t payloadChecksum;
+        std::uint64_t headerChecksum;
+        char reserved[8];
+    };
+
+    static_assert(sizeof(Header) == 64, "compiled dictionary headers are 64 bytes");
+
+
+    // The 64-bit FNV-1a hash, followed by a final mixing step so that both
+    // halves of the result are well distributed.  Since it's part of the
+    // file format, changing it means changing FORMAT_VERSION.
+    std::uint64_t hashWord(std::string_view word)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+
+        for (char c : word)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+
+    // A slot's tag is the upper half of its word's hash, except that 0
+    // marks an empty slot.
+    std::uint32_t tagOf(std::uint64_t hash)
+    {
+        std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+        return tag != 0 ? tag : 1;
+    }
+
+
+    // wordAt() finds the word at the given offset in a blob of the given
+    // size, returning false if it would run past the end of the blob.
+    bool wordAt(const char* blob, size_t blobSize, std::uint64_t offset, std::string_view& word)
+    {
+        std::uint16_t length;
+
+        if (offset + sizeof(length) > blobSize)
+        {
+            return false;
+        }
+
+        std::memcpy(&length, blob + offset, sizeof(length));
+
+        if (offset + sizeof(length) + length > blobSize)
+        {
+            return false;
+        }
+
+        word = std::string_view{blob + offset + sizeof(length), length};
+        return true;
+    }
+
+
+    // checksum() folds the data into 64 bits, eight bytes at a time, so
+    // that verifying even a large dictionary doesn't take long.
+    std::uint64_t checksum(const char* data, size_t size)
+    {
+        std::uint64_t sum = 0x9e3779b97f4a7c15ull ^ size;
+        size_t i = 0;
+
+        for (; i + 8 <= size; i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, 8);
+
+            sum = (sum ^ word) * 0xff51afd7ed558ccdull;
+            sum ^= sum >> 29;
+        }
+
+        for (; i < size; ++i)
+        {
+            sum = (sum ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+        }
+
+        return sum;
+    }
+
+
+    std::uint64_t headerChecksum(const Header& header)
+    {
+        return checksum(
+            reinterpret_cast<const char*>(&header), offsetof(Header, headerChecksum));
+    }
+
+
+    // compile() builds the header and the rest of a compiled dictionary
+    // holding the given words, leaving out duplicates, returning false if
+    // a word is too long or the blob would outgrow 32-bit offsets.
+    bool compile(const std::vector<std::string>& words, Header& header, std::string& payload)
+    {
+        // At most three quarters of the slots are used, so that probes stay
+        // short, and there's always an empty slot to end them.
+        std::uint64_t slotCount = 1;
+
+        while (slotCount * 3 < words.size() * 4 + 1)
+        {
+            slotCount *= 2;
+        }
+
+        std::vector<std::uint64_t> slots(slotCount, 0);
+        std::string blob;
+        std::uint64_t wordCount = 0;
+
+        for (const std::string& word : words)
+        {
+            // Offsets into the blob have to fit in the upper half of a slot.
+            if (word.size() > CompiledWordSet::MAXIMUM_WORD_LENGTH
+                || blob.size() + sizeof(std::uint16_t) + word.size() > 0xFFFFFFFFull)
+            {
+                return false;
+            }
+
+            std::uint64_t hash = hashWord(word);
+            std::uint32_t tag = tagOf(hash);
+            std::uint64_t i = hash & (slotCount - 1);
+            std::string_view found;
+            bool duplicate = false;
+
+            for (; slots[i] != 0 && !duplicate; i = (i + 1) & (slotCount - 1))
+            {
+                duplicate = static_cast<std::uint32_t>(slots[i]) == tag
+                    && wordAt(blob.data(), blob.size(), slots[i] >> 32, found) && found == word;
+            }
+
+            if (duplicate)
+            {
+                continue;
+            }
+
+            std::uint16_t length = static_cast<std::uint16_t>(word.size());
+            slots[i] = (static_cast<std::uint64_t>(blob.size()) << 32) | tag;
+            blob.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            blob.append(word);
+            ++wordCount;
+        }
+
+        header = Header{};
+        std::copy(magic, magic + sizeof(magic), header.magic);
+        header.version = CompiledWordSet::FORMAT_VERSION;
+        header.headerSize = sizeof(header);
+        header.wordCount = wordCount;
+        header.slotCount = slotCount;
+        header.blobSize = blob.size();
+
+        payload.assign(slotCount * 8 + blob.size(), '\0');
+        std::memcpy(payload.data(), slots.data(), slotCount * 8);
+        std::memcpy(payload.data() + slotCount * 8, blob.data(), blob.size());
+
+        header.payloadChecksum = checksum(payload.data(), payload.size());
+        header.headerChecksum = headerChecksum(header);
+        return true;
+    }
+}
+
+
+
+CompiledWordSet::CompiledWordSet()
+    : file{}, valid{false}, wordCount{0}, slotMask{0}, slots{nullptr}, blob{nullptr}
+{
+}
+
+
+CompiledWordSet::CompiledWordSet(const std::string& path, bool verifyChecksum)
+    : CompiledWordSet{}
+{
+    open(path, verifyChecksum);
+}
+
+
+bool CompiledWordSet::open(const std::string& path, bool verifyChecksum)
+{
+    file = MappedFile{path, MappedFile::Access::Random};
+    return validate(verifyChecksum);
+}
+
+
+bool CompiledWordSet::openShared(const std::string& name, bool verifyChecksum)
+{
+    file = MappedFile::openSharedMemory(name);
+    return validate(verifyChecksum);
+}
+
+
+bool CompiledWordSet::isOpen() const
+{
+    return valid;
+}
+
+
+bool CompiledWordSet::isImplemented() const
+{
+    return true;
+}
+
+
+void CompiledWordSet::add(const std::string&)
+{
+}
+
+
+bool CompiledWordSet::contains(const std::string& element) const
+{
+    return valid && findSlot(element, hashWord(element));
+}
+
+
+std::vector<bool> CompiledWordSet::containsBatch(const std::vector<std::string>& elements) const
+{
+    std::vector<bool> results(elements.size(), false);
+
+    if (!valid)
+    {
+        return results;
+    }
+
+    std::uint64_t hashes[CONTAINS_BATCH_WINDOW];
+
+    for (size_t first = 0; first < elements.size(); first += CONTAINS_BATCH_WINDOW)
+    {
+        size_t count = std::min<size_t>(CONTAINS_BATCH_WINDOW, elements.size() - first);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            hashes[i] = hashWord(elements[first + i]);
+            __builtin_prefetch(&slots[hashes[i] & slotMask]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            results[first + i] = findSlot(elements[first + i], hashes[i]);
+        }
+    }
+
+    return results;
+}
+
+
+unsigned int CompiledWordSet::size() const
+{
+    return static_cast<unsigned int>(wordCount);
+}
+
+
+void CompiledWordSet::forEachWord(const std::function<void(std::string_view)>& f) const
+{
+    if (!valid)
+    {
+        return;
+    }
+
+    size_t blobSize = file.size() - (blob - file.data());
+    std::string_view word;
+
+    for (std::uint64_t i = 0; i <= slotMask; ++i)
+    {
+        if (static_cast<std::uint32_t>(slots[i]) != 0 && wordAt(blob, blobSize, slots[i] >> 32, word))
+        {
+            f(word);
+        }
+    }
+}
+
+
+// validate() checks the header of the dictionary that's been mapped and,
+// if asked to, the checksum of the rest of it, leaving the set empty if
+// it isn't valid.
+bool CompiledWordSet::validate(bool verifyChecksum)
+{
+    valid = false;
+    wordCount = 0;
+
+    Header header;
+
+    if (file.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (!std::equal(magic, magic + sizeof(magic), header.magic)
+        || header.version != FORMAT_VERSION
+        || header.headerSize != sizeof(header)
+        || header.headerChecksum != headerChecksum(header))
+    {
+        return false;
+    }
+
+    // The sizes are checked without multiplying, so that a corrupt header
+    // can't make them overflow.
+    size_t payloadSize = file.size() - sizeof(header);
+
+    if (header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0
+        || header.slotCount > payloadSize / 8
+        || header.blobSize != payloadSize - header.slotCount * 8
+        || header.wordCount > header.slotCount)
+    {
+        return false;
+    }
+
+    if (verifyChecksum
+        && header.payloadChecksum != checksum(file.data() + sizeof(header), payloadSize))
+    {
+        return false;
+    }
+
+    valid = true;
+    wordCount = header.wordCount;
+    slotMask = header.slotCount - 1;
+    slots = reinterpret_cast<const std::uint64_t*>(file.data() + sizeof(header));
+    blob = file.data() + sizeof(header) + header.slotCount * 8;
+    return true;
+}
+
+
+// findSlot() probes linearly from the word's home slot until it finds the
+// word or an empty slot.  Words are only compared when their tags match.
+// Even if the file is corrupt and its checksum wasn't verified, nothing
+// is read from past the end of the blob, and probing always ends.
+bool CompiledWordSet::findSlot(std::string_view word, std::uint64_t hash) const
+{
+    std::uint32_t tag = tagOf(hash);
+    size_t blobSize = file.size() - (blob - file.data());
+    std::string_view found;
+
+    std::uint64_t i = hash & slotMask;
+
+    for (std::uint64_t probes = 0; probes <= slotMask; ++probes, i = (i + 1) & slotMask)
+    {
+        std::uint64_t slot = slots[i];
+        std::uint32_t slotTag = static_cast<std::uint32_t>(slot);
+
+        if (slotTag == 0)
+        {
+            return false;
+        }
+        else if (slotTag == tag && wordAt(blob, blobSize, slot >> 32, found) && found == word)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool CompiledWordSet::isCompiledWordSet(const std::string& path)
+{
+    struct stat status;
+
+    if (::stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        return false;
+    }
+
+    std::ifstream in{path, std::ios::binary};
+    char bytes[sizeof(magic)];
+
+    return in.read(bytes, sizeof(bytes)) && std::equal(magic, magic + sizeof(magic), bytes);
+}
+
+
+bool CompiledWordSet::write(const std::vector<std::string>& words, const std::string& path)
+{
+    Header header;
+    std::string payload;
+
+    if (!compile(words, header, payload))
+    {
+        return false;
+    }
+
+    // The dictionary is written alongside its final path and renamed into
+    // place, so that anything opening it never sees it half-written.
+    std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream out{temporaryPath, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(payload.data(), payload.size());
+
+        if (!out.flush())
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+
+bool CompiledWordSet::writeShared(const std::vector<std::string>& words, const std::string& name)
+{
+    Header header;
+    std::string payload;
+
+    if (!compile(words, header, payload))
+    {
+        return false;
+    }
+
+    // A dictionary already published under the name is unlinked rather
+    // than overwritten, so processes that have it mapped keep using it
+    // undisturbed, and only processes that attach from now on see the new
+    // one.
+    ::shm_unlink(name.c_str());
+
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    size_t size = sizeof(header) + payload.size();
+    void* mapped = MAP_FAILED;
+
+    if (::ftruncate(fd, size) == 0)
+    {
+        mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+
+    // The header is written last, so that a process attaching while the
+    // rest is still being written finds no valid header and fails to open
+    // the dictionary, instead of querying it half-written.
+    char* contents = static_cast<char*>(mapped);
+    std::memcpy(contents + sizeof(header), payload.data(), payload.size());
+    std::memcpy(contents, &header, sizeof(header));
+
+    ::munmap(mapped, size);
+    return true;
+}
+
+
+bool CompiledWordSet::removeShared(const std::string& name)
+{
+    return ::shm_unlink(name.c_str()) == 0;
+}
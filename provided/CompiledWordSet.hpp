@@ -0,0 +1,144 @@
+// CompiledWordSet.hpp
+//
+// A CompiledWordSet is a read-only Set<std::string> that's queried in
+// place in a precompiled dictionary file, which is mapped into memory
+// rather than parsed, so opening one takes about the same time however
+// many words it holds, and allocates nothing per word.  Dictionaries are
+// compiled from word files by WordSetLoader::compile(), which normalizes
+// the words the same way WordSetLoader::load() does.
+//
+// A compiled dictionary is, in the byte order of the machine that wrote
+// it:
+//
+//     a 64-byte header: the magic bytes "SPELLDIC", the format version,
+//         the header's size, the number of words, the number of slots,
+//         the size of the string blob, a checksum of everything after
+//         the header, and a checksum of the header's other fields
+//
+//     an open-addressed hash table of 8-byte slots (a power of two of
+//         them, at most three quarters full), each holding 32 bits of its
+//         word's hash (never 0, which marks an empty slot) and the offset
+//         of the word in the blob, probed linearly
+//
+//     the string blob, in which each word is a 16-bit length followed by
+//         its bytes
+//
+// Files that aren't compiled dictionaries, are of another version, are
+// cut short, or whose checksums don't match, can't be opened; verifying
+// the checksum of everything after the header reads the whole file, so
+// it can be skipped.
+//
+// Since a compiled dictionary refers to its words by their offsets, not
+// by pointers, it works wherever it's mapped, so it can also be published
+// in a POSIX shared memory object by writeShared() and opened from there
+// by openShared().  Every process that opens it that way queries the same
+// physical pages, rather than holding a copy of its own.
+//
+// A CompiledWordSet is read-only, so add() has no effect.
+
+#ifndef COMPILEDWORDSET_HPP
+#define COMPILEDWORDSET_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Set.hpp"
+
+
+
+class CompiledWordSet : public Set<std::string>
+{
+public:
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    // The longest word a compiled dictionary can hold, in bytes.
+    static constexpr size_t MAXIMUM_WORD_LENGTH = 0xFFFF;
+
+public:
+    // Initializes a CompiledWordSet with no dictionary open, so that it's
+    // empty until open() is called.
+    CompiledWordSet();
+
+    // Opens the compiled dictionary at the given path (see open()).
+    explicit CompiledWordSet(const std::string& path, bool verifyChecksum = true);
+
+    CompiledWordSet(const CompiledWordSet&) = delete;
+    CompiledWordSet& operator=(const CompiledWordSet&) = delete;
+
+
+    // open() maps the compiled dictionary at the given path, in place of
+    // any that was open before, checking its header and, if asked to, the
+    // checksum of the rest of it.  It returns false if the file couldn't
+    // be opened or isn't a valid compiled dictionary, in which case the
+    // set is left empty.
+    bool open(const std::string& path, bool verifyChecksum = true);
+
+    // openShared() does the same as open(), but with the dictionary
+    // published by writeShared() in the shared memory object with the
+    // given name.
+    bool openShared(const std::string& name, bool verifyChecksum = true);
+
+    bool isOpen() const;
+
+
+    virtual bool isImplemented() const;
+    virtual void add(const std::string& element);
+    virtual bool contains(const std::string& element) const;
+
+    // containsBatch() hashes a window of words and prefetches their slots
+    // before probing any of them, so the cache misses overlap, the same
+    // way HashSet::containsBatch() does.
+    virtual std::vector<bool> containsBatch(const std::vector<std::string>& elements) const;
+
+    virtual unsigned int size() const;
+
+
+    // forEachWord() calls the given function with each of the words, in
+    // no particular order.
+    void forEachWord(const std::function<void(std::string_view)>& f) const;
+
+
+    // isCompiledWordSet() returns true if the file at the given path starts
+    // with a compiled dictionary's magic bytes, without checking any more.
+    // Only regular files are looked at, since reading the start of a pipe
+    // would use it up, and opening a named pipe waits for a writer.
+    static bool isCompiledWordSet(const std::string& path);
+
+    // write() compiles the given words, leaving out duplicates, into a
+    // dictionary at the given path, returning false if it can't be
+    // written or a word is longer than MAXIMUM_WORD_LENGTH.
+    static bool write(const std::vector<std::string>& words, const std::string& path);
+
+    // writeShared() compiles the given words the same way, but into a
+    // POSIX shared memory object with the given name (such as
+    // "/spellcheck"), replacing any dictionary published under it before.
+    // The object lasts until removeShared() is called or the machine is
+    // restarted, even after the process that wrote it has finished.
+    static bool writeShared(const std::vector<std::string>& words, const std::string& name);
+
+    // removeShared() removes the shared memory object with the given name,
+    // returning false if there isn't one.  Processes that already have the
+    // dictionary open can keep using it.
+    static bool removeShared(const std::string& name);
+
+
+private:
+    MappedFile file;
+    bool valid;
+
+    std::uint64_t wordCount;
+    std::uint64_t slotMask;
+    const std::uint64_t* slots;
+    const char* blob;
+
+private:
+    bool validate(bool verifyChecksum);
+    bool findSlot(std::string_view word, std::uint64_t hash) const;
+};
+
+
+
+#endif // COMPILEDWORDSET_HPP
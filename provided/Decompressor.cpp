@@ -0,0 +1,301 @@
+// Decompressor.cpp
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "Decompressor.hpp"
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+
+namespace
+{
+    const unsigned char gzipMagic[] = { 0x1F, 0x8B };
+    const unsigned char zstdMagic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+
+
+    template <size_t Count>
+    bool startsWith(const unsigned char* bytes, size_t size, const unsigned char (&magic)[Count])
+    {
+        return size >= Count && std::equal(magic, magic + Count, bytes);
+    }
+}
+
+
+
+Compression detectCompression(const std::string& path)
+{
+    int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+
+    if (fileDescriptor < 0)
+    {
+        return Compression::None;
+    }
+
+    Compression compression = detectCompression(fileDescriptor);
+    ::close(fileDescriptor);
+    return compression;
+}
+
+
+Compression detectCompression(int fileDescriptor)
+{
+    struct stat status;
+
+    if (::fstat(fileDescriptor, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        return Compression::None;
+    }
+
+    // pread() leaves the file's offset where it was.
+    unsigned char bytes[4];
+    ssize_t count = ::pread(fileDescriptor, bytes, sizeof(bytes), 0);
+    size_t size = count > 0 ? count : 0;
+
+    if (startsWith(bytes, size, gzipMagic))
+    {
+        return Compression::Gzip;
+    }
+    else if (startsWith(bytes, size, zstdMagic))
+    {
+        return Compression::Zstd;
+    }
+    else
+    {
+        return Compression::None;
+    }
+}
+
+
+bool compressionSupported(Compression compression)
+{
+    switch (compression)
+    {
+    case Compression::None:
+    case Compression::Gzip:
+        return true;
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+    case Compression::Zstd:
+        return true;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+
+std::string compressionName(Compression compression)
+{
+    switch (compression)
+    {
+    case Compression::Gzip:
+        return "gzip";
+
+    case Compression::Zstd:
+        return "zstd";
+
+    default:
+        return "none";
+    }
+}
+
+
+
+struct Decompressor::Codec
+{
+    z_stream gzip{};
+    bool gzipInitialized = false;
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+    ZSTD_DStream* zstd = nullptr;
+#endif
+
+    ~Codec()
+    {
+        if (gzipInitialized)
+        {
+            inflateEnd(&gzip);
+        }
+
+#ifdef SPELLCHECK_HAVE_ZSTD
+        ZSTD_freeDStream(zstd);
+#endif
+    }
+};
+
+
+
+Decompressor::Decompressor(int fileDescriptor, Compression compression, size_t inputSize)
+    : fileDescriptor{fileDescriptor}, fileCompression{compression}, codec{std::make_unique<Codec>()},
+      input(std::max<size_t>(inputSize, 1)), inputStart{0}, inputEnd{0},
+      inputDone{false}, outputDone{false}, bytesRead{0}
+{
+    if (compression == Compression::Gzip)
+    {
+        // Adding 16 to the window size asks for a gzip header and trailer
+        // rather than zlib's.
+        codec->gzipInitialized = inflateInit2(&codec->gzip, MAX_WBITS + 16) == Z_OK;
+    }
+#ifdef SPELLCHECK_HAVE_ZSTD
+    else if (compression == Compression::Zstd)
+    {
+        codec->zstd = ZSTD_createDStream();
+    }
+#endif
+
+    if (!isOpen())
+    {
+        outputDone = true;
+    }
+}
+
+
+Decompressor::~Decompressor() = default;
+
+
+bool Decompressor::isOpen() const
+{
+#ifdef SPELLCHECK_HAVE_ZSTD
+    if (fileCompression == Compression::Zstd)
+    {
+        return codec->zstd != nullptr;
+    }
+#endif
+
+    return fileCompression == Compression::Gzip && codec->gzipInitialized;
+}
+
+
+size_t Decompressor::read(char* target, size_t size)
+{
+    size_t produced = 0;
+
+    while (produced == 0 && !outputDone && size > 0)
+    {
+        if (inputStart == inputEnd && !inputDone)
+        {
+            refill();
+        }
+
+        produced = fileCompression == Compression::Gzip
+            ? inflate(target, size)
+            : decompressZstd(target, size);
+    }
+
+    return produced;
+}
+
+
+Compression Decompressor::compression() const
+{
+    return fileCompression;
+}
+
+
+unsigned long long Decompressor::compressedBytesRead() const
+{
+    return bytesRead;
+}
+
+
+bool Decompressor::refill()
+{
+    inputStart = 0;
+    inputEnd = 0;
+
+    while (true)
+    {
+        ssize_t count = ::read(fileDescriptor, input.data(), input.size());
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count <= 0)
+        {
+            inputDone = true;
+            return false;
+        }
+
+        inputEnd = count;
+        bytesRead += count;
+        return true;
+    }
+}
+
+
+size_t Decompressor::inflate(char* target, size_t size)
+{
+    z_stream& gzip = codec->gzip;
+
+    gzip.next_in = reinterpret_cast<Bytef*>(input.data() + inputStart);
+    gzip.avail_in = inputEnd - inputStart;
+    gzip.next_out = reinterpret_cast<Bytef*>(target);
+    gzip.avail_out = std::min<size_t>(size, UINT_MAX);
+
+    int result = ::inflate(&gzip, Z_NO_FLUSH);
+
+    size_t produced = std::min<size_t>(size, UINT_MAX) - gzip.avail_out;
+    inputStart = inputEnd - gzip.avail_in;
+
+    if (result == Z_STREAM_END)
+    {
+        // Another member may follow this one.
+        if (inputStart == inputEnd && !inputDone)
+        {
+            refill();
+        }
+
+        if (inputStart == inputEnd)
+        {
+            outputDone = true;
+        }
+        else
+        {
+            inflateReset(&gzip);
+        }
+    }
+    else if (result == Z_BUF_ERROR)
+    {
+        // No progress could be made, which is only a problem if there's
+        // no more input to be had.
+        outputDone = inputStart == inputEnd && inputDone;
+    }
+    else if (result != Z_OK)
+    {
+        outputDone = true;
+    }
+
+    return produced;
+}
+
+
+size_t Decompressor::decompressZstd([[maybe_unused]] char* target, [[maybe_unused]] size_t size)
+{
+#ifdef SPELLCHECK_HAVE_ZSTD
+    ZSTD_inBuffer in{input.data() + inputStart, inputEnd - inputStart, 0};
+    ZSTD_outBuffer out{target, size, 0};
+
+    size_t result = ZSTD_decompressStream(codec->zstd, &out, &in);
+    inputStart += in.pos;
+
+    if (ZSTD_isError(result) || (out.pos == 0 && inputStart == inputEnd && inputDone))
+    {
+        outputDone = true;
+    }
+
+    return out.pos;
+#else
+    outputDone = true;
+    return 0;
+#endif
+}
@@ -0,0 +1,113 @@
+// Decompressor.hpp
+//
+// A Decompressor reads a gzip- or zstd-compressed file from a file
+// descriptor and hands out its decompressed contents a piece at a time,
+// so that a compressed file can be read without first decompressing all
+// of it to memory or to disk.
+//
+// gzip is supported using zlib.  zstd is only supported when the program
+// is built with SPELLCHECK_HAVE_ZSTD defined and linked with libzstd.
+//
+// Compressed files are recognized by the "magic numbers" they start with,
+// not by their names.  A gzip file may be made of several members one
+// after another, as when gzipped files are concatenated, and so may a
+// zstd file.  Data that can't be decompressed, including a file that ends
+// partway through, is treated as the end of the file, just as read errors
+// are elsewhere.
+
+#ifndef DECOMPRESSOR_HPP
+#define DECOMPRESSOR_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+
+enum class Compression
+{
+    None,
+    Gzip,
+    Zstd
+};
+
+
+// detectCompression() returns the kind of compression the file with the
+// given path uses, judging by its first few bytes, or Compression::None
+// if it's not compressed, isn't a regular file or can't be opened.
+// Streams, such as pipes, aren't looked at, since their first few bytes
+// couldn't then be read again.
+Compression detectCompression(const std::string& path);
+Compression detectCompression(int fileDescriptor);
+
+
+// compressionSupported() returns true if files compressed in the given
+// way can be decompressed by this build.
+bool compressionSupported(Compression compression);
+
+
+// compressionName() returns a name for the kind of compression, such as
+// "gzip", suitable for messages.
+std::string compressionName(Compression compression);
+
+
+
+class Decompressor
+{
+public:
+    static constexpr size_t DEFAULT_INPUT_SIZE = 1 << 16;
+
+public:
+    // Decompresses the contents of the given file descriptor, which is
+    // left open, starting at its current offset.  The descriptor should be
+    // read only through the Decompressor from then on.
+    Decompressor(
+        int fileDescriptor, Compression compression,
+        size_t inputSize = DEFAULT_INPUT_SIZE);
+
+    ~Decompressor();
+
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    // isOpen() returns false if the compression isn't supported, in which
+    // case the file reads as though it were empty.
+    bool isOpen() const;
+
+    Compression compression() const;
+
+
+    // read() decompresses up to size bytes into target, returning the
+    // number of bytes stored there, which is 0 only at the end of the
+    // decompressed data.
+    size_t read(char* target, size_t size);
+
+
+    // compressedBytesRead() returns the number of compressed bytes read
+    // from the file so far.
+    unsigned long long compressedBytesRead() const;
+
+
+private:
+    struct Codec;
+
+    int fileDescriptor;
+    Compression fileCompression;
+    std::unique_ptr<Codec> codec;
+
+    std::vector<char> input;
+    size_t inputStart;
+    size_t inputEnd;
+    bool inputDone;
+    bool outputDone;
+    unsigned long long bytesRead;
+
+private:
+    bool refill();
+    size_t inflate(char* target, size_t size);
+    size_t decompressZstd(char* target, size_t size);
+};
+
+
+
+#endif // DECOMPRESSOR_HPP
@@ -0,0 +1,32 @@
+// LineChunks.cpp
+
+#include <algorithm>
+#include <cstring>
+#include "LineChunks.hpp"
+
+
+
+std::vector<std::string_view> splitAtLines(std::string_view text, size_t chunkSize)
+{
+    std::vector<std::string_view> chunks;
+    const char* position = text.data();
+    const char* end = text.data() + text.size();
+
+    chunkSize = std::max<size_t>(chunkSize, 1);
+
+    while (position < end)
+    {
+        const char* chunkEnd = end;
+
+        if (static_cast<size_t>(end - position) > chunkSize)
+        {
+            const void* newline = std::memchr(position + chunkSize, '\n', end - position - chunkSize);
+            chunkEnd = newline != nullptr ? static_cast<const char*>(newline) + 1 : end;
+        }
+
+        chunks.emplace_back(position, chunkEnd - position);
+        position = chunkEnd;
+    }
+
+    return chunks;
+}
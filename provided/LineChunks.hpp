@@ -0,0 +1,21 @@
+// LineChunks.hpp
+//
+// Text held in memory is processed in parallel by dividing it into chunks
+// at line boundaries, so that no line is split between two threads.
+
+#ifndef LINECHUNKS_HPP
+#define LINECHUNKS_HPP
+
+#include <string_view>
+#include <vector>
+
+
+
+// splitAtLines() divides text into chunks of about chunkSize bytes, each
+// ending just after a newline (except perhaps the last), so that every
+// line is in exactly one chunk.
+std::vector<std::string_view> splitAtLines(std::string_view text, size_t chunkSize);
+
+
+
+#endif // LINECHUNKS_HPP
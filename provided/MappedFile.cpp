@@ -0,0 +1,106 @@
+// MappedFile.cpp
+
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedFile.hpp"
+
+
+
+MappedFile::MappedFile()
+    : contents{nullptr}, contentSize{0}
+{
+}
+
+
+MappedFile::MappedFile(const std::string& path, Access access)
+    : MappedFile{}
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd >= 0)
+    {
+        map(fd, MAP_PRIVATE, access);
+        ::close(fd);
+    }
+}
+
+
+MappedFile MappedFile::openSharedMemory(const std::string& name, Access access)
+{
+    MappedFile mapped;
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+
+    if (fd >= 0)
+    {
+        mapped.map(fd, MAP_SHARED, access);
+        ::close(fd);
+    }
+
+    return mapped;
+}
+
+
+MappedFile::~MappedFile()
+{
+    if (contents != nullptr)
+    {
+        ::munmap(const_cast<char*>(contents), contentSize);
+    }
+}
+
+
+MappedFile::MappedFile(MappedFile&& f)
+    : MappedFile{}
+{
+    std::swap(contents, f.contents);
+    std::swap(contentSize, f.contentSize);
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& f)
+{
+    std::swap(contents, f.contents);
+    std::swap(contentSize, f.contentSize);
+    return *this;
+}
+
+
+const char* MappedFile::data() const
+{
+    return contents;
+}
+
+
+size_t MappedFile::size() const
+{
+    return contentSize;
+}
+
+
+std::string_view MappedFile::text() const
+{
+    return std::string_view{contents, contentSize};
+}
+
+
+void MappedFile::map(int fd, int flags, Access access)
+{
+    struct stat status;
+
+    if (::fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void* mapped = ::mmap(nullptr, status.st_size, PROT_READ, flags, fd, 0);
+
+        if (mapped != MAP_FAILED)
+        {
+            ::madvise(
+                mapped, status.st_size,
+                access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            contents = static_cast<const char*>(mapped);
+            contentSize = status.st_size;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// MappedFile.hpp
+//
+// A MappedFile maps the whole of a file into memory, read-only, for as
+// long as it exists.  A file that can't be opened or mapped, or that is
+// empty, is treated as having no contents.
+//
+// A POSIX shared memory object can be mapped the same way, read-only, so
+// that every process mapping it shares the same physical pages.
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <string_view>
+
+
+
+class MappedFile
+{
+public:
+    // How the contents will be read, which tells the kernel whether
+    // reading ahead of the pages being touched is worthwhile.
+    enum class Access
+    {
+        Sequential,
+        Random
+    };
+
+public:
+    // Initializes a MappedFile with no contents.
+    MappedFile();
+
+    explicit MappedFile(const std::string& path, Access access = Access::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Moving a MappedFile hands over its mapping, leaving the MappedFile
+    // it was moved from with no contents.
+    MappedFile(MappedFile&& f);
+    MappedFile& operator=(MappedFile&& f);
+
+
+    // openSharedMemory() maps the POSIX shared memory object with the given
+    // name (such as "/spellcheck"), as shm_open() names them.
+    static MappedFile openSharedMemory(const std::string& name, Access access = Access::Random);
+
+
+    const char* data() const;
+    size_t size() const;
+
+    // text() returns a view of the whole file.
+    std::string_view text() const;
+
+
+private:
+    const char* contents;
+    size_t contentSize;
+
+private:
+    void map(int fd, int flags, Access access);
+};
+
+
+
+#endif // MAPPEDFILE_HPP
@@ -0,0 +1,119 @@
+// MappedTextFileReader.cpp
+
+#include <cstring>
+#include "MappedTextFileReader.hpp"
+
+
+
+MappedTextFileReader::MappedTextFileReader(const std::string& textFilePath)
+    : MappedTextFileReader{textFilePath, bestTokenizerKind()}
+{
+}
+
+
+MappedTextFileReader::MappedTextFileReader(
+    const std::string& textFilePath, TokenizerKind tokenizerKind)
+    : tokenizer{tokenizerKind}, file{textFilePath}, data{file.data()}, size{file.size()}
+{
+    // As with TextFileReader, a file that can't be read has no words.
+    start();
+}
+
+
+MappedTextFileReader::MappedTextFileReader(
+    const char* begin, const char* end, TokenizerKind tokenizerKind)
+    : tokenizer{tokenizerKind}, file{}, data{begin}, size{static_cast<size_t>(end - begin)}
+{
+    start();
+}
+
+
+bool MappedTextFileReader::noMoreWords() const
+{
+    return eof;
+}
+
+
+void MappedTextFileReader::advanceToNextWord()
+{
+    while (!tokenizer.nextWord(data, lineIndex, lineEnd, word, wordStart, wordEnd))
+    {
+        if (!advanceToNextLine())
+        {
+            word.clear();
+            eof = true;
+            return;
+        }
+    }
+}
+
+
+std::string_view MappedTextFileReader::currentWordView() const
+{
+    return word;
+}
+
+
+std::string_view MappedTextFileReader::currentLineView() const
+{
+    if (eof)
+    {
+        return std::string_view{};
+    }
+
+    return std::string_view{data + lineStart, lineEnd - lineStart};
+}
+
+
+int MappedTextFileReader::currentLineNumber() const
+{
+    return lineNumber;
+}
+
+
+WordContext MappedTextFileReader::currentWordContext() const
+{
+    return wordContextInLine(
+        word, currentLineView(), wordStart - lineStart, wordEnd - lineStart,
+        lineStart, lineNumber);
+}
+
+
+bool MappedTextFileReader::linesStayValid() const
+{
+    return true;
+}
+
+
+void MappedTextFileReader::start()
+{
+    eof = false;
+    lineStart = 0;
+    lineEnd = 0;
+    nextLineStart = 0;
+    lineNumber = 0;
+    lineIndex = 0;
+    wordStart = 0;
+    wordEnd = 0;
+
+    advanceToNextWord();
+}
+
+
+bool MappedTextFileReader::advanceToNextLine()
+{
+    if (nextLineStart >= size)
+    {
+        return false;
+    }
+
+    lineStart = nextLineStart;
+
+    const void* newline = std::memchr(data + lineStart, '\n', size - lineStart);
+    lineEnd = newline != nullptr ? static_cast<const char*>(newline) - data : size;
+
+    nextLineStart = lineEnd + 1;
+    lineIndex = lineStart;
+    ++lineNumber;
+    return true;
+}
@@ -0,0 +1,77 @@
+// MappedTextFileReader.hpp
+//
+// Reads an input file the same way a TextFileReader does, but maps the
+// whole file into memory and tokenizes it in place.  Lines are views of
+// the mapped bytes, so they are never copied, and each word is uppercased
+// into a scratch buffer that is reused from one word to the next.  Word
+// boundaries are found with a WordTokenizer, which scans many bytes at a
+// time when the CPU supports it.
+//
+// A MappedTextFileReader can also read a range of text that something
+// else keeps in memory, such as one chunk of a larger MappedFile.  Line
+// numbers, and the offsets in word contexts, are counted from the start
+// of the range.
+
+#ifndef MAPPEDTEXTFILEREADER_HPP
+#define MAPPEDTEXTFILEREADER_HPP
+
+#include <string>
+#include <string_view>
+#include "MappedFile.hpp"
+#include "WordReader.hpp"
+#include "WordTokenizer.hpp"
+
+
+
+class MappedTextFileReader : public WordReader
+{
+public:
+    MappedTextFileReader(const std::string& textFilePath);
+    MappedTextFileReader(const std::string& textFilePath, TokenizerKind tokenizerKind);
+
+    // Reads the text in [begin, end), which must outlive the reader.
+    MappedTextFileReader(
+        const char* begin, const char* end,
+        TokenizerKind tokenizerKind = bestTokenizerKind());
+    virtual ~MappedTextFileReader() = default;
+
+    MappedTextFileReader(const MappedTextFileReader&) = delete;
+    MappedTextFileReader& operator=(const MappedTextFileReader&) = delete;
+
+    virtual bool noMoreWords() const;
+    virtual void advanceToNextWord();
+
+    virtual std::string_view currentWordView() const;
+    virtual std::string_view currentLineView() const;
+    virtual int currentLineNumber() const;
+    virtual WordContext currentWordContext() const;
+
+    virtual bool linesStayValid() const;
+
+private:
+    WordTokenizer tokenizer;
+    MappedFile file;
+
+    const char* data;
+    size_t size;
+
+    bool eof;
+
+    size_t lineStart;
+    size_t lineEnd;
+    size_t nextLineStart;
+    int lineNumber;
+    size_t lineIndex;
+
+    std::string word;
+    size_t wordStart;
+    size_t wordEnd;
+
+private:
+    void start();
+    bool advanceToNextLine();
+};
+
+
+
+#endif // MAPPEDTEXTFILEREADER_HPP
@@ -0,0 +1,32 @@
+// MisspellingRecord.hpp
+//
+// A MisspellingRecord describes one misspelling a spell checker found:
+// the word, where it was found, the suggestions found for it, and whether
+// all of them were found before the suggestion budget ran out.
+//
+// The record owns its copy of the word, and its context's view of the
+// word is a view of that copy.  Since moving a short string can move its
+// characters, the view isn't valid after the record is moved or copied
+// until it's pointed at the copy again, which spell checkers do just
+// before they hand records to their listeners.
+
+#ifndef MISSPELLINGRECORD_HPP
+#define MISSPELLINGRECORD_HPP
+
+#include <string>
+#include <vector>
+#include "WordContext.hpp"
+
+
+
+struct MisspellingRecord
+{
+    std::string word;
+    WordContext context;
+    std::vector<std::string> suggestions;
+    bool complete = true;
+};
+
+
+
+#endif // MISSPELLINGRECORD_HPP
@@ -3,8 +3,49 @@
 #include "OutputSpellCheckerListener.hpp"
 
 
+
+namespace
+{
+    void describeMisspelling(
+        std::string& description, const WordContext& context,
+        const std::vector<std::string>& suggestions)
+    {
+        description += '\n';
+
+        if (context.lineContinuesBefore)
+        {
+            description += "...";
+        }
+
+        description += context.text;
+
+        if (context.lineContinuesAfter)
+        {
+            description += "...";
+        }
+
+        description += "\n     word not found: ";
+        description += context.word;
+        description += '\n';
+
+        if (suggestions.size() > 0)
+        {
+            description += "  perhaps you meant:\n";
+
+            for (const std::string& suggestion : suggestions)
+            {
+                description += "      ";
+                description += suggestion;
+                description += '\n';
+            }
+        }
+    }
+}
+
+
+
 OutputSpellCheckerListener::OutputSpellCheckerListener(std::ostream& out)
-    : out{out}
+    : out{out}, description{}
 {
 }
 
@@ -13,18 +54,37 @@ void OutputSpellCheckerListener::misspellingFound(
     const std::string& word, const std::string& line,
     const std::vector<std::string>& suggestions)
 {
-    out << std::endl;
-    out << line << std::endl;
-    out << "     word not found: " << word << std::endl;
+    misspellingFoundInLine(word, line, suggestions);
+}
 
-    if (suggestions.size() > 0)
-    {
-        out << "  perhaps you meant:" << std::endl;
 
-        for (const std::string& suggestion : suggestions)
-        {
-            out << "      " << suggestion << std::endl;
-        }
-    }
+void OutputSpellCheckerListener::misspellingFoundInLine(
+    std::string_view word, std::string_view line,
+    const std::vector<std::string>& suggestions)
+{
+    misspellingFoundInContext(WordContext{word, line}, suggestions);
 }
 
+
+void OutputSpellCheckerListener::misspellingFoundInContext(
+    const WordContext& context, const std::vector<std::string>& suggestions)
+{
+    description.clear();
+    describeMisspelling(description, context, suggestions);
+
+    out << description << std::flush;
+}
+
+
+void OutputSpellCheckerListener::misspellingsFound(
+    const std::vector<MisspellingRecord>& misspellings)
+{
+    description.clear();
+
+    for (const MisspellingRecord& misspelling : misspellings)
+    {
+        describeMisspelling(description, misspelling.context, misspelling.suggestions);
+    }
+
+    out << description << std::flush;
+}
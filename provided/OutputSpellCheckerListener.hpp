@@ -1,7 +1,11 @@
 // OutputSpellCheckerListener.hpp
 //
 // A SpellCheckListener that prints output describing misspellings
-// as they're found.
+// as they're found.  When only part of a misspelling's line is known,
+// "..." marks where the line was cut.
+//
+// The description of each batch of misspellings is built up in memory
+// and written, then flushed, all at once.
 
 #ifndef OUTPUTSPELLCHECKERLISTENER_HPP
 #define OUTPUTSPELLCHECKERLISTENER_HPP
@@ -20,8 +24,18 @@ public:
         const std::string& word, const std::string& line,
         const std::vector<std::string>& suggestions);
 
+    virtual void misspellingFoundInLine(
+        std::string_view word, std::string_view line,
+        const std::vector<std::string>& suggestions);
+
+    virtual void misspellingFoundInContext(
+        const WordContext& context, const std::vector<std::string>& suggestions);
+
+    virtual void misspellingsFound(const std::vector<MisspellingRecord>& misspellings);
+
 private:
     std::ostream& out;
+    std::string description;
 };
 
 
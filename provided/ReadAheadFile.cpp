@@ -0,0 +1,265 @@
+// ReadAheadFile.cpp
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ReadAheadFile.hpp"
+
+
+
+ReadAheadFile::ReadAheadFile(const std::string& path, size_t blockSize)
+    : fileDescriptor{::open(path.c_str(), O_RDONLY)}, regularFile{false},
+      current{0}, position{0}, endReached{false}, waiting{0}, stopping{false}
+{
+    for (Block& block : blocks)
+    {
+        block.data.resize(std::max<size_t>(blockSize, 1));
+        block.size = 0;
+        block.full = false;
+    }
+
+    if (fileDescriptor < 0)
+    {
+        endReached = true;
+        return;
+    }
+
+    struct stat status;
+    regularFile = ::fstat(fileDescriptor, &status) == 0 && S_ISREG(status.st_mode);
+
+    if (regularFile)
+    {
+        ::posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        Compression compression = detectCompression(fileDescriptor);
+
+        if (compression != Compression::None)
+        {
+            decompressor = std::make_unique<Decompressor>(fileDescriptor, compression);
+
+            if (!decompressor->isOpen())
+            {
+                endReached = true;
+                return;
+            }
+        }
+    }
+
+    reader = std::thread{[this]() { readBlocks(); }};
+}
+
+
+ReadAheadFile::~ReadAheadFile()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+
+    blockEmptied.notify_all();
+
+    if (reader.joinable())
+    {
+        reader.join();
+    }
+
+    if (fileDescriptor >= 0)
+    {
+        ::close(fileDescriptor);
+    }
+}
+
+
+bool ReadAheadFile::isOpen() const
+{
+    return fileDescriptor >= 0 && (!decompressor || decompressor->isOpen());
+}
+
+
+Compression ReadAheadFile::compression() const
+{
+    return decompressor ? decompressor->compression() : Compression::None;
+}
+
+
+size_t ReadAheadFile::read(char* target, size_t size)
+{
+    if (endReached || size == 0)
+    {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock{mutex};
+    Block* block = &blocks[current];
+
+    if (block->full && position == block->size)
+    {
+        // The current block is used up, so it can be refilled while the
+        // next one is used.
+        block->full = false;
+        blockEmptied.notify_all();
+
+        current = 1 - current;
+        position = 0;
+        block = &blocks[current];
+    }
+
+    if (!block->full)
+    {
+        auto started = std::chrono::steady_clock::now();
+        blockFilled.wait(lock, [&]() { return block->full; });
+        waiting += std::chrono::steady_clock::now() - started;
+    }
+
+    // A block is only ever handed over empty at the end of the file.
+    if (block->size == 0)
+    {
+        endReached = true;
+        return 0;
+    }
+
+    size_t count = std::min(size, block->size - position);
+    lock.unlock();
+
+    // Only this thread touches a full block, so it can be copied from
+    // without holding the lock.
+    std::memcpy(target, block->data.data() + position, count);
+    position += count;
+    return count;
+}
+
+
+bool ReadAheadFile::dataReady() const
+{
+    if (endReached)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    const Block& block = blocks[current];
+
+    return block.full && (position < block.size || block.size == 0 || blocks[1 - current].full);
+}
+
+
+std::chrono::nanoseconds ReadAheadFile::timeWaiting() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return waiting;
+}
+
+
+void ReadAheadFile::readBlocks()
+{
+    off_t offset = 0;
+    size_t next = 0;
+
+    while (true)
+    {
+        Block& block = blocks[next];
+
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            blockEmptied.wait(lock, [&]() { return stopping || !block.full; });
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+
+        size_t count = fill(block.data.data(), block.data.size(), offset);
+        offset += count;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            block.size = count;
+            block.full = true;
+        }
+
+        blockFilled.notify_all();
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        next = 1 - next;
+    }
+}
+
+
+// fill() reads as much of a block as it can.  A regular file is read
+// until the block is full or the file ends, but a pipe or device only
+// until whatever it has available has been read, so that its data isn't
+// held back waiting for more.  Errors are treated as the end of the file.
+//
+// Waiting for a pipe is done in short polls, so that a ReadAheadFile can
+// be destroyed before its writer is done with it.  A compressed file is
+// decompressed until the block is full or the decompressed data ends.
+size_t ReadAheadFile::fill(char* target, size_t size, off_t offset)
+{
+    size_t filled = 0;
+
+    if (decompressor)
+    {
+        while (filled < size && !stopping)
+        {
+            size_t count = decompressor->read(target + filled, size - filled);
+
+            if (count == 0)
+            {
+                break;
+            }
+
+            filled += count;
+        }
+
+        return filled;
+    }
+
+    while (filled < size)
+    {
+        if (!regularFile)
+        {
+            struct pollfd source{fileDescriptor, POLLIN, 0};
+
+            if (::poll(&source, 1, 100) == 0)
+            {
+                if (stopping)
+                {
+                    break;
+                }
+
+                continue;
+            }
+        }
+
+        ssize_t count = regularFile
+            ? ::pread(fileDescriptor, target + filled, size - filled, offset + filled)
+            : ::read(fileDescriptor, target + filled, size - filled);
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count <= 0)
+        {
+            break;
+        }
+
+        filled += count;
+
+        if (!regularFile)
+        {
+            break;
+        }
+    }
+
+    return filled;
+}
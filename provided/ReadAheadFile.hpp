@@ -0,0 +1,105 @@
+// ReadAheadFile.hpp
+//
+// A ReadAheadFile reads a file sequentially, a block at a time, on a
+// background thread, so that the next block is being read while the one
+// before it is being used.  There are two blocks: while one is being
+// consumed by read(), the other is being filled.
+//
+// Regular files are read with pread(); anything else, such as a pipe or
+// a device, is read with read(), in which case a block may be handed out
+// before it's full, as soon as any data has arrived.
+//
+// A regular file compressed with gzip or zstd is decompressed as it's
+// read (see Decompressor), so decompressing also happens on the
+// background thread, and read() hands out the decompressed contents.
+
+#ifndef READAHEADFILE_HPP
+#define READAHEADFILE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Decompressor.hpp"
+
+
+
+class ReadAheadFile
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+public:
+    // Opens the file with the given path and starts reading it.  A file
+    // that can't be opened, or is compressed in a way this build can't
+    // decompress, reads as though it were empty.
+    explicit ReadAheadFile(const std::string& path, size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    // Stops reading and closes the file.
+    ~ReadAheadFile();
+
+    ReadAheadFile(const ReadAheadFile&) = delete;
+    ReadAheadFile& operator=(const ReadAheadFile&) = delete;
+
+    bool isOpen() const;
+
+    // compression() returns the kind of compression the file uses.
+    Compression compression() const;
+
+
+    // read() copies up to size bytes into target, waiting for the next
+    // block if the current one has been used up, and returns the number
+    // of bytes copied, which is 0 only at the end of the file.  It never
+    // copies from more than one block, so it may return fewer bytes than
+    // requested even when there are more to come.
+    size_t read(char* target, size_t size);
+
+
+    // dataReady() returns true if read() can return without waiting.
+    bool dataReady() const;
+
+
+    // timeWaiting() returns the total time read() has spent waiting for
+    // blocks to be read, which is the time that reading didn't overlap
+    // with whatever was done with the blocks.
+    std::chrono::nanoseconds timeWaiting() const;
+
+
+private:
+    struct Block
+    {
+        std::vector<char> data;
+        size_t size;
+        bool full;
+    };
+
+    int fileDescriptor;
+    bool regularFile;
+    std::unique_ptr<Decompressor> decompressor;
+
+    Block blocks[2];
+    size_t current;
+    size_t position;
+    bool endReached;
+
+    std::chrono::nanoseconds waiting;
+
+    mutable std::mutex mutex;
+    std::condition_variable blockFilled;
+    std::condition_variable blockEmptied;
+    std::atomic<bool> stopping;
+
+    std::thread reader;
+
+private:
+    void readBlocks();
+    size_t fill(char* target, size_t size, off_t offset);
+};
+
+
+
+#endif // READAHEADFILE_HPP
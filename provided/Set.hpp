@@ -7,6 +7,9 @@
 #ifndef SET_HPP
 #define SET_HPP
 
+#include <istream>
+#include <ostream>
+#include <vector>
 
 
 template <typename T>
@@ -35,11 +38,71 @@ public:
     virtual bool contains(const T& element) const = 0;
 
 
+    // containsBatch() returns a vector with one entry per given element,
+    // indicating whether that element is in the set.  The default simply
+    // calls contains() on each element in turn; implementations that can
+    // overlap the memory accesses of several lookups should override it.
+    virtual std::vector<bool> containsBatch(const std::vector<T>& elements) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const = 0;
+
+
+    // saveSnapshot() writes a snapshot of the set to the given stream, in
+    // a form particular to the kind of set that keeps its structure (the
+    // shape of a tree, the levels of a skip list, or the layout of a hash
+    // table), so that loadSnapshot() can rebuild it as it was without
+    // adding the elements one at a time.  It returns false if this kind
+    // of set can't be saved as a snapshot, or if writing failed.  (See
+    // SetSnapshot.hpp.)
+    virtual bool saveSnapshot(std::ostream& out) const;
+
+
+    // loadSnapshot() replaces the contents of the set with those of a
+    // snapshot written by saveSnapshot() from the same kind of set.  It
+    // returns false, leaving the set as it was, if the snapshot is of some
+    // other kind of set, or is cut short or otherwise not valid.
+    virtual bool loadSnapshot(std::istream& in);
 };
 
 
 
+// The number of lookups that an overriding containsBatch() keeps in flight
+// at once.  It's small enough that what's prefetched for each lookup is
+// still in cache by the time that lookup uses it.
+inline constexpr unsigned int CONTAINS_BATCH_WINDOW = 16;
+
+
+template <typename T>
+std::vector<bool> Set<T>::containsBatch(const std::vector<T>& elements) const
+{
+    std::vector<bool> results;
+    results.reserve(elements.size());
+
+    for (const T& element : elements)
+    {
+        results.push_back(contains(element));
+    }
+
+    return results;
+}
+
+
+template <typename T>
+bool Set<T>::saveSnapshot(std::ostream&) const
+{
+    return false;
+}
+
+
+template <typename T>
+bool Set<T>::loadSnapshot(std::istream&)
+{
+    return false;
+}
+
+
+
 #endif // SET_HPP
 
@@ -0,0 +1,256 @@
+// SetSnapshot.hpp
+//
+// Functions that Set implementations use to write and read snapshots of
+// themselves (see Set<T>::saveSnapshot()).  Every snapshot starts with a
+// 24-byte header: the magic bytes "SETSNAP" and a NUL, the kind of set it
+// is, NUL-padded to eight bytes, the snapshot format version, and four
+// reserved bytes.  What follows is up to the kind of set, built from
+// integers, lengths and elements written by the functions here.  As with
+// compiled dictionaries, integers are written in the byte order of the
+// machine writing them.  Lengths, which are usually small, are written
+// seven bits to a byte, with the high bit set on every byte but the last.
+//
+// Elements that are strings are written as a length followed by their
+// bytes; elements of any other trivially copyable type are written as
+// they're laid out in memory.
+//
+// Snapshots are read and written through the streams' buffers directly,
+// since they're made of a great many small pieces.
+
+#ifndef SETSNAPSHOT_HPP
+#define SETSNAPSHOT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+
+constexpr std::uint32_t SET_SNAPSHOT_VERSION = 1;
+
+// The longest string element a snapshot can hold, in bytes, so that a
+// corrupt length can't make reading a snapshot allocate without limit.
+constexpr std::uint64_t SET_SNAPSHOT_MAXIMUM_STRING_LENGTH = 1 << 24;
+
+
+
+namespace setSnapshotDetail
+{
+    const char magic[8] = { 'S', 'E', 'T', 'S', 'N', 'A', 'P', '\0' };
+
+
+    struct Header
+    {
+        char magic[8];
+        char kind[8];
+        std::uint32_t version;
+        char reserved[4];
+    };
+
+    static_assert(sizeof(Header) == 24, "set snapshot headers are 24 bytes");
+
+
+    inline Header makeHeader(const char* kind)
+    {
+        Header header{};
+        std::copy(magic, magic + sizeof(magic), header.magic);
+        std::copy_n(kind, std::min(std::strlen(kind), sizeof(header.kind)), header.kind);
+        header.version = SET_SNAPSHOT_VERSION;
+        return header;
+    }
+
+
+    inline void write(std::ostream& out, const void* data, std::streamsize size)
+    {
+        if (out.rdbuf()->sputn(static_cast<const char*>(data), size) != size)
+        {
+            out.setstate(std::ios::badbit);
+        }
+    }
+
+
+    inline bool read(std::istream& in, void* data, std::streamsize size)
+    {
+        if (in.rdbuf()->sgetn(static_cast<char*>(data), size) != size)
+        {
+            in.setstate(std::ios::failbit);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+
+// isSetSnapshot() returns true if the file at the given path starts with
+// a set snapshot's magic bytes, without checking any more.
+inline bool isSetSnapshot(const std::string& path)
+{
+    std::ifstream in{path, std::ios::binary};
+    char bytes[sizeof(setSnapshotDetail::magic)];
+
+    return in.read(bytes, sizeof(bytes))
+        && std::equal(bytes, bytes + sizeof(bytes), setSnapshotDetail::magic);
+}
+
+
+// writeSnapshotHeader() writes the header of a snapshot of the given kind
+// of set, and readSnapshotHeader() reads one, returning false if it isn't
+// a snapshot of that kind of set, or is of another version.
+inline void writeSnapshotHeader(std::ostream& out, const char* kind)
+{
+    setSnapshotDetail::Header header = setSnapshotDetail::makeHeader(kind);
+    setSnapshotDetail::write(out, &header, sizeof(header));
+}
+
+
+inline bool readSnapshotHeader(std::istream& in, const char* kind)
+{
+    setSnapshotDetail::Header expected = setSnapshotDetail::makeHeader(kind);
+    setSnapshotDetail::Header header;
+
+    return setSnapshotDetail::read(in, &header, sizeof(header))
+        && std::memcmp(&header, &expected, offsetof(setSnapshotDetail::Header, reserved)) == 0;
+}
+
+
+template <typename Integer>
+void writeSnapshotInteger(std::ostream& out, Integer value)
+{
+    static_assert(std::is_integral<Integer>::value, "only integers are written this way");
+    setSnapshotDetail::write(out, &value, sizeof(value));
+}
+
+
+template <typename Integer>
+bool readSnapshotInteger(std::istream& in, Integer& value)
+{
+    static_assert(std::is_integral<Integer>::value, "only integers are read this way");
+    return setSnapshotDetail::read(in, &value, sizeof(value));
+}
+
+
+inline void writeSnapshotLength(std::ostream& out, std::uint64_t length)
+{
+    char bytes[10];
+    size_t count = 0;
+
+    for (; length >= 0x80; length >>= 7)
+    {
+        bytes[count++] = static_cast<char>(length | 0x80);
+    }
+
+    bytes[count++] = static_cast<char>(length);
+    setSnapshotDetail::write(out, bytes, count);
+}
+
+
+inline bool readSnapshotLength(std::istream& in, std::uint64_t& length)
+{
+    length = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        std::streambuf::int_type byte = in.rdbuf()->sbumpc();
+
+        if (byte == std::streambuf::traits_type::eof())
+        {
+            in.setstate(std::ios::failbit);
+            return false;
+        }
+
+        length |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    in.setstate(std::ios::failbit);
+    return false;
+}
+
+
+template <typename T>
+void writeSnapshotElement(std::ostream& out, const T& element)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+    setSnapshotDetail::write(out, &element, sizeof(element));
+}
+
+
+inline void writeSnapshotElement(std::ostream& out, const std::string& element)
+{
+    writeSnapshotLength(out, element.size());
+    setSnapshotDetail::write(out, element.data(), element.size());
+}
+
+
+template <typename T>
+bool readSnapshotElement(std::istream& in, T& element)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+    return setSnapshotDetail::read(in, &element, sizeof(element));
+}
+
+
+inline bool readSnapshotElement(std::istream& in, std::string& element)
+{
+    std::uint64_t length;
+
+    if (!readSnapshotLength(in, length) || length > SET_SNAPSHOT_MAXIMUM_STRING_LENGTH)
+    {
+        return false;
+    }
+
+    element.resize(length);
+    return setSnapshotDetail::read(in, element.data(), length);
+}
+
+
+// snapshotTreeIsOrdered() returns true if the keys of a binary search tree
+// loaded from a snapshot, whose nodes have a key and left and right
+// pointers, are strictly increasing in order, which those of a corrupt
+// snapshot might not be.  The tree is walked with a stack, since it might
+// be very deep.
+template <typename Node>
+bool snapshotTreeIsOrdered(const Node* root)
+{
+    std::vector<const Node*> stack;
+    const Node* previous = nullptr;
+    const Node* n = root;
+
+    while (n != nullptr || !stack.empty())
+    {
+        for (; n != nullptr; n = n->left)
+        {
+            stack.push_back(n);
+        }
+
+        n = stack.back();
+        stack.pop_back();
+
+        if (previous != nullptr && !(previous->key < n->key))
+        {
+            return false;
+        }
+
+        previous = n;
+        n = n->right;
+    }
+
+    return true;
+}
+
+
+
+#endif // SETSNAPSHOT_HPP
@@ -0,0 +1,163 @@
+// SpellCheckClient.cpp
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "SpellCheckClient.hpp"
+#include "SpellCheckProtocol.hpp"
+
+
+
+SpellCheckClient::SpellCheckClient(const std::string& socketPath)
+    : socket{-1}
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        return;
+    }
+
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (socket >= 0
+        && connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        disconnect();
+    }
+}
+
+
+SpellCheckClient::~SpellCheckClient()
+{
+    disconnect();
+}
+
+
+bool SpellCheckClient::isConnected() const
+{
+    return socket >= 0;
+}
+
+
+bool SpellCheckClient::checkWords(const std::vector<std::string>& words, std::vector<bool>& exists)
+{
+    std::string response;
+
+    if (!request(CHECK_WORDS_REQUEST, joinWords(words), response))
+    {
+        return false;
+    }
+    else if (response.size() != words.size())
+    {
+        disconnect();
+        return false;
+    }
+
+    exists.assign(words.size(), false);
+
+    for (size_t i = 0; i < response.size(); ++i)
+    {
+        exists[i] = response[i] == '1';
+    }
+
+    return true;
+}
+
+
+bool SpellCheckClient::findSuggestions(
+    const std::vector<std::string>& words,
+    std::vector<std::vector<std::string>>& suggestions)
+{
+    std::string response;
+
+    if (!request(SUGGEST_REQUEST, joinWords(words), response))
+    {
+        return false;
+    }
+
+    // Each word's line ends with a newline, so there's one more piece than
+    // there are words, and the last one is empty.
+    std::vector<std::string> lines = splitWords(response);
+
+    bool valid = words.empty()
+        ? lines.empty()
+        : lines.size() == words.size() + 1 && lines.back().empty();
+
+    if (!valid)
+    {
+        disconnect();
+        return false;
+    }
+
+    suggestions.assign(words.size(), std::vector<std::string>{});
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        size_t start = 0;
+
+        while (start < lines[i].size())
+        {
+            size_t end = lines[i].find(' ', start);
+
+            if (end == std::string::npos)
+            {
+                end = lines[i].size();
+            }
+
+            suggestions[i].push_back(lines[i].substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    return true;
+}
+
+
+bool SpellCheckClient::checkText(std::string_view text, std::string& misspellings)
+{
+    return request(CHECK_TEXT_REQUEST, text, misspellings);
+}
+
+
+bool SpellCheckClient::shutdownServer()
+{
+    std::string response;
+    return request(SHUTDOWN_REQUEST, std::string_view{}, response);
+}
+
+
+bool SpellCheckClient::request(char kind, std::string_view body, std::string& response)
+{
+    if (socket < 0)
+    {
+        return false;
+    }
+
+    std::string payload;
+    payload.reserve(1 + body.size());
+    payload += kind;
+    payload += body;
+
+    if (!sendFrame(socket, payload) || !receiveFrame(socket, response))
+    {
+        disconnect();
+        return false;
+    }
+
+    return true;
+}
+
+
+void SpellCheckClient::disconnect()
+{
+    if (socket >= 0)
+    {
+        close(socket);
+        socket = -1;
+    }
+}
@@ -0,0 +1,68 @@
+// SpellCheckClient.hpp
+//
+// A SpellCheckClient connects to a SpellCheckServer over its Unix domain
+// socket and makes requests of it (see SpellCheckProtocol.hpp), waiting
+// for the response to each.  A client is meant to be used by one thread
+// at a time; threads that make requests at the same time should each
+// have a client of their own.
+
+#ifndef SPELLCHECKCLIENT_HPP
+#define SPELLCHECKCLIENT_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+class SpellCheckClient
+{
+public:
+    // Connects to the server listening on the socket at the given path.
+    explicit SpellCheckClient(const std::string& socketPath);
+
+    ~SpellCheckClient();
+
+    SpellCheckClient(const SpellCheckClient&) = delete;
+    SpellCheckClient& operator=(const SpellCheckClient&) = delete;
+
+
+    // isConnected() returns false if the client couldn't connect, or if
+    // the connection has since failed.
+    bool isConnected() const;
+
+
+    // Each of these makes a request and stores what the server responded
+    // with, returning false if the client isn't connected or the response
+    // didn't arrive or made no sense, in which case the connection is
+    // closed.
+
+    // checkWords() stores, for each of the given words, whether it's
+    // spelled correctly.
+    bool checkWords(const std::vector<std::string>& words, std::vector<bool>& exists);
+
+    // findSuggestions() stores the suggestions for each of the given words.
+    bool findSuggestions(
+        const std::vector<std::string>& words,
+        std::vector<std::vector<std::string>>& suggestions);
+
+    // checkText() stores the misspellings in the given document, as the
+    // shell displays them.
+    bool checkText(std::string_view text, std::string& misspellings);
+
+    // shutdownServer() asks the server to shut down, returning once it
+    // has acknowledged the request.
+    bool shutdownServer();
+
+
+private:
+    int socket;
+
+private:
+    bool request(char kind, std::string_view body, std::string& response);
+    void disconnect();
+};
+
+
+
+#endif // SPELLCHECKCLIENT_HPP
@@ -0,0 +1,163 @@
+// SpellCheckProtocol.cpp
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include "SpellCheckProtocol.hpp"
+
+
+
+namespace
+{
+    bool sendAll(int socket, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            // MSG_NOSIGNAL keeps a connection closed by the other end from
+            // killing the process with SIGPIPE.
+            ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (sent <= 0)
+            {
+                return false;
+            }
+
+            data += sent;
+            size -= sent;
+        }
+
+        return true;
+    }
+
+
+    bool receiveAll(int socket, char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t received = recv(socket, data, size, 0);
+
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (received <= 0)
+            {
+                return false;
+            }
+
+            data += received;
+            size -= received;
+        }
+
+        return true;
+    }
+}
+
+
+
+void appendFrame(std::string& buffer, std::string_view payload)
+{
+    std::uint32_t length = payload.size();
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer.append(payload);
+}
+
+
+FrameStatus findFrame(std::string_view buffer, size_t& offset, std::string_view& payload)
+{
+    if (buffer.size() - offset < FRAME_HEADER_SIZE)
+    {
+        return FrameStatus::Incomplete;
+    }
+
+    std::uint32_t length;
+    std::memcpy(&length, buffer.data() + offset, sizeof(length));
+
+    if (length > MAXIMUM_FRAME_SIZE)
+    {
+        return FrameStatus::TooLarge;
+    }
+    else if (buffer.size() - offset - FRAME_HEADER_SIZE < length)
+    {
+        return FrameStatus::Incomplete;
+    }
+
+    payload = buffer.substr(offset + FRAME_HEADER_SIZE, length);
+    offset += FRAME_HEADER_SIZE + length;
+    return FrameStatus::Complete;
+}
+
+
+bool sendFrame(int socket, std::string_view payload)
+{
+    std::string frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    appendFrame(frame, payload);
+
+    return sendAll(socket, frame.data(), frame.size());
+}
+
+
+bool receiveFrame(int socket, std::string& payload)
+{
+    std::uint32_t length;
+
+    if (!receiveAll(socket, reinterpret_cast<char*>(&length), sizeof(length))
+        || length > MAXIMUM_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    payload.resize(length);
+    return receiveAll(socket, payload.data(), length);
+}
+
+
+std::string joinWords(const std::vector<std::string>& words)
+{
+    std::string body;
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        if (i > 0)
+        {
+            body += '\n';
+        }
+
+        body += words[i];
+    }
+
+    return body;
+}
+
+
+std::vector<std::string> splitWords(std::string_view body)
+{
+    std::vector<std::string> words;
+
+    if (body.empty())
+    {
+        return words;
+    }
+
+    size_t start = 0;
+
+    while (true)
+    {
+        size_t end = body.find('\n', start);
+
+        if (end == std::string_view::npos)
+        {
+            words.emplace_back(body.substr(start));
+            return words;
+        }
+
+        words.emplace_back(body.substr(start, end - start));
+        start = end + 1;
+    }
+}
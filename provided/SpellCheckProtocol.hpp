@@ -0,0 +1,82 @@
+// SpellCheckProtocol.hpp
+//
+// The protocol spoken over a Unix domain socket between a SpellCheckServer
+// and its clients.  Every message, in either direction, is a frame: a
+// four-byte length, in the byte order of the machine (the socket is only
+// ever local), followed by that many bytes.  A request's first byte says
+// what kind of request it is, and the rest is its body:
+//
+//     'W' and words separated by newlines: the response holds one byte
+//         per word, '1' if it's spelled correctly and '0' if it isn't
+//
+//     'S' and words separated by newlines: the response holds a line for
+//         each word, listing its suggestions separated by spaces
+//
+//     'T' and a document: the response lists the misspellings in the
+//         document, with their suggestions, as the shell displays them
+//
+//     'Q': the server responds with an empty frame, then shuts down
+//
+// Words are looked up exactly as given, so they should already be
+// normalized the way the dictionary's words were (see WordTokenizer).
+// Each client gets its responses in the order it sent its requests, and
+// may send several requests before reading any of the responses.  A
+// request the server doesn't understand, or a frame longer than
+// MAXIMUM_FRAME_SIZE, makes it close the connection.
+
+#ifndef SPELLCHECKPROTOCOL_HPP
+#define SPELLCHECKPROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+constexpr char CHECK_WORDS_REQUEST = 'W';
+constexpr char SUGGEST_REQUEST = 'S';
+constexpr char CHECK_TEXT_REQUEST = 'T';
+constexpr char SHUTDOWN_REQUEST = 'Q';
+
+constexpr std::uint32_t MAXIMUM_FRAME_SIZE = 1 << 26;
+
+constexpr size_t FRAME_HEADER_SIZE = sizeof(std::uint32_t);
+
+
+// appendFrame() appends a frame holding the given payload to the given
+// buffer.
+void appendFrame(std::string& buffer, std::string_view payload);
+
+
+enum class FrameStatus
+{
+    Complete,
+    Incomplete,
+    TooLarge
+};
+
+
+// findFrame() looks for a complete frame in the given buffer, starting at
+// the given offset.  If there is one, it stores a view of its payload and
+// moves the offset past it.
+FrameStatus findFrame(std::string_view buffer, size_t& offset, std::string_view& payload);
+
+
+// sendFrame() and receiveFrame() write and read one frame on the given
+// socket, waiting for as long as it takes, and return false if the
+// connection fails or is closed (or, for receiveFrame(), if the frame is
+// too large).
+bool sendFrame(int socket, std::string_view payload);
+bool receiveFrame(int socket, std::string& payload);
+
+
+// joinWords() joins words with newlines, the way requests carry them, and
+// splitWords() splits them apart again.  An empty body holds no words, so
+// a single empty word can't be asked about.
+std::string joinWords(const std::vector<std::string>& words);
+std::vector<std::string> splitWords(std::string_view body);
+
+
+
+#endif // SPELLCHECKPROTOCOL_HPP
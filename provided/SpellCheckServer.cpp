@@ -0,0 +1,511 @@
+// SpellCheckServer.cpp
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "MappedTextFileReader.hpp"
+#include "OutputSpellCheckerListener.hpp"
+#include "SpellChecker.hpp"
+#include "SpellCheckProtocol.hpp"
+#include "SpellCheckServer.hpp"
+
+
+
+namespace
+{
+    // How long the server waits, when it's shutting down, for clients to
+    // read the responses they haven't read yet.
+    constexpr int SHUTDOWN_TIMEOUT_MILLISECONDS = 1000;
+
+
+    bool isKnownRequest(char kind)
+    {
+        return kind == CHECK_WORDS_REQUEST || kind == SUGGEST_REQUEST
+            || kind == CHECK_TEXT_REQUEST || kind == SHUTDOWN_REQUEST;
+    }
+
+
+    // A socket left behind by a server that didn't shut down cleanly is
+    // replaced, but anything else at the path is left alone, so that
+    // binding to it fails.
+    void removeStaleSocket(const std::string& socketPath)
+    {
+        struct stat status;
+
+        if (lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        {
+            unlink(socketPath.c_str());
+        }
+    }
+}
+
+
+
+SpellCheckServer::SpellCheckServer(DictionaryHandle& dictionary, const std::string& socketPath)
+    : dictionary{dictionary}, socketPath{socketPath},
+      listener{-1}, wakeReader{-1}, wakeWriter{-1}, stopping{false},
+      connections{}, wordChecker{}, wordCheckerVersion{0}, requests{0}, batches{0}
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path) || dictionary.current() == nullptr)
+    {
+        return;
+    }
+
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int wakeEnds[2];
+
+    if (pipe2(wakeEnds, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        return;
+    }
+
+    wakeReader = wakeEnds[0];
+    wakeWriter = wakeEnds[1];
+
+    removeStaleSocket(socketPath);
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (listener >= 0
+        && (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listener, SOMAXCONN) != 0))
+    {
+        close(listener);
+        listener = -1;
+    }
+}
+
+
+SpellCheckServer::~SpellCheckServer()
+{
+    for (const std::unique_ptr<Connection>& connection : connections)
+    {
+        close(connection->socket);
+    }
+
+    if (listener >= 0)
+    {
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+
+    if (wakeReader >= 0)
+    {
+        close(wakeReader);
+        close(wakeWriter);
+    }
+}
+
+
+bool SpellCheckServer::isListening() const
+{
+    return listener >= 0;
+}
+
+
+void SpellCheckServer::run()
+{
+    std::vector<pollfd> events;
+
+    while (!stopping && isListening())
+    {
+        events.clear();
+        events.push_back(pollfd{listener, POLLIN, 0});
+        events.push_back(pollfd{wakeReader, POLLIN, 0});
+
+        for (const std::unique_ptr<Connection>& connection : connections)
+        {
+            size_t pendingOutput = connection->output.size() - connection->outputOffset;
+            short wanted = 0;
+
+            if (!connection->closed && pendingOutput < MAXIMUM_PENDING_OUTPUT)
+            {
+                wanted |= POLLIN;
+            }
+
+            if (pendingOutput > 0)
+            {
+                wanted |= POLLOUT;
+            }
+
+            events.push_back(pollfd{connection->socket, wanted, 0});
+        }
+
+        if (poll(events.data(), events.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        if (events[1].revents != 0)
+        {
+            char drained[64];
+
+            while (read(wakeReader, drained, sizeof(drained)) > 0)
+            {
+            }
+        }
+
+        for (size_t i = 0; i < connections.size(); ++i)
+        {
+            short happened = events[i + 2].revents;
+
+            if ((happened & (POLLIN | POLLHUP | POLLERR)) != 0 && !connections[i]->closed)
+            {
+                readFrom(*connections[i]);
+            }
+        }
+
+        if ((events[0].revents & POLLIN) != 0)
+        {
+            acceptConnections();
+        }
+
+        std::vector<Request> batch = takeRequests();
+
+        if (!batch.empty())
+        {
+            serve(batch);
+        }
+
+        // Responses are sent right away, rather than waiting to be told
+        // the sockets can take them, since they usually can.
+        for (const std::unique_ptr<Connection>& connection : connections)
+        {
+            connection->input.erase(0, connection->inputOffset);
+            connection->inputOffset = 0;
+
+            writeTo(*connection);
+        }
+
+        for (size_t i = 0; i < connections.size(); )
+        {
+            if (connections[i]->closed && connections[i]->outputOffset == connections[i]->output.size())
+            {
+                close(connections[i]->socket);
+                connections.erase(connections.begin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    // Before shutting down, clients are given a little while to read what
+    // they've been sent, including the acknowledgement of a shutdown.
+    while (true)
+    {
+        events.clear();
+
+        for (const std::unique_ptr<Connection>& connection : connections)
+        {
+            if (connection->outputOffset < connection->output.size())
+            {
+                events.push_back(pollfd{connection->socket, POLLOUT, 0});
+            }
+        }
+
+        if (events.empty() || poll(events.data(), events.size(), SHUTDOWN_TIMEOUT_MILLISECONDS) <= 0)
+        {
+            break;
+        }
+
+        for (const std::unique_ptr<Connection>& connection : connections)
+        {
+            writeTo(*connection);
+        }
+    }
+}
+
+
+void SpellCheckServer::stop()
+{
+    stopping = true;
+
+    if (wakeWriter >= 0)
+    {
+        // If the pipe is full, the server is already due to wake up.
+        char wake = 0;
+        [[maybe_unused]] ssize_t written = write(wakeWriter, &wake, 1);
+    }
+}
+
+
+unsigned long SpellCheckServer::requestCount() const
+{
+    return requests.load();
+}
+
+
+unsigned long SpellCheckServer::batchCount() const
+{
+    return batches.load();
+}
+
+
+void SpellCheckServer::acceptConnections()
+{
+    while (true)
+    {
+        int socket = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (socket < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return;
+        }
+
+        connections.push_back(
+            std::unique_ptr<Connection>{new Connection{socket, "", 0, "", 0, false}});
+    }
+}
+
+
+void SpellCheckServer::readFrom(Connection& connection)
+{
+    char buffer[65536];
+
+    while (true)
+    {
+        ssize_t received = recv(connection.socket, buffer, sizeof(buffer), 0);
+
+        if (received > 0)
+        {
+            connection.input.append(buffer, received);
+        }
+        else if (received == 0)
+        {
+            // The client has finished sending, but may still be waiting
+            // for responses.
+            connection.closed = true;
+            return;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return;
+        }
+        else
+        {
+            connection.closed = true;
+            connection.output.clear();
+            connection.outputOffset = 0;
+            return;
+        }
+    }
+}
+
+
+void SpellCheckServer::writeTo(Connection& connection)
+{
+    while (connection.outputOffset < connection.output.size())
+    {
+        ssize_t sent = send(
+            connection.socket, connection.output.data() + connection.outputOffset,
+            connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+
+        if (sent > 0)
+        {
+            connection.outputOffset += sent;
+        }
+        else if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        else
+        {
+            // The client has gone away, so there's no one to send the
+            // rest to.
+            connection.closed = true;
+            break;
+        }
+    }
+
+    connection.output.clear();
+    connection.outputOffset = 0;
+}
+
+
+std::vector<SpellCheckServer::Request> SpellCheckServer::takeRequests()
+{
+    std::vector<Request> batch;
+
+    for (const std::unique_ptr<Connection>& connection : connections)
+    {
+        size_t firstRequest = batch.size();
+        std::string_view payload;
+        bool broken = false;
+
+        while (true)
+        {
+            FrameStatus status = findFrame(connection->input, connection->inputOffset, payload);
+
+            if (status != FrameStatus::Complete)
+            {
+                broken = status == FrameStatus::TooLarge;
+                break;
+            }
+            else if (payload.empty() || !isKnownRequest(payload[0]))
+            {
+                broken = true;
+                break;
+            }
+
+            batch.push_back(Request{connection.get(), payload[0], payload.substr(1)});
+        }
+
+        // A client that breaks the protocol is disconnected, without
+        // answering any of its requests, since it can't be trusted to
+        // make sense of the answers.
+        if (broken)
+        {
+            batch.resize(firstRequest);
+            connection->closed = true;
+            connection->inputOffset = connection->input.size();
+            connection->output.clear();
+            connection->outputOffset = 0;
+        }
+    }
+
+    return batch;
+}
+
+
+void SpellCheckServer::serve(const std::vector<Request>& batch)
+{
+    const WordChecker& checker = currentWordChecker();
+
+    // The words of every word-checking request in the batch are looked up
+    // together, so the lookups' cache misses overlap across requests.
+    std::vector<std::string> words;
+    std::vector<size_t> firstWords;
+
+    for (const Request& request : batch)
+    {
+        firstWords.push_back(words.size());
+
+        if (request.kind == CHECK_WORDS_REQUEST)
+        {
+            std::vector<std::string> requestWords = splitWords(request.body);
+            words.insert(
+                words.end(),
+                std::make_move_iterator(requestWords.begin()),
+                std::make_move_iterator(requestWords.end()));
+        }
+    }
+
+    firstWords.push_back(words.size());
+
+    std::vector<bool> exists = checker.wordsExist(words);
+    std::string response;
+
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        const Request& request = batch[i];
+        response.clear();
+
+        switch (request.kind)
+        {
+        case CHECK_WORDS_REQUEST:
+            for (size_t j = firstWords[i]; j < firstWords[i + 1]; ++j)
+            {
+                response += exists[j] ? '1' : '0';
+            }
+
+            break;
+
+        case SUGGEST_REQUEST:
+            for (const std::string& word : splitWords(request.body))
+            {
+                std::vector<std::string> suggestions = checker.findSuggestions(word);
+
+                for (size_t j = 0; j < suggestions.size(); ++j)
+                {
+                    if (j > 0)
+                    {
+                        response += ' ';
+                    }
+
+                    response += suggestions[j];
+                }
+
+                response += '\n';
+            }
+
+            break;
+
+        case CHECK_TEXT_REQUEST:
+            response = checkText(checker, request.body);
+            break;
+
+        case SHUTDOWN_REQUEST:
+            stopping = true;
+            break;
+        }
+
+        appendFrame(request.connection->output, response);
+    }
+
+    requests += batch.size();
+    ++batches;
+}
+
+
+std::string SpellCheckServer::checkText(const WordChecker& checker, std::string_view text) const
+{
+    std::ostringstream misspellings;
+
+    SpellChecker spellChecker;
+    std::shared_ptr<OutputSpellCheckerListener> output =
+        std::make_shared<OutputSpellCheckerListener>(misspellings);
+
+    spellChecker.addObserver(output);
+
+    MappedTextFileReader reader{text.data(), text.data() + text.size()};
+    spellChecker.run(checker, reader);
+
+    return misspellings.str();
+}
+
+
+const WordChecker& SpellCheckServer::currentWordChecker()
+{
+    // The version is read before the dictionary, so if the dictionary is
+    // replaced in between, the next batch just makes a new checker again.
+    unsigned long version = dictionary.version();
+
+    if (wordChecker == nullptr || version != wordCheckerVersion)
+    {
+        wordChecker = std::make_unique<WordChecker>(dictionary.current());
+        wordCheckerVersion = version;
+    }
+
+    return *wordChecker;
+}
@@ -0,0 +1,119 @@
+// SpellCheckServer.hpp
+//
+// A SpellCheckServer keeps a dictionary loaded and answers requests to
+// check words and documents, and to find suggestions, that clients send
+// it over a Unix domain socket (see SpellCheckProtocol.hpp), so that
+// checking a small document doesn't mean loading the dictionary again.
+//
+// The server runs on one thread, waiting with poll() for any of its
+// clients to send something.  Every request that has arrived by the time
+// it wakes up is served as part of one batch: the words of all of the
+// batch's word-checking requests are looked up together, with a single
+// call to WordChecker::wordsExist(), and the rest are served in turn.
+// Clients are answered as soon as their batch has been served.
+//
+// The dictionary is taken from a DictionaryHandle at the start of each
+// batch, so it can be reloaded in the background while the server runs;
+// the suggestion cache is kept from one batch to the next until it is.
+
+#ifndef SPELLCHECKSERVER_HPP
+#define SPELLCHECKSERVER_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Dictionary.hpp"
+#include "WordChecker.hpp"
+
+
+
+class SpellCheckServer
+{
+public:
+    // A client whose responses haven't been read isn't read from again
+    // until fewer than this many bytes of them are waiting to be sent.
+    static constexpr size_t MAXIMUM_PENDING_OUTPUT = 1 << 20;
+
+public:
+    // Starts listening on a socket at the given path, replacing anything
+    // already there, for requests to check words against the dictionary
+    // held by the given handle.  The handle must outlive the server.
+    SpellCheckServer(DictionaryHandle& dictionary, const std::string& socketPath);
+
+    // Closes every connection, and removes the socket.
+    ~SpellCheckServer();
+
+    SpellCheckServer(const SpellCheckServer&) = delete;
+    SpellCheckServer& operator=(const SpellCheckServer&) = delete;
+
+
+    // isListening() returns false if the socket couldn't be set up.
+    bool isListening() const;
+
+
+    // run() serves requests until stop() is called or a client asks the
+    // server to shut down.
+    void run();
+
+    // stop() makes run() return once it's finished the batch it's serving.
+    // It can be called from any thread.
+    void stop();
+
+
+    // requestCount() and batchCount() return how many requests have been
+    // served, and in how many batches.
+    unsigned long requestCount() const;
+    unsigned long batchCount() const;
+
+
+private:
+    struct Connection
+    {
+        int socket;
+        std::string input;
+        size_t inputOffset;
+        std::string output;
+        size_t outputOffset;
+        bool closed;
+    };
+
+    struct Request
+    {
+        Connection* connection;
+        char kind;
+        std::string_view body;
+    };
+
+
+    DictionaryHandle& dictionary;
+    std::string socketPath;
+
+    int listener;
+    int wakeReader;
+    int wakeWriter;
+    std::atomic<bool> stopping;
+
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    std::unique_ptr<WordChecker> wordChecker;
+    unsigned long wordCheckerVersion;
+
+    std::atomic<unsigned long> requests;
+    std::atomic<unsigned long> batches;
+
+private:
+    void acceptConnections();
+    void readFrom(Connection& connection);
+    void writeTo(Connection& connection);
+
+    std::vector<Request> takeRequests();
+    void serve(const std::vector<Request>& batch);
+    std::string checkText(const WordChecker& checker, std::string_view text) const;
+    const WordChecker& currentWordChecker();
+};
+
+
+
+#endif // SPELLCHECKSERVER_HPP
@@ -1,24 +1,40 @@
 // SpellCheckShell.cpp
 
 
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <sstream>
 #include "SpellCheckShell.hpp"
 #include "AVLSet.hpp"
+#include "BloomFilter.hpp"
 #include "BSTSet.hpp"
+#include "CompiledWordSet.hpp"
+#include "Decompressor.hpp"
+#include "Dictionary.hpp"
 #include "EmptySet.hpp"
 #include "HashSet.hpp"
 #include "ListSet.hpp"
+#include "MappedFile.hpp"
+#include "MappedTextFileReader.hpp"
 #include "OutputSpellCheckerListener.hpp"
+#include "ReadAheadFile.hpp"
 #include "Set.hpp"
+#include "SetSnapshot.hpp"
 #include "SkipListSet.hpp"
 #include "SpellChecker.hpp"
+#include "SpellCheckClient.hpp"
+#include "SpellCheckServer.hpp"
 #include "Stopwatch.hpp"
+#include "StreamTextReader.hpp"
 #include "StringHashing.hpp"
-#include "TextFileReader.hpp"
+#include "ThreadPool.hpp"
+#include "WindowedTextReader.hpp"
 #include "WordChecker.hpp"
+#include "WordFrequencies.hpp"
 #include "WordSetLoader.hpp"
 
 
@@ -56,6 +72,10 @@ namespace
         {
             return std::make_unique<BSTSet<std::string>>();
         }
+        else if (setType == "COMPILED")
+        {
+            return std::make_unique<CompiledWordSet>();
+        }
         else if (setType == "EMPTY")
         {
             return std::make_unique<EmptySet<std::string>>();
@@ -76,6 +96,10 @@ namespace
         {
             return std::make_unique<ListSet<std::string>>();
         }
+        else if (setType == "SHARED")
+        {
+            return std::make_unique<CompiledWordSet>();
+        }
         else if (setType == "SKIPLIST")
         {
             return std::make_unique<SkipListSet<std::string>>();
@@ -86,9 +110,29 @@ namespace
         }
     }
 
+
+    void requireImplemented(const Set<std::string>& wordSet)
+    {
+        if (!wordSet.isImplemented())
+        {
+            throw SpellCheckShell::ShellException{
+                "Search structure type not implemented (did you change isImplemented() to return true?)"};
+        }
+    }
+
     
+    // A compressed file is only checked to be non-empty before it's
+    // decompressed, but is also checked to be decompressible.
     void requireNonEmptyFileExists(const std::string& filePath)
     {
+        Compression compression = detectCompression(filePath);
+
+        if (!compressionSupported(compression))
+        {
+            throw SpellCheckShell::ShellException{
+                "Cannot decompress " + compressionName(compression) + " file: " + filePath};
+        }
+
         std::ifstream file{filePath};
 
         if (file.is_open())
@@ -118,6 +162,119 @@ namespace
     };
 
 
+    // Options that change how the spell check is run.  The search structure
+    // type may be followed by " BLOOM", and the output type by any of:
+    //
+    //     TOP k     rank suggestions and report only the best k of them,
+    //               using word frequencies from a file alongside the word
+    //               set, if there is one (see frequencyFilePathFor())
+    //     THREADS n load the word set, check chunks of the input file, and
+    //               find suggestions for long words, using n threads
+    //     BUDGET t  spend at most t microseconds finding suggestions for
+    //               each misspelled word
+    //     PROBES n  look up at most (about) n candidate words when finding
+    //               suggestions for each misspelled word
+    //     STREAM    read the text file as a stream, a block at a time, so
+    //               that it can be a pipe and can be of any size (text
+    //               files compressed with gzip or zstd are always read
+    //               this way)
+    //     BLOCK n   read streams ahead on a background thread in blocks of
+    //               n KB (0 turns reading ahead off)
+    //     CONTEXT n read the text file through a fixed-size window, never
+    //               holding a whole line, and report at most n bytes of a
+    //               misspelling's line on either side of it, so that files
+    //               with gigantic lines are checked in bounded memory
+    //     PIPELINE n  read, look up, find suggestions for, and report
+    //               words in a pipeline of stages that run at once, on
+    //               threads of their own, finding suggestions on n threads
+    //               (see SpellChecker::runPipelined()), unless THREADS is
+    //               given and the file is checked in chunks instead
+    //
+    // The text file may be given as "-", meaning the rest of the standard
+    // input, which is always read as a stream.
+    struct RunOptions
+    {
+        bool useBloomFilter = false;
+        bool sharedMemory = false;
+        unsigned int topSuggestions = 0;
+        unsigned int threads = 1;
+        SuggestionBudget budget;
+        bool stream = false;
+        unsigned int pipelineThreads = 0;
+        size_t readAheadBlockSize = ReadAheadFile::DEFAULT_BLOCK_SIZE;
+        size_t contextSize = 0;
+    };
+
+
+    const std::string standardInputPath = "-";
+
+
+    void readRunOptions(std::istringstream& in, RunOptions& options)
+    {
+        std::string option;
+        long budgetTime;
+        size_t blockKilobytes;
+
+        while (in >> option)
+        {
+            if (option == "TOP" && in >> options.topSuggestions && options.topSuggestions > 0)
+            {
+                continue;
+            }
+            else if (option == "THREADS" && in >> options.threads && options.threads > 0)
+            {
+                continue;
+            }
+            else if (option == "BUDGET" && in >> budgetTime && budgetTime > 0)
+            {
+                options.budget.time = std::chrono::microseconds{budgetTime};
+            }
+            else if (option == "PROBES" && in >> options.budget.probes && options.budget.probes > 0)
+            {
+                continue;
+            }
+            else if (option == "STREAM")
+            {
+                options.stream = true;
+            }
+            else if (option == "PIPELINE" && in >> options.pipelineThreads && options.pipelineThreads > 0)
+            {
+                continue;
+            }
+            else if (option == "BLOCK" && in >> blockKilobytes)
+            {
+                options.readAheadBlockSize = blockKilobytes * 1024;
+            }
+            else if (option == "CONTEXT" && in >> options.contextSize && options.contextSize > 0)
+            {
+                continue;
+            }
+            else
+            {
+                throw SpellCheckShell::ShellException{"Invalid option: " + option};
+            }
+        }
+    }
+
+
+    // The word frequency table for a word set is in a file with the same
+    // name, but with the extension ".freq" (e.g., wordset.freq).
+    std::string frequencyFilePathFor(const std::string& wordFilePath)
+    {
+        size_t dot = wordFilePath.find_last_of('.');
+        size_t slash = wordFilePath.find_last_of('/');
+
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        {
+            return wordFilePath.substr(0, dot) + ".freq";
+        }
+        else
+        {
+            return wordFilePath + ".freq";
+        }
+    }
+
+
     OutputType makeOutputType(const std::string& outputType)
     {
         if (outputType == "DISPLAY")
@@ -135,11 +292,430 @@ namespace
     }
 
 
+    // A search structure type may be followed by " BLOOM", in which case a
+    // Bloom filter is loaded along with the words and placed in front of
+    // the search structure.
+    bool removeBloomSuffix(std::string& setType)
+    {
+        const std::string suffix = " BLOOM";
+
+        if (setType.size() > suffix.size()
+            && setType.compare(setType.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            setType.erase(setType.size() - suffix.size());
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+
+    // A snapshot of a search structure (see Set<T>::saveSnapshot()) can be
+    // given in place of a word file, in which case the structure is loaded
+    // as it was saved.  A Bloom filter can't be loaded along with it, since
+    // a Set can't list the words in it.
+    void loadSnapshot(
+        const std::string& snapshotFilePath, Set<std::string>& wordSet, BloomFilter* filter)
+    {
+        if (filter != nullptr)
+        {
+            throw SpellCheckShell::ShellException{
+                "Cannot load a Bloom filter from a snapshot: " + snapshotFilePath};
+        }
+
+        std::ifstream in{snapshotFilePath, std::ios::binary};
+
+        if (!wordSet.loadSnapshot(in))
+        {
+            throw SpellCheckShell::ShellException{
+                "Invalid snapshot for this search structure type: " + snapshotFilePath};
+        }
+    }
+
+
+    // The search structure type "SHARED" is a CompiledWordSet that opens a
+    // dictionary published in shared memory (see publishWordSet()), so in
+    // place of the path of a word file, it's given the shared memory
+    // object's name.
+    bool isSharedMemoryType(const std::string& setType)
+    {
+        return setType == "SHARED";
+    }
+
+
+    // A CompiledWordSet is loaded by opening the compiled dictionary in
+    // place, either in a file or, if sharedMemory is true, in a shared
+    // memory object, so only a Bloom filter has to be loaded word by word.
+    // Other sets are loaded from a snapshot, if that's what the word file
+    // is, or else using the pool, if there is one.
+    void loadWordSet(
+        const std::string& wordFilePath, Set<std::string>& wordSet,
+        BloomFilter* filter, ThreadPool* pool, bool sharedMemory)
+    {
+        if (CompiledWordSet* compiled = dynamic_cast<CompiledWordSet*>(&wordSet))
+        {
+            if (sharedMemory && !compiled->openShared(wordFilePath))
+            {
+                throw SpellCheckShell::ShellException{"Invalid shared word set: " + wordFilePath};
+            }
+            else if (!sharedMemory && !compiled->open(wordFilePath))
+            {
+                throw SpellCheckShell::ShellException{"Invalid compiled word set: " + wordFilePath};
+            }
+
+            if (filter != nullptr)
+            {
+                filter->reset(compiled->size());
+
+                compiled->forEachWord(
+                    [&](std::string_view word)
+                    {
+                        filter->add(std::string{word});
+                    });
+            }
+        }
+        else if (isSetSnapshot(wordFilePath))
+        {
+            loadSnapshot(wordFilePath, wordSet, filter);
+        }
+        else if (pool != nullptr && filter != nullptr)
+        {
+            WordSetLoader{}.load(wordFilePath, wordSet, *filter, *pool);
+        }
+        else if (pool != nullptr)
+        {
+            WordSetLoader{}.load(wordFilePath, wordSet, *pool);
+        }
+        else if (filter != nullptr)
+        {
+            WordSetLoader{}.load(wordFilePath, wordSet, *filter);
+        }
+        else
+        {
+            WordSetLoader{}.load(wordFilePath, wordSet);
+        }
+    }
+
+
+    WordChecker makeWordChecker(const Set<std::string>& wordSet, const BloomFilter* filter)
+    {
+        if (filter != nullptr)
+        {
+            return WordChecker{wordSet, *filter};
+        }
+        else
+        {
+            return WordChecker{wordSet};
+        }
+    }
+
+
+    void configureWordChecker(
+        WordChecker& wordChecker, const RunOptions& options,
+        const WordFrequencies& frequencies, ThreadPool& pool)
+    {
+        if (options.topSuggestions > 0)
+        {
+            wordChecker.setRanking(frequencies, options.topSuggestions);
+        }
+
+        if (options.threads > 1)
+        {
+            wordChecker.setThreadPool(pool);
+        }
+    }
+
+
+    void runSpellChecker(
+        SpellChecker& spellChecker, const WordChecker& wordChecker,
+        const RunOptions& options, WordReader& reader)
+    {
+        if (options.pipelineThreads > 0)
+        {
+            spellChecker.runPipelined(wordChecker, reader, options.pipelineThreads);
+        }
+        else
+        {
+            spellChecker.run(wordChecker, reader);
+        }
+    }
+
+
+    // Streams, and files read through a window, are checked on one thread,
+    // since they can't be split into chunks without reading all of them
+    // first, though suggestions for long words are still found using all
+    // of the threads.  The standard input is always read as a stream.
+    void checkSpelling(
+        SpellChecker& spellChecker, const WordChecker& wordChecker,
+        const RunOptions& options, const std::string& textFilePath, ThreadPool& pool)
+    {
+        if (options.contextSize > 0 && textFilePath != standardInputPath)
+        {
+            // A window is always read ahead, so turning reading ahead off
+            // just reads it a window at a time.
+            size_t blockSize = options.readAheadBlockSize > 0
+                ? options.readAheadBlockSize
+                : WindowedTextReader::DEFAULT_WINDOW_SIZE;
+
+            WindowedTextReader reader{
+                textFilePath, options.contextSize, WindowedTextReader::DEFAULT_WINDOW_SIZE, blockSize};
+
+            if (!reader.isOpen())
+            {
+                throw SpellCheckShell::ShellException{"Cannot open file: " + textFilePath};
+            }
+
+            runSpellChecker(spellChecker, wordChecker, options, reader);
+        }
+        else if (options.stream)
+        {
+            std::unique_ptr<StreamTextReader> reader =
+                textFilePath == standardInputPath
+                    ? std::make_unique<StreamTextReader>(stdin)
+                    : std::make_unique<StreamTextReader>(
+                        textFilePath, StreamTextReader::DEFAULT_BUFFER_SIZE,
+                        options.readAheadBlockSize);
+
+            if (!reader->isOpen())
+            {
+                throw SpellCheckShell::ShellException{"Cannot open file: " + textFilePath};
+            }
+
+            runSpellChecker(spellChecker, wordChecker, options, *reader);
+        }
+        else if (options.threads > 1)
+        {
+            MappedFile textFile{textFilePath};
+            spellChecker.runParallel(wordChecker, textFile.text(), pool);
+        }
+        else
+        {
+            MappedTextFileReader reader{textFilePath};
+            runSpellChecker(spellChecker, wordChecker, options, reader);
+        }
+    }
+
+
+    // "COMPILE" is followed by the path of a word file and the path to
+    // write it to as a compiled dictionary, which the search structure
+    // type "COMPILED" then queries in place (see CompiledWordSet).
+    void compileWordSet()
+    {
+        std::string wordFilePath = readString();
+        requireNonEmptyFileExists(wordFilePath);
+
+        std::string compiledFilePath = readString();
+
+        if (!WordSetLoader{}.compile(wordFilePath, compiledFilePath))
+        {
+            throw SpellCheckShell::ShellException{"Cannot write compiled word set: " + compiledFilePath};
+        }
+
+        CompiledWordSet compiled{compiledFilePath};
+
+        std::cout << "Compiled " << compiled.size() << " words from " << wordFilePath
+                  << " into " << compiledFilePath << std::endl;
+    }
+
+
+    // "PUBLISH" is followed by the path of a word file and the name of a
+    // POSIX shared memory object (such as "/spellcheck"), into which the
+    // words are compiled.  Any number of processes can then check spelling
+    // with the search structure type "SHARED", given the object's name in
+    // place of a word file, all sharing the one copy of the dictionary.
+    // It stays published until "UNPUBLISH", followed by the name, removes
+    // it.
+    void publishWordSet()
+    {
+        std::string wordFilePath = readString();
+        requireNonEmptyFileExists(wordFilePath);
+
+        std::string sharedMemoryName = readString();
+
+        if (!WordSetLoader{}.compileShared(wordFilePath, sharedMemoryName))
+        {
+            throw SpellCheckShell::ShellException{"Cannot publish word set: " + sharedMemoryName};
+        }
+
+        CompiledWordSet shared;
+        shared.openShared(sharedMemoryName, false);
+
+        std::cout << "Published " << shared.size() << " words from " << wordFilePath
+                  << " as " << sharedMemoryName << std::endl;
+    }
+
+
+    void unpublishWordSet()
+    {
+        std::string sharedMemoryName = readString();
+
+        if (!CompiledWordSet::removeShared(sharedMemoryName))
+        {
+            throw SpellCheckShell::ShellException{"No published word set: " + sharedMemoryName};
+        }
+
+        std::cout << "Removed " << sharedMemoryName << std::endl;
+    }
+
+
+    // "SNAPSHOT" is followed by a search structure type, the path of a
+    // word file, and the path to write a snapshot of that type of search
+    // structure to, once the words have been loaded into it.  The snapshot
+    // can then be given in place of the word file for the same type of
+    // search structure.  As with compiled dictionaries, it's written
+    // alongside its final path and renamed into place.
+    void snapshotWordSet()
+    {
+        std::unique_ptr<Set<std::string>> wordSet = makeWordSet(readString());
+        requireImplemented(*wordSet);
+
+        std::string wordFilePath = readString();
+        requireNonEmptyFileExists(wordFilePath);
+
+        std::string snapshotFilePath = readString();
+        std::string temporaryPath = snapshotFilePath + ".tmp";
+
+        loadWordSet(wordFilePath, *wordSet, nullptr, nullptr, false);
+
+        bool saved;
+
+        {
+            std::ofstream out{temporaryPath, std::ios::binary | std::ios::trunc};
+            saved = wordSet->saveSnapshot(out);
+        }
+
+        if (!saved || std::rename(temporaryPath.c_str(), snapshotFilePath.c_str()) != 0)
+        {
+            std::remove(temporaryPath.c_str());
+            throw SpellCheckShell::ShellException{
+                "Cannot write a snapshot of this search structure type: " + snapshotFilePath};
+        }
+
+        std::cout << "Saved a snapshot of " << wordSet->size() << " words from " << wordFilePath
+                  << " into " << snapshotFilePath << std::endl;
+    }
+
+
+    // "SERVE" is followed by a search structure type, the path of a word
+    // file, and the path of a Unix domain socket, on which the words are
+    // served to clients (see SpellCheckServer) until one of them asks the
+    // server to shut down.
+    void serveWordSet()
+    {
+        std::string setType = readString();
+        bool useBloomFilter = removeBloomSuffix(setType);
+
+        bool sharedMemory = isSharedMemoryType(setType);
+
+        std::unique_ptr<Set<std::string>> wordSet = makeWordSet(setType);
+        requireImplemented(*wordSet);
+
+        std::string wordFilePath = readString();
+
+        if (!sharedMemory)
+        {
+            requireNonEmptyFileExists(wordFilePath);
+        }
+
+        std::string socketPath = readString();
+
+        std::unique_ptr<BloomFilter> filter =
+            useBloomFilter ? std::make_unique<BloomFilter>() : nullptr;
+
+        loadWordSet(wordFilePath, *wordSet, filter.get(), nullptr, sharedMemory);
+        unsigned int wordCount = wordSet->size();
+
+        DictionaryHandle dictionary{
+            std::make_shared<Dictionary>(std::move(wordSet), std::move(filter))};
+
+        SpellCheckServer server{dictionary, socketPath};
+
+        if (!server.isListening())
+        {
+            throw SpellCheckShell::ShellException{"Cannot listen on socket: " + socketPath};
+        }
+
+        std::cout << "Serving " << wordCount << " words from " << wordFilePath
+                  << " on " << socketPath << std::endl;
+
+        server.run();
+
+        std::cout << "Served " << server.requestCount() << " requests in "
+                  << server.batchCount() << " batches" << std::endl;
+    }
+
+
+    // "CLIENT" is followed by the path of a server's socket and the path
+    // of a text file (or "-" for the standard input), which is sent to the
+    // server to be checked, displaying the misspellings the same way they
+    // would be if it had been checked here.
+    void checkWithServer()
+    {
+        std::string socketPath = readString();
+        std::string textFilePath = readString();
+
+        std::string input;
+        MappedFile textFile;
+
+        if (textFilePath == standardInputPath)
+        {
+            input.assign(std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{});
+        }
+        else
+        {
+            requireNonEmptyFileExists(textFilePath);
+            textFile = MappedFile{textFilePath};
+        }
+
+        SpellCheckClient client{socketPath};
+
+        if (!client.isConnected())
+        {
+            throw SpellCheckShell::ShellException{"Cannot connect to server: " + socketPath};
+        }
+
+        std::string misspellings;
+
+        if (!client.checkText(
+                textFilePath == standardInputPath ? std::string_view{input} : textFile.text(),
+                misspellings))
+        {
+            throw SpellCheckShell::ShellException{"Lost connection to server: " + socketPath};
+        }
+
+        std::cout << misspellings;
+    }
+
+
+    // "SHUTDOWN" is followed by the path of a server's socket, and asks
+    // that server to shut down.
+    void shutDownServer()
+    {
+        std::string socketPath = readString();
+        SpellCheckClient client{socketPath};
+
+        if (!client.shutdownServer())
+        {
+            throw SpellCheckShell::ShellException{"Cannot connect to server: " + socketPath};
+        }
+
+        std::cout << "Server on " << socketPath << " is shutting down" << std::endl;
+    }
+
+
     void runWithDisplay(
-        Set<std::string>& wordSet,
+        Set<std::string>& wordSet, const RunOptions& options,
         const std::string& wordFilePath, const std::string& textFilePath)
     {
+        BloomFilter bloomFilter;
+        BloomFilter* filter = options.useBloomFilter ? &bloomFilter : nullptr;
+        WordFrequencies frequencies;
+        ThreadPool pool{options.threads - 1};
+
         SpellChecker spellChecker;
+        spellChecker.setSuggestionBudget(options.budget);
 
         std::shared_ptr<OutputSpellCheckerListener> output =
             std::make_shared<OutputSpellCheckerListener>(std::cout);
@@ -149,24 +725,36 @@ namespace
         std::cout << std::endl;
         std::cout << "Loading word set from " << wordFilePath << " ..." << std::endl;
 
-        WordSetLoader{}.load(wordFilePath, wordSet);
+        loadWordSet(
+            wordFilePath, wordSet, filter, options.threads > 1 ? &pool : nullptr,
+            options.sharedMemory);
 
-        std::cout << "Checking spelling in " << textFilePath << " ..." << std::endl;
+        if (options.topSuggestions > 0)
+        {
+            WordSetLoader{}.loadFrequencies(frequencyFilePathFor(wordFilePath), frequencies);
+        }
 
-        WordChecker wordChecker{wordSet};
-        TextFileReader reader{textFilePath};
+        std::cout << "Checking spelling in " << textFilePath << " ..." << std::endl;
 
-        spellChecker.run(wordChecker, reader);
+        WordChecker wordChecker = makeWordChecker(wordSet, filter);
+        configureWordChecker(wordChecker, options, frequencies, pool);
+        checkSpelling(spellChecker, wordChecker, options, textFilePath, pool);
     }
 
 
     void runTimingTest(
-        Set<std::string>& wordSet,
+        Set<std::string>& wordSet, const RunOptions& options,
         const std::string& wordFilePath, const std::string& textFilePath)
     {
+        BloomFilter bloomFilter;
+        BloomFilter* filter = options.useBloomFilter ? &bloomFilter : nullptr;
+        WordFrequencies frequencies;
+        ThreadPool pool{options.threads - 1};
+
         std::cout << std::endl;
 
         SpellChecker spellChecker;
+        spellChecker.setSuggestionBudget(options.budget);
 
         Stopwatch stopwatch;
 
@@ -175,7 +763,15 @@ namespace
 
         {
             stopwatch.start();
-            WordSetLoader{}.load(wordFilePath, wordSet);
+            loadWordSet(
+                wordFilePath, wordSet, filter, options.threads > 1 ? &pool : nullptr,
+                options.sharedMemory);
+
+            if (options.topSuggestions > 0)
+            {
+                WordSetLoader{}.loadFrequencies(frequencyFilePathFor(wordFilePath), frequencies);
+            }
+
             stopwatch.stop();
         }
 
@@ -184,14 +780,25 @@ namespace
         std::cout << "Checking spelling of words in " << textFilePath
                   << " using search structure ..." << std::endl;
 
+        unsigned long suggestionCacheHits = 0;
+        unsigned long suggestionCacheMisses = 0;
+
         {
             stopwatch.start();
-            WordChecker wordChecker{wordSet};
-            TextFileReader reader{textFilePath};
-            spellChecker.run(wordChecker, reader);
+            WordChecker wordChecker = makeWordChecker(wordSet, filter);
+            configureWordChecker(wordChecker, options, frequencies, pool);
+            checkSpelling(spellChecker, wordChecker, options, textFilePath, pool);
             stopwatch.stop();
+
+            suggestionCacheHits = wordChecker.suggestionCache().hits();
+            suggestionCacheMisses = wordChecker.suggestionCache().misses();
         }
 
+        unsigned long misspellings = spellChecker.misspellingCount();
+        unsigned long budgetsExhausted = spellChecker.budgetExhaustedCount();
+        std::vector<SpellChecker::PipelineStageStatistics> pipelineStages =
+            spellChecker.pipelineStatistics();
+
         double wordSetSpellCheckDuration = stopwatch.lastDuration();
 
         EmptySet<std::string> emptySet;
@@ -199,8 +806,17 @@ namespace
         std::cout << "Loading word set from " << wordFilePath
                   << " into empty set ..." << std::endl;
         {
+            // A snapshot, or a compiled dictionary, whether in a file or in
+            // shared memory, has no words to read, so there's nothing to
+            // load into an empty set.
             stopwatch.start();
-            WordSetLoader{}.load(wordFilePath, emptySet);
+
+            if (!options.sharedMemory && !isSetSnapshot(wordFilePath)
+                && dynamic_cast<CompiledWordSet*>(&wordSet) == nullptr)
+            {
+                WordSetLoader{}.load(wordFilePath, emptySet);
+            }
+
             stopwatch.stop();
         }
 
@@ -212,8 +828,8 @@ namespace
         {
             stopwatch.start();
             WordChecker wordChecker{emptySet};
-            TextFileReader reader{textFilePath};
-            spellChecker.run(wordChecker, reader);
+            configureWordChecker(wordChecker, options, frequencies, pool);
+            checkSpelling(spellChecker, wordChecker, options, textFilePath, pool);
             stopwatch.stop();
         }
 
@@ -264,6 +880,53 @@ namespace
                      - (emptySetLoadDuration + emptySetSpellCheckDuration) << "usec";
 
         std::cout << std::endl;
+
+        std::cout << std::endl;
+        std::cout << "Suggestion cache: " << suggestionCacheHits << " hits, "
+                  << suggestionCacheMisses << " misses" << std::endl;
+
+        if (options.budget.isLimited())
+        {
+            std::cout << "Suggestion budget: exhausted for " << budgetsExhausted
+                      << " of " << misspellings << " misspellings" << std::endl;
+        }
+
+        if (!pipelineStages.empty())
+        {
+            std::cout << "Pipeline:   stage  threads     words   busy usec    words/s  queue max/avg"
+                      << "  starved  blocked" << std::endl;
+
+            for (const SpellChecker::PipelineStageStatistics& stage : pipelineStages)
+            {
+                std::cout << std::right << std::setw(19) << stage.name
+                          << std::setw(9) << stage.threads
+                          << std::setw(10) << stage.words
+                          << std::setprecision(0) << std::setw(12) << stage.busyMicroseconds
+                          << std::setw(11)
+                          << (stage.busyMicroseconds > 0
+                              ? stage.words / (stage.busyMicroseconds / 1000000.0) : 0.0)
+                          << std::setw(6) << stage.maximumQueueDepth << "/"
+                          << std::left << std::setprecision(1) << std::setw(8)
+                          << stage.averageQueueDepth
+                          << std::right << std::setw(9) << stage.starved
+                          << std::setw(9) << stage.blocked << std::endl;
+            }
+        }
+
+        if (filter != nullptr)
+        {
+            double rejectionRatio =
+                filter->queries() > 0
+                ? static_cast<double>(filter->rejections()) / filter->queries()
+                : 0.0;
+
+            std::cout << "Bloom filter: " << filter->sizeInBytes() << " bytes, "
+                      << std::setprecision(3) << (filter->falsePositiveRate() * 100.0)
+                      << "% estimated false positives, rejected "
+                      << filter->rejections() << " of " << filter->queries()
+                      << " lookups (" << std::setprecision(1) << (rejectionRatio * 100.0)
+                      << "%)" << std::endl;
+        }
     }
 }
 
@@ -271,30 +934,100 @@ namespace
 
 void SpellCheckShell::run()
 {
-    std::unique_ptr<Set<std::string>> wordSet = makeWordSet(readString());
+    RunOptions options;
 
-    if (!wordSet->isImplemented())
+    std::string setType = readString();
+
+    if (setType == "COMPILE")
+    {
+        compileWordSet();
+        return;
+    }
+    else if (setType == "PUBLISH")
+    {
+        publishWordSet();
+        return;
+    }
+    else if (setType == "UNPUBLISH")
+    {
+        unpublishWordSet();
+        return;
+    }
+    else if (setType == "SNAPSHOT")
+    {
+        snapshotWordSet();
+        return;
+    }
+    else if (setType == "SERVE")
+    {
+        serveWordSet();
+        return;
+    }
+    else if (setType == "CLIENT")
     {
-        throw SpellCheckShell::ShellException{
-            "Search structure type not implemented (did you change isImplemented() to return true?)"};
+        checkWithServer();
+        return;
     }
+    else if (setType == "SHUTDOWN")
+    {
+        shutDownServer();
+        return;
+    }
+
+    options.useBloomFilter = removeBloomSuffix(setType);
+    options.sharedMemory = isSharedMemoryType(setType);
+
+    std::unique_ptr<Set<std::string>> wordSet = makeWordSet(setType);
+    requireImplemented(*wordSet);
 
     std::string wordFilePath = readString();
-    requireNonEmptyFileExists(wordFilePath);
+
+    if (!options.sharedMemory)
+    {
+        requireNonEmptyFileExists(wordFilePath);
+    }
 
     std::string textFilePath = readString();
-    requireNonEmptyFileExists(textFilePath);
 
-    OutputType outputType = makeOutputType(readString());
+    std::istringstream outputLine{readString()};
+    std::string outputTypeName;
+    outputLine >> outputTypeName;
+
+    OutputType outputType = makeOutputType(outputTypeName);
+    readRunOptions(outputLine, options);
+
+    // A stream can't be checked for emptiness without consuming it, and
+    // may not have been written yet.
+    if (textFilePath == standardInputPath)
+    {
+        options.stream = true;
+
+        if (outputType == OutputType::TimeOnly)
+        {
+            throw SpellCheckShell::ShellException{
+                "Timing tests read the text file twice, so it can't be the standard input"};
+        }
+    }
+    else if (!options.stream)
+    {
+        requireNonEmptyFileExists(textFilePath);
+
+        // A compressed file can't be mapped into memory or split into
+        // chunks, so it's decompressed as a stream instead.
+        if (detectCompression(textFilePath) != Compression::None)
+        {
+            options.stream = true;
+        }
+    }
 
     switch (outputType)
     {
     case OutputType::Display:
-        runWithDisplay(*wordSet, wordFilePath, textFilePath);
+        runWithDisplay(*wordSet, options, wordFilePath, textFilePath);
         break;
 
     case OutputType::TimeOnly:
-        runTimingTest(*wordSet, wordFilePath, textFilePath);
+        runTimingTest(*wordSet, options, wordFilePath, textFilePath);
         break;
     }
 }
@@ -1,33 +1,621 @@
 // SpellChecker.cpp
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include "BoundedQueue.hpp"
+#include "LineChunks.hpp"
+#include "MappedTextFileReader.hpp"
+#include "ReorderBuffer.hpp"
 #include "SpellChecker.hpp"
 
 
 
-void SpellChecker::run(const WordChecker& wordChecker, TextFileReader& reader)
+namespace
 {
-    while (!reader.noMoreWords())
+    struct Chunk
     {
-        if (!wordChecker.wordExists(reader.currentWord()))
+        std::string_view text;
+        std::vector<MisspellingRecord> misspellings;
+        unsigned long long lineCount;
+    };
+
+
+    // A TokenBatch is a batch of words read ahead, along with their
+    // contexts and copies of any of the contexts' text that the reader
+    // won't keep valid.  The copies are in a deque, so the contexts' views
+    // of them stay valid when the batch is moved.
+    struct TokenBatch
+    {
+        std::vector<std::string> words;
+        std::vector<WordContext> contexts;
+        std::deque<std::string> textCopies;
+    };
+
+
+    // A MisspellingBatch is the misspellings found in a TokenBatch, which
+    // take over its copies of their contexts' text.
+    struct MisspellingBatch
+    {
+        std::vector<MisspellingRecord> misspellings;
+        std::deque<std::string> textCopies;
+    };
+
+
+    // readBatches() reads the reader's words into batches of the given size
+    // and calls deliver() with each one, then clears it for the next, until
+    // deliver() returns false.  A batch is delivered early when the reader
+    // may have to wait for more input, and at the end, even if it's empty.
+    template <typename DeliverFunction>
+    void readBatches(WordReader& reader, size_t batchSize, DeliverFunction deliver)
+    {
+        TokenBatch batch;
+
+        // Words on the same short line share the same context text, which
+        // is only copied once.
+        bool copyText = !reader.linesStayValid();
+        unsigned long long copiedLineNumber = 0;
+        unsigned long long copiedTextOffset = 0;
+
+        auto deliverBatch =
+            [&]()
+            {
+                bool more = deliver(batch);
+                batch.words.clear();
+                batch.contexts.clear();
+                batch.textCopies.clear();
+                return more;
+            };
+
+        while (!reader.noMoreWords())
         {
-            notifyMisspellingFound(
-                reader.currentWord(), reader.currentLine(),
-                wordChecker.findSuggestions(reader.currentWord()));
+            if (batch.words.size() >= batchSize && !deliverBatch())
+            {
+                return;
+            }
+
+            WordContext context = reader.currentWordContext();
+
+            if (copyText)
+            {
+                unsigned long long textOffset = context.offset - context.wordStart;
+
+                if (batch.textCopies.empty() || context.lineNumber != copiedLineNumber
+                    || textOffset != copiedTextOffset
+                    || context.text.size() != batch.textCopies.back().size())
+                {
+                    batch.textCopies.emplace_back(context.text);
+                    copiedLineNumber = context.lineNumber;
+                    copiedTextOffset = textOffset;
+                }
+
+                context.text = batch.textCopies.back();
+            }
+
+            batch.words.emplace_back(context.word);
+            batch.contexts.push_back(context);
+
+            // Don't hold on to misspellings while waiting for input that
+            // may be a long time coming.
+            if (reader.mayWaitForInput() && !deliverBatch())
+            {
+                return;
+            }
+
+            reader.advanceToNextWord();
         }
 
-        reader.advanceToNextWord();
+        deliverBatch();
     }
+
+
+    double microsecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // A PipelineStage runs one stage of runPipelined() (or one thread of a
+    // stage) on a thread of its own, or the calling thread, timing how long
+    // it spends working rather than waiting on its queues.  If the stage
+    // throws, every queue is cancelled, so the other stages stop too, and
+    // the exception is kept to be rethrown once they have.
+    class PipelineStage
+    {
+    public:
+        explicit PipelineStage(const std::string& name)
+            : statistics{}, exception{}, inputPushes{0}, inputDepth{0}
+        {
+            statistics.name = name;
+        }
+
+
+        template <typename StageFunction, typename CancelFunction>
+        void run(StageFunction stage, CancelFunction cancelAll)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            try
+            {
+                stage();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+                cancelAll();
+            }
+
+            statistics.busyMicroseconds += microsecondsSince(start);
+        }
+
+
+        // pop() and push() take an item from the stage's input queue and
+        // give one to its output queue, not counting the time they spend
+        // waiting as time spent working.
+        template <typename T>
+        bool pop(BoundedQueue<T>& queue, T& item)
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool popped = queue.pop(item);
+            statistics.busyMicroseconds -= microsecondsSince(start);
+            return popped;
+        }
+
+
+        template <typename T>
+        bool push(BoundedQueue<T>& queue, T&& item)
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool pushed = queue.push(std::move(item));
+            statistics.busyMicroseconds -= microsecondsSince(start);
+            return pushed;
+        }
+
+
+        // readFrom() and writeTo() add the statistics of one of the stage's
+        // input and output queues to the stage's.
+        template <typename T>
+        void readFrom(const BoundedQueue<T>& queue)
+        {
+            const typename BoundedQueue<T>::Statistics& queueStatistics = queue.statistics();
+
+            inputPushes += queueStatistics.pushes;
+            inputDepth += queueStatistics.totalDepth;
+
+            statistics.queueCapacity = queue.capacity();
+            statistics.maximumQueueDepth =
+                std::max(statistics.maximumQueueDepth, queueStatistics.maximumDepth);
+            statistics.averageQueueDepth =
+                inputPushes > 0 ? static_cast<double>(inputDepth) / inputPushes : 0.0;
+            statistics.starved += queueStatistics.consumerWaits;
+        }
+
+
+        template <typename T>
+        void writeTo(const BoundedQueue<T>& queue)
+        {
+            statistics.blocked += queue.statistics().producerWaits;
+        }
+
+
+        // add() adds the work done by one thread of the stage to the
+        // stage's.
+        void add(const PipelineStage& thread)
+        {
+            statistics.batches += thread.statistics.batches;
+            statistics.words += thread.statistics.words;
+            statistics.busyMicroseconds += thread.statistics.busyMicroseconds;
+        }
+
+
+        SpellChecker::PipelineStageStatistics statistics;
+        std::exception_ptr exception;
+
+    private:
+        unsigned long long inputPushes;
+        unsigned long long inputDepth;
+    };
 }
 
 
-void SpellChecker::notifyMisspellingFound(
-    const std::string& word, const std::string& line,
-    const std::vector<std::string>& suggestions)
+
+SpellChecker::SpellChecker()
+    : budget{}, misspellings{0}, budgetsExhausted{0}, pipelineStages{}
 {
-    notifyObservers(
-        [&](auto listener)
+}
+
+
+void SpellChecker::run(const WordChecker& wordChecker, WordReader& reader)
+{
+    Hold hold{*this};
+
+    checkWords(
+        wordChecker, reader,
+        [this](std::vector<MisspellingRecord>& misspellings)
+        {
+            notifyMisspellingsFound(misspellings);
+        });
+}
+
+
+void SpellChecker::runParallel(
+    const WordChecker& wordChecker, std::string_view text, ThreadPool& pool,
+    size_t chunkSize)
+{
+    Hold hold{*this};
+
+    std::vector<Chunk> chunks;
+
+    for (std::string_view chunkText : splitAtLines(text, chunkSize))
+    {
+        chunks.push_back(Chunk{chunkText, {}, 0});
+    }
+
+    // Each chunk's reader counts offsets and lines from the start of the
+    // chunk, so they're made relative to the whole text as the chunks are
+    // delivered, which is done in order.
+    unsigned long long linesBefore = 0;
+
+    ReorderBuffer reorderBuffer{
+        chunks.size(),
+        [this, text, &chunks, &linesBefore](size_t index)
+        {
+            Chunk& chunk = chunks[index];
+
+            for (MisspellingRecord& misspelling : chunk.misspellings)
+            {
+                misspelling.context.offset += chunk.text.data() - text.data();
+                misspelling.context.lineNumber += linesBefore;
+            }
+
+            if (!chunk.misspellings.empty())
+            {
+                notifyMisspellingsFound(chunk.misspellings);
+            }
+
+            linesBefore += chunk.lineCount;
+            chunk.misspellings = std::vector<MisspellingRecord>{};
+        }};
+
+    std::vector<ThreadPool::Task> tasks;
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        tasks.push_back(
+            [&, i]()
+            {
+                Chunk& chunk = chunks[i];
+                MappedTextFileReader reader{chunk.text.data(), chunk.text.data() + chunk.text.size()};
+
+                checkWords(
+                    wordChecker, reader,
+                    [&chunk](std::vector<MisspellingRecord>& misspellings)
+                    {
+                        chunk.misspellings.insert(
+                            chunk.misspellings.end(),
+                            std::make_move_iterator(misspellings.begin()),
+                            std::make_move_iterator(misspellings.end()));
+                    });
+
+                chunk.lineCount = reader.currentLineNumber();
+                reorderBuffer.taskFinished(i);
+            });
+    }
+
+    pool.runAll(tasks);
+}
+
+
+void SpellChecker::runPipelined(
+    const WordChecker& wordChecker, WordReader& reader, unsigned int suggestingThreads)
+{
+    Hold hold{*this};
+
+    suggestingThreads = std::max(suggestingThreads, 1u);
+
+    // Each suggesting thread has queues of its own, to which batches are
+    // handed in turn, and from which they're taken in the same turn, so
+    // that every queue has one thread at each end, and batches come out in
+    // the order they went in.
+    BoundedQueue<TokenBatch> tokens{PIPELINE_QUEUE_CAPACITY};
+    std::vector<std::unique_ptr<BoundedQueue<MisspellingBatch>>> misspelled;
+    std::vector<std::unique_ptr<BoundedQueue<MisspellingBatch>>> suggested;
+
+    for (unsigned int i = 0; i < suggestingThreads; ++i)
+    {
+        misspelled.push_back(std::make_unique<BoundedQueue<MisspellingBatch>>(PIPELINE_QUEUE_CAPACITY));
+        suggested.push_back(std::make_unique<BoundedQueue<MisspellingBatch>>(PIPELINE_QUEUE_CAPACITY));
+    }
+
+    auto cancelAll =
+        [&]()
+        {
+            tokens.cancel();
+
+            for (unsigned int i = 0; i < suggestingThreads; ++i)
+            {
+                misspelled[i]->cancel();
+                suggested[i]->cancel();
+            }
+        };
+
+    PipelineStage reading{"read"};
+    PipelineStage checking{"check"};
+    std::vector<PipelineStage> suggesting(suggestingThreads, PipelineStage{"suggest"});
+    PipelineStage notifying{"notify"};
+
+    std::vector<std::thread> threads;
+
+    threads.emplace_back(
+        [&]()
         {
-            listener->misspellingFound(word, line, suggestions);
+            reading.run(
+                [&]()
+                {
+                    readBatches(
+                        reader, PIPELINE_BATCH_SIZE,
+                        [&](TokenBatch& batch)
+                        {
+                            if (batch.words.empty())
+                            {
+                                return !tokens.isCancelled();
+                            }
+
+                            ++reading.statistics.batches;
+                            reading.statistics.words += batch.words.size();
+                            return reading.push(tokens, std::move(batch));
+                        });
+
+                    tokens.close();
+                },
+                cancelAll);
+        });
+
+    threads.emplace_back(
+        [&]()
+        {
+            checking.run(
+                [&]()
+                {
+                    TokenBatch batch;
+                    unsigned int turn = 0;
+
+                    while (checking.pop(tokens, batch))
+                    {
+                        ++checking.statistics.batches;
+                        checking.statistics.words += batch.words.size();
+
+                        std::vector<bool> exists = wordChecker.wordsExist(batch.words);
+                        MisspellingBatch found;
+
+                        for (size_t i = 0; i < batch.words.size(); ++i)
+                        {
+                            if (!exists[i])
+                            {
+                                found.misspellings.push_back(MisspellingRecord{
+                                    std::move(batch.words[i]), batch.contexts[i], {}, true});
+                            }
+                        }
+
+                        if (!found.misspellings.empty())
+                        {
+                            found.textCopies = std::move(batch.textCopies);
+                            checking.push(*misspelled[turn], std::move(found));
+                            turn = (turn + 1) % suggestingThreads;
+                        }
+                    }
+
+                    for (unsigned int i = 0; i < suggestingThreads; ++i)
+                    {
+                        misspelled[i]->close();
+                    }
+                },
+                cancelAll);
         });
+
+    for (unsigned int t = 0; t < suggestingThreads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                PipelineStage& stage = suggesting[t];
+
+                stage.run(
+                    [&]()
+                    {
+                        MisspellingBatch batch;
+
+                        while (stage.pop(*misspelled[t], batch))
+                        {
+                            ++stage.statistics.batches;
+                            stage.statistics.words += batch.misspellings.size();
+
+                            for (MisspellingRecord& misspelling : batch.misspellings)
+                            {
+                                misspelling.suggestions = findSuggestions(
+                                    wordChecker, misspelling.word, misspelling.complete);
+                            }
+
+                            stage.push(*suggested[t], std::move(batch));
+                        }
+
+                        suggested[t]->close();
+                    },
+                    cancelAll);
+            });
+    }
+
+    // Observers are notified on the calling thread, as they are by run().
+    // Once the queue whose turn it is has been closed and emptied, there
+    // are no more batches in any of them.
+    notifying.run(
+        [&]()
+        {
+            MisspellingBatch batch;
+            unsigned int turn = 0;
+
+            while (notifying.pop(*suggested[turn], batch))
+            {
+                ++notifying.statistics.batches;
+                notifying.statistics.words += batch.misspellings.size();
+                turn = (turn + 1) % suggestingThreads;
+
+                notifyMisspellingsFound(batch.misspellings);
+            }
+        },
+        cancelAll);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    PipelineStage suggestingStage{"suggest"};
+    suggestingStage.statistics.threads = suggestingThreads;
+
+    reading.writeTo(tokens);
+    checking.readFrom(tokens);
+
+    for (unsigned int i = 0; i < suggestingThreads; ++i)
+    {
+        checking.writeTo(*misspelled[i]);
+        suggestingStage.readFrom(*misspelled[i]);
+        suggestingStage.writeTo(*suggested[i]);
+        suggestingStage.add(suggesting[i]);
+        notifying.readFrom(*suggested[i]);
+    }
+
+    pipelineStages = {
+        reading.statistics, checking.statistics, suggestingStage.statistics, notifying.statistics};
+
+    std::vector<const PipelineStage*> stages = {&reading, &checking, &notifying};
+
+    for (const PipelineStage& stage : suggesting)
+    {
+        stages.push_back(&stage);
+    }
+
+    for (const PipelineStage* stage : stages)
+    {
+        if (stage->exception != nullptr)
+        {
+            std::rethrow_exception(stage->exception);
+        }
+    }
 }
 
+
+void SpellChecker::checkWords(
+    const WordChecker& wordChecker, WordReader& reader,
+    const MisspellingsFound& found) const
+{
+    std::vector<MisspellingRecord> misspellings;
+
+    readBatches(
+        reader, BATCH_SIZE,
+        [&](TokenBatch& batch)
+        {
+            checkBatch(wordChecker, batch.words, batch.contexts, misspellings);
+
+            if (!misspellings.empty())
+            {
+                found(misspellings);
+                misspellings.clear();
+            }
+
+            return true;
+        });
+}
+
+
+void SpellChecker::checkBatch(
+    const WordChecker& wordChecker,
+    std::vector<std::string>& words,
+    const std::vector<WordContext>& contexts,
+    std::vector<MisspellingRecord>& found) const
+{
+    std::vector<bool> exists = wordChecker.wordsExist(words);
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        if (!exists[i])
+        {
+            bool complete = true;
+            std::vector<std::string> suggestions = findSuggestions(wordChecker, words[i], complete);
+
+            found.push_back(
+                MisspellingRecord{std::move(words[i]), contexts[i], std::move(suggestions), complete});
+        }
+    }
+}
+
+
+std::vector<std::string> SpellChecker::findSuggestions(
+    const WordChecker& wordChecker, const std::string& word, bool& complete) const
+{
+    if (!budget.isLimited())
+    {
+        complete = true;
+        return wordChecker.findSuggestions(word);
+    }
+
+    return wordChecker.findSuggestions(word, budget, complete);
+}
+
+
+void SpellChecker::countMisspelling(bool complete)
+{
+    ++misspellings;
+
+    if (!complete)
+    {
+        ++budgetsExhausted;
+    }
+}
+
+
+void SpellChecker::setSuggestionBudget(const SuggestionBudget& budget)
+{
+    this->budget = budget;
+}
+
+
+unsigned long SpellChecker::misspellingCount() const
+{
+    return misspellings;
+}
+
+
+unsigned long SpellChecker::budgetExhaustedCount() const
+{
+    return budgetsExhausted;
+}
+
+
+const std::vector<SpellChecker::PipelineStageStatistics>& SpellChecker::pipelineStatistics() const
+{
+    return pipelineStages;
+}
+
+
+// notifyMisspellingsFound() points each misspelling's context back at its
+// word, which it may have been moved away from, counts the misspellings,
+// then tells each observer about all of them at once.
+void SpellChecker::notifyMisspellingsFound(std::vector<MisspellingRecord>& misspellings)
+{
+    for (MisspellingRecord& misspelling : misspellings)
+    {
+        misspelling.context.word = misspelling.word;
+        countMisspelling(misspelling.complete);
+    }
+
+    notifyEachObserver(
+        [&](auto listener)
+        {
+            listener->misspellingsFound(misspellings);
+        });
+}
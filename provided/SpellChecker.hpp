@@ -2,28 +2,149 @@
 //
 // This class implements a basic spell checker.  It uses the given
 // WordChecker to determine whether words are spelled correctly,
-// the given TextFileReader to determine which words to check,
+// the given WordReader to determine which words to check,
 // and notifies any observers whenever misspellings are found.
+//
+// runParallel() checks a large text held in memory by splitting it into
+// chunks at line boundaries and checking the chunks on a ThreadPool.  The
+// misspellings found in each chunk are held in a reorder buffer until
+// every chunk before it has been reported, so observers are told about
+// them in the same order as run() would, one chunk at a time.
+//
+// runPipelined() checks what a WordReader reads in four stages, each on
+// threads of its own, so that a slow stage doesn't hold up the others:
+// reading (and tokenizing) batches of words, looking them up, finding
+// suggestions for the misspelled ones, which usually takes the longest
+// and so can be done on several threads, and notifying observers, which
+// is done on the calling thread.  Batches are handed from one stage to
+// the next through BoundedQueues, so a stage that gets ahead waits for
+// the next one to catch up rather than reading the whole input into
+// memory.  Observers are told about misspellings in the same order as
+// run() would.
+//
+// Observers are told about misspellings in batches (see
+// SpellCheckerListener): run() reports those found in each batch of words
+// it reads, runParallel() those found in each chunk, and runPipelined()
+// those found in each of its batches.  They're given each misspelling's
+// context (see WordContext), with offsets and line numbers counted from
+// the start of the whole input.  Each run holds its observers (see
+// Observable::Hold) from start to finish, so that notifying them doesn't
+// touch their reference counts.
 
 #ifndef SPELLCHECKER_HPP
 #define SPELLCHECKER_HPP
 
 #include <ics46/observable/Observable.hpp>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "SpellCheckerListener.hpp"
-#include "TextFileReader.hpp"
+#include "ThreadPool.hpp"
 #include "WordChecker.hpp"
+#include "WordReader.hpp"
 
 
 
 class SpellChecker : public ics46::observable::Observable<SpellCheckerListener>
 {
 public:
-    void run(const WordChecker& wordChecker, TextFileReader& reader);
+    // The number of words run() reads ahead and checks with a single
+    // batched lookup.
+    static constexpr unsigned int BATCH_SIZE = 64;
+
+    // The number of bytes of text runParallel() puts in each chunk, by
+    // default.  Chunks are extended to the end of their last line.
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    // The number of words runPipelined() reads into each batch, and the
+    // number of batches each of its queues holds.
+    static constexpr unsigned int PIPELINE_BATCH_SIZE = 1024;
+    static constexpr size_t PIPELINE_QUEUE_CAPACITY = 16;
+
+    // What one stage of runPipelined() did: how many batches, and words
+    // (or misspellings) in them, it handled, and how long it spent working
+    // on them, as opposed to waiting, in total across its threads.  Its
+    // input queues' capacity and their maximum and average depth are
+    // given, along with how many times the stage found an input queue
+    // empty (starved) and an output queue full (blocked).
+    struct PipelineStageStatistics
+    {
+        std::string name;
+        unsigned int threads = 1;
+        unsigned long long batches = 0;
+        unsigned long long words = 0;
+        double busyMicroseconds = 0.0;
+        size_t queueCapacity = 0;
+        size_t maximumQueueDepth = 0;
+        double averageQueueDepth = 0.0;
+        unsigned long long starved = 0;
+        unsigned long long blocked = 0;
+    };
+
+public:
+    SpellChecker();
+
+    void run(const WordChecker& wordChecker, WordReader& reader);
+
+    // runParallel() checks the given text, which is read the same way a
+    // MappedTextFileReader reads a file.  Observers are notified on the
+    // pool's threads, though never on more than one at a time.
+    void runParallel(
+        const WordChecker& wordChecker, std::string_view text, ThreadPool& pool,
+        size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    // runPipelined() checks the words the reader reads, the same way run()
+    // does, but in a pipeline of stages running at once, finding
+    // suggestions on the given number of threads.  If any stage throws,
+    // including an observer, the others are stopped and the exception is
+    // rethrown.
+    void runPipelined(
+        const WordChecker& wordChecker, WordReader& reader, unsigned int suggestingThreads = 1);
+
+
+    // setSuggestionBudget() limits the work done finding suggestions for
+    // each misspelled word.  When the budget runs out, the suggestions
+    // found so far are reported.
+    void setSuggestionBudget(const SuggestionBudget& budget);
+
+
+    // misspellingCount() returns the number of misspellings found so far,
+    // and budgetExhaustedCount() how many of them ran out of budget before
+    // all of their suggestions were found.
+    unsigned long misspellingCount() const;
+    unsigned long budgetExhaustedCount() const;
+
+    // pipelineStatistics() returns the statistics of each stage of the last
+    // call to runPipelined(), in order, or nothing if it hasn't been called.
+    const std::vector<PipelineStageStatistics>& pipelineStatistics() const;
+
+private:
+    typedef std::function<void(std::vector<MisspellingRecord>& misspellings)> MisspellingsFound;
+
+    void notifyMisspellingsFound(std::vector<MisspellingRecord>& misspellings);
+
+    void countMisspelling(bool complete);
+
+    void checkWords(
+        const WordChecker& wordChecker, WordReader& reader,
+        const MisspellingsFound& found) const;
+
+    void checkBatch(
+        const WordChecker& wordChecker,
+        std::vector<std::string>& words,
+        const std::vector<WordContext>& contexts,
+        std::vector<MisspellingRecord>& found) const;
+
+    std::vector<std::string> findSuggestions(
+        const WordChecker& wordChecker, const std::string& word, bool& complete) const;
 
 private:
-    void notifyMisspellingFound(
-        const std::string& word, const std::string& line,
-        const std::vector<std::string>& suggestions);
+    SuggestionBudget budget;
+    unsigned long misspellings;
+    unsigned long budgetsExhausted;
+    std::vector<PipelineStageStatistics> pipelineStages;
 };
 
 
@@ -2,13 +2,24 @@
 //
 // An abstract base class for listeners that are told when spell
 // checkers do interesting things.  At present, there's only one
-// such thing: a notification that a misspelling was found.
+// such thing: a notification that misspellings were found.
+//
+// Spell checkers report misspellings in batches, calling
+// misspellingsFound() once for all of the misspellings found in a batch
+// of words, so that the cost of notifying each listener is paid once per
+// batch rather than once per misspelling.  Listeners that only care about
+// one misspelling at a time can leave it alone and override
+// misspellingFound(), misspellingFoundInLine() or
+// misspellingFoundInContext() instead.
 
 #ifndef SPELLCHECKERLISTENER_HPP
 #define SPELLCHECKERLISTENER_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include "MisspellingRecord.hpp"
+#include "WordContext.hpp"
 
 
 
@@ -18,6 +29,36 @@ public:
     virtual void misspellingFound(
         const std::string& word, const std::string& line,
         const std::vector<std::string>& suggestions) = 0;
+
+    // misspellingFoundInLine() lets listeners that can work with views
+    // avoid copying the word and the line.  By default, it copies them and
+    // calls misspellingFound().
+    virtual void misspellingFoundInLine(
+        std::string_view word, std::string_view line,
+        const std::vector<std::string>& suggestions)
+    {
+        misspellingFound(std::string{word}, std::string{line}, suggestions);
+    }
+
+    // misspellingFoundInContext() also says where the word was found.  The
+    // context's text is a bounded piece of the word's line, which by
+    // default is passed to misspellingFoundInLine() as the line.
+    virtual void misspellingFoundInContext(
+        const WordContext& context, const std::vector<std::string>& suggestions)
+    {
+        misspellingFoundInLine(context.word, context.text, suggestions);
+    }
+
+    // Spell checkers call this with each batch of misspellings they find,
+    // in the order they were found.  By default, it calls
+    // misspellingFoundInContext() with each of them in turn.
+    virtual void misspellingsFound(const std::vector<MisspellingRecord>& misspellings)
+    {
+        for (const MisspellingRecord& misspelling : misspellings)
+        {
+            misspellingFoundInContext(misspelling.context, misspelling.suggestions);
+        }
+    }
 };
 
 
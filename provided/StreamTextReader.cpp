@@ -0,0 +1,399 @@
+// StreamTextReader.cpp
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "StreamTextReader.hpp"
+#include "Utf8.hpp"
+
+
+
+namespace
+{
+    inline bool isWordChar(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')
+            || c == '-' || c == '\'';
+    }
+
+
+    // The number of bytes in the UTF-8 sequence that a byte begins, if
+    // it's a valid one.
+    inline size_t sequenceLength(char c)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        return byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+    }
+}
+
+
+
+StreamTextReader::StreamTextReader(int fileDescriptor, size_t bufferSize)
+    : fileDescriptor{fileDescriptor}, file{nullptr}, ownsFileDescriptor{false},
+      buffer(std::max<size_t>(bufferSize, 2))
+{
+    start();
+}
+
+
+StreamTextReader::StreamTextReader(std::FILE* file, size_t bufferSize)
+    : fileDescriptor{-1}, file{file}, ownsFileDescriptor{false},
+      buffer(std::max<size_t>(bufferSize, 2))
+{
+    start();
+}
+
+
+StreamTextReader::StreamTextReader(
+    const std::string& path, size_t bufferSize, size_t readAheadBlockSize)
+    : fileDescriptor{-1}, file{nullptr}, ownsFileDescriptor{true},
+      buffer(std::max<size_t>(bufferSize, 2))
+{
+    if (readAheadBlockSize > 0)
+    {
+        readAhead = std::make_unique<ReadAheadFile>(path, readAheadBlockSize);
+    }
+    else
+    {
+        fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        Compression compression = detectCompression(fileDescriptor);
+
+        if (compression != Compression::None)
+        {
+            decompressor = std::make_unique<Decompressor>(fileDescriptor, compression);
+        }
+    }
+
+    start();
+}
+
+
+StreamTextReader::~StreamTextReader()
+{
+    if (ownsFileDescriptor && fileDescriptor >= 0)
+    {
+        ::close(fileDescriptor);
+    }
+}
+
+
+bool StreamTextReader::isOpen() const
+{
+    if (decompressor && !decompressor->isOpen())
+    {
+        return false;
+    }
+
+    return fileDescriptor >= 0 || file != nullptr || (readAhead && readAhead->isOpen());
+}
+
+
+bool StreamTextReader::noMoreWords() const
+{
+    return eof;
+}
+
+
+void StreamTextReader::advanceToNextWord()
+{
+    while (!tokenizer.nextWord(buffer.data(), lineIndex, lineEnd, word, wordStart, wordEnd))
+    {
+        if (!advanceToNextLine())
+        {
+            word.clear();
+            eof = true;
+            return;
+        }
+    }
+}
+
+
+std::string_view StreamTextReader::currentWordView() const
+{
+    return word;
+}
+
+
+std::string_view StreamTextReader::currentLineView() const
+{
+    if (eof)
+    {
+        return std::string_view{};
+    }
+
+    return std::string_view{buffer.data() + lineStart, lineEnd - lineStart};
+}
+
+
+int StreamTextReader::currentLineNumber() const
+{
+    return lineNumber;
+}
+
+
+// A piece of a broken line is a line of its own as far as currentLineView()
+// and currentLineNumber() are concerned, but a word's context gives its
+// position in the whole line.
+WordContext StreamTextReader::currentWordContext() const
+{
+    WordContext context = wordContextInLine(
+        word, currentLineView(), wordStart - lineStart, wordEnd - lineStart,
+        bufferOffset + lineStart, textLineNumber);
+
+    unsigned long long pieceColumn = bufferOffset + lineStart - textLineStart;
+    context.column += pieceColumn;
+    context.lineContinuesBefore = context.lineContinuesBefore || pieceColumn > 0;
+    context.lineContinuesAfter = context.lineContinuesAfter || lineBroken;
+    return context;
+}
+
+
+bool StreamTextReader::mayWaitForInput() const
+{
+    if (eof || sourceDone)
+    {
+        return false;
+    }
+
+    // Whether the next line can be had without waiting only changes from
+    // one line to the next, so the source is asked at most once per line.
+    if (!sourceChecked)
+    {
+        sourceChecked = true;
+
+        if (std::memchr(buffer.data() + nextLineStart, '\n', filled - nextLineStart) != nullptr)
+        {
+            sourceReady = true;
+        }
+        else if (readAhead)
+        {
+            sourceReady = readAhead->dataReady();
+        }
+        else
+        {
+            struct pollfd source{file != nullptr ? fileno(file) : fileDescriptor, POLLIN, 0};
+            sourceReady = ::poll(&source, 1, 0) != 0;
+        }
+    }
+
+    if (sourceReady)
+    {
+        return false;
+    }
+
+    size_t index = lineIndex;
+    std::string nextWord;
+    return !tokenizer.nextWord(buffer.data(), index, lineEnd, nextWord);
+}
+
+
+std::chrono::nanoseconds StreamTextReader::readAheadWaitTime() const
+{
+    return readAhead ? readAhead->timeWaiting() : std::chrono::nanoseconds{0};
+}
+
+
+void StreamTextReader::start()
+{
+    filled = 0;
+    sourceDone = !isOpen();
+    eof = false;
+
+    lineStart = 0;
+    lineEnd = 0;
+    nextLineStart = 0;
+    lineNumber = 0;
+    lineIndex = 0;
+    lineBroken = false;
+
+    wordStart = 0;
+    wordEnd = 0;
+    bufferOffset = 0;
+    textLineNumber = 0;
+    textLineStart = 0;
+
+    sourceChecked = false;
+    sourceReady = false;
+
+    advanceToNextWord();
+}
+
+
+bool StreamTextReader::advanceToNextLine()
+{
+    size_t scanFrom = nextLineStart;
+    bool broken = false;
+
+    while (true)
+    {
+        const void* newline = std::memchr(buffer.data() + scanFrom, '\n', filled - scanFrom);
+
+        if (newline != nullptr)
+        {
+            lineStart = nextLineStart;
+            lineEnd = static_cast<const char*>(newline) - buffer.data();
+            nextLineStart = lineEnd + 1;
+            break;
+        }
+
+        scanFrom = filled;
+
+        if (sourceDone)
+        {
+            if (nextLineStart == filled)
+            {
+                return false;
+            }
+
+            lineStart = nextLineStart;
+            lineEnd = filled;
+            nextLineStart = filled;
+            break;
+        }
+
+        // Make room by discarding the lines already read, and if there's
+        // still no room, the line is too long and has to be broken.
+        if (nextLineStart > 0)
+        {
+            std::memmove(buffer.data(), buffer.data() + nextLineStart, filled - nextLineStart);
+            filled -= nextLineStart;
+            scanFrom -= nextLineStart;
+            bufferOffset += nextLineStart;
+            nextLineStart = 0;
+        }
+
+        if (filled == buffer.size())
+        {
+            lineStart = 0;
+            lineEnd = findBreak();
+            nextLineStart = lineEnd;
+            broken = true;
+            break;
+        }
+
+        size_t count = readMore(buffer.data() + filled, buffer.size() - filled);
+
+        if (count == 0)
+        {
+            sourceDone = true;
+        }
+        else
+        {
+            filled += count;
+        }
+    }
+
+    // The piece after a broken line is part of the same line of text.
+    if (!lineBroken)
+    {
+        ++textLineNumber;
+        textLineStart = bufferOffset + lineStart;
+    }
+
+    lineBroken = broken;
+    lineIndex = lineStart;
+    ++lineNumber;
+    sourceChecked = false;
+    return true;
+}
+
+
+size_t StreamTextReader::readMore(char* target, size_t size)
+{
+    if (readAhead)
+    {
+        return readAhead->read(target, size);
+    }
+    else if (decompressor)
+    {
+        return decompressor->read(target, size);
+    }
+    else if (file != nullptr)
+    {
+        // Stop at the end of a line, since the next one may not have been
+        // written yet.
+        size_t count = 0;
+        int c;
+
+        while (count < size && (c = getc_unlocked(file)) != EOF)
+        {
+            target[count++] = static_cast<char>(c);
+
+            if (c == '\n')
+            {
+                break;
+            }
+        }
+
+        return count;
+    }
+
+    while (true)
+    {
+        ssize_t count = ::read(fileDescriptor, target, size);
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        return count > 0 ? count : 0;
+    }
+}
+
+
+// findBreak() finds where to break a line that fills the whole buffer:
+// at its last space or punctuation mark, so that no word is broken, or at
+// the end of the buffer if there isn't one.  Characters are classified
+// the way the tokenizer classifies them, so a UTF-8 line is never broken
+// inside a word made of non-ASCII letters, nor inside a character,
+// including one that's cut short by the end of the buffer.  UTF-8 can
+// only be decoded forward, so the line is scanned from its start.
+size_t StreamTextReader::findBreak() const
+{
+    bool utf8 = tokenizer.encoding() == TextEncoding::Utf8;
+    size_t lastBreak = 0;
+    size_t charactersEnd = 0;
+    size_t index = 0;
+
+    while (index < filled)
+    {
+        size_t start = index;
+        bool wordChar;
+
+        if (!utf8 || static_cast<unsigned char>(buffer[index]) < 0x80)
+        {
+            wordChar = isWordChar(buffer[index]);
+            ++index;
+        }
+        else
+        {
+            char32_t codePoint;
+            bool valid = decodeUtf8(buffer.data(), index, filled, codePoint);
+
+            if (!valid && start + sequenceLength(buffer[start]) > filled)
+            {
+                break;
+            }
+
+            wordChar = valid && isWordCharacter(codePoint);
+        }
+
+        if (!wordChar && start > 0)
+        {
+            lastBreak = start;
+        }
+
+        charactersEnd = index;
+    }
+
+    if (lastBreak > 0)
+    {
+        return lastBreak;
+    }
+
+    return charactersEnd > 0 ? charactersEnd : filled;
+}
@@ -0,0 +1,126 @@
+// StreamTextReader.hpp
+//
+// Reads text the same way a TextFileReader does, but from a stream, such
+// as the standard input or a pipe, whose length isn't known in advance
+// and which can only be read once.  Text is read in blocks into a buffer
+// of fixed size, so that memory use doesn't depend on how much input
+// there is; a line longer than the buffer is broken into pieces, each of
+// which is treated as a line of its own, at a space or punctuation mark
+// if there is one.
+//
+// A line is available as soon as its newline has been read, so words are
+// reported as they arrive, rather than when the stream ends.
+//
+// When reading a file by its path, the file is read ahead in large blocks
+// on a background thread (see ReadAheadFile), so that reading overlaps
+// with checking the words already read.  A file compressed with gzip or
+// zstd is decompressed as it's read, on the background thread when reading
+// ahead.
+
+#ifndef STREAMTEXTREADER_HPP
+#define STREAMTEXTREADER_HPP
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Decompressor.hpp"
+#include "ReadAheadFile.hpp"
+#include "WordReader.hpp"
+#include "WordTokenizer.hpp"
+
+
+
+class StreamTextReader : public WordReader
+{
+public:
+    // The number of bytes in the buffer, by default, which is also the
+    // length of the longest line that isn't broken into pieces.
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+public:
+    // Reads from the given file descriptor, which is left open.
+    explicit StreamTextReader(int fileDescriptor, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    // Reads from the given C stream, which is left open.  Use this for the
+    // standard input, which std::cin reads through stdin, so that nothing
+    // std::cin has already buffered is lost.
+    explicit StreamTextReader(std::FILE* file, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    // Opens and reads from the file with the given path, which may be a
+    // named pipe or a device rather than a regular file, reading ahead in
+    // blocks of the given size, or reading directly if it's 0.  As with
+    // TextFileReader, a file that can't be opened, or can't be
+    // decompressed by this build, has no words.
+    explicit StreamTextReader(
+        const std::string& path, size_t bufferSize = DEFAULT_BUFFER_SIZE,
+        size_t readAheadBlockSize = ReadAheadFile::DEFAULT_BLOCK_SIZE);
+
+    virtual ~StreamTextReader();
+
+    StreamTextReader(const StreamTextReader&) = delete;
+    StreamTextReader& operator=(const StreamTextReader&) = delete;
+
+    // isOpen() returns false if the file couldn't be opened or can't be
+    // decompressed.
+    bool isOpen() const;
+
+    virtual bool noMoreWords() const;
+    virtual void advanceToNextWord();
+
+    virtual std::string_view currentWordView() const;
+    virtual std::string_view currentLineView() const;
+    virtual int currentLineNumber() const;
+    virtual WordContext currentWordContext() const;
+
+    virtual bool mayWaitForInput() const;
+
+    // readAheadWaitTime() returns the time spent waiting for blocks to be
+    // read ahead, or zero if the file isn't being read ahead.
+    std::chrono::nanoseconds readAheadWaitTime() const;
+
+private:
+    int fileDescriptor;
+    std::FILE* file;
+    bool ownsFileDescriptor;
+    std::unique_ptr<ReadAheadFile> readAhead;
+    std::unique_ptr<Decompressor> decompressor;
+
+    WordTokenizer tokenizer;
+
+    std::vector<char> buffer;
+    size_t filled;
+    bool sourceDone;
+
+    bool eof;
+
+    size_t lineStart;
+    size_t lineEnd;
+    size_t nextLineStart;
+    int lineNumber;
+    size_t lineIndex;
+    bool lineBroken;
+
+    std::string word;
+    size_t wordStart;
+    size_t wordEnd;
+
+    // Where the start of the buffer is in the stream, and which line of
+    // the text, and where it starts, the current line is part of.
+    unsigned long long bufferOffset;
+    unsigned long long textLineNumber;
+    unsigned long long textLineStart;
+
+    mutable bool sourceChecked;
+    mutable bool sourceReady;
+
+private:
+    void start();
+    bool advanceToNextLine();
+    size_t readMore(char* target, size_t size);
+    size_t findBreak() const;
+};
+
+
+
+#endif // STREAMTEXTREADER_HPP
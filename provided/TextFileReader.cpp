@@ -1,11 +1,12 @@
 // TextFileReader.cpp
 
-#include <cctype>
 #include "TextFileReader.hpp"
+#include "TextFileStream.hpp"
 
 
 TextFileReader::TextFileReader(const std::string& textFilePath)
-    : textFile{textFilePath}, eof{false}, line{}, lineIndex{0}, word{}
+    : textFile{openTextFile(textFilePath)}, eof{false}, line{}, lineNumber{0}, lineIndex{0},
+      lineOffset{0}, nextLineOffset{0}, word{}, wordStart{0}, wordEnd{0}, tokenizer{}
 {
     advanceToNextWord();
 }
@@ -23,41 +24,24 @@ void TextFileReader::advanceToNextWord()
 
     while (!eof)
     {
-        while (lineIndex < line.length() && !std::isalnum(line[lineIndex]))
-        {
-            ++lineIndex;                
-        }
-
-        if (lineIndex >= line.length())
-        {
-            advanceToNextLine();
-            continue;
-        }
-
-        while (lineIndex < line.length() &&
-            (std::isalnum(line[lineIndex]) || line[lineIndex] == '-' || line[lineIndex] == '\''))
-        {
-            word.push_back(std::toupper(line[lineIndex++]));
-        }
-
-        if (!std::isalnum(word[word.length() - 1]))
-        {
-            word.pop_back();
-        }
-
-        if (word.length() > 0)
+        if (tokenizer.nextWord(line.data(), lineIndex, line.length(), word, wordStart, wordEnd))
         {
             return;
         }
+
+        advanceToNextLine();
     }
 }
 
 
 void TextFileReader::advanceToNextLine()
 {
-    if (std::getline(textFile, line))
+    if (std::getline(*textFile, line))
     {
+        ++lineNumber;
         lineIndex = 0;
+        lineOffset = nextLineOffset;
+        nextLineOffset += line.length() + 1;
     }
     else
     {
@@ -79,3 +63,27 @@ std::string TextFileReader::currentWord() const
     return word;
 }
 
+
+std::string_view TextFileReader::currentWordView() const
+{
+    return word;
+}
+
+
+std::string_view TextFileReader::currentLineView() const
+{
+    return line;
+}
+
+
+int TextFileReader::currentLineNumber() const
+{
+    return lineNumber;
+}
+
+
+WordContext TextFileReader::currentWordContext() const
+{
+    return wordContextInLine(word, line, wordStart, wordEnd, lineOffset, lineNumber);
+}
+
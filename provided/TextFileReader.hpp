@@ -2,36 +2,51 @@
 //
 // Reads an input file and makes it possible to consume it word by word,
 // with spaces and punctuation skipped (except for hyphens or apostrophes
-// within words).
+// within words).  A file compressed with gzip or zstd is decompressed as
+// it's read (see TextFileStream.hpp).
 
 #ifndef TEXTFILEREADER_HPP
 #define TEXTFILEREADER_HPP
 
-#include <fstream>
+#include <istream>
+#include <memory>
 #include <string>
+#include "WordReader.hpp"
+#include "WordTokenizer.hpp"
 
 
 
-class TextFileReader
+class TextFileReader : public WordReader
 {
 public:
     TextFileReader(const std::string& textFilePath);
 
-    bool noMoreWords() const;
-    void advanceToNextWord();
+    virtual bool noMoreWords() const;
+    virtual void advanceToNextWord();
 
     std::string currentLine() const;
     std::string currentWord() const;
 
+    virtual std::string_view currentWordView() const;
+    virtual std::string_view currentLineView() const;
+    virtual int currentLineNumber() const;
+    virtual WordContext currentWordContext() const;
+
 private:
-    std::ifstream textFile;
+    std::unique_ptr<std::istream> textFile;
 
     bool eof;
 
     std::string line;
-    int lineIndex;
+    int lineNumber;
+    size_t lineIndex;
+    unsigned long long lineOffset;
+    unsigned long long nextLineOffset;
 
     std::string word;
+    size_t wordStart;
+    size_t wordEnd;
+    WordTokenizer tokenizer;
 
 private:
     void advanceToNextLine();
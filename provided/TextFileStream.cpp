@@ -0,0 +1,85 @@
+// TextFileStream.cpp
+
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include "Decompressor.hpp"
+#include "ReadAheadFile.hpp"
+#include "TextFileStream.hpp"
+
+
+
+namespace
+{
+    // A stream buffer that hands out the decompressed contents of a file,
+    // as they're read ahead.
+    class DecompressingBuffer : public std::streambuf
+    {
+    public:
+        explicit DecompressingBuffer(const std::string& path)
+            : file{path}, buffer(1 << 16)
+        {
+        }
+
+        bool isOpen() const
+        {
+            return file.isOpen();
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            size_t count = file.read(buffer.data(), buffer.size());
+
+            if (count == 0)
+            {
+                return traits_type::eof();
+            }
+
+            setg(buffer.data(), buffer.data(), buffer.data() + count);
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        ReadAheadFile file;
+        std::vector<char> buffer;
+    };
+
+
+    class DecompressingStream : public std::istream
+    {
+    public:
+        explicit DecompressingStream(const std::string& path)
+            : std::istream{nullptr}, buffer{path}
+        {
+            rdbuf(&buffer);
+
+            if (!buffer.isOpen())
+            {
+                setstate(std::ios::failbit);
+            }
+        }
+
+    private:
+        DecompressingBuffer buffer;
+    };
+}
+
+
+
+std::unique_ptr<std::istream> openTextFile(const std::string& path)
+{
+    if (detectCompression(path) != Compression::None)
+    {
+        return std::make_unique<DecompressingStream>(path);
+    }
+    else
+    {
+        return std::make_unique<std::ifstream>(path);
+    }
+}
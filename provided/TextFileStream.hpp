@@ -0,0 +1,25 @@
+// TextFileStream.hpp
+//
+// Opens text files, such as word sets and word frequency tables, for
+// reading with std::getline() and the like, whether or not they're
+// compressed.  A compressed file is decompressed as it's read, on a
+// background thread (see ReadAheadFile), so that decompressing overlaps
+// with whatever is done with the lines.
+
+#ifndef TEXTFILESTREAM_HPP
+#define TEXTFILESTREAM_HPP
+
+#include <istream>
+#include <memory>
+#include <string>
+
+
+
+// openTextFile() opens the file with the given path.  As with an
+// std::ifstream, a file that can't be opened (or, here, decompressed)
+// gives a stream that's already failed.
+std::unique_ptr<std::istream> openTextFile(const std::string& path);
+
+
+
+#endif // TEXTFILESTREAM_HPP
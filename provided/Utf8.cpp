@@ -0,0 +1,368 @@
+// Utf8.cpp
+
+#include <cstdint>
+#include <cstring>
+#include "Utf8.hpp"
+#include "WordTokenizer.hpp"
+
+
+
+namespace
+{
+    struct Range
+    {
+        char32_t first;
+        char32_t last;
+    };
+
+
+    // Combining marks, which can continue a word but not start one.
+    const Range combiningMarks[] =
+    {
+        { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF },
+        { 0x20D0, 0x20FF }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }
+    };
+
+
+    // Characters at or above U+0080 that are not letters.  Anything else
+    // at or above U+0080 that isn't a combining mark is treated as one.
+    const Range nonLetters[] =
+    {
+        { 0x0080, 0x00A9 }, { 0x00AB, 0x00B4 }, { 0x00B6, 0x00B9 }, { 0x00BB, 0x00BF },
+        { 0x00D7, 0x00D7 }, { 0x00F7, 0x00F7 }, { 0x02C2, 0x02C5 }, { 0x02D2, 0x02DF },
+        { 0x0375, 0x0375 }, { 0x037E, 0x037E }, { 0x0384, 0x0385 }, { 0x0387, 0x0387 },
+        { 0x0482, 0x0482 }, { 0x055A, 0x055F }, { 0x0589, 0x058A }, { 0x05BE, 0x05BE },
+        { 0x05C0, 0x05C0 }, { 0x05C3, 0x05C3 }, { 0x05F3, 0x05F4 }, { 0x060C, 0x060D },
+        { 0x061B, 0x061F }, { 0x066A, 0x066D }, { 0x06D4, 0x06D4 }, { 0x0964, 0x0965 },
+        { 0x0E4F, 0x0E4F }, { 0x0E5A, 0x0E5B }, { 0x2000, 0x20CF }, { 0x2100, 0x2BFF },
+        { 0x2E00, 0x2E7F }, { 0x3000, 0x303F }, { 0xD800, 0xF8FF }, { 0xFE10, 0xFE1F },
+        { 0xFE30, 0xFE6F }, { 0xFEFF, 0xFEFF }, { 0xFF00, 0xFF20 }, { 0xFF3B, 0xFF40 },
+        { 0xFF5B, 0xFF65 }, { 0xFFF0, 0xFFFF }, { 0x1F000, 0x1FBFF }, { 0xE0000, 0x10FFFF }
+    };
+
+
+    template <size_t Count>
+    bool inRanges(char32_t codePoint, const Range (&ranges)[Count])
+    {
+        for (const Range& range : ranges)
+        {
+            if (codePoint < range.first)
+            {
+                return false;
+            }
+            else if (codePoint <= range.last)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    inline bool isAsciiLetterOrDigit(char32_t c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+
+
+    inline bool isOdd(char32_t c)
+    {
+        return (c & 1) != 0;
+    }
+
+
+    inline bool isContinuation(unsigned char byte)
+    {
+        return (byte & 0xC0) == 0x80;
+    }
+}
+
+
+
+bool decodeUtf8(const char* data, size_t& index, size_t end, char32_t& codePoint)
+{
+    unsigned char first = static_cast<unsigned char>(data[index]);
+
+    if (first < 0x80)
+    {
+        codePoint = first;
+        ++index;
+        return true;
+    }
+
+    size_t length;
+    char32_t minimum;
+
+    if ((first & 0xE0) == 0xC0)
+    {
+        length = 2;
+        minimum = 0x80;
+        codePoint = first & 0x1F;
+    }
+    else if ((first & 0xF0) == 0xE0)
+    {
+        length = 3;
+        minimum = 0x800;
+        codePoint = first & 0x0F;
+    }
+    else if ((first & 0xF8) == 0xF0)
+    {
+        length = 4;
+        minimum = 0x10000;
+        codePoint = first & 0x07;
+    }
+    else
+    {
+        ++index;
+        return false;
+    }
+
+    if (end - index < length)
+    {
+        ++index;
+        return false;
+    }
+
+    for (size_t i = 1; i < length; ++i)
+    {
+        unsigned char byte = static_cast<unsigned char>(data[index + i]);
+
+        if (!isContinuation(byte))
+        {
+            ++index;
+            return false;
+        }
+
+        codePoint = (codePoint << 6) | (byte & 0x3F);
+    }
+
+    // Overlong encodings, surrogates and values beyond Unicode are not
+    // valid UTF-8.
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+    {
+        ++index;
+        return false;
+    }
+
+    index += length;
+    return true;
+}
+
+
+void appendUtf8(char32_t codePoint, std::string& text)
+{
+    if (codePoint < 0x80)
+    {
+        text.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        text.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        text.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        text.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+
+bool isLetterOrDigit(char32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        return isAsciiLetterOrDigit(codePoint);
+    }
+
+    return !inRanges(codePoint, nonLetters) && !inRanges(codePoint, combiningMarks);
+}
+
+
+bool isWordCharacter(char32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        return isAsciiLetterOrDigit(codePoint) || codePoint == '-' || codePoint == '\'';
+    }
+
+    return !inRanges(codePoint, nonLetters);
+}
+
+
+char32_t toUppercase(char32_t c)
+{
+    if (c < 0x80)
+    {
+        return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+    }
+
+    // Latin-1 Supplement
+    if (c == 0xB5)
+    {
+        return 0x39C;
+    }
+    else if (c >= 0xE0 && c <= 0xFE && c != 0xF7)
+    {
+        return c - 0x20;
+    }
+    else if (c == 0xFF)
+    {
+        return 0x178;
+    }
+
+    // Latin Extended-A, which is mostly pairs of uppercase and lowercase
+    // letters, though the pairs don't all start on an even code point.
+    if ((c >= 0x100 && c <= 0x12F) || (c >= 0x132 && c <= 0x137) || (c >= 0x14A && c <= 0x177))
+    {
+        return isOdd(c) ? c - 1 : c;
+    }
+    else if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+    {
+        return isOdd(c) ? c : c - 1;
+    }
+    else if (c == 0x131)
+    {
+        return 'I';
+    }
+    else if (c == 0x17F)
+    {
+        return 'S';
+    }
+
+    // Greek
+    if ((c >= 0x3B1 && c <= 0x3C1) || (c >= 0x3C3 && c <= 0x3CB))
+    {
+        return c - 0x20;
+    }
+    else if (c == 0x3C2)
+    {
+        return 0x3A3;
+    }
+    else if (c == 0x3AC)
+    {
+        return 0x386;
+    }
+    else if (c >= 0x3AD && c <= 0x3AF)
+    {
+        return c - 0x25;
+    }
+    else if (c == 0x3CC)
+    {
+        return 0x38C;
+    }
+    else if (c == 0x3CD || c == 0x3CE)
+    {
+        return c - 0x3F;
+    }
+
+    // Cyrillic
+    if (c >= 0x430 && c <= 0x44F)
+    {
+        return c - 0x20;
+    }
+    else if (c >= 0x450 && c <= 0x45F)
+    {
+        return c - 0x50;
+    }
+    else if ((c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF) || (c >= 0x4D0 && c <= 0x52F))
+    {
+        return isOdd(c) ? c - 1 : c;
+    }
+    else if (c >= 0x4C1 && c <= 0x4CE)
+    {
+        return isOdd(c) ? c : c - 1;
+    }
+    else if (c == 0x4CF)
+    {
+        return 0x4C0;
+    }
+
+    // Armenian
+    if (c >= 0x561 && c <= 0x586)
+    {
+        return c - 0x30;
+    }
+
+    // Latin Extended Additional
+    if ((c >= 0x1E00 && c <= 0x1E95) || (c >= 0x1EA0 && c <= 0x1EFF))
+    {
+        return isOdd(c) ? c - 1 : c;
+    }
+
+    // Fullwidth forms
+    if (c >= 0xFF41 && c <= 0xFF5A)
+    {
+        return c - 0x20;
+    }
+
+    return c;
+}
+
+
+size_t asciiPrefixLength(std::string_view text)
+{
+    size_t length = 0;
+
+    for (; length + 8 <= text.size(); length += 8)
+    {
+        std::uint64_t bytes;
+        std::memcpy(&bytes, text.data() + length, 8);
+
+        if ((bytes & 0x8080808080808080ull) != 0)
+        {
+            break;
+        }
+    }
+
+    while (length < text.size() && (static_cast<unsigned char>(text[length]) & 0x80) == 0)
+    {
+        ++length;
+    }
+
+    return length;
+}
+
+
+void uppercaseUtf8(std::string_view text, std::string& uppercase)
+{
+    static const WordTokenizer tokenizer;
+
+    uppercase.clear();
+    size_t index = 0;
+
+    while (index < text.size())
+    {
+        size_t asciiLength = asciiPrefixLength(text.substr(index));
+
+        if (asciiLength > 0)
+        {
+            size_t start = uppercase.size();
+            uppercase.resize(start + asciiLength);
+            tokenizer.copyUppercase(text.data() + index, asciiLength, uppercase.data() + start);
+            index += asciiLength;
+            continue;
+        }
+
+        size_t start = index;
+        char32_t codePoint;
+
+        if (decodeUtf8(text.data(), index, text.size(), codePoint))
+        {
+            appendUtf8(toUppercase(codePoint), uppercase);
+        }
+        else
+        {
+            uppercase.push_back(text[start]);
+        }
+    }
+}
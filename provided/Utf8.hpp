@@ -0,0 +1,59 @@
+// Utf8.hpp
+//
+// Functions for decoding UTF-8 text, classifying the characters in it and
+// converting them to uppercase, for the readers and loaders that need to
+// treat non-ASCII letters as letters.
+//
+// Classification and case conversion are approximations that avoid the
+// full Unicode tables.  Letters are the Latin, Greek, Cyrillic and other
+// alphabetic ranges, plus anything else that isn't in a block of
+// punctuation, symbols or private-use characters; combining marks can
+// continue a word but not start one.  Case conversion covers Latin-1,
+// Latin Extended-A, Greek, Cyrillic, Armenian and the fullwidth forms,
+// one character at a time (so, for example, a German sharp s stays as
+// it is).
+
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <string>
+#include <string_view>
+
+
+
+// decodeUtf8() decodes the character that starts at data[index], which
+// must be before end, storing it in codePoint and moving index past it.
+// It returns false, moving index past one byte, if the bytes there are
+// not a valid UTF-8 encoding of a character.
+bool decodeUtf8(const char* data, size_t& index, size_t end, char32_t& codePoint);
+
+
+// appendUtf8() appends the UTF-8 encoding of a character to text.
+void appendUtf8(char32_t codePoint, std::string& text);
+
+
+// isLetterOrDigit() returns true for characters that can start a word,
+// and isWordCharacter() for those that can be part of one, which also
+// includes hyphens, apostrophes and combining marks.
+bool isLetterOrDigit(char32_t codePoint);
+bool isWordCharacter(char32_t codePoint);
+
+
+// toUppercase() returns the uppercase form of a character, or the
+// character itself if it has none.
+char32_t toUppercase(char32_t codePoint);
+
+
+// asciiPrefixLength() returns the number of ASCII bytes at the start of
+// text, checking eight bytes at a time.
+size_t asciiPrefixLength(std::string_view text);
+
+
+// uppercaseUtf8() converts all of the characters in text to uppercase,
+// storing the result in uppercase.  Runs of ASCII characters are
+// converted in bulk, and invalid bytes are kept as they are.
+void uppercaseUtf8(std::string_view text, std::string& uppercase);
+
+
+
+#endif // UTF8_HPP
@@ -0,0 +1,187 @@
+// WindowedTextReader.cpp
+
+#include <algorithm>
+#include <cstring>
+#include "WindowedTextReader.hpp"
+
+
+
+WindowedTextReader::WindowedTextReader(
+    const std::string& path, size_t contextSize, size_t windowSize, size_t readAheadBlockSize)
+    : file{path, readAheadBlockSize}, tokenizer{}, contextSize{contextSize},
+      window(std::max(windowSize, 4 * contextSize + 256)), filled{0}, sourceDone{!file.isOpen()},
+      windowOffset{0}, index{0}, counted{0}, lineNumber{1}, lineStartOffset{0}, eof{false}
+{
+    advanceToNextWord();
+}
+
+
+bool WindowedTextReader::isOpen() const
+{
+    return file.isOpen();
+}
+
+
+bool WindowedTextReader::noMoreWords() const
+{
+    return eof;
+}
+
+
+void WindowedTextReader::advanceToNextWord()
+{
+    while (true)
+    {
+        size_t next = index;
+        size_t wordStart;
+        size_t wordEnd;
+        bool found = tokenizer.nextWord(window.data(), next, filled, word, wordStart, wordEnd);
+
+        // A word that reaches the end of what's in the window may go on
+        // past it, and so may the context after it, so more is read first,
+        // keeping the context before the word.  If there's no more room,
+        // the word (or its context) is cut short.
+        if (!sourceDone && (!found || next + contextSize >= filled))
+        {
+            size_t keepFrom = found ? wordStart : filled;
+
+            if (readMore(keepFrom - std::min(keepFrom, contextSize)))
+            {
+                continue;
+            }
+        }
+
+        if (!found)
+        {
+            word.clear();
+            context = WordContext{};
+            eof = true;
+            return;
+        }
+
+        index = next;
+        findContext(wordStart, wordEnd);
+        return;
+    }
+}
+
+
+std::string_view WindowedTextReader::currentWordView() const
+{
+    return word;
+}
+
+
+std::string_view WindowedTextReader::currentLineView() const
+{
+    return context.text;
+}
+
+
+int WindowedTextReader::currentLineNumber() const
+{
+    return static_cast<int>(context.lineNumber);
+}
+
+
+WordContext WindowedTextReader::currentWordContext() const
+{
+    return context;
+}
+
+
+// Reading is only likely to wait once the window is nearly used up, so the
+// file is only asked whether it has data ready then.
+bool WindowedTextReader::mayWaitForInput() const
+{
+    if (eof || sourceDone || filled - index > window.size() / 4)
+    {
+        return false;
+    }
+
+    return !file.dataReady();
+}
+
+
+// readMore() discards what's in the window before keepFrom, then reads as
+// much as will fit after what's left.  It returns false if the window is
+// unchanged, because nothing was discarded and nothing could be read.
+bool WindowedTextReader::readMore(size_t keepFrom)
+{
+    bool moved = keepFrom > 0;
+
+    if (moved)
+    {
+        countLinesUpTo(keepFrom);
+
+        std::memmove(window.data(), window.data() + keepFrom, filled - keepFrom);
+        filled -= keepFrom;
+        windowOffset += keepFrom;
+        index = std::max(index, keepFrom) - keepFrom;
+        counted -= keepFrom;
+    }
+
+    size_t count = filled < window.size() && !sourceDone
+        ? file.read(window.data() + filled, window.size() - filled)
+        : 0;
+
+    if (count == 0)
+    {
+        sourceDone = sourceDone || filled < window.size();
+        return moved;
+    }
+
+    filled += count;
+    return true;
+}
+
+
+void WindowedTextReader::countLinesUpTo(size_t position)
+{
+    while (counted < position)
+    {
+        const void* newline = std::memchr(window.data() + counted, '\n', position - counted);
+
+        if (newline == nullptr)
+        {
+            counted = position;
+            return;
+        }
+
+        counted = static_cast<const char*>(newline) - window.data() + 1;
+        ++lineNumber;
+        lineStartOffset = windowOffset + counted;
+    }
+}
+
+
+// findContext() finds the context of the word at [wordStart, wordEnd) in
+// the window, from the part of its line that's in the window.
+void WindowedTextReader::findContext(size_t wordStart, size_t wordEnd)
+{
+    countLinesUpTo(wordStart);
+
+    size_t lineStart = lineStartOffset > windowOffset ? lineStartOffset - windowOffset : 0;
+    // One byte more than the context is searched, so that it's known
+    // whether the line goes on past the context.
+    size_t searchEnd = std::min(filled, wordEnd + contextSize + 1);
+
+    const void* newline = std::memchr(window.data() + wordEnd, '\n', searchEnd - wordEnd);
+    size_t lineEnd = newline != nullptr ? static_cast<const char*>(newline) - window.data() : searchEnd;
+
+    context = wordContextInLine(
+        word, std::string_view{window.data() + lineStart, lineEnd - lineStart},
+        wordStart - lineStart, wordEnd - lineStart,
+        windowOffset + lineStart, lineNumber, contextSize);
+
+    // The line may have begun before the window, and may go on past the
+    // end of a full window.
+    unsigned long long lineBeforeWindow = windowOffset + lineStart - lineStartOffset;
+    context.column += lineBeforeWindow;
+    context.lineContinuesBefore = context.lineContinuesBefore || lineBeforeWindow > 0;
+
+    if (newline == nullptr && searchEnd == filled && !sourceDone)
+    {
+        context.lineContinuesAfter = true;
+    }
+}
@@ -0,0 +1,88 @@
+// WindowedTextReader.hpp
+//
+// Reads a text file the same way a TextFileReader does, but without ever
+// holding a whole line: the file is read through a window of fixed size,
+// and only a bounded context around each word (see WordContext) is kept.
+// Memory use is the same whether the file's lines are short or hundreds
+// of megabytes long, which makes this the reader to use for minified
+// files, or ones with no newlines at all.
+//
+// Since no whole line is ever available, currentLineView() returns the
+// current word's context instead, and a word longer than the window is
+// broken into pieces, each of which is treated as a word of its own.
+//
+// The file is read ahead on a background thread (see ReadAheadFile), and
+// may be compressed or be a pipe.
+
+#ifndef WINDOWEDTEXTREADER_HPP
+#define WINDOWEDTEXTREADER_HPP
+
+#include <string>
+#include <vector>
+#include "ReadAheadFile.hpp"
+#include "WordReader.hpp"
+#include "WordTokenizer.hpp"
+
+
+
+class WindowedTextReader : public WordReader
+{
+public:
+    // The number of bytes in the window, by default.
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 1 << 16;
+
+public:
+    // Opens the file with the given path, keeping up to contextSize bytes
+    // on either side of each word.  The window is made larger if it's
+    // too small to hold a word's context with room to spare.  As with
+    // TextFileReader, a file that can't be opened has no words.
+    explicit WindowedTextReader(
+        const std::string& path, size_t contextSize = WordContext::DEFAULT_SIZE,
+        size_t windowSize = DEFAULT_WINDOW_SIZE,
+        size_t readAheadBlockSize = ReadAheadFile::DEFAULT_BLOCK_SIZE);
+
+    WindowedTextReader(const WindowedTextReader&) = delete;
+    WindowedTextReader& operator=(const WindowedTextReader&) = delete;
+
+    bool isOpen() const;
+
+    virtual bool noMoreWords() const;
+    virtual void advanceToNextWord();
+
+    virtual std::string_view currentWordView() const;
+    virtual std::string_view currentLineView() const;
+    virtual int currentLineNumber() const;
+    virtual WordContext currentWordContext() const;
+
+    virtual bool mayWaitForInput() const;
+
+private:
+    ReadAheadFile file;
+    WordTokenizer tokenizer;
+    size_t contextSize;
+
+    std::vector<char> window;
+    size_t filled;
+    bool sourceDone;
+    unsigned long long windowOffset;
+
+    // The position in the window where the search for the next word
+    // starts, and the position up to which lines have been counted.
+    size_t index;
+    size_t counted;
+    unsigned long long lineNumber;
+    unsigned long long lineStartOffset;
+
+    bool eof;
+    std::string word;
+    WordContext context;
+
+private:
+    bool readMore(size_t keepFrom);
+    void countLinesUpTo(size_t position);
+    void findContext(size_t wordStart, size_t wordEnd);
+};
+
+
+
+#endif // WINDOWEDTEXTREADER_HPP
@@ -0,0 +1,46 @@
+// WordContext.cpp
+
+#include <algorithm>
+#include "WordContext.hpp"
+
+
+
+namespace
+{
+    inline bool isContinuationByte(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+}
+
+
+
+WordContext wordContextInLine(
+    std::string_view word, std::string_view line, size_t wordStart, size_t wordEnd,
+    unsigned long long lineOffset, unsigned long long lineNumber, size_t contextSize)
+{
+    size_t from = wordStart - std::min(wordStart, contextSize);
+    size_t to = wordEnd + std::min(line.size() - wordEnd, contextSize);
+
+    while (from < wordStart && isContinuationByte(line[from]))
+    {
+        ++from;
+    }
+
+    while (to > wordEnd && to < line.size() && isContinuationByte(line[to]))
+    {
+        --to;
+    }
+
+    WordContext context;
+    context.word = word;
+    context.text = line.substr(from, to - from);
+    context.wordStart = wordStart - from;
+    context.wordEnd = wordEnd - from;
+    context.lineContinuesBefore = from > 0;
+    context.lineContinuesAfter = to < line.size();
+    context.offset = lineOffset + wordStart;
+    context.lineNumber = lineNumber;
+    context.column = wordStart + 1;
+    return context;
+}
@@ -0,0 +1,59 @@
+// WordContext.hpp
+//
+// A WordContext says where a word was found in its input: its byte
+// offset, line and column, and a piece of its line around it.  The piece
+// of the line is bounded, holding at most a given number of bytes on
+// either side of the word, so that reporting a word on a very long line
+// (such as in a minified file, or one with no newlines at all) costs no
+// more than reporting one on a short line.
+//
+// Lines and columns are numbered from 1, and columns count bytes rather
+// than characters.  The views in a WordContext are only valid for as long
+// as whatever they came from says (see WordReader).
+
+#ifndef WORDCONTEXT_HPP
+#define WORDCONTEXT_HPP
+
+#include <cstddef>
+#include <string_view>
+
+
+
+struct WordContext
+{
+    // The number of bytes of context kept on either side of a word, by
+    // default.
+    static constexpr size_t DEFAULT_SIZE = 80;
+
+    // The word, uppercased.
+    std::string_view word;
+
+    // The word as it appears in the input, along with whatever of its line
+    // is kept around it.  The word is text[wordStart, wordEnd).
+    std::string_view text;
+    size_t wordStart = 0;
+    size_t wordEnd = 0;
+
+    // Whether the line goes on before or after text.
+    bool lineContinuesBefore = false;
+    bool lineContinuesAfter = false;
+
+    unsigned long long offset = 0;
+    unsigned long long lineNumber = 0;
+    unsigned long long column = 0;
+};
+
+
+// wordContextInLine() returns the context of the word found at
+// [wordStart, wordEnd) of the given line, which starts at lineOffset in
+// the input, keeping at most contextSize bytes of the line on either side
+// of the word.  The context is never cut partway through a UTF-8
+// character.
+WordContext wordContextInLine(
+    std::string_view word, std::string_view line, size_t wordStart, size_t wordEnd,
+    unsigned long long lineOffset, unsigned long long lineNumber,
+    size_t contextSize = WordContext::DEFAULT_SIZE);
+
+
+
+#endif // WORDCONTEXT_HPP
@@ -0,0 +1,65 @@
+// WordReader.hpp
+//
+// An abstract base class for anything that can be consumed word by word,
+// with spaces and punctuation skipped (except for hyphens or apostrophes
+// within words), keeping track of the line each word is on.  Words are
+// uppercase.
+//
+// The views returned by currentWordView() and currentLineView() are valid
+// until the next call to advanceToNextWord(), except that the line views
+// of readers whose linesStayValid() returns true are valid for as long as
+// the reader exists.
+//
+// currentWordContext() says where the current word is and gives a bounded
+// piece of its line around it (see WordContext); its views are valid for
+// as long as currentLineView()'s.  Readers that don't know where their
+// words are give the whole line as the context, with no position.
+//
+// Readers of streams, such as pipes, may have to wait for more input to
+// arrive; mayWaitForInput() returns true when the next call to
+// advanceToNextWord() might, so that anything waiting on the words read
+// so far can be dealt with first.
+
+#ifndef WORDREADER_HPP
+#define WORDREADER_HPP
+
+#include <string_view>
+#include "WordContext.hpp"
+
+
+
+class WordReader
+{
+public:
+    virtual ~WordReader() = default;
+
+    virtual bool noMoreWords() const = 0;
+    virtual void advanceToNextWord() = 0;
+
+    virtual std::string_view currentWordView() const = 0;
+    virtual std::string_view currentLineView() const = 0;
+    virtual int currentLineNumber() const = 0;
+
+    virtual WordContext currentWordContext() const
+    {
+        WordContext context;
+        context.word = currentWordView();
+        context.text = currentLineView();
+        context.lineNumber = currentLineNumber();
+        return context;
+    }
+
+    virtual bool linesStayValid() const
+    {
+        return false;
+    }
+
+    virtual bool mayWaitForInput() const
+    {
+        return false;
+    }
+};
+
+
+
+#endif // WORDREADER_HPP
@@ -1,31 +1,419 @@
 // WordSetLoader.cpp
 
 #include <algorithm>
-#include <cctype>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+#include "CompiledWordSet.hpp"
+#include "Decompressor.hpp"
+#include "LineChunks.hpp"
+#include "MappedFile.hpp"
+#include "ReorderBuffer.hpp"
+#include "TextFileStream.hpp"
+#include "Utf8.hpp"
 #include "WordSetLoader.hpp"
+#include "WordTokenizer.hpp"
 
 
 
-void WordSetLoader::load(const std::string& wordFilePath, Set<std::string>& wordSet)
+namespace
 {
-    std::ifstream wordFile{wordFilePath};
-
-    std::string word;
-
-    while (std::getline(wordFile, word))
+    // normalizeWord() makes a line of a word file into the word on it:
+    // uppercased, without any line-ending characters.
+    void normalizeWord(std::string_view line, std::string& word)
     {
-        std::transform(
-            word.begin(), word.end(), word.begin(),
-            [](auto c) { return std::toupper(c); });
+        uppercaseUtf8(line, word);
 
         word.erase(
             std::remove_if(
                 word.begin(), word.end(),
                 [](auto c) { return c == '\r' || c == '\n'; }),
             word.end());
+    }
+
+
+    // copyUppercaseAscii() copies text to uppercase, converting its ASCII
+    // letters to uppercase as many at a time as the CPU allows, and leaving
+    // any non-ASCII characters for normalizeWord() to deal with.
+    void copyUppercaseAscii(std::string_view text, std::string& uppercase)
+    {
+        static const WordTokenizer tokenizer;
+
+        uppercase.resize(text.size());
+        tokenizer.copyUppercase(text.data(), text.size(), uppercase.data());
+    }
+
+
+    // isRegularFile() returns false for pipes and devices, which can only
+    // be read once, so they have to be opened only once, too: reopening a
+    // pipe after looking at it would lose what was read, and reopening a
+    // named pipe would wait for another writer.
+    bool isRegularFile(const std::string& path)
+    {
+        struct stat status;
+        return ::stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+    }
+
+
+    // readWordFile() reads the whole of a word file, decompressing it if
+    // need be, into one buffer, with its ASCII letters already converted
+    // to uppercase.  An uncompressed file is mapped, so that it's copied
+    // into the buffer and converted in the same pass.
+    std::string readWordFile(const std::string& wordFilePath)
+    {
+        constexpr size_t MINIMUM_READ_SIZE = 1 << 20;
+
+        std::string text;
+        bool regular = isRegularFile(wordFilePath);
+
+        if (regular && detectCompression(wordFilePath) == Compression::None)
+        {
+            MappedFile file{wordFilePath};
+
+            if (file.size() > 0)
+            {
+                copyUppercaseAscii(file.text(), text);
+                return text;
+            }
+        }
+
+        // Compressed files, and empty ones, are read as a stream instead,
+        // as are pipes and devices, which are opened just this once and
+        // never decompressed.
+        std::unique_ptr<std::istream> wordFile =
+            regular
+            ? openTextFile(wordFilePath)
+            : std::make_unique<std::ifstream>(wordFilePath, std::ios::binary);
+
+        while (*wordFile)
+        {
+            size_t size = text.size();
+            text.resize(std::max(size * 2, MINIMUM_READ_SIZE));
+            wordFile->read(text.data() + size, text.size() - size);
+            text.resize(size + wordFile->gcount());
+        }
+
+        copyUppercaseAscii(text, text);
+        return text;
+    }
+
+
+    // forEachNormalizedWord() calls add with each of the words in text,
+    // which is a word file, or a chunk of one that ends at a line
+    // boundary, whose ASCII letters have already been converted to
+    // uppercase.  That leaves most lines with nothing more to do, so their
+    // words are handed over as views into text; only lines with non-ASCII
+    // characters or carriage returns are normalized into a string of their
+    // own.
+    template <typename AddFunction>
+    void forEachNormalizedWord(std::string_view text, AddFunction add)
+    {
+        bool hasCarriageReturns = text.find('\r') != std::string_view::npos;
+        size_t nextNonAscii = asciiPrefixLength(text);
+        std::string normalized;
+
+        for (size_t start = 0; start < text.size(); )
+        {
+            size_t end = std::min(text.find('\n', start), text.size());
+            std::string_view word = text.substr(start, end - start);
+
+            if (end > nextNonAscii)
+            {
+                normalizeWord(word, normalized);
+                word = normalized;
+                nextNonAscii = end + asciiPrefixLength(text.substr(end));
+            }
+            else if (hasCarriageReturns && word.find('\r') != std::string_view::npos)
+            {
+                normalizeWord(word, normalized);
+                word = normalized;
+            }
+
+            add(word);
+            start = end + 1;
+        }
+    }
+
+
+    // loadWords() calls add with each of the words in a word file, reusing
+    // one string for all of them, so that adding a word to a set allocates
+    // nothing unless the set keeps a copy.  The words in a compiled
+    // dictionary were normalized when it was compiled, so they're added as
+    // they are.
+    template <typename AddFunction>
+    void loadWords(const std::string& wordFilePath, AddFunction add)
+    {
+        std::string word;
 
-        wordSet.add(word);
+        if (CompiledWordSet::isCompiledWordSet(wordFilePath))
+        {
+            CompiledWordSet compiled{wordFilePath};
+
+            compiled.forEachWord(
+                [&](std::string_view compiledWord)
+                {
+                    word.assign(compiledWord);
+                    add(word);
+                });
+
+            return;
+        }
+
+        forEachNormalizedWord(
+            readWordFile(wordFilePath),
+            [&](std::string_view normalized)
+            {
+                word.assign(normalized);
+                add(word);
+            });
+    }
+
+
+    // normalizedWords() returns all of the words in a word file, to be
+    // compiled into a dictionary.
+    std::vector<std::string> normalizedWords(const std::string& wordFilePath)
+    {
+        std::vector<std::string> words;
+
+        loadWords(
+            wordFilePath,
+            [&](const std::string& word)
+            {
+                words.push_back(word);
+            });
+
+        return words;
+    }
+
+
+    // A Shard is one chunk of a word file, along with its words once
+    // they've been normalized, and their hashes if they're needed.  The
+    // words are kept end to end in one string, rather than each in a
+    // string of its own, so that normalizing them allocates very little.
+    struct Shard
+    {
+        std::string_view text;
+        std::string words;
+        std::vector<size_t> wordEnds;
+        std::vector<std::uint64_t> hashes;
+
+
+        template <typename AddFunction>
+        void forEachWord(AddFunction add) const
+        {
+            std::string word;
+            size_t start = 0;
+
+            for (size_t end : wordEnds)
+            {
+                word.assign(words, start, end - start);
+                add(word);
+                start = end;
+            }
+        }
+    };
+
+
+    // Chunks are small enough that every thread gets several, so that
+    // the last few to finish don't keep the others waiting long, but not
+    // so small that there are a great many of them.
+    constexpr size_t MINIMUM_SHARD_SIZE = 64 * 1024;
+    constexpr size_t MAXIMUM_SHARD_SIZE = 4 * 1024 * 1024;
+
+
+    // loadShards() maps the word file, splits it into shards at line
+    // boundaries, and normalizes (and, if asked to, hashes) the words in
+    // each shard on the pool's threads.  As each shard is ready, it's
+    // delivered, in the order the shards are in the file, and one at a
+    // time.  Compressed files, compiled dictionaries, pipes and devices
+    // can't be split, so loadShards() returns false for them, having
+    // delivered nothing.
+    template <typename DeliverFunction>
+    bool loadShards(
+        const std::string& wordFilePath, ThreadPool& pool, bool hashWords,
+        DeliverFunction deliver)
+    {
+        if (!isRegularFile(wordFilePath)
+            || detectCompression(wordFilePath) != Compression::None
+            || CompiledWordSet::isCompiledWordSet(wordFilePath))
+        {
+            return false;
+        }
+
+        MappedFile file{wordFilePath};
+
+        size_t shardSize = std::clamp<size_t>(
+            file.size() / (4 * (pool.threadCount() + 1)), MINIMUM_SHARD_SIZE, MAXIMUM_SHARD_SIZE);
+
+        std::vector<Shard> shards;
+
+        for (std::string_view text : splitAtLines(file.text(), shardSize))
+        {
+            shards.push_back(Shard{text, {}, {}, {}});
+        }
+
+        ReorderBuffer reorderBuffer{
+            shards.size(),
+            [&](size_t index)
+            {
+                deliver(shards[index]);
+                shards[index] = Shard{};
+            }};
+
+        std::vector<ThreadPool::Task> tasks;
+
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            tasks.push_back(
+                [&, i]()
+                {
+                    Shard& shard = shards[i];
+                    std::string text;
+                    std::string word;
+
+                    copyUppercaseAscii(shard.text, text);
+
+                    forEachNormalizedWord(
+                        text,
+                        [&](std::string_view normalized)
+                        {
+                            shard.words += normalized;
+                            shard.wordEnds.push_back(shard.words.size());
+
+                            if (hashWords)
+                            {
+                                word.assign(normalized);
+                                shard.hashes.push_back(BloomFilter::hash(word));
+                            }
+                        });
+
+                    reorderBuffer.taskFinished(i);
+                });
+        }
+
+        pool.runAll(tasks);
+        return true;
+    }
+
+
+    void fillFilter(BloomFilter& filter, const std::vector<std::uint64_t>& hashes)
+    {
+        filter.reset(hashes.size());
+
+        for (std::uint64_t hash : hashes)
+        {
+            filter.addHash(hash);
+        }
     }
 }
 
+
+
+void WordSetLoader::load(const std::string& wordFilePath, Set<std::string>& wordSet)
+{
+    loadWords(
+        wordFilePath,
+        [&](const std::string& word)
+        {
+            wordSet.add(word);
+        });
+}
+
+
+void WordSetLoader::load(
+    const std::string& wordFilePath, Set<std::string>& wordSet,
+    BloomFilter& filter)
+{
+    // The filter can only be sized once the number of words is known, so
+    // the hashes are gathered as the set is loaded and added afterward.
+    std::vector<std::uint64_t> hashes;
+
+    loadWords(
+        wordFilePath,
+        [&](const std::string& word)
+        {
+            wordSet.add(word);
+            hashes.push_back(BloomFilter::hash(word));
+        });
+
+    fillFilter(filter, hashes);
+}
+
+
+void WordSetLoader::load(
+    const std::string& wordFilePath, Set<std::string>& wordSet, ThreadPool& pool)
+{
+    bool loaded = loadShards(
+        wordFilePath, pool, false,
+        [&](const Shard& shard)
+        {
+            shard.forEachWord([&](const std::string& word) { wordSet.add(word); });
+        });
+
+    if (!loaded)
+    {
+        load(wordFilePath, wordSet);
+    }
+}
+
+
+void WordSetLoader::load(
+    const std::string& wordFilePath, Set<std::string>& wordSet,
+    BloomFilter& filter, ThreadPool& pool)
+{
+    std::vector<std::uint64_t> hashes;
+
+    bool loaded = loadShards(
+        wordFilePath, pool, true,
+        [&](const Shard& shard)
+        {
+            shard.forEachWord([&](const std::string& word) { wordSet.add(word); });
+            hashes.insert(hashes.end(), shard.hashes.begin(), shard.hashes.end());
+        });
+
+    if (loaded)
+    {
+        fillFilter(filter, hashes);
+    }
+    else
+    {
+        load(wordFilePath, wordSet, filter);
+    }
+}
+
+
+bool WordSetLoader::compile(const std::string& wordFilePath, const std::string& compiledFilePath)
+{
+    return CompiledWordSet::write(normalizedWords(wordFilePath), compiledFilePath);
+}
+
+
+bool WordSetLoader::compileShared(const std::string& wordFilePath, const std::string& sharedMemoryName)
+{
+    return CompiledWordSet::writeShared(normalizedWords(wordFilePath), sharedMemoryName);
+}
+
+
+void WordSetLoader::loadFrequencies(
+    const std::string& frequencyFilePath, WordFrequencies& frequencies)
+{
+    std::unique_ptr<std::istream> frequencyFile = openTextFile(frequencyFilePath);
+    std::string line;
+
+    while (std::getline(*frequencyFile, line))
+    {
+        std::istringstream in{line};
+        std::string word;
+        unsigned long frequency;
+
+        if (in >> word >> frequency)
+        {
+            std::string uppercase;
+            uppercaseUtf8(word, uppercase);
+            frequencies.set(uppercase, frequency);
+        }
+    }
+}
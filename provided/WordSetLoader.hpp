@@ -1,13 +1,34 @@
 // WordSetLoader.hpp
 //
 // A class that loads a word set from a file containing one word on each
-// line.  The words are then added to the given Set<std::string>.
+// line.  The words are then added to the given Set<std::string>, and
+// optionally also to a BloomFilter that can sit in front of the set.  It
+// can also load a table of word frequencies used to rank suggestions.
+// Either file may be compressed with gzip or zstd, in which case it's
+// decompressed as it's loaded.  A word file is read into memory whole,
+// and its letters converted to uppercase in bulk, so that only lines with
+// non-ASCII characters or carriage returns are normalized one at a time.
+//
+// A word set can also be loaded using a ThreadPool.  The file is split
+// into chunks at line boundaries, and the words in each chunk are
+// normalized (and, for a BloomFilter, hashed) on the pool's threads.  Sets
+// aren't safe to add to from more than one thread at a time, so words are
+// added to the set one chunk at a time, as each is ready, in the order
+// they're in the file; the set ends up the same as if it had been loaded
+// on one thread, down to the shape of a tree.
+//
+// A word set can also be compiled into a dictionary that's queried in
+// place by a CompiledWordSet, with no parsing at all.  A compiled
+// dictionary can be loaded into any other Set, too.
 
 #ifndef WORDSETLOADER_HPP
 #define WORDSETLOADER_HPP
 
 #include <string>
+#include "BloomFilter.hpp"
 #include "Set.hpp"
+#include "ThreadPool.hpp"
+#include "WordFrequencies.hpp"
 
 
 
@@ -15,9 +36,38 @@ class WordSetLoader
 {
 public:
     void load(const std::string& wordFilePath, Set<std::string>& wordSet);
+
+    // This overload also resets the given filter, sizes it for the number
+    // of words in the file, and adds every word to it.
+    void load(
+        const std::string& wordFilePath, Set<std::string>& wordSet,
+        BloomFilter& filter);
+
+    // These overloads load the word set using the given pool.  Compressed
+    // files, compiled dictionaries, pipes and devices are loaded on the
+    // calling thread.
+    void load(const std::string& wordFilePath, Set<std::string>& wordSet, ThreadPool& pool);
+
+    void load(
+        const std::string& wordFilePath, Set<std::string>& wordSet,
+        BloomFilter& filter, ThreadPool& pool);
+
+    // compile() normalizes the words in the given word file the same way
+    // load() does, then writes them as a compiled dictionary (see
+    // CompiledWordSet), returning false if it can't be written.
+    bool compile(const std::string& wordFilePath, const std::string& compiledFilePath);
+
+    // compileShared() does the same, but publishes the compiled dictionary
+    // in the POSIX shared memory object with the given name, for other
+    // processes to open with CompiledWordSet::openShared().
+    bool compileShared(const std::string& wordFilePath, const std::string& sharedMemoryName);
+
+    // loadFrequencies() loads a word frequency table from a file with one
+    // word on each line, followed by whitespace and the word's frequency.
+    void loadFrequencies(
+        const std::string& frequencyFilePath, WordFrequencies& frequencies);
 };
 
 
 
 #endif // WORDSETLOADER_HPP
-
@@ -0,0 +1,550 @@
+// WordTokenizer.cpp
+
+#include <cstring>
+#include "Utf8.hpp"
+#include "WordTokenizer.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define WORDTOKENIZER_X86 1
+#include <immintrin.h>
+#endif
+
+
+
+namespace
+{
+    inline bool isAlnum(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+
+
+    inline bool isWordChar(char c)
+    {
+        return isAlnum(c) || c == '-' || c == '\'';
+    }
+
+
+    inline bool isHigh(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0x80) != 0;
+    }
+
+
+    inline char toUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+
+    // Each implementation is compiled twice: once where only ASCII letters
+    // and digits can start a run, and once for UTF-8, where non-ASCII bytes
+    // can start or continue one too.
+
+    template <bool Utf8>
+    size_t scalarFindRunEnd(const char* data, size_t index, size_t end, bool& nonAscii)
+    {
+        while (index < end && (isWordChar(data[index]) || (Utf8 && isHigh(data[index]))))
+        {
+            nonAscii |= Utf8 && isHigh(data[index]);
+            ++index;
+        }
+
+        return index;
+    }
+
+
+    template <bool Utf8>
+    size_t scalarFindRun(const char* data, size_t index, size_t end, size_t& runEnd, bool& nonAscii)
+    {
+        while (index < end && !isAlnum(data[index]) && !(Utf8 && isHigh(data[index])))
+        {
+            ++index;
+        }
+
+        runEnd = scalarFindRunEnd<Utf8>(data, index, end, nonAscii);
+        return index;
+    }
+
+
+    void scalarCopyUppercase(const char* source, size_t count, char* target)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            target[i] = toUpper(source[i]);
+        }
+    }
+
+
+#ifdef WORDTOKENIZER_X86
+
+    // The vectorized tokenizers classify a block of bytes at a time into
+    // three bitmasks: one with a bit set for each letter or digit, one with
+    // a bit set for each word character, and one with a bit set for each
+    // non-ASCII byte.  A run starts at the lowest bit in the first mask and
+    // ends at the next clear bit in the second, so usually one block is
+    // enough to find a whole run.
+    //
+    // Blocks never extend past the end of the data, which may be the end
+    // of a mapping; a short last block is copied into a buffer padded with
+    // zeroes, which are not word characters.
+
+    template <size_t Width>
+    inline const char* blockAt(const char* data, size_t index, size_t end, char (&padded)[Width])
+    {
+        if (index + Width <= end)
+        {
+            return data + index;
+        }
+
+        std::memset(padded, 0, Width);
+        std::memcpy(padded, data + index, end - index);
+        return padded;
+    }
+
+
+    // SSE2 has no byte shuffle, so bytes are classified with range
+    // comparisons.  The comparisons are signed, which conveniently puts
+    // every non-ASCII byte below all of the ranges.
+
+    inline __m128i sse2InRange(__m128i bytes, char low, char high)
+    {
+        return _mm_and_si128(
+            _mm_cmpgt_epi8(bytes, _mm_set1_epi8(low - 1)),
+            _mm_cmplt_epi8(bytes, _mm_set1_epi8(high + 1)));
+    }
+
+
+    template <bool Utf8>
+    inline void sse2Classify(
+        const char* block, unsigned int& alnumMask, unsigned int& wordMask, unsigned int& highMask)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+
+        __m128i alnum = _mm_or_si128(
+            sse2InRange(bytes, '0', '9'), sse2InRange(folded, 'a', 'z'));
+
+        __m128i word = _mm_or_si128(
+            alnum,
+            _mm_or_si128(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-')),
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\''))));
+
+        highMask = Utf8 ? _mm_movemask_epi8(bytes) : 0;
+        alnumMask = _mm_movemask_epi8(alnum) | highMask;
+        wordMask = _mm_movemask_epi8(word) | highMask;
+    }
+
+
+    template <bool Utf8>
+    size_t sse2FindRunEnd(const char* data, size_t index, size_t end, bool& nonAscii)
+    {
+        char padded[16];
+
+        for (; index < end; index += 16)
+        {
+            unsigned int alnumMask;
+            unsigned int wordMask;
+            unsigned int highMask;
+            sse2Classify<Utf8>(blockAt(data, index, end, padded), alnumMask, wordMask, highMask);
+
+            unsigned int endMask = ~wordMask & 0xFFFF;
+
+            if (endMask != 0)
+            {
+                unsigned int runEnd = __builtin_ctz(endMask);
+
+                if (Utf8 && highMask != 0)
+                {
+                    nonAscii |= (highMask & ((1u << runEnd) - 1)) != 0;
+                }
+
+                return index + runEnd;
+            }
+
+            nonAscii |= highMask != 0;
+        }
+
+        return end;
+    }
+
+
+    template <bool Utf8>
+    size_t sse2FindRun(const char* data, size_t index, size_t end, size_t& runEnd, bool& nonAscii)
+    {
+        char padded[16];
+
+        for (; index < end; index += 16)
+        {
+            unsigned int alnumMask;
+            unsigned int wordMask;
+            unsigned int highMask;
+            sse2Classify<Utf8>(blockAt(data, index, end, padded), alnumMask, wordMask, highMask);
+
+            if (alnumMask == 0)
+            {
+                continue;
+            }
+
+            unsigned int offset = __builtin_ctz(alnumMask);
+            unsigned int endMask = ~wordMask & (0xFFFFu << offset) & 0xFFFF;
+
+            if (endMask != 0)
+            {
+                unsigned int blockRunEnd = __builtin_ctz(endMask);
+
+                if (Utf8 && highMask != 0)
+                {
+                    nonAscii |= (highMask & (0xFFFFu << offset) & ((1u << blockRunEnd) - 1)) != 0;
+                }
+
+                runEnd = index + blockRunEnd;
+            }
+            else
+            {
+                nonAscii |= (highMask & (0xFFFFu << offset)) != 0;
+                runEnd = sse2FindRunEnd<Utf8>(data, index + 16, end, nonAscii);
+            }
+
+            return index + offset;
+        }
+
+        runEnd = end;
+        return end;
+    }
+
+
+    void sse2CopyUppercase(const char* source, size_t count, char* target)
+    {
+        size_t i = 0;
+
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            __m128i lower = sse2InRange(bytes, 'a', 'z');
+            __m128i upper = _mm_sub_epi8(bytes, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), upper);
+        }
+
+        scalarCopyUppercase(source + i, count - i, target + i);
+    }
+
+
+    // AVX2 classifies each byte by looking up its low and high nibbles in
+    // two 16-entry tables and ANDing the results; a byte is in a class
+    // only if both of its nibbles are.  The classes are:
+    //
+    //     0x01  hyphen or apostrophe   (high nibble 2, low nibble 7 or D)
+    //     0x02  digit                  (high nibble 3, low nibble 0-9)
+    //     0x04  letter A-O or a-o      (high nibble 4 or 6, low nibble 1-F)
+    //     0x08  letter P-Z or p-z      (high nibble 5 or 7, low nibble 0-A)
+    //
+    // Bytes with the high bit set have high nibbles 8-F, which are in no
+    // class.
+
+    template <bool Utf8>
+    __attribute__((target("avx2")))
+    inline void avx2Classify(
+        const char* block, unsigned int& alnumMask, unsigned int& wordMask, unsigned int& highMask)
+    {
+        const __m256i lowTable = _mm256_setr_epi8(
+            0x0A, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F,
+            0x0E, 0x0E, 0x0C, 0x04, 0x04, 0x05, 0x04, 0x04,
+            0x0A, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F,
+            0x0E, 0x0E, 0x0C, 0x04, 0x04, 0x05, 0x04, 0x04);
+
+        const __m256i highTable = _mm256_setr_epi8(
+            0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i zero = _mm256_setzero_si256();
+
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i low = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(bytes, nibble));
+        __m256i high = _mm256_shuffle_epi8(
+            highTable, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+
+        __m256i classes = _mm256_and_si256(low, high);
+        __m256i alnum = _mm256_and_si256(classes, _mm256_set1_epi8(0x0E));
+
+        highMask = Utf8 ? _mm256_movemask_epi8(bytes) : 0;
+        alnumMask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(alnum, zero)) | highMask;
+        wordMask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(classes, zero)) | highMask;
+    }
+
+
+    template <bool Utf8>
+    __attribute__((target("avx2")))
+    size_t avx2FindRunEnd(const char* data, size_t index, size_t end, bool& nonAscii)
+    {
+        char padded[32];
+
+        for (; index < end; index += 32)
+        {
+            unsigned int alnumMask;
+            unsigned int wordMask;
+            unsigned int highMask;
+            avx2Classify<Utf8>(blockAt(data, index, end, padded), alnumMask, wordMask, highMask);
+
+            if (~wordMask != 0)
+            {
+                unsigned int runEnd = __builtin_ctz(~wordMask);
+
+                if (Utf8 && highMask != 0)
+                {
+                    nonAscii |= (highMask & ((1u << runEnd) - 1)) != 0;
+                }
+
+                return index + runEnd;
+            }
+
+            nonAscii |= highMask != 0;
+        }
+
+        return end;
+    }
+
+
+    template <bool Utf8>
+    __attribute__((target("avx2")))
+    size_t avx2FindRun(const char* data, size_t index, size_t end, size_t& runEnd, bool& nonAscii)
+    {
+        char padded[32];
+
+        for (; index < end; index += 32)
+        {
+            unsigned int alnumMask;
+            unsigned int wordMask;
+            unsigned int highMask;
+            avx2Classify<Utf8>(blockAt(data, index, end, padded), alnumMask, wordMask, highMask);
+
+            if (alnumMask == 0)
+            {
+                continue;
+            }
+
+            unsigned int offset = __builtin_ctz(alnumMask);
+            unsigned int endMask = ~wordMask & (0xFFFFFFFFu << offset);
+
+            if (endMask != 0)
+            {
+                unsigned int blockRunEnd = __builtin_ctz(endMask);
+
+                if (Utf8 && highMask != 0)
+                {
+                    nonAscii |= (highMask & (0xFFFFFFFFu << offset) & ((1u << blockRunEnd) - 1)) != 0;
+                }
+
+                runEnd = index + blockRunEnd;
+            }
+            else
+            {
+                nonAscii |= (highMask & (0xFFFFFFFFu << offset)) != 0;
+                runEnd = avx2FindRunEnd<Utf8>(data, index + 32, end, nonAscii);
+            }
+
+            return index + offset;
+        }
+
+        runEnd = end;
+        return end;
+    }
+
+
+    __attribute__((target("avx2")))
+    void avx2CopyUppercase(const char* source, size_t count, char* target)
+    {
+        size_t i = 0;
+
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+            __m256i lower = _mm256_and_si256(
+                _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('a' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), bytes));
+            __m256i upper = _mm256_sub_epi8(bytes, _mm256_and_si256(lower, _mm256_set1_epi8(0x20)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), upper);
+        }
+
+        sse2CopyUppercase(source + i, count - i, target + i);
+    }
+
+#endif // WORDTOKENIZER_X86
+}
+
+
+
+bool tokenizerKindSupported(TokenizerKind kind)
+{
+    switch (kind)
+    {
+#ifdef WORDTOKENIZER_X86
+    case TokenizerKind::Sse2:
+        return __builtin_cpu_supports("sse2");
+
+    case TokenizerKind::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+
+    case TokenizerKind::Scalar:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+TokenizerKind bestTokenizerKind()
+{
+    static const TokenizerKind best =
+        tokenizerKindSupported(TokenizerKind::Avx2) ? TokenizerKind::Avx2
+        : tokenizerKindSupported(TokenizerKind::Sse2) ? TokenizerKind::Sse2
+        : TokenizerKind::Scalar;
+
+    return best;
+}
+
+
+
+WordTokenizer::WordTokenizer(TokenizerKind kind, TextEncoding encoding)
+    : tokenizerKind{tokenizerKindSupported(kind) ? kind : TokenizerKind::Scalar},
+      textEncoding{encoding},
+      findRunFunction{encoding == TextEncoding::Utf8 ? scalarFindRun<true> : scalarFindRun<false>},
+      copyUppercaseFunction{scalarCopyUppercase}
+{
+#ifdef WORDTOKENIZER_X86
+    bool utf8 = encoding == TextEncoding::Utf8;
+
+    if (tokenizerKind == TokenizerKind::Sse2)
+    {
+        findRunFunction = utf8 ? sse2FindRun<true> : sse2FindRun<false>;
+        copyUppercaseFunction = sse2CopyUppercase;
+    }
+    else if (tokenizerKind == TokenizerKind::Avx2)
+    {
+        findRunFunction = utf8 ? avx2FindRun<true> : avx2FindRun<false>;
+        copyUppercaseFunction = avx2CopyUppercase;
+    }
+#endif
+}
+
+
+bool WordTokenizer::nextWord(
+    const char* data, size_t& index, size_t end, std::string& word,
+    size_t& wordStart, size_t& wordEnd) const
+{
+    while (true)
+    {
+        bool nonAscii = false;
+        size_t runEnd;
+        size_t runStart = findRunFunction(data, index, end, runEnd, nonAscii);
+
+        if (runStart >= end)
+        {
+            index = end;
+            return false;
+        }
+
+        if (nonAscii)
+        {
+            index = runStart;
+
+            if (nextUtf8Word(data, index, runEnd, word, wordStart, wordEnd))
+            {
+                return true;
+            }
+
+            index = runEnd;
+            continue;
+        }
+
+        // The whole run is one ASCII word.
+        index = runEnd;
+
+        if (!isAlnum(data[runEnd - 1]))
+        {
+            --runEnd;
+        }
+
+        word.resize(runEnd - runStart);
+        copyUppercase(data + runStart, runEnd - runStart, word.data());
+
+        wordStart = runStart;
+        wordEnd = runEnd;
+        return true;
+    }
+}
+
+
+// nextUtf8Word() finds the first word in a run that contains non-ASCII
+// bytes, decoding it one character at a time.  The run may hold more than
+// one word, or none, since it can include non-ASCII punctuation.
+bool WordTokenizer::nextUtf8Word(
+    const char* data, size_t& index, size_t runEnd, std::string& word,
+    size_t& wordStart, size_t& wordEnd) const
+{
+    char32_t codePoint = 0;
+    wordStart = index;
+
+    while (index < runEnd)
+    {
+        wordStart = index;
+
+        if (decodeUtf8(data, index, runEnd, codePoint) && isLetterOrDigit(codePoint))
+        {
+            break;
+        }
+    }
+
+    if (wordStart >= runEnd || !isLetterOrDigit(codePoint))
+    {
+        return false;
+    }
+
+    word.clear();
+    appendUtf8(toUppercase(codePoint), word);
+
+    bool endsWithPunctuation = false;
+    size_t lastStart = wordStart;
+
+    while (index < runEnd)
+    {
+        size_t next = index;
+
+        if (!decodeUtf8(data, next, runEnd, codePoint) || !isWordCharacter(codePoint))
+        {
+            break;
+        }
+
+        appendUtf8(toUppercase(codePoint), word);
+        endsWithPunctuation = codePoint == '-' || codePoint == '\'';
+        lastStart = index;
+        index = next;
+    }
+
+    if (endsWithPunctuation)
+    {
+        word.pop_back();
+    }
+
+    wordEnd = endsWithPunctuation ? lastStart : index;
+
+    return true;
+}
+
+
+TokenizerKind WordTokenizer::kind() const
+{
+    return tokenizerKind;
+}
+
+
+TextEncoding WordTokenizer::encoding() const
+{
+    return textEncoding;
+}
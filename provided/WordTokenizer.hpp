@@ -0,0 +1,110 @@
+// WordTokenizer.hpp
+//
+// A WordTokenizer finds the words within a range of bytes and copies them
+// out in uppercase.  A word begins with a letter or digit and continues
+// through letters, digits, hyphens and apostrophes, except that one
+// trailing hyphen or apostrophe is dropped.
+//
+// Text is UTF-8 by default, with non-ASCII letters classified and
+// converted to uppercase as described in Utf8.hpp, and invalid bytes
+// treated as punctuation.  Text can instead be treated as ASCII, in which
+// case every byte outside of ASCII is punctuation, as in the "C" locale.
+//
+// There are several implementations: a portable scalar one, one that uses
+// SSE2 to classify 16 bytes at a time, and one that uses AVX2 to classify
+// 32 bytes at a time with table lookups.  By default, the fastest one the
+// CPU supports is used.  They find runs of ASCII word characters, so words
+// made only of ASCII characters never go near the UTF-8 decoder; the
+// vectorized ones treat non-ASCII bytes as possibly part of a word, and
+// only runs that contain one are decoded.
+
+#ifndef WORDTOKENIZER_HPP
+#define WORDTOKENIZER_HPP
+
+#include <cstddef>
+#include <string>
+
+
+
+enum class TokenizerKind
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+
+enum class TextEncoding
+{
+    Ascii,
+    Utf8
+};
+
+
+// tokenizerKindSupported() returns true if the given kind of tokenizer can
+// run on this CPU, and bestTokenizerKind() returns the fastest one that can.
+bool tokenizerKindSupported(TokenizerKind kind);
+TokenizerKind bestTokenizerKind();
+
+
+
+class WordTokenizer
+{
+public:
+    // Initializes a tokenizer of the given kind.  If that kind isn't
+    // supported, the scalar implementation is used instead.
+    explicit WordTokenizer(
+        TokenizerKind kind = bestTokenizerKind(),
+        TextEncoding encoding = TextEncoding::Utf8);
+
+
+    // nextWord() finds the first word in data[index, end) and stores it,
+    // uppercased, in word.  It moves index past the word and returns true,
+    // or returns false if there are no more words.  The second overload
+    // also stores where the word is in data, as [wordStart, wordEnd),
+    // which doesn't include a dropped trailing hyphen or apostrophe.
+    bool nextWord(const char* data, size_t& index, size_t end, std::string& word) const
+    {
+        size_t wordStart;
+        size_t wordEnd;
+        return nextWord(data, index, end, word, wordStart, wordEnd);
+    }
+
+    bool nextWord(
+        const char* data, size_t& index, size_t end, std::string& word,
+        size_t& wordStart, size_t& wordEnd) const;
+
+
+    // copyUppercase() copies count bytes from source to target, converting
+    // ASCII lowercase letters to uppercase.  Source and target may be the
+    // same, to convert bytes in place, but must not otherwise overlap.
+    void copyUppercase(const char* source, size_t count, char* target) const
+    {
+        copyUppercaseFunction(source, count, target);
+    }
+
+
+    TokenizerKind kind() const;
+    TextEncoding encoding() const;
+
+
+private:
+    TokenizerKind tokenizerKind;
+    TextEncoding textEncoding;
+
+    // Finds the first run in data[index, end) that starts with an ASCII
+    // letter or digit (or, for UTF-8, any non-ASCII byte) and continues
+    // through ASCII word characters (and non-ASCII bytes), returning its
+    // start, storing its end in runEnd, and setting nonAscii if it
+    // contains any non-ASCII bytes.
+    size_t (*findRunFunction)(const char*, size_t, size_t, size_t&, bool&);
+    void (*copyUppercaseFunction)(const char*, size_t, char*);
+
+    bool nextUtf8Word(
+        const char* data, size_t& index, size_t runEnd, std::string& word,
+        size_t& wordStart, size_t& wordEnd) const;
+};
+
+
+
+#endif // WORDTOKENIZER_HPP